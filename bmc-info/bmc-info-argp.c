@@ -65,6 +65,7 @@ static struct argp_option cmdline_options[] =
     ARGP_COMMON_OPTIONS_WORKAROUND_FLAGS,
     ARGP_COMMON_HOSTRANGED_OPTIONS,
     ARGP_COMMON_OPTIONS_DEBUG,
+    ARGP_COMMON_OPTIONS_PACKET_TRACE,
     /* legacy */
     { "guid", GUID_KEY, NULL, OPTION_HIDDEN,
       "Display only device guid.", 40},
@@ -70,6 +70,7 @@ static struct argp_option cmdline_options[] =
     ARGP_COMMON_OPTIONS_CONFIG_FILE,
     ARGP_COMMON_OPTIONS_WORKAROUND_FLAGS,
     ARGP_COMMON_OPTIONS_DEBUG,
+    ARGP_COMMON_OPTIONS_PACKET_TRACE,
     { "set", SET_KEY, NULL, 0,
       "Set BMC Watchdog Config.", 40},
     { "get", GET_KEY, NULL, 0,
@@ -111,6 +111,13 @@ _init_bmc_watchdog (void)
   
   if (!(ipmi_ctx = ipmi_ctx_create ()))
     err_exit ("ipmi_ctx_create: %s", strerror (errno));
+
+  if (cmd_args.common_args.packet_trace_file)
+    {
+      if (ipmi_ctx_set_packet_trace_file (ipmi_ctx,
+                                          cmd_args.common_args.packet_trace_file) < 0)
+        err_exit ("ipmi_ctx_set_packet_trace_file: %s", ipmi_ctx_errormsg (ipmi_ctx));
+    }
   
   if (cmd_args.common_args.driver_type == IPMI_DEVICE_UNKNOWN)
     {
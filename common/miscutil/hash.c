@@ -31,6 +31,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -44,6 +45,7 @@
 
 #define HASH_ALLOC      1024
 #define HASH_DEF_SIZE   1213
+#define HASH_MAX_LOAD   2               /* avg chain length before growing  */
 #define HASH_MAGIC      0xDEADBEEF
 
 
@@ -55,12 +57,21 @@ struct hash_node {
     struct hash_node   *next;           /* next node in list                 */
     void               *data;           /* ptr to hashed item                */
     const void         *hkey;           /* ptr to hashed item's key          */
+    unsigned int        hval;           /* hashed item's key hash value      */
+};
+
+struct hash_slot {
+    void               *data;           /* ptr to hashed item, NULL if empty */
+    const void         *hkey;           /* ptr to hashed item's key          */
+    unsigned int        hval;           /* hashed item's key hash value      */
 };
 
 struct hash {
     int                 count;          /* number of items in hash table     */
     int                 size;           /* num slots allocated in hash table */
+    int                 capacity;       /* max items if fixed, o/w 0         */
     struct hash_node  **table;          /* hash table array of node ptrs     */
+    struct hash_slot   *slots;          /* open addressed slots if fixed     */
     hash_cmp_f          cmp_f;          /* key comparison function           */
     hash_del_f          del_f;          /* item deletion function            */
     hash_key_f          key_f;          /* key hash function                 */
@@ -81,6 +92,13 @@ static struct hash_node * hash_node_alloc (void);
 
 static void hash_node_free (struct hash_node *node);
 
+static void hash_grow (hash_t h);
+
+static struct hash_slot * hash_slot_lookup (hash_t h, const void *key,
+    unsigned int hval);
+
+static void hash_slot_clear (hash_t h, struct hash_slot *slot);
+
 
 /*****************************************************************************
  *  Variables
@@ -143,6 +161,43 @@ hash_create (int size, hash_key_f key_f, hash_cmp_f cmp_f, hash_del_f del_f)
     }
     h->count = 0;
     h->size = size;
+    h->capacity = 0;
+    h->slots = NULL;
+    h->cmp_f = cmp_f;
+    h->del_f = del_f;
+    h->key_f = key_f;
+    lsd_mutex_init (&h->mutex);
+    assert (h->magic = HASH_MAGIC);     /* set magic via assert abuse */
+    return (h);
+}
+
+
+hash_t
+hash_create_fixed (int size,
+    hash_key_f key_f, hash_cmp_f cmp_f, hash_del_f del_f)
+{
+    hash_t h;
+    int n;
+
+    if (!cmp_f || !key_f || size <= 0 || size > INT_MAX / 4) {
+        errno = EINVAL;
+        return (NULL);
+    }
+    /*  Keep the table at most half full so probe runs stay short.
+     */
+    for (n = 1; n < size * 2; n <<= 1)
+        ;
+    if (!(h = malloc (sizeof (*h)))) {
+        return (lsd_nomem_error (__FILE__, __LINE__, "hash_create_fixed"));
+    }
+    if (!(h->slots = calloc (n, sizeof (struct hash_slot)))) {
+        free (h);
+        return (lsd_nomem_error (__FILE__, __LINE__, "hash_create_fixed"));
+    }
+    h->count = 0;
+    h->size = n;
+    h->capacity = size;
+    h->table = NULL;
     h->cmp_f = cmp_f;
     h->del_f = del_f;
     h->key_f = key_f;
@@ -164,18 +219,27 @@ hash_destroy (hash_t h)
     }
     lsd_mutex_lock (&h->mutex);
     assert (h->magic == HASH_MAGIC);
-    for (i = 0; i < h->size; i++) {
-        for (p = h->table[i]; p != NULL; p = q) {
-            q = p->next;
-            if (h->del_f)
-                h->del_f (p->data);
-            hash_node_free (p);
+    if (h->slots) {
+        for (i = 0; i < h->size; i++) {
+            if (h->slots[i].data && h->del_f)
+                h->del_f (h->slots[i].data);
+        }
+    }
+    else {
+        for (i = 0; i < h->size; i++) {
+            for (p = h->table[i]; p != NULL; p = q) {
+                q = p->next;
+                if (h->del_f)
+                    h->del_f (p->data);
+                hash_node_free (p);
+            }
         }
     }
     assert (h->magic = ~HASH_MAGIC);    /* clear magic via assert abuse */
     lsd_mutex_unlock (&h->mutex);
     lsd_mutex_destroy (&h->mutex);
     free (h->table);
+    free (h->slots);
     free (h);
     return;
 }
@@ -218,7 +282,7 @@ hash_count (hash_t h)
 void *
 hash_find (hash_t h, const void *key)
 {
-    unsigned int slot;
+    unsigned int hval;
     struct hash_node *p;
     void *data = NULL;
 
@@ -227,15 +291,21 @@ hash_find (hash_t h, const void *key)
         return (NULL);
     }
     errno = 0;
+    hval = h->key_f (key);
     lsd_mutex_lock (&h->mutex);
     assert (h->magic == HASH_MAGIC);
-    slot = h->key_f (key) % h->size;
-    for (p = h->table[slot]; p != NULL; p = p->next) {
-        if (!h->cmp_f (p->hkey, key)) {
+    if (h->slots) {
+        data = hash_slot_lookup (h, key, hval)->data;
+        goto end;
+    }
+    for (p = h->table[hval % h->size]; p != NULL; p = p->next) {
+        if (p->hval == hval && !h->cmp_f (p->hkey, key)) {
             data = p->data;
             break;
         }
     }
+
+end:
     lsd_mutex_unlock (&h->mutex);
     return (data);
 }
@@ -245,17 +315,38 @@ void *
 hash_insert (hash_t h, const void *key, void *data)
 {
     struct hash_node *p;
+    struct hash_slot *s;
+    unsigned int hval;
     unsigned int slot;
 
     if (!h || !key || !data) {
         errno = EINVAL;
         return (NULL);
     }
+    hval = h->key_f (key);
     lsd_mutex_lock (&h->mutex);
     assert (h->magic == HASH_MAGIC);
-    slot = h->key_f (key) % h->size;
+    if (h->slots) {
+        s = hash_slot_lookup (h, key, hval);
+        if (s->data) {
+            errno = EEXIST;
+            data = NULL;
+        }
+        else if (h->count >= h->capacity) {
+            errno = ENOSPC;
+            data = NULL;
+        }
+        else {
+            s->hkey = key;
+            s->data = data;
+            s->hval = hval;
+            h->count++;
+        }
+        goto end;
+    }
+    slot = hval % h->size;
     for (p = h->table[slot]; p != NULL; p = p->next) {
-        if (!h->cmp_f (p->hkey, key)) {
+        if (p->hval == hval && !h->cmp_f (p->hkey, key)) {
             errno = EEXIST;
             data = NULL;
             goto end;
@@ -267,9 +358,12 @@ hash_insert (hash_t h, const void *key, void *data)
     }
     p->hkey = key;
     p->data = data;
+    p->hval = hval;
     p->next = h->table[slot];
     h->table[slot] = p;
     h->count++;
+    if (h->count > h->size * HASH_MAX_LOAD)
+        hash_grow (h);
 
 end:
     lsd_mutex_unlock (&h->mutex);
@@ -282,7 +376,8 @@ hash_remove (hash_t h, const void *key)
 {
     struct hash_node **pp;
     struct hash_node *p;
-    unsigned int slot;
+    struct hash_slot *s;
+    unsigned int hval;
     void *data = NULL;
 
     if (!h || !key) {
@@ -290,11 +385,17 @@ hash_remove (hash_t h, const void *key)
         return (NULL);
     }
     errno = 0;
+    hval = h->key_f (key);
     lsd_mutex_lock (&h->mutex);
     assert (h->magic == HASH_MAGIC);
-    slot = h->key_f (key) % h->size;
-    for (pp = &(h->table[slot]); (p = *pp) != NULL; pp = &((*pp)->next)) {
-        if (!h->cmp_f (p->hkey, key)) {
+    if (h->slots) {
+        s = hash_slot_lookup (h, key, hval);
+        if ((data = s->data))
+            hash_slot_clear (h, s);
+        goto end;
+    }
+    for (pp = &(h->table[hval % h->size]); (p = *pp) != NULL; pp = &((*pp)->next)) {
+        if (p->hval == hval && !h->cmp_f (p->hkey, key)) {
             data = p->data;
             *pp = p->next;
             hash_node_free (p);
@@ -302,6 +403,8 @@ hash_remove (hash_t h, const void *key)
             break;
         }
     }
+
+end:
     lsd_mutex_unlock (&h->mutex);
     return (data);
 }
@@ -311,8 +414,10 @@ int
 hash_delete_if (hash_t h, hash_arg_f arg_f, void *arg)
 {
     int i;
+    int start;
     struct hash_node **pp;
     struct hash_node *p;
+    struct hash_slot *s;
     int n = 0;
 
     if (!h || !arg_f) {
@@ -321,6 +426,24 @@ hash_delete_if (hash_t h, hash_arg_f arg_f, void *arg)
     }
     lsd_mutex_lock (&h->mutex);
     assert (h->magic == HASH_MAGIC);
+    if (h->slots) {
+        /*  Start just after an empty slot, so no probe run wraps past the
+         *    start.  Clearing a slot can then only shift not yet visited
+         *    items back into it, and each item is visited once.
+         */
+        for (start = 0; h->slots[start].data; start++)
+            ;
+        for (i = 1; i <= h->size; i++) {
+            s = &(h->slots[(start + i) & (h->size - 1)]);
+            while (s->data && arg_f (s->data, s->hkey, arg) > 0) {
+                if (h->del_f)
+                    h->del_f (s->data);
+                hash_slot_clear (h, s);
+                n++;
+            }
+        }
+        goto end;
+    }
     for (i = 0; i < h->size; i++) {
         pp = &(h->table[i]);
         while ((p = *pp) != NULL) {
@@ -337,6 +460,8 @@ hash_delete_if (hash_t h, hash_arg_f arg_f, void *arg)
             }
         }
     }
+
+end:
     lsd_mutex_unlock (&h->mutex);
     return (n);
 }
@@ -355,13 +480,23 @@ hash_for_each (hash_t h, hash_arg_f arg_f, void *arg)
     }
     lsd_mutex_lock (&h->mutex);
     assert (h->magic == HASH_MAGIC);
-    for (i = 0; i < h->size; i++) {
-        for (p = h->table[i]; p != NULL; p = p->next) {
-            if (arg_f (p->data, p->hkey, arg) > 0) {
+    if (h->slots) {
+        for (i = 0; i < h->size; i++) {
+            if (h->slots[i].data
+                && arg_f (h->slots[i].data, h->slots[i].hkey, arg) > 0) {
                 n++;
             }
         }
     }
+    else {
+        for (i = 0; i < h->size; i++) {
+            for (p = h->table[i]; p != NULL; p = p->next) {
+                if (arg_f (p->data, p->hkey, arg) > 0) {
+                    n++;
+                }
+            }
+        }
+    }
     lsd_mutex_unlock (&h->mutex);
     return (n);
 }
@@ -374,12 +509,16 @@ hash_for_each (hash_t h, hash_arg_f arg_f, void *arg)
 unsigned int
 hash_key_string (const char *str)
 {
+/*  FNV-1a.  Each character is mixed into the whole value, so long keys
+ *    differing only early on (e.g. hostnames sharing a domain) spread out.
+ */
     unsigned char *p;
-    unsigned int hval = 0;
-    const unsigned int multiplier = 31;
+    unsigned int hval = 2166136261U;
+    const unsigned int prime = 16777619U;
 
     for (p = (unsigned char *) str; *p != '\0'; p++) {
-        hval += (multiplier * hval) + *p;
+        hval ^= *p;
+        hval *= prime;
     }
     return (hval);
 }
@@ -444,3 +583,86 @@ hash_node_free (struct hash_node *node)
 #endif
     return;
 }
+
+
+static void
+hash_grow (hash_t h)
+{
+/*  Roughly doubles the number of slots in chained hash table [h],
+ *    relinking the existing nodes into the new table.
+ *  If the new table cannot be allocated, [h] is left at its current size.
+ */
+    struct hash_node **table;
+    struct hash_node *p, *q;
+    unsigned int slot;
+    int size;
+    int i;
+    int e;
+
+    assert (h->table != NULL);
+    if (h->size > (INT_MAX - 1) / 2)
+        return;
+    size = (h->size * 2) + 1;
+    e = errno;
+    if (!(table = calloc (size, sizeof (struct hash_node *)))) {
+        errno = e;
+        return;
+    }
+    for (i = 0; i < h->size; i++) {
+        for (p = h->table[i]; p != NULL; p = q) {
+            q = p->next;
+            slot = p->hval % size;
+            p->next = table[slot];
+            table[slot] = p;
+        }
+    }
+    free (h->table);
+    h->table = table;
+    h->size = size;
+    return;
+}
+
+
+static struct hash_slot *
+hash_slot_lookup (hash_t h, const void *key, unsigned int hval)
+{
+/*  Returns the slot holding [key] in fixed hash table [h], or the empty
+ *    slot ending its probe run if [key] is not in the table.
+ */
+    unsigned int mask = h->size - 1;
+    unsigned int i;
+
+    assert (h->slots != NULL);
+    for (i = hval & mask; h->slots[i].data; i = (i + 1) & mask) {
+        if (h->slots[i].hval == hval && !h->cmp_f (h->slots[i].hkey, key))
+            break;
+    }
+    return (&(h->slots[i]));
+}
+
+
+static void
+hash_slot_clear (hash_t h, struct hash_slot *slot)
+{
+/*  Empties [slot] in fixed hash table [h].  Later items in the same probe
+ *    run are shifted back into the hole, so lookups never stop short.
+ */
+    unsigned int mask = h->size - 1;
+    unsigned int i, j, home;
+
+    assert (h->slots != NULL);
+    i = j = slot - h->slots;
+    while (1) {
+        j = (j + 1) & mask;
+        if (!h->slots[j].data)
+            break;
+        home = h->slots[j].hval & mask;
+        if ((i < j) ? (home <= i || home > j) : (home <= i && home > j)) {
+            h->slots[i] = h->slots[j];
+            i = j;
+        }
+    }
+    memset (&(h->slots[i]), 0, sizeof (struct hash_slot));
+    h->count--;
+    return;
+}
@@ -97,9 +97,10 @@ hash_t hash_create (int size,
  *  Creates and returns a new hash table on success.
  *    Returns lsd_nomem_error() with errno=ENOMEM if memory allocation fails.
  *    Returns NULL with errno=EINVAL if [keyf] or [cmpf] is not specified.
- *  The [size] is the number of slots in the table; a larger table requires
- *    more memory, but generally provide quicker access times.  If set <= 0,
- *    the default size is used.
+ *  The [size] is the initial number of slots in the table; a larger table
+ *    requires more memory, but generally provide quicker access times.  If
+ *    set <= 0, the default size is used.  The table grows as items are
+ *    inserted, once there are on average more than two items per slot.
  *  The [keyf] function converts a key into a hash value.
  *  The [cmpf] function determines whether two keys are equal.
  *  The [delf] function de-allocates memory used by items in the hash;
@@ -107,6 +108,17 @@ hash_t hash_create (int size,
  *    when the hash is destroyed.
  */
 
+hash_t hash_create_fixed (int size,
+    hash_key_f key_f, hash_cmp_f cmp_f, hash_del_f del_f);
+/*
+ *  Like hash_create(), but for a table that will never hold more than
+ *    [size] items.  Items are kept in the table itself (open addressing)
+ *    instead of in separately allocated nodes, so inserts never allocate.
+ *  Returns NULL with errno=EINVAL if [size] <= 0.
+ *  Once [size] items are in the table, hash_insert() returns NULL with
+ *    errno=ENOSPC.
+ */
+
 void hash_destroy (hash_t h);
 /*
  *  Destroys hash table [h].  If a deletion function was specified when the
@@ -139,6 +151,7 @@ void * hash_insert (hash_t h, const void *key, void *data);
  *  Returns a ptr to the inserted item's data on success.
  *    Returns NULL with errno=EEXIST if [key] already exists in the hash.
  *    Returns NULL with errno=EINVAL if [key] or [data] is not specified.
+ *    Returns NULL with errno=ENOSPC if a fixed hash is full.
  *    Returns lsd_nomem_error() with errno=ENOMEM if memory allocation fails.
  */
 
@@ -145,9 +145,11 @@ static List list_free_lists = NULL;
 static ListNode list_free_nodes = NULL;
 static ListIterator list_free_iterators = NULL;
 
+#if 0
 #ifdef WITH_PTHREADS
 static pthread_mutex_t list_free_lock = PTHREAD_MUTEX_INITIALIZER;
 #endif /* WITH_PTHREADS */
+#endif
 
 
 /************
@@ -775,6 +777,10 @@ list_alloc_aux (int size, void *pfreelist)
 /*  Allocates an object of [size] bytes from the freelist [*pfreelist].
  *  Memory is added to the freelist in chunks of size LIST_ALLOC.
  *  Returns a ptr to the object, or NULL if the memory request fails.
+ *
+ *  The freelist is disabled and objects come straight from malloc(),
+ *  whose per-thread caches already recycle small objects without a
+ *  shared lock.  So list_free_lock is only taken with the freelist.
  */
 #if 0
     void **px;
@@ -788,8 +794,8 @@ list_alloc_aux (int size, void *pfreelist)
     assert(size >= sizeof(void *));
     assert(pfreelist != NULL);
     assert(LIST_ALLOC > 0);
-    list_mutex_lock(&list_free_lock);
 #if 0
+    list_mutex_lock(&list_free_lock);
     if (!*pfree) {
         if ((*pfree = malloc(LIST_ALLOC * size))) {
             px = *pfree;
@@ -803,14 +809,11 @@ list_alloc_aux (int size, void *pfreelist)
         *pfree = *px;
     else
         errno = ENOMEM;
-#else
-    if (!(ptr = malloc(size)))
-      errno = ENOMEM;
-#endif
     list_mutex_unlock(&list_free_lock);
-#if 0
     return(px);
 #else
+    if (!(ptr = malloc(size)))
+      errno = ENOMEM;
     return(ptr);
 #endif
 }
@@ -828,14 +831,14 @@ list_free_aux (void *x, void *pfreelist)
 
     assert(x != NULL);
     assert(pfreelist != NULL);
-    list_mutex_lock(&list_free_lock);
 #if 0
+    list_mutex_lock(&list_free_lock);
     *px = *pfree;
     *pfree = px;
+    list_mutex_unlock(&list_free_lock);
 #else
     free(x);
 #endif
-    list_mutex_unlock(&list_free_lock);
     return;
 }
 
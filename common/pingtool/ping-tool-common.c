@@ -73,6 +73,8 @@
 #include <freeipmi/freeipmi.h>
 
 #include "freeipmi-portability.h"
+#include "fi_hostlist.h"
+#include "hash.h"
 
 #include "ping-tool-common.h"
 
@@ -92,6 +94,10 @@
 #define IPMI_PING_MAX_PKT_LEN      1024
 #define IPMI_PING_MAX_ERR_LEN      1024
 
+#define IPMI_PING_HOSTRANGE_BUFLEN 65536
+
+#define IPMI_PING_RTT_LEN_INITIAL  64
+
 #define IPMI_PING_VERSION_1_5_STR  "1.5"
 #define IPMI_PING_VERSION_2_0_STR  "2.0"
 
@@ -113,6 +119,7 @@ static int pingtool_verbose = 0;
 static int pingtool_debug = 0;
 static int pingtool_version = IPMI_PING_VERSION_1_5;
 static int pingtool_initial_sequence_number = -1;
+static int pingtool_rate = 0;
 
 /* globals */
 static int pingtool_sockfd = 0;
@@ -132,6 +139,37 @@ static unsigned int pingtool_pkt_sent = 0;
 static unsigned int pingtool_pkt_recv = 0;
 static Ipmi_Ping_EndResult pingtool_end_result = NULL;
 
+/* Hostrange sweeps.  All hosts are pinged from the one socket set up
+ * for the first host, responses are matched to hosts by source
+ * address.  Outstanding requests are kept on a list in the order they
+ * were sent, the timeout is the same for every request so the head of
+ * the list is always the next to time out.
+ */
+struct pingtool_host
+{
+  char dest[MAXHOSTNAMELEN+1];
+  char dest_ip[INET6_ADDRSTRLEN+1];
+  struct sockaddr_in6 destaddr;   /* large enough for either family */
+  socklen_t destaddr_len;
+  unsigned int sequence_number;
+  unsigned int pkt_sent;
+  unsigned int pkt_recv;
+  int outstanding;
+  uint64_t last_send;             /* usecs */
+  int prev;
+  int next;
+  unsigned int *rtt;              /* usecs */
+  unsigned int rtt_len;
+  unsigned int rtt_size;
+};
+
+static char *pingtool_hostrange = NULL;
+static struct pingtool_host *pingtool_hosts = NULL;
+static unsigned int pingtool_hosts_count = 0;
+static hash_t pingtool_hosts_hash = NULL;
+static int pingtool_outstanding_head = -1;
+static int pingtool_outstanding_tail = -1;
+
 static void
 _cleanup (void)
 {
@@ -175,7 +213,7 @@ _strncpy (char *dest, char *src, unsigned int len)
   assert (src);
 
   strncpy (dest, src, len);
-  dest[len] = '0';
+  dest[len] = '\0';
 }
 
 static void
@@ -184,7 +222,7 @@ _output_usage (const char *options)
   assert (pingtool_progname);
   assert (options);
 
-  fprintf (stderr, "%s [OPTIONS] destination\n", pingtool_progname);
+  fprintf (stderr, "%s [OPTIONS] destination|hostrange\n", pingtool_progname);
   if (strchr (options, 'c'))
     fprintf (stderr, "  -c   count\n");
   if (strchr (options, 'i'))
@@ -199,6 +237,8 @@ _output_usage (const char *options)
     fprintf (stderr, "  -r   protocol version\n");
   if (strchr (options, 's'))
     fprintf (stderr, "  -s   starting sequence number\n");
+  if (strchr (options, 'R'))
+    fprintf (stderr, "  -R   hostrange rate limit in packets per second\n");
   if (strchr (options, 'd'))
     fprintf (stderr, "  -d   turn on debugging\n");
   exit (EXIT_FAILURE);
@@ -285,6 +325,14 @@ _cmdline_parse (int argc,
               || pingtool_initial_sequence_number > max_sequence_number)
             ipmi_ping_err_exit ("initial sequence number out of range");
           break;
+        case 'R':
+          errno = 0;
+          pingtool_rate = strtol (optarg, &endptr, 10);
+          if (errno || endptr[0] != '\0')
+            ipmi_ping_err_exit ("rate argument invalid");
+          if (pingtool_rate <= 0)
+            ipmi_ping_err_exit ("rate must be > 0");
+          break;
         case 'd':
           pingtool_debug++;
           break;
@@ -299,6 +347,7 @@ _cmdline_parse (int argc,
     ipmi_ping_err_exit ("destination must be specified");
 
   _strncpy (pingtool_dest, argv[optind], MAXHOSTNAMELEN);
+  pingtool_hostrange = argv[optind];
 }
 
 /* signal handlers + sleep(3) is a bad idea, so use select(3) */
@@ -316,6 +365,200 @@ _sleep (unsigned int len)
   return (0);
 }
 
+static uint64_t
+_now_usec (void)
+{
+  struct timeval tv;
+
+  if (gettimeofday (&tv, NULL) < 0)
+    ipmi_ping_err_exit ("gettimeofday: %s", strerror (errno));
+
+  return ((uint64_t)tv.tv_sec * 1000000 + tv.tv_usec);
+}
+
+static void
+_sockaddr_str (const struct sockaddr_in6 *addr6, char *str)
+{
+  assert (addr6);
+  assert (str);
+
+  memset (str, '\0', INET6_ADDRSTRLEN + 1);
+  if (addr6->sin6_family == AF_INET6)
+    {
+      if (!inet_ntop (AF_INET6, &addr6->sin6_addr, str, INET6_ADDRSTRLEN))
+        ipmi_ping_err_exit ("inet_ntop: %s\n", strerror (errno));
+    }
+  else
+    {
+      /* memcpy hacks to avoid warnings, i.e.
+       * warning: dereferencing pointer 'X' does break strict-aliasing rules
+       */
+      struct sockaddr_in addr4;
+
+      memcpy (&addr4, addr6, sizeof (struct sockaddr_in));
+
+      if (!inet_ntop (AF_INET, &addr4.sin_addr, str, INET6_ADDRSTRLEN))
+        ipmi_ping_err_exit ("inet_ntop: %s\n", strerror (errno));
+    }
+}
+
+static void
+_outstanding_add (unsigned int index)
+{
+  struct pingtool_host *host;
+
+  assert (index < pingtool_hosts_count);
+
+  host = &pingtool_hosts[index];
+  host->outstanding = 1;
+  host->prev = pingtool_outstanding_tail;
+  host->next = -1;
+
+  if (pingtool_outstanding_tail >= 0)
+    pingtool_hosts[pingtool_outstanding_tail].next = index;
+  else
+    pingtool_outstanding_head = index;
+  pingtool_outstanding_tail = index;
+}
+
+static void
+_outstanding_remove (unsigned int index)
+{
+  struct pingtool_host *host;
+
+  assert (index < pingtool_hosts_count);
+
+  host = &pingtool_hosts[index];
+  assert (host->outstanding);
+
+  if (host->prev >= 0)
+    pingtool_hosts[host->prev].next = host->next;
+  else
+    pingtool_outstanding_head = host->next;
+
+  if (host->next >= 0)
+    pingtool_hosts[host->next].prev = host->prev;
+  else
+    pingtool_outstanding_tail = host->prev;
+
+  host->outstanding = 0;
+  host->prev = -1;
+  host->next = -1;
+}
+
+static void
+_rtt_add (struct pingtool_host *host, uint64_t rtt)
+{
+  assert (host);
+
+  if (host->rtt_len == host->rtt_size)
+    {
+      unsigned int size;
+      unsigned int *tmp;
+
+      size = host->rtt_size ? host->rtt_size * 2 : IPMI_PING_RTT_LEN_INITIAL;
+      if (!(tmp = realloc (host->rtt, size * sizeof (unsigned int))))
+        ipmi_ping_err_exit ("realloc: %s", strerror (errno));
+
+      host->rtt = tmp;
+      host->rtt_size = size;
+    }
+
+  host->rtt[host->rtt_len++] = rtt > UINT_MAX ? UINT_MAX : rtt;
+}
+
+static int
+_rtt_cmp (const void *a, const void *b)
+{
+  unsigned int rtt_a = *((const unsigned int *)a);
+  unsigned int rtt_b = *((const unsigned int *)b);
+
+  if (rtt_a < rtt_b)
+    return (-1);
+  if (rtt_a > rtt_b)
+    return (1);
+  return (0);
+}
+
+/* Per host statistics are output through the tool's end result, so
+ * they read the same as with a single destination, followed by the
+ * round trip times and a summary of the hosts that never responded.
+ */
+static int
+_sweep_end_result (void)
+{
+  fi_hostlist_t noresponse = NULL;
+  unsigned int responding = 0;
+  unsigned int i;
+  int ret, rv = 0;
+
+  assert (pingtool_progname);
+  assert (pingtool_end_result);
+
+  if (!(noresponse = fi_hostlist_create (NULL)))
+    ipmi_ping_err_exit ("fi_hostlist_create: %s", strerror (errno));
+
+  for (i = 0; i < pingtool_hosts_count; i++)
+    {
+      struct pingtool_host *host = &pingtool_hosts[i];
+
+      if ((ret = pingtool_end_result (pingtool_progname,
+                                      host->dest,
+                                      host->pkt_sent,
+                                      host->pkt_recv)))
+        rv = ret;
+
+      if (host->rtt_len)
+        {
+          uint64_t sum = 0;
+          unsigned int p99;
+          unsigned int j;
+
+          qsort (host->rtt, host->rtt_len, sizeof (unsigned int), _rtt_cmp);
+
+          for (j = 0; j < host->rtt_len; j++)
+            sum += host->rtt[j];
+
+          /* nearest rank */
+          p99 = (host->rtt_len * 99 + 99) / 100;
+
+          printf ("rtt min/avg/max/p99 = %.3f/%.3f/%.3f/%.3f ms\n",
+                  host->rtt[0] / 1000.0,
+                  ((double)sum / host->rtt_len) / 1000.0,
+                  host->rtt[host->rtt_len - 1] / 1000.0,
+                  host->rtt[p99 - 1] / 1000.0);
+
+          responding++;
+        }
+      else
+        {
+          if (!fi_hostlist_push_host (noresponse, host->dest))
+            ipmi_ping_err_exit ("fi_hostlist_push_host: %s", strerror (errno));
+        }
+    }
+
+  printf ("--- %s %s sweep statistics ---\n",
+          pingtool_progname,
+          pingtool_hostrange);
+  printf ("%u hosts, %u responding, %u not responding\n",
+          pingtool_hosts_count,
+          responding,
+          pingtool_hosts_count - responding);
+
+  if (responding < pingtool_hosts_count)
+    {
+      char buf[IPMI_PING_HOSTRANGE_BUFLEN];
+
+      if (fi_hostlist_ranged_string (noresponse, IPMI_PING_HOSTRANGE_BUFLEN, buf) < 0)
+        ipmi_ping_err_exit ("fi_hostlist_ranged_string: %s", strerror (errno));
+
+      printf ("not responding: %s\n", buf);
+    }
+
+  fi_hostlist_destroy (noresponse);
+  return (rv);
+}
+
 static void
 _signal_handler (int sig)
 {
@@ -327,14 +570,73 @@ _signal_handler (int sig)
   /* Must output result here, b/c who knows where in the code we are
    * when we caught the signal
    */
-  ret = pingtool_end_result (pingtool_progname,
-                             pingtool_dest,
-                             pingtool_pkt_sent,
-                             pingtool_pkt_recv);
+  if (pingtool_hosts_count)
+    ret = _sweep_end_result ();
+  else
+    ret = pingtool_end_result (pingtool_progname,
+                               pingtool_dest,
+                               pingtool_pkt_sent,
+                               pingtool_pkt_recv);
   _cleanup ();
   exit (ret);
 }
 
+/* A destination that expands to more than one host is swept.  A
+ * destination that isn't a valid hostrange is left to getaddrinfo.
+ */
+static void
+_hostrange_setup (void)
+{
+  fi_hostlist_t hl = NULL;
+  fi_hostlist_iterator_t itr = NULL;
+  unsigned int count;
+  char *host;
+
+  assert (pingtool_hostrange);
+
+  if (!(hl = fi_hostlist_create (pingtool_hostrange)))
+    return;
+
+  fi_hostlist_uniq (hl);
+
+  if (fi_hostlist_count (hl) <= 1)
+    goto cleanup;
+
+  count = fi_hostlist_count (hl);
+
+  if (!(pingtool_hosts = calloc (count, sizeof (struct pingtool_host))))
+    ipmi_ping_err_exit ("calloc: %s", strerror (errno));
+
+  if (!(itr = fi_hostlist_iterator_create (hl)))
+    ipmi_ping_err_exit ("fi_hostlist_iterator_create: %s", strerror (errno));
+
+  while ((host = fi_hostlist_next (itr)) && pingtool_hosts_count < count)
+    {
+      struct pingtool_host *h = &pingtool_hosts[pingtool_hosts_count];
+
+      if (strlen (host) > MAXHOSTNAMELEN)
+        ipmi_ping_err_exit ("hostname too long: %s", host);
+
+      _strncpy (h->dest, host, MAXHOSTNAMELEN);
+      h->prev = -1;
+      h->next = -1;
+      pingtool_hosts_count++;
+      free (host);
+    }
+
+  /* the socket is setup for the first host as with a single
+   * destination, its length was checked above
+   */
+  memcpy (pingtool_dest,
+          pingtool_hosts[0].dest,
+          strlen (pingtool_hosts[0].dest) + 1);
+
+ cleanup:
+  if (itr)
+    fi_hostlist_iterator_destroy (itr);
+  fi_hostlist_destroy (hl);
+}
+
 static void
 _setup (void)
 {
@@ -528,6 +830,21 @@ _setup (void)
   freeaddrinfo (ai_res);
 }
 
+static void
+_initial_sequence_number_setup (void)
+{
+  if (pingtool_initial_sequence_number < 0)
+    {
+      int len;
+
+      if ((len = ipmi_get_random (&pingtool_initial_sequence_number,
+                                  sizeof (pingtool_initial_sequence_number))) < 0)
+        ipmi_ping_err_exit ("ipmi_get_random: %s", strerror (errno));
+      if (len != sizeof (pingtool_initial_sequence_number))
+        ipmi_ping_err_exit ("ipmi_get_random: invalid len returned");
+    }
+}
+
 static void
 _main_loop (Ipmi_Ping_CreatePacket create,
             Ipmi_Ping_ParsePacket parse,
@@ -543,16 +860,7 @@ _main_loop (Ipmi_Ping_CreatePacket create,
   assert (pingtool_progname);
   assert (pingtool_end_result);
 
-  if (pingtool_initial_sequence_number < 0)
-    {
-      int len;
-
-      if ((len = ipmi_get_random (&pingtool_initial_sequence_number,
-                                  sizeof (pingtool_initial_sequence_number))) < 0)
-        ipmi_ping_err_exit ("ipmi_get_random: %s", strerror (errno));
-      if (len != sizeof (pingtool_initial_sequence_number))
-        ipmi_ping_err_exit ("ipmi_get_random: invalid len returned");
-    }
+  _initial_sequence_number_setup ();
 
   sequence_number = pingtool_initial_sequence_number;
 
@@ -662,24 +970,7 @@ _main_loop (Ipmi_Ping_CreatePacket create,
               if (len < 0)
                 ipmi_ping_err_exit ("ipmi_recvfrom: %s", strerror (errno));
 
-	      memset (fromstr, '\0', INET6_ADDRSTRLEN + 1);
-              if (from6.sin6_family == AF_INET6)
-                {
-                  if (!inet_ntop (AF_INET6, &from6.sin6_addr, fromstr, INET6_ADDRSTRLEN))
-                    ipmi_ping_err_exit ("inet_ntop: %s\n", strerror (errno));
-                }
-              else
-                {
-                  /* memcpy hacks to avoid warnings, i.e.
-                   * warning: dereferencing pointer 'X' does break strict-aliasing rules
-                   */
-                  struct sockaddr_in from4;
-
-                  memcpy (&from4, &from6, fromlen);
-
-                  if (!inet_ntop (AF_INET, &from4.sin_addr, fromstr, INET6_ADDRSTRLEN))
-                    ipmi_ping_err_exit ("inet_ntop: %s\n", strerror (errno));
-                }
+              _sockaddr_str (&from6, fromstr);
 
               if ((rv = parse (pingtool_dest,
                                buf,
@@ -718,6 +1009,255 @@ _main_loop (Ipmi_Ping_CreatePacket create,
   exit (ret);
 }
 
+static void
+_hostrange_resolve (void)
+{
+  struct addrinfo ai_hints, *ai_res = NULL;
+  uint16_t port = RMCP_PRIMARY_RMCP_PORT;
+  char port_str[MAXPORTBUFLEN + 1];
+  unsigned int i;
+  int ret;
+
+  assert (pingtool_hosts_count);
+  assert (pingtool_destaddr);
+
+  memset (port_str, '\0', MAXPORTBUFLEN + 1);
+  snprintf (port_str, MAXPORTBUFLEN, "%d", port);
+  memset (&ai_hints, 0, sizeof (struct addrinfo));
+  /* one socket, so every host must be of the first host's family */
+  ai_hints.ai_family = pingtool_destaddr->sa_family;
+  ai_hints.ai_socktype = SOCK_DGRAM;
+  ai_hints.ai_flags = AI_ADDRCONFIG;
+
+  if (!(pingtool_hosts_hash = hash_create_fixed (pingtool_hosts_count,
+                                                 (hash_key_f)hash_key_string,
+                                                 (hash_cmp_f)strcmp,
+                                                 NULL)))
+    ipmi_ping_err_exit ("hash_create_fixed: %s", strerror (errno));
+
+  for (i = 0; i < pingtool_hosts_count; i++)
+    {
+      struct pingtool_host *host = &pingtool_hosts[i];
+
+      if (!i)
+        {
+          memcpy (&host->destaddr, pingtool_destaddr, pingtool_destaddr_len);
+          host->destaddr_len = pingtool_destaddr_len;
+        }
+      else
+        {
+          if ((ret = getaddrinfo (host->dest, port_str, &ai_hints, &ai_res)))
+            ipmi_ping_err_exit ("getaddrinfo: %s: %s", host->dest, gai_strerror (ret));
+
+          memcpy (&host->destaddr, ai_res->ai_addr, ai_res->ai_addrlen);
+          host->destaddr_len = ai_res->ai_addrlen;
+
+          freeaddrinfo (ai_res);
+          ai_res = NULL;
+        }
+
+      _sockaddr_str (&host->destaddr, host->dest_ip);
+
+      if (!hash_insert (pingtool_hosts_hash, host->dest_ip, host))
+        {
+          if (errno == EEXIST)
+            ipmi_ping_err_exit ("%s: duplicate address %s", host->dest, host->dest_ip);
+          ipmi_ping_err_exit ("hash_insert: %s", strerror (errno));
+        }
+    }
+}
+
+/* Hosts are sent to in rounds, a round starting every interval.  As
+ * with a single destination, a host still waiting on its last request
+ * when its turn comes up is passed over until the response arrives or
+ * the request times out.  With a rate limit the sends within a round
+ * are spaced out instead of sent in one burst.
+ */
+static void
+_sweep_loop (Ipmi_Ping_CreatePacket create,
+             Ipmi_Ping_ParsePacket parse,
+             Ipmi_Ping_LatePacket late)
+{
+  uint64_t interval = (uint64_t)pingtool_interval * 1000000;
+  uint64_t timeout = (uint64_t)pingtool_timeout * 1000000;
+  uint64_t spacing = pingtool_rate ? 1000000 / pingtool_rate : 0;
+  uint64_t round_start, next_send = 0, now;
+  unsigned int hosts_done = 0;
+  unsigned int cursor = 0;
+  unsigned int i;
+  int ret;
+
+  assert (create);
+  assert (parse);
+  assert (late);
+  assert (pingtool_progname);
+  assert (pingtool_hosts_count);
+
+  _initial_sequence_number_setup ();
+
+  for (i = 0; i < pingtool_hosts_count; i++)
+    pingtool_hosts[i].sequence_number = pingtool_initial_sequence_number;
+
+  printf ("%s %s (%u hosts)\n",
+          pingtool_progname,
+          pingtool_hostrange,
+          pingtool_hosts_count);
+
+  round_start = _now_usec ();
+
+  while (1)
+    {
+      uint8_t buf[IPMI_PING_MAX_PKT_LEN];
+      struct sockaddr_in6 from6;
+      socklen_t fromlen;
+      char fromstr[INET6_ADDRSTRLEN+1];
+      struct pingtool_host *host;
+      uint64_t wakeup;
+      struct timeval tv;
+      fd_set rset;
+      int rv, len;
+
+      now = _now_usec ();
+
+      /* the oldest request is always the next to time out */
+      while (pingtool_outstanding_head >= 0
+             && now - pingtool_hosts[pingtool_outstanding_head].last_send >= timeout)
+        {
+          host = &pingtool_hosts[pingtool_outstanding_head];
+          _outstanding_remove (pingtool_outstanding_head);
+          printf ("%s: ", host->dest);
+          late (host->sequence_number);
+          host->sequence_number++;
+        }
+
+      if (cursor == pingtool_hosts_count
+          && hosts_done < pingtool_hosts_count
+          && now >= round_start + interval)
+        {
+          cursor = 0;
+          round_start = now;
+        }
+
+      while (cursor < pingtool_hosts_count && now >= next_send)
+        {
+          host = &pingtool_hosts[cursor];
+
+          if (host->outstanding
+              || (pingtool_count != -1 && host->pkt_sent >= pingtool_count))
+            {
+              cursor++;
+              continue;
+            }
+
+          if ((len = create (host->dest,
+                             buf,
+                             IPMI_PING_MAX_PKT_LEN,
+                             host->sequence_number,
+                             pingtool_version,
+                             pingtool_debug)) < 0)
+            ipmi_ping_err_exit ("_create failed: %s", strerror (errno));
+
+          rv = ipmi_lan_sendto (pingtool_sockfd,
+                                buf,
+                                len,
+                                0,
+                                (struct sockaddr *)&host->destaddr,
+                                host->destaddr_len);
+          if (rv < 0)
+            ipmi_ping_err_exit ("ipmi_sendto: %s", strerror (errno));
+
+          if (rv != len)
+            ipmi_ping_err_exit ("ipmi_sendto: wrong bytes written");
+
+          host->last_send = now;
+          host->pkt_sent++;
+          _outstanding_add (cursor);
+
+          if (pingtool_count != -1 && host->pkt_sent == pingtool_count)
+            hosts_done++;
+
+          next_send = now + spacing;
+          cursor++;
+        }
+
+      if (hosts_done == pingtool_hosts_count
+          && pingtool_outstanding_head < 0)
+        break;
+
+      if (cursor < pingtool_hosts_count)
+        wakeup = next_send;
+      else if (hosts_done < pingtool_hosts_count)
+        wakeup = round_start + interval;
+      else
+        wakeup = pingtool_hosts[pingtool_outstanding_head].last_send + timeout;
+
+      if (pingtool_outstanding_head >= 0
+          && pingtool_hosts[pingtool_outstanding_head].last_send + timeout < wakeup)
+        wakeup = pingtool_hosts[pingtool_outstanding_head].last_send + timeout;
+
+      now = _now_usec ();
+      wakeup = wakeup > now ? wakeup - now : 0;
+
+      FD_ZERO (&rset);
+      FD_SET (pingtool_sockfd, &rset);
+
+      tv.tv_sec = wakeup / 1000000;
+      tv.tv_usec = wakeup % 1000000;
+
+      if ((rv = select (pingtool_sockfd+1, &rset, NULL, NULL, &tv)) < 0)
+        ipmi_ping_err_exit ("select: %s", strerror (errno));
+
+      if (!rv)
+        continue;
+
+      fromlen = sizeof (from6);
+      len = ipmi_lan_recvfrom (pingtool_sockfd,
+                               buf,
+                               IPMI_PING_MAX_PKT_LEN,
+                               0,
+                               (struct sockaddr *)&from6,
+                               &fromlen);
+
+      /* see _main_loop for ignoring ECONNRESET and ECONNREFUSED */
+      if (len < 0
+          && (errno == ECONNRESET
+              || errno == ECONNREFUSED))
+        continue;
+
+      if (len < 0)
+        ipmi_ping_err_exit ("ipmi_recvfrom: %s", strerror (errno));
+
+      _sockaddr_str (&from6, fromstr);
+
+      /* not one of ours, or a response after the request timed out */
+      if (!(host = hash_find (pingtool_hosts_hash, fromstr))
+          || !host->outstanding)
+        continue;
+
+      if ((rv = parse (host->dest,
+                       buf,
+                       len,
+                       fromstr,
+                       host->sequence_number,
+                       pingtool_verbose,
+                       pingtool_version,
+                       pingtool_debug)) < 0)
+        ipmi_ping_err_exit ("_parse failed: %s", strerror (errno));
+
+      if (!rv)
+        continue;
+
+      _rtt_add (host, _now_usec () - host->last_send);
+      _outstanding_remove (host - pingtool_hosts);
+      host->pkt_recv++;
+      host->sequence_number++;
+    }
+
+  ret = _sweep_end_result ();
+  _cleanup ();
+  exit (ret);
+}
+
 void
 ipmi_ping_setup (int argc,
                  char **argv,
@@ -725,7 +1265,7 @@ ipmi_ping_setup (int argc,
                  unsigned int max_sequence_number,
                  const char *options)
 {
-  char *valid_options = "hVciItvrsd:";
+  char *valid_options = "hVciItvrsRd:";
   char *ptr;
   char c;
 
@@ -751,7 +1291,10 @@ ipmi_ping_setup (int argc,
                   min_sequence_number,
                   max_sequence_number,
                   options);
+  _hostrange_setup ();
   _setup ();
+  if (pingtool_hosts_count)
+    _hostrange_resolve ();
 }
 
 void
@@ -767,7 +1310,10 @@ ipmi_ping_loop (Ipmi_Ping_CreatePacket create,
 
   pingtool_end_result = end;
 
-  _main_loop (create, parse, late);
+  if (pingtool_hosts_count)
+    _sweep_loop (create, parse, late);
+  else
+    _main_loop (create, parse, late);
 
   return;                     /* NOT REACHED */
 }
@@ -405,6 +405,14 @@ common_parse_opt (int key,
     case ARGP_DEBUG_KEY:
       common_args->debug++;
       break;
+    case ARGP_PACKET_TRACE_FILE_KEY:
+      free (common_args->packet_trace_file);
+      if (!(common_args->packet_trace_file = strdup (arg)))
+        {
+          perror ("strdup");
+          exit (EXIT_FAILURE);
+        }
+      break;
 
       /* 
        * sdr options
@@ -439,6 +447,9 @@ common_parse_opt (int key,
     case ARGP_IGNORE_SDR_CACHE_KEY:
       common_args->ignore_sdr_cache = 1;
       break;
+    case ARGP_SDR_CACHE_SHARED_KEY:
+      common_args->sdr_cache_shared = 1;
+      break;
 
       /* 
        * time options
@@ -531,6 +542,7 @@ _init_common_cmd_args (struct common_cmd_args *common_args)
   common_args->workaround_flags_inband = 0;
   common_args->section_specific_workaround_flags = 0;
   common_args->debug = 0;
+  common_args->packet_trace_file = NULL;
 
   common_args->flush_cache = 0;
   common_args->quiet_cache = 0;
@@ -538,6 +550,7 @@ _init_common_cmd_args (struct common_cmd_args *common_args)
   common_args->sdr_cache_file = NULL;
   common_args->sdr_cache_directory = NULL;
   common_args->ignore_sdr_cache = 0;
+  common_args->sdr_cache_shared = 0;
 
   common_args->utc_to_localtime = 0;
   common_args->localtime_to_utc = 0;
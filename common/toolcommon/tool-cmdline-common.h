@@ -64,6 +64,7 @@ enum argp_common_option_keys
     ARGP_CONFIG_FILE_KEY = 146,
     ARGP_WORKAROUND_FLAGS_KEY = 'W',
     ARGP_DEBUG_KEY = 147,
+    ARGP_PACKET_TRACE_FILE_KEY = 159,
     /* sdr options */
     ARGP_FLUSH_CACHE_KEY = 148,
     ARGP_FLUSH_CACHE_LEGACY_KEY = 'f',
@@ -73,6 +74,7 @@ enum argp_common_option_keys
     ARGP_SDR_CACHE_FILE_KEY = 151,
     ARGP_SDR_CACHE_DIRECTORY_KEY = 152,
     ARGP_IGNORE_SDR_CACHE_KEY = 153,
+    ARGP_SDR_CACHE_SHARED_KEY = 158,
     /* time options */
     ARGP_UTC_TO_LOCALTIME_KEY = 154,
     ARGP_LOCALTIME_TO_UTC_KEY = 155,
@@ -197,7 +199,9 @@ enum argp_common_option_keys
   { "sdr-cache-file", ARGP_SDR_CACHE_FILE_KEY, "FILE", 0,                                                       \
       "Specify a specific file for the sensor data repository (SDR) cache to be stored or read from.", 23},     \
   { "sdr-cache-directory", ARGP_SDR_CACHE_DIRECTORY_KEY, "DIRECTORY", 0,                                        \
-      "Specify an alternate directory for sensor data repository (SDR) caches to be stored or read from.", 24}
+      "Specify an alternate directory for sensor data repository (SDR) caches to be stored or read from.", 24}, \
+  { "sdr-cache-shared", ARGP_SDR_CACHE_SHARED_KEY, 0, 0,                                                        \
+      "Share identical sensor data repository (SDR) caches between hosts of the same platform.", 24}
 
 #define ARGP_COMMON_SDR_CACHE_OPTIONS_IGNORE                                                                    \
   { "ignore-sdr-cache", ARGP_IGNORE_SDR_CACHE_KEY, 0, 0,                                                        \
@@ -227,6 +231,10 @@ enum argp_common_option_keys
   { "debug",     ARGP_DEBUG_KEY, 0, 0,                                                                          \
       "Turn on debugging.", 34}
 
+#define ARGP_COMMON_OPTIONS_PACKET_TRACE                                                                        \
+  { "packet-trace-file", ARGP_PACKET_TRACE_FILE_KEY, "FILE", 0,                                                 \
+      "Record all IPMI packets in binary form to FILE.", 34}
+
 struct common_cmd_args
 {
   /* inband options */
@@ -263,6 +271,7 @@ struct common_cmd_args
   unsigned int workaround_flags_sdr;
   unsigned int section_specific_workaround_flags;
   int debug;
+  char *packet_trace_file;
 
   /* sdr options */
   int flush_cache;
@@ -271,6 +280,7 @@ struct common_cmd_args
   char *sdr_cache_file;
   char *sdr_cache_directory;
   int ignore_sdr_cache;
+  int sdr_cache_shared;
 
   /* time options */
   int utc_to_localtime;
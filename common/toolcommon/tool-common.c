@@ -24,6 +24,7 @@
 #include <stdlib.h>
 #if STDC_HEADERS
 #include <string.h>
+#include <stdarg.h>
 #endif /* STDC_HEADERS */
 #if HAVE_UNISTD_H
 #include <unistd.h>
@@ -41,8 +42,11 @@
 #include "parse-common.h"
 
 #include "freeipmi-portability.h"
+#include "error.h"
 #include "network.h"
 
+#define IPMI_OPEN_DAEMON_ERR_BUFLEN 1024
+
 ipmi_ctx_t
 ipmi_open (const char *progname,
            const char *hostname,
@@ -65,6 +69,19 @@ ipmi_open (const char *progname,
       goto cleanup;
     }
 
+  if (common_args->packet_trace_file)
+    {
+      if (ipmi_ctx_set_packet_trace_file (ipmi_ctx,
+                                          common_args->packet_trace_file) < 0)
+        {
+          PSTDOUT_FPRINTF (pstate,
+                           stderr,
+                           "ipmi_ctx_set_packet_trace_file: %s\n",
+                           ipmi_ctx_errormsg (ipmi_ctx));
+          goto cleanup;
+        }
+    }
+
   if (hostname && !host_is_localhost (hostname))
     {
       if (common_args->driver_type == IPMI_DEVICE_LAN_2_0)
@@ -239,3 +256,279 @@ ipmi_open (const char *progname,
   ipmi_ctx_destroy (ipmi_ctx);
   return (NULL);
 }
+
+static void
+_ipmi_open_daemon_err_output (const char *hostname, const char *message, ...)
+{
+  char buf[IPMI_OPEN_DAEMON_ERR_BUFLEN + 1];
+  va_list ap;
+
+  assert (message);
+
+  memset (buf, '\0', IPMI_OPEN_DAEMON_ERR_BUFLEN + 1);
+
+  va_start (ap, message);
+  vsnprintf (buf, IPMI_OPEN_DAEMON_ERR_BUFLEN, message, ap);
+  va_end (ap);
+
+  if (!hostname)
+    err_output ("%s", buf);
+  else
+    err_output ("%s: %s", hostname, buf);
+}
+
+/* returns 1 if the error should be output, 0 if not */
+static int
+_ipmi_open_daemon_errnum_manage (ipmi_ctx_t ipmi_ctx,
+                                 int verbose,
+                                 int *last_ipmi_errnum,
+                                 unsigned int *last_ipmi_errnum_count)
+{
+  int rv;
+
+  assert (ipmi_ctx);
+  assert (last_ipmi_errnum);
+  assert (last_ipmi_errnum_count);
+
+  rv = ((*last_ipmi_errnum) != ipmi_ctx_errnum (ipmi_ctx) || verbose);
+
+  if ((*last_ipmi_errnum) != ipmi_ctx_errnum (ipmi_ctx))
+    {
+      (*last_ipmi_errnum) = ipmi_ctx_errnum (ipmi_ctx);
+      (*last_ipmi_errnum_count) = 1;
+    }
+  else
+    {
+      (*last_ipmi_errnum_count)++;
+      if ((*last_ipmi_errnum_count) > IPMI_OPEN_DAEMON_ERROR_OUTPUT_LIMIT)
+        {
+          (*last_ipmi_errnum) = 0;
+          (*last_ipmi_errnum_count) = 0;
+        }
+    }
+
+  return (rv);
+}
+
+ipmi_ctx_t
+ipmi_open_daemon (const char *hostname,
+                  struct common_cmd_args *common_args,
+                  int verbose,
+                  int *last_ipmi_errnum,
+                  unsigned int *last_ipmi_errnum_count)
+{
+  ipmi_ctx_t ipmi_ctx = NULL;
+  unsigned int workaround_flags = 0;
+
+  assert (common_args);
+  assert (last_ipmi_errnum);
+  assert (last_ipmi_errnum_count);
+
+  if (!(ipmi_ctx = ipmi_ctx_create ()))
+    {
+      _ipmi_open_daemon_err_output (hostname, "ipmi_ctx_create: %s", strerror (errno));
+      goto cleanup;
+    }
+
+  if (common_args->packet_trace_file)
+    {
+      if (ipmi_ctx_set_packet_trace_file (ipmi_ctx,
+                                          common_args->packet_trace_file) < 0)
+        {
+          _ipmi_open_daemon_err_output (hostname,
+                                        "ipmi_ctx_set_packet_trace_file: %s",
+                                        ipmi_ctx_errormsg (ipmi_ctx));
+          goto cleanup;
+        }
+    }
+
+  if (hostname && !host_is_localhost (hostname))
+    {
+      if (common_args->driver_type == IPMI_DEVICE_LAN_2_0)
+        {
+          parse_get_freeipmi_outofband_2_0_flags (common_args->workaround_flags_outofband_2_0,
+                                                  &workaround_flags);
+
+          if (ipmi_ctx_open_outofband_2_0 (ipmi_ctx,
+                                           hostname,
+                                           common_args->username,
+                                           common_args->password,
+                                           (common_args->k_g_len) ? common_args->k_g : NULL,
+                                           (common_args->k_g_len) ? common_args->k_g_len : 0,
+                                           common_args->privilege_level,
+                                           common_args->cipher_suite_id,
+                                           common_args->session_timeout,
+                                           common_args->retransmission_timeout,
+                                           workaround_flags,
+                                           (common_args->debug > 1) ? IPMI_FLAGS_DEBUG_DUMP : IPMI_FLAGS_DEFAULT) < 0)
+            {
+              if (_ipmi_open_daemon_errnum_manage (ipmi_ctx,
+                                                   verbose,
+                                                   last_ipmi_errnum,
+                                                   last_ipmi_errnum_count))
+                {
+                  if (ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_USERNAME_INVALID
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_PASSWORD_INVALID
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_K_G_INVALID
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_PRIVILEGE_LEVEL_INSUFFICIENT
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_PRIVILEGE_LEVEL_CANNOT_BE_OBTAINED
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_CIPHER_SUITE_ID_UNAVAILABLE
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_PASSWORD_VERIFICATION_TIMEOUT
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_IPMI_2_0_UNAVAILABLE
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_CONNECTION_TIMEOUT
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_SESSION_TIMEOUT
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_HOSTNAME_INVALID)
+                    _ipmi_open_daemon_err_output (hostname,
+                                                  "Error connecting: %s",
+                                                  ipmi_ctx_errormsg (ipmi_ctx));
+                  else
+                    _ipmi_open_daemon_err_output (hostname,
+                                                  "ipmi_ctx_open_outofband_2_0: %s",
+                                                  ipmi_ctx_errormsg (ipmi_ctx));
+                }
+              goto cleanup;
+            }
+        }
+      else
+        {
+          if (ipmi_ctx_open_outofband (ipmi_ctx,
+                                       hostname,
+                                       common_args->username,
+                                       common_args->password,
+                                       common_args->authentication_type,
+                                       common_args->privilege_level,
+                                       common_args->session_timeout,
+                                       common_args->retransmission_timeout,
+                                       workaround_flags,
+                                       (common_args->debug > 1) ? IPMI_FLAGS_DEBUG_DUMP : IPMI_FLAGS_DEFAULT) < 0)
+            {
+              if (_ipmi_open_daemon_errnum_manage (ipmi_ctx,
+                                                   verbose,
+                                                   last_ipmi_errnum,
+                                                   last_ipmi_errnum_count))
+                {
+                  if (ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_USERNAME_INVALID
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_PASSWORD_INVALID
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_PRIVILEGE_LEVEL_INSUFFICIENT
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_PRIVILEGE_LEVEL_CANNOT_BE_OBTAINED
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_AUTHENTICATION_TYPE_UNAVAILABLE
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_PASSWORD_VERIFICATION_TIMEOUT
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_CONNECTION_TIMEOUT
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_SESSION_TIMEOUT
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_HOSTNAME_INVALID)
+                    _ipmi_open_daemon_err_output (hostname,
+                                                  "Error connecting: %s",
+                                                  ipmi_ctx_errormsg (ipmi_ctx));
+                  else
+                    _ipmi_open_daemon_err_output (hostname,
+                                                  "ipmi_ctx_open_outofband: %s",
+                                                  ipmi_ctx_errormsg (ipmi_ctx));
+                }
+              goto cleanup;
+            }
+        }
+    }
+  else
+    {
+      if (!ipmi_is_root ())
+        {
+          _ipmi_open_daemon_err_output (hostname, "%s", ipmi_ctx_strerror (IPMI_ERR_PERMISSION));
+          goto cleanup;
+        }
+
+      parse_get_freeipmi_inband_flags (common_args->workaround_flags_inband,
+                                       &workaround_flags);
+
+      if (common_args->driver_type == IPMI_DEVICE_UNKNOWN)
+        {
+          int ret;
+
+          if ((ret = ipmi_ctx_find_inband (ipmi_ctx,
+                                           NULL,
+                                           common_args->disable_auto_probe,
+                                           common_args->driver_address,
+                                           common_args->register_spacing,
+                                           common_args->driver_device,
+                                           workaround_flags,
+                                           (common_args->debug > 1) ? IPMI_FLAGS_DEBUG_DUMP : IPMI_FLAGS_DEFAULT)) < 0)
+            {
+              if (_ipmi_open_daemon_errnum_manage (ipmi_ctx,
+                                                   verbose,
+                                                   last_ipmi_errnum,
+                                                   last_ipmi_errnum_count))
+                {
+                  if (ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_PERMISSION
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_DRIVER_BUSY
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_DRIVER_TIMEOUT)
+                    _ipmi_open_daemon_err_output (hostname,
+                                                  "Error loading driver: %s",
+                                                  ipmi_ctx_errormsg (ipmi_ctx));
+                  else
+                    _ipmi_open_daemon_err_output (hostname,
+                                                  "ipmi_ctx_find_inband: %s",
+                                                  ipmi_ctx_errormsg (ipmi_ctx));
+                }
+              goto cleanup;
+            }
+
+          if (!ret)
+            {
+              /* XXX deal w/ specific errors */
+              _ipmi_open_daemon_err_output (hostname, "could not find inband device");
+              goto cleanup;
+            }
+        }
+      else
+        {
+          if (ipmi_ctx_open_inband (ipmi_ctx,
+                                    common_args->driver_type,
+                                    common_args->disable_auto_probe,
+                                    common_args->driver_address,
+                                    common_args->register_spacing,
+                                    common_args->driver_device,
+                                    workaround_flags,
+                                    (common_args->debug > 1) ? IPMI_FLAGS_DEBUG_DUMP : IPMI_FLAGS_DEFAULT) < 0)
+            {
+              if (_ipmi_open_daemon_errnum_manage (ipmi_ctx,
+                                                   verbose,
+                                                   last_ipmi_errnum,
+                                                   last_ipmi_errnum_count))
+                {
+                  if (ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_PERMISSION
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_DEVICE_NOT_FOUND
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_DRIVER_BUSY
+                      || ipmi_ctx_errnum (ipmi_ctx) == IPMI_ERR_DRIVER_TIMEOUT)
+                    _ipmi_open_daemon_err_output (hostname,
+                                                  "Error loading driver: %s",
+                                                  ipmi_ctx_errormsg (ipmi_ctx));
+                  else
+                    _ipmi_open_daemon_err_output (hostname,
+                                                  "ipmi_ctx_open_inband: %s",
+                                                  ipmi_ctx_errormsg (ipmi_ctx));
+                }
+              goto cleanup;
+            }
+        }
+    }
+
+  if (common_args->target_channel_number_is_set
+      || common_args->target_slave_address_is_set)
+    {
+      if (ipmi_ctx_set_target (ipmi_ctx,
+                               common_args->target_channel_number_is_set ? &common_args->target_channel_number : NULL,
+                               common_args->target_slave_address_is_set ? &common_args->target_slave_address : NULL) < 0)
+        {
+          _ipmi_open_daemon_err_output (hostname,
+                                        "ipmi_ctx_set_target: %s",
+                                        ipmi_ctx_errormsg (ipmi_ctx));
+          goto cleanup;
+        }
+    }
+
+  return (ipmi_ctx);
+
+ cleanup:
+  ipmi_ctx_close (ipmi_ctx);
+  ipmi_ctx_destroy (ipmi_ctx);
+  return (NULL);
+}
@@ -31,4 +31,19 @@ ipmi_ctx_t ipmi_open (const char *progname,
                       pstdout_state_t pstate,
                       unsigned int flags);
 
+/* A repeated failure is only output once every this many attempts */
+#define IPMI_OPEN_DAEMON_ERROR_OUTPUT_LIMIT 20
+
+/* ipmi_open() for daemons that reconnect to hosts every poll.  Errors
+ * are output with err_output(), prefixed by hostname.  A connection
+ * error equal to the last one, tracked in last_ipmi_errnum and
+ * last_ipmi_errnum_count, is output only every
+ * IPMI_OPEN_DAEMON_ERROR_OUTPUT_LIMIT attempts unless verbose is set.
+ */
+ipmi_ctx_t ipmi_open_daemon (const char *hostname,
+                             struct common_cmd_args *common_args,
+                             int verbose,
+                             int *last_ipmi_errnum,
+                             unsigned int *last_ipmi_errnum_count);
+
 #endif /* TOOL_COMMON_H */
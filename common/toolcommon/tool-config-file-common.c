@@ -1351,7 +1351,7 @@ config_file_parse (const char *filename,
     authentication_type_count = 0, cipher_suite_id_count = 0,
     privilege_level_count = 0;
 
-  int quiet_cache_count = 0, sdr_cache_directory_count = 0;
+  int quiet_cache_count = 0, sdr_cache_directory_count = 0, sdr_cache_shared_count = 0;
 
   int utc_to_localtime_count = 0, localtime_to_utc_count = 0,
     utc_offset_count = 0;
@@ -1724,6 +1724,17 @@ config_file_parse (const char *filename,
         &(common_args->sdr_cache_directory),
         0
       },
+      {
+        "sdr-cache-shared",
+        CONFFILE_OPTION_BOOL,
+        -1,
+        _config_file_bool,
+        1,
+        0,
+        &sdr_cache_shared_count,
+        &(common_args->sdr_cache_shared),
+        0
+      },
     };
 
   struct conffile_option time_options[] =
@@ -4828,6 +4839,50 @@ config_file_parse (const char *filename,
         &(ipmipower_data.ping_consec_count),
         0
       },
+      {
+        "ipmipower-shared-socket",
+        CONFFILE_OPTION_BOOL,
+        -1,
+        _config_file_bool,
+        1,
+        0,
+        &(ipmipower_data.shared_socket_count),
+        &(ipmipower_data.shared_socket),
+        0
+      },
+      {
+        "ipmipower-rate-limit",
+        CONFFILE_OPTION_INT,
+        -1,
+        _config_file_unsigned_int,
+        1,
+        0,
+        &(ipmipower_data.rate_limit_count),
+        &(ipmipower_data.rate_limit),
+        0
+      },
+      {
+        "ipmipower-group-map",
+        CONFFILE_OPTION_STRING,
+        -1,
+        _config_file_string,
+        1,
+        0,
+        &(ipmipower_data.group_map_count),
+        &(ipmipower_data.group_map),
+        0
+      },
+      {
+        "ipmipower-stage-delay",
+        CONFFILE_OPTION_INT,
+        -1,
+        _config_file_unsigned_int,
+        1,
+        0,
+        &(ipmipower_data.stage_delay_count),
+        &(ipmipower_data.stage_delay),
+        0
+      },
     };
 
   /*
@@ -281,6 +281,14 @@ struct config_file_data_ipmipower
   int ping_percent_count;
   unsigned int ping_consec_count;
   int ping_consec_count_count;
+  int shared_socket;
+  int shared_socket_count;
+  unsigned int rate_limit;
+  int rate_limit_count;
+  char *group_map;
+  int group_map_count;
+  unsigned int stage_delay;
+  int stage_delay_count;
 };
 
 struct config_file_data_ipmiseld
@@ -43,6 +43,7 @@
 #endif  /* !HAVE_SYS_TIME_H */
 #endif /* !TIME_WITH_SYS_TIME */
 #include <signal.h>
+#include <pthread.h>
 #include <errno.h>
 #include <assert.h>
 
@@ -50,11 +51,32 @@
 
 #include "freeipmi-portability.h"
 #include "error.h"
+#include "list.h"
 
 static char *daemon_pidfile = NULL;
 
 static sighandler_t daemon_cb = NULL;
 
+struct daemon_threadpool_data
+{
+  pthread_t tid;
+  int threadpool_num;
+  DaemonThreadPoolCallback callback;
+  DaemonThreadPoolPostProcess postprocess;
+  int exit_flag;
+};
+
+static struct daemon_threadpool_data *threadpool_data_array = NULL;
+static unsigned int threadpool_data_array_len = 0;
+
+static List threadpool_queue = NULL;
+static pthread_mutex_t threadpool_queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t threadpool_queue_cond = PTHREAD_COND_INITIALIZER;
+
+static unsigned int threadpool_count = 0;
+static pthread_mutex_t threadpool_count_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t threadpool_count_cond = PTHREAD_COND_INITIALIZER;
+
 int
 daemonize_common (const char *pidfile)
 {
@@ -172,3 +194,170 @@ daemon_sleep (unsigned int sleep_len)
     }
   return (0);
 }
+
+static void *
+_threadpool_func (void *arg)
+{
+  struct daemon_threadpool_data *threadpool_data;
+
+  assert (arg);
+
+  threadpool_data = (struct daemon_threadpool_data *)arg;
+
+  while (!threadpool_data->exit_flag)
+    {
+      void *queue_arg;
+
+      pthread_mutex_lock (&threadpool_queue_lock);
+
+      while (!list_count (threadpool_queue)
+             && !threadpool_data->exit_flag)
+        pthread_cond_wait (&threadpool_queue_cond, &threadpool_queue_lock);
+
+      if (threadpool_data->exit_flag)
+        {
+          pthread_mutex_unlock (&threadpool_queue_lock);
+          break;
+        }
+
+      if (!(queue_arg = list_dequeue (threadpool_queue)))
+        err_output ("list_dequeue: %s", strerror (errno));
+
+      pthread_mutex_unlock (&threadpool_queue_lock);
+
+      if (queue_arg)
+        {
+          threadpool_data->callback (queue_arg);
+
+          if (threadpool_data->postprocess)
+            threadpool_data->postprocess (queue_arg);
+        }
+    }
+
+  pthread_mutex_lock (&threadpool_count_lock);
+  threadpool_count--;
+  pthread_cond_signal (&threadpool_count_cond);
+  pthread_mutex_unlock (&threadpool_count_lock);
+
+  return (NULL);
+}
+
+int
+daemon_threadpool_init (unsigned int threadpool_count_init,
+                        DaemonThreadPoolCallback callback,
+                        DaemonThreadPoolPostProcess postprocess)
+{
+  unsigned int i;
+  int ret;
+  int rv = -1;
+
+  assert (threadpool_count_init);
+  assert (callback);
+  /* postprocess can be NULL */
+  assert (!threadpool_data_array);
+
+  if (!(threadpool_data_array = (struct daemon_threadpool_data *)malloc (sizeof (struct daemon_threadpool_data) * threadpool_count_init)))
+    {
+      err_output ("malloc: %s", strerror (errno));
+      goto cleanup;
+    }
+
+  if (!(threadpool_queue = list_create (NULL)))
+    {
+      err_output ("list_create: %s", strerror (errno));
+      goto cleanup;
+    }
+
+  if ((ret = pthread_mutex_init (&threadpool_queue_lock, NULL)))
+    {
+      err_output ("pthread_mutex_init: %s", strerror (ret));
+      goto cleanup;
+    }
+
+  for (i = 0; i < threadpool_count_init; i++)
+    {
+      threadpool_data_array[i].threadpool_num = i;
+      threadpool_data_array[i].callback = callback;
+      threadpool_data_array[i].postprocess = postprocess;
+      threadpool_data_array[i].exit_flag = 0;
+
+      if ((ret = pthread_create (&threadpool_data_array[i].tid,
+                                 NULL,
+                                 _threadpool_func,
+                                 &threadpool_data_array[i])))
+        {
+          err_output ("pthread_create: %s", strerror (ret));
+          goto cleanup;
+        }
+
+      pthread_mutex_lock (&threadpool_count_lock);
+      threadpool_count++;
+      pthread_mutex_unlock (&threadpool_count_lock);
+    }
+
+  threadpool_data_array_len = threadpool_count_init;
+
+  rv = 0;
+ cleanup:
+  return (rv);
+}
+
+void
+daemon_threadpool_destroy (void)
+{
+  unsigned int i;
+  int ret;
+
+  /* We want any current poll to complete, so we won't
+   * pthread_cancel() here (and likewise won't use
+   * pthread_cleanup_push/pthread_cleanup_pop).
+   *
+   * Instead we set this flag and wait for the threads to finish up.
+   */
+  pthread_mutex_lock (&threadpool_count_lock);
+
+  for (i = 0; i < threadpool_data_array_len; i++)
+    threadpool_data_array[i].exit_flag = 1;
+
+  for (i = 0; i < threadpool_data_array_len; i++)
+    {
+      if ((ret = pthread_cond_signal (&threadpool_queue_cond)))
+        err_output ("pthread_cond_signal: %s", strerror (ret));
+    }
+
+  while (threadpool_count > 0)
+    pthread_cond_wait (&threadpool_count_cond, &threadpool_count_lock);
+
+  pthread_mutex_unlock (&threadpool_count_lock);
+
+  free (threadpool_data_array);
+  threadpool_data_array = NULL;
+  threadpool_data_array_len = 0;
+
+  if (threadpool_queue)
+    {
+      list_destroy (threadpool_queue);
+      threadpool_queue = NULL;
+    }
+}
+
+int
+daemon_threadpool_queue (void *arg)
+{
+  assert (arg);
+
+  pthread_mutex_lock (&threadpool_queue_lock);
+
+  if (!list_enqueue (threadpool_queue, arg))
+    {
+      pthread_mutex_unlock (&threadpool_queue_lock);
+      err_output ("list_enqueue: %s", strerror (errno));
+      return (-1);
+    }
+
+  pthread_cond_signal (&threadpool_queue_cond);
+
+  pthread_mutex_unlock (&threadpool_queue_lock);
+
+  return (0);
+}
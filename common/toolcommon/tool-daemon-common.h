@@ -38,4 +38,20 @@ int daemon_signal_handler_setup (sighandler_t cb);
 /* signal handlers + sleep(3) is a bad idea */
 int daemon_sleep (unsigned int sleep_len);
 
+typedef int (*DaemonThreadPoolCallback)(void *arg);
+
+typedef int (*DaemonThreadPoolPostProcess)(void *arg);
+
+/* threadpool_count threads call callback, then postprocess if
+ * non-NULL, on every argument queued with daemon_threadpool_queue().
+ */
+int daemon_threadpool_init (unsigned int threadpool_count,
+                            DaemonThreadPoolCallback callback,
+                            DaemonThreadPoolPostProcess postprocess);
+
+/* waits for callbacks in progress to complete */
+void daemon_threadpool_destroy (void);
+
+int daemon_threadpool_queue (void *arg);
+
 #endif /* TOOL_DAEMON_COMMON_H */
@@ -0,0 +1,479 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#if STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#include <math.h>
+#include <errno.h>
+#include <assert.h>
+
+#include "tool-output-common.h"
+
+#include "freeipmi-portability.h"
+
+#define TOOL_OUTPUT_BUFLEN_INITIAL 1024
+
+/* uint32 length + uint16 field count */
+#define TOOL_OUTPUT_BINARY_HEADER_LEN 6
+
+#define TOOL_OUTPUT_BINARY_NAME_MAX   255
+
+#define TOOL_OUTPUT_BINARY_STRING_MAX 65535
+
+int
+tool_output_format_parse (const char *str)
+{
+  assert (str);
+
+  if (!strcasecmp (str, "text"))
+    return (TOOL_OUTPUT_FORMAT_TEXT);
+  if (!strcasecmp (str, "json"))
+    return (TOOL_OUTPUT_FORMAT_JSON);
+  if (!strcasecmp (str, "binary"))
+    return (TOOL_OUTPUT_FORMAT_BINARY);
+  return (-1);
+}
+
+void
+tool_output_record_init (struct tool_output_record *record, int format)
+{
+  assert (record);
+  assert (format == TOOL_OUTPUT_FORMAT_JSON
+          || format == TOOL_OUTPUT_FORMAT_BINARY);
+
+  record->format = format;
+  record->buf = NULL;
+  record->buflen = 0;
+  record->bufsize = 0;
+  record->field_count = 0;
+}
+
+void
+tool_output_record_cleanup (struct tool_output_record *record)
+{
+  if (!record)
+    return;
+
+  free (record->buf);
+  record->buf = NULL;
+  record->buflen = 0;
+  record->bufsize = 0;
+  record->field_count = 0;
+}
+
+static int
+_reserve (struct tool_output_record *record, unsigned int len)
+{
+  unsigned int newsize;
+  uint8_t *tmp;
+
+  assert (record);
+
+  if (record->buflen + len <= record->bufsize)
+    return (0);
+
+  newsize = record->bufsize ? record->bufsize : TOOL_OUTPUT_BUFLEN_INITIAL;
+  while (newsize < record->buflen + len)
+    newsize *= 2;
+
+  if (!(tmp = realloc (record->buf, newsize)))
+    return (-1);
+
+  record->buf = tmp;
+  record->bufsize = newsize;
+  return (0);
+}
+
+static int
+_append (struct tool_output_record *record, const void *data, unsigned int len)
+{
+  assert (record);
+
+  if (_reserve (record, len) < 0)
+    return (-1);
+
+  memcpy (record->buf + record->buflen, data, len);
+  record->buflen += len;
+  return (0);
+}
+
+static int
+_append_le (struct tool_output_record *record, uint64_t val, unsigned int bytes)
+{
+  unsigned int i;
+
+  assert (record);
+  assert (bytes <= 8);
+
+  if (_reserve (record, bytes) < 0)
+    return (-1);
+
+  for (i = 0; i < bytes; i++)
+    record->buf[record->buflen++] = (val >> (i * 8)) & 0xFF;
+  return (0);
+}
+
+/* Numbers are formatted by hand, this is called for every field of
+ * every record and printf is the slow part of the text output.
+ */
+static int
+_append_json_unsigned (struct tool_output_record *record, uint64_t val)
+{
+  char digits[20];
+  unsigned int len = 0;
+
+  assert (record);
+
+  do
+    {
+      digits[len++] = '0' + (val % 10);
+      val /= 10;
+    } while (val);
+
+  if (_reserve (record, len) < 0)
+    return (-1);
+
+  while (len)
+    record->buf[record->buflen++] = digits[--len];
+  return (0);
+}
+
+static int
+_append_json_string (struct tool_output_record *record, const char *str)
+{
+  static const char hex[] = "0123456789abcdef";
+  const unsigned char *p;
+
+  assert (record);
+  assert (str);
+
+  /* worst case every character escaped as \u00XX, plus the quotes */
+  if (_reserve (record, strlen (str) * 6 + 2) < 0)
+    return (-1);
+
+  record->buf[record->buflen++] = '"';
+  for (p = (const unsigned char *)str; *p; p++)
+    {
+      if (*p == '"' || *p == '\\')
+        {
+          record->buf[record->buflen++] = '\\';
+          record->buf[record->buflen++] = *p;
+        }
+      else if (*p < 0x20)
+        {
+          record->buf[record->buflen++] = '\\';
+          record->buf[record->buflen++] = 'u';
+          record->buf[record->buflen++] = '0';
+          record->buf[record->buflen++] = '0';
+          record->buf[record->buflen++] = hex[*p >> 4];
+          record->buf[record->buflen++] = hex[*p & 0xF];
+        }
+      else
+        record->buf[record->buflen++] = *p;
+    }
+  record->buf[record->buflen++] = '"';
+  return (0);
+}
+
+static int
+_append_binary_string (struct tool_output_record *record, const char *str)
+{
+  unsigned int len;
+
+  assert (record);
+  assert (str);
+
+  len = strlen (str);
+  if (len > TOOL_OUTPUT_BINARY_STRING_MAX)
+    len = TOOL_OUTPUT_BINARY_STRING_MAX;
+
+  if (_append_le (record, len, 2) < 0)
+    return (-1);
+  return (_append (record, str, len));
+}
+
+static int
+_add_field_name (struct tool_output_record *record,
+                 const char *name,
+                 uint8_t type)
+{
+  assert (record);
+  assert (name);
+  assert (record->buflen);
+
+  if (record->format == TOOL_OUTPUT_FORMAT_JSON)
+    {
+      if (record->field_count)
+        {
+          if (_append (record, ",", 1) < 0)
+            return (-1);
+        }
+      if (_append_json_string (record, name) < 0)
+        return (-1);
+      if (_append (record, ":", 1) < 0)
+        return (-1);
+    }
+  else
+    {
+      unsigned int len;
+
+      len = strlen (name);
+      assert (len <= TOOL_OUTPUT_BINARY_NAME_MAX);
+
+      if (_append_le (record, type, 1) < 0)
+        return (-1);
+      if (_append_le (record, len, 1) < 0)
+        return (-1);
+      if (_append (record, name, len) < 0)
+        return (-1);
+    }
+
+  record->field_count++;
+  return (0);
+}
+
+int
+tool_output_record_start (struct tool_output_record *record,
+                          const char *hostname)
+{
+  assert (record);
+
+  record->buflen = 0;
+  record->field_count = 0;
+
+  if (record->format == TOOL_OUTPUT_FORMAT_JSON)
+    {
+      if (_append (record, "{", 1) < 0)
+        return (-1);
+    }
+  else
+    {
+      if (_reserve (record, TOOL_OUTPUT_BINARY_HEADER_LEN) < 0)
+        return (-1);
+      memset (record->buf, '\0', TOOL_OUTPUT_BINARY_HEADER_LEN);
+      record->buflen = TOOL_OUTPUT_BINARY_HEADER_LEN;
+    }
+
+  if (hostname)
+    return (tool_output_record_add_string (record, "host", hostname));
+
+  return (0);
+}
+
+int
+tool_output_record_add_null (struct tool_output_record *record,
+                             const char *name)
+{
+  assert (record);
+  assert (name);
+
+  if (_add_field_name (record, name, TOOL_OUTPUT_FIELD_NULL) < 0)
+    return (-1);
+
+  if (record->format == TOOL_OUTPUT_FORMAT_JSON)
+    return (_append (record, "null", 4));
+
+  return (0);
+}
+
+int
+tool_output_record_add_unsigned (struct tool_output_record *record,
+                                 const char *name,
+                                 uint64_t val)
+{
+  assert (record);
+  assert (name);
+
+  if (_add_field_name (record, name, TOOL_OUTPUT_FIELD_UNSIGNED) < 0)
+    return (-1);
+
+  if (record->format == TOOL_OUTPUT_FORMAT_JSON)
+    return (_append_json_unsigned (record, val));
+
+  return (_append_le (record, val, 8));
+}
+
+int
+tool_output_record_add_signed (struct tool_output_record *record,
+                               const char *name,
+                               int64_t val)
+{
+  assert (record);
+  assert (name);
+
+  if (_add_field_name (record, name, TOOL_OUTPUT_FIELD_SIGNED) < 0)
+    return (-1);
+
+  if (record->format == TOOL_OUTPUT_FORMAT_JSON)
+    {
+      if (val < 0)
+        {
+          if (_append (record, "-", 1) < 0)
+            return (-1);
+          return (_append_json_unsigned (record, -(uint64_t)val));
+        }
+      return (_append_json_unsigned (record, val));
+    }
+
+  return (_append_le (record, (uint64_t)val, 8));
+}
+
+int
+tool_output_record_add_double (struct tool_output_record *record,
+                               const char *name,
+                               const double *val)
+{
+  assert (record);
+  assert (name);
+
+  /* JSON has no representation for NaN or infinity */
+  if (!val
+      || (record->format == TOOL_OUTPUT_FORMAT_JSON
+          && (isnan (*val) || isinf (*val))))
+    return (tool_output_record_add_null (record, name));
+
+  if (_add_field_name (record, name, TOOL_OUTPUT_FIELD_DOUBLE) < 0)
+    return (-1);
+
+  if (record->format == TOOL_OUTPUT_FORMAT_JSON)
+    {
+      char buf[64];
+      int len;
+
+      /* 15 significant digits is what a double reliably holds */
+      len = snprintf (buf, sizeof (buf), "%.15g", *val);
+      return (_append (record, buf, len));
+    }
+  else
+    {
+      uint64_t bits;
+
+      memcpy (&bits, val, sizeof (bits));
+      return (_append_le (record, bits, 8));
+    }
+}
+
+int
+tool_output_record_add_string (struct tool_output_record *record,
+                               const char *name,
+                               const char *str)
+{
+  assert (record);
+  assert (name);
+
+  if (!str)
+    return (tool_output_record_add_null (record, name));
+
+  if (_add_field_name (record, name, TOOL_OUTPUT_FIELD_STRING) < 0)
+    return (-1);
+
+  if (record->format == TOOL_OUTPUT_FORMAT_JSON)
+    return (_append_json_string (record, str));
+
+  return (_append_binary_string (record, str));
+}
+
+int
+tool_output_record_add_string_list (struct tool_output_record *record,
+                                    const char *name,
+                                    char **list,
+                                    unsigned int list_len)
+{
+  unsigned int i;
+
+  assert (record);
+  assert (name);
+  assert (list || !list_len);
+
+  if (_add_field_name (record, name, TOOL_OUTPUT_FIELD_STRING_LIST) < 0)
+    return (-1);
+
+  if (record->format == TOOL_OUTPUT_FORMAT_JSON)
+    {
+      if (_append (record, "[", 1) < 0)
+        return (-1);
+
+      for (i = 0; i < list_len; i++)
+        {
+          if (i)
+            {
+              if (_append (record, ",", 1) < 0)
+                return (-1);
+            }
+          if (_append_json_string (record, list[i]) < 0)
+            return (-1);
+        }
+
+      return (_append (record, "]", 1));
+    }
+
+  if (list_len > TOOL_OUTPUT_BINARY_STRING_MAX)
+    list_len = TOOL_OUTPUT_BINARY_STRING_MAX;
+
+  if (_append_le (record, list_len, 2) < 0)
+    return (-1);
+
+  for (i = 0; i < list_len; i++)
+    {
+      if (_append_binary_string (record, list[i]) < 0)
+        return (-1);
+    }
+
+  return (0);
+}
+
+int
+tool_output_record_write (struct tool_output_record *record,
+                          FILE *stream)
+{
+  assert (record);
+  assert (record->buflen);
+  assert (stream);
+
+  if (record->format == TOOL_OUTPUT_FORMAT_JSON)
+    {
+      if (_append (record, "}\n", 2) < 0)
+        return (-1);
+    }
+  else
+    {
+      unsigned int i;
+      uint32_t len;
+
+      len = record->buflen - 4;
+      for (i = 0; i < 4; i++)
+        record->buf[i] = (len >> (i * 8)) & 0xFF;
+      record->buf[4] = record->field_count & 0xFF;
+      record->buf[5] = (record->field_count >> 8) & 0xFF;
+    }
+
+  /* a single fwrite holds the stream lock for the whole record */
+  if (fwrite (record->buf, 1, record->buflen, stream) != record->buflen)
+    return (-1);
+
+  record->buflen = 0;
+  record->field_count = 0;
+  return (0);
+}
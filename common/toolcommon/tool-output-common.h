@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TOOL_OUTPUT_COMMON_H
+#define TOOL_OUTPUT_COMMON_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define TOOL_OUTPUT_FORMAT_TEXT   0
+#define TOOL_OUTPUT_FORMAT_JSON   1
+#define TOOL_OUTPUT_FORMAT_BINARY 2
+
+/* Machine readable output records.
+ *
+ * Fields are appended to a per-thread record buffer straight from
+ * the tool's internal values and the whole record is written to the
+ * stream with a single fwrite(), so records from different hosts
+ * never interleave.  pstdout is bypassed, a "host" field identifies
+ * the host instead of the hostname prefix.
+ *
+ * JSON - one object per line, e.g.
+ *
+ *   {"host":"node1","record_id":4,"reading":27,"event":["OK"]}
+ *
+ * Binary - little endian, length prefixed:
+ *
+ *   uint32 length of the rest of the record
+ *   uint16 number of fields
+ *   per field:
+ *     uint8 type (TOOL_OUTPUT_FIELD_*)
+ *     uint8 name length, followed by the name
+ *     value: NULL - nothing
+ *            UNSIGNED - uint64
+ *            SIGNED - int64
+ *            DOUBLE - 8 byte IEEE 754 double
+ *            STRING - uint16 length, followed by the bytes
+ *            STRING_LIST - uint16 count, followed by count STRINGs
+ */
+#define TOOL_OUTPUT_FIELD_NULL        0x00
+#define TOOL_OUTPUT_FIELD_UNSIGNED    0x01
+#define TOOL_OUTPUT_FIELD_SIGNED      0x02
+#define TOOL_OUTPUT_FIELD_DOUBLE      0x03
+#define TOOL_OUTPUT_FIELD_STRING      0x04
+#define TOOL_OUTPUT_FIELD_STRING_LIST 0x05
+
+struct tool_output_record
+{
+  int format;
+  uint8_t *buf;
+  unsigned int buflen;
+  unsigned int bufsize;
+  unsigned int field_count;
+};
+
+/* returns TOOL_OUTPUT_FORMAT_* on success, -1 on invalid input */
+int tool_output_format_parse (const char *str);
+
+void tool_output_record_init (struct tool_output_record *record, int format);
+
+void tool_output_record_cleanup (struct tool_output_record *record);
+
+/* All functions below return 0 on success, -1 on error with errno
+ * set.  A record is started, has fields added and is written, after
+ * which the record can be started again.  hostname may be NULL.
+ */
+
+int tool_output_record_start (struct tool_output_record *record,
+                              const char *hostname);
+
+int tool_output_record_add_null (struct tool_output_record *record,
+                                 const char *name);
+
+int tool_output_record_add_unsigned (struct tool_output_record *record,
+                                     const char *name,
+                                     uint64_t val);
+
+int tool_output_record_add_signed (struct tool_output_record *record,
+                                   const char *name,
+                                   int64_t val);
+
+/* val may be NULL, outputs null */
+int tool_output_record_add_double (struct tool_output_record *record,
+                                   const char *name,
+                                   const double *val);
+
+/* str may be NULL, outputs null */
+int tool_output_record_add_string (struct tool_output_record *record,
+                                   const char *name,
+                                   const char *str);
+
+int tool_output_record_add_string_list (struct tool_output_record *record,
+                                        const char *name,
+                                        char **list,
+                                        unsigned int list_len);
+
+int tool_output_record_write (struct tool_output_record *record,
+                              FILE *stream);
+
+#endif /* TOOL_OUTPUT_COMMON_H */
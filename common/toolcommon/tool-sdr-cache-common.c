@@ -38,6 +38,8 @@
 #include <netdb.h>              /* MAXHOSTNAMELEN Solaris */
 #endif /* HAVE_NETDB_H */
 #include <libgen.h>
+#include <dirent.h>
+#include <time.h>
 #include <assert.h>
 #include <errno.h>
 
@@ -590,6 +592,705 @@ _sdr_cache_create (ipmi_sdr_ctx_t ctx,
   return (rv);
 }
 
+/* Shared SDR caches
+ *
+ * With --sdr-cache-shared, the per-host cache file becomes a symlink
+ * to a content addressed blob, "sdr-cache-blob-<hash>", in the same
+ * directory.  A second symlink, the platform link, points to the most
+ * recent blob for a platform.  It is named after the BMC's
+ * manufacturer id, product id, SDR record count, and a hash of its
+ * firmware revision and SDR repository info.  A host whose SDR
+ * validates against the platform blob is simply linked to it instead
+ * of downloading its SDR.  Hosts of the same platform then share one
+ * file, and one set of mmap'd pages.
+ *
+ * A BMC that does not report SDR timestamps gives no way to tell
+ * whether its SDR matches another, so it is never shared.
+ *
+ * Blobs no longer linked to by any host, and platform links to
+ * removed blobs, are removed whenever a shared cache is created.
+ */
+
+/* Blobs and links newer than this are not garbage collected, another
+ * process may be about to link to them.
+ */
+#define SDR_CACHE_SHARED_GC_GRACE         60
+
+/* FNV-1a 64 bit, blob contents are compared before they are shared,
+ * so a cryptographic hash is not necessary.
+ */
+static uint64_t
+_sdr_cache_shared_hash (uint64_t hash, const uint8_t *buf, unsigned int buflen)
+{
+  unsigned int i;
+
+  assert (buf);
+
+  for (i = 0; i < buflen; i++)
+    {
+      hash ^= buf[i];
+      hash *= 0x100000001B3ULL;
+    }
+
+  return (hash);
+}
+
+#define SDR_CACHE_SHARED_HASH_INIT        0xCBF29CE484222325ULL
+
+/* returns 0 on success, -1 on error, buf is malloc'ed */
+static int
+_sdr_cache_shared_read_file (const char *filename,
+                             uint8_t **buf,
+                             unsigned int *buflen)
+{
+  struct stat statbuf;
+  FILE *fp = NULL;
+  int rv = -1;
+
+  assert (filename);
+  assert (buf);
+  assert (buflen);
+
+  *buf = NULL;
+  *buflen = 0;
+
+  if (!(fp = fopen (filename, "r")))
+    goto cleanup;
+
+  if (fstat (fileno (fp), &statbuf) < 0)
+    goto cleanup;
+
+  if (!statbuf.st_size || statbuf.st_size > INT_MAX)
+    goto cleanup;
+
+  if (!(*buf = malloc (statbuf.st_size)))
+    goto cleanup;
+
+  if (fread (*buf, statbuf.st_size, 1, fp) != 1)
+    {
+      free (*buf);
+      *buf = NULL;
+      goto cleanup;
+    }
+  *buflen = statbuf.st_size;
+
+  rv = 0;
+ cleanup:
+  if (fp)
+    fclose (fp);
+  return (rv);
+}
+
+/* returns 0 on success, -1 if the name does not fit */
+static int
+_sdr_cache_shared_blobname (const uint8_t *cachebuf,
+                            unsigned int cachebuflen,
+                            char *buf,
+                            unsigned int buflen)
+{
+  int ret;
+
+  assert (cachebuf);
+  assert (buf);
+  assert (buflen);
+
+  ret = snprintf (buf,
+                  buflen,
+                  "%s-blob-%016llX",
+                  SDR_CACHE_FILENAME_PREFIX,
+                  (unsigned long long)_sdr_cache_shared_hash (SDR_CACHE_SHARED_HASH_INIT,
+                                                              cachebuf,
+                                                              cachebuflen));
+  if (ret < 0 || ret >= buflen)
+    return (-1);
+
+  return (0);
+}
+
+/* filename of name in the directory of cachefilename, returns 0 on
+ * success, -1 if it does not fit
+ */
+static int
+_sdr_cache_shared_filename (const char *cachefilename,
+                            const char *name,
+                            char *buf,
+                            unsigned int buflen)
+{
+  char cachedirbuf[MAXPATHLEN+1];
+  int ret;
+
+  assert (cachefilename);
+  assert (name);
+  assert (buf);
+  assert (buflen);
+
+  if (strlen (cachefilename) > MAXPATHLEN)
+    return (-1);
+
+  strcpy (cachedirbuf, cachefilename);
+  ret = snprintf (buf, buflen, "%s/%s", dirname (cachedirbuf), name);
+  if (ret < 0 || ret >= buflen)
+    return (-1);
+
+  return (0);
+}
+
+/* atomically point linkname at target, target is relative to the
+ * directory linkname is in.
+ */
+static int
+_sdr_cache_shared_symlink (pstdout_state_t pstate,
+                           const char *target,
+                           const char *linkname)
+{
+  char tmplinkbuf[MAXPATHLEN+1];
+  int fd;
+
+  assert (target);
+  assert (linkname);
+
+  if (strlen (linkname) > (MAXPATHLEN - 7))
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "internal overflow error\n");
+      return (-1);
+    }
+
+  /* mkstemp to find a unique name, then replace it with the link */
+  snprintf (tmplinkbuf, MAXPATHLEN + 1, "%s.XXXXXX", linkname);
+  if ((fd = mkstemp (tmplinkbuf)) < 0)
+    {
+      PSTDOUT_PERROR (pstate, "mkstemp");
+      return (-1);
+    }
+  close (fd);
+  unlink (tmplinkbuf);
+
+  if (symlink (target, tmplinkbuf) < 0)
+    {
+      PSTDOUT_PERROR (pstate, "symlink");
+      return (-1);
+    }
+
+  if (rename (tmplinkbuf, linkname) < 0)
+    {
+      PSTDOUT_PERROR (pstate, "rename");
+      unlink (tmplinkbuf);
+      return (-1);
+    }
+
+  return (0);
+}
+
+/* returns 1 if the host's SDR may be shared and buf holds its
+ * platform link filename, 0 if it may not be shared, -1 on error
+ */
+static int
+_sdr_cache_shared_platform_filename (pstdout_state_t pstate,
+                                     ipmi_ctx_t ipmi_ctx,
+                                     const char *cachefilename,
+                                     char *buf,
+                                     unsigned int buflen,
+                                     uint16_t *record_count)
+{
+  fiid_obj_t obj_device_id_rs = NULL;
+  fiid_obj_t obj_sdr_repository_info_rs = NULL;
+  uint8_t databuf[IPMI_MAX_PAYLOAD_LENGTH];
+  char namebuf[MAXPATHLEN+1];
+  uint64_t val;
+  uint64_t hash = SDR_CACHE_SHARED_HASH_INIT;
+  uint32_t manufacturer_id;
+  uint16_t product_id;
+  uint32_t most_recent_addition_timestamp, most_recent_erase_timestamp;
+  int len, ret;
+  int rv = -1;
+
+  assert (ipmi_ctx);
+  assert (cachefilename);
+  assert (buf);
+  assert (buflen);
+  assert (record_count);
+
+  if (!(obj_device_id_rs = fiid_obj_create (tmpl_cmd_get_device_id_rs)))
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_create: %s\n",
+                       strerror (errno));
+      goto cleanup;
+    }
+
+  if (ipmi_cmd_get_device_id (ipmi_ctx, obj_device_id_rs) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "ipmi_cmd_get_device_id: %s\n",
+                       ipmi_ctx_errormsg (ipmi_ctx));
+      goto cleanup;
+    }
+
+  if (FIID_OBJ_GET (obj_device_id_rs, "manufacturer_id.id", &val) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_get: 'manufacturer_id.id': %s\n",
+                       fiid_obj_errormsg (obj_device_id_rs));
+      goto cleanup;
+    }
+  manufacturer_id = val;
+
+  if (FIID_OBJ_GET (obj_device_id_rs, "product_id", &val) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_get: 'product_id': %s\n",
+                       fiid_obj_errormsg (obj_device_id_rs));
+      goto cleanup;
+    }
+  product_id = val;
+
+  /* Everything past the completion code identifies the BMC and its
+   * firmware, except the device available bit (byte 4, bit 7).
+   */
+  if ((len = fiid_obj_get_all (obj_device_id_rs, databuf, IPMI_MAX_PAYLOAD_LENGTH)) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_get_all: %s\n",
+                       fiid_obj_errormsg (obj_device_id_rs));
+      goto cleanup;
+    }
+
+  if (len > 4)
+    {
+      databuf[4] &= 0x7F;
+      hash = _sdr_cache_shared_hash (hash, databuf + 2, len - 2);
+    }
+
+  if (!(obj_sdr_repository_info_rs = fiid_obj_create (tmpl_cmd_get_sdr_repository_info_rs)))
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_create: %s\n",
+                       strerror (errno));
+      goto cleanup;
+    }
+
+  if (ipmi_cmd_get_sdr_repository_info (ipmi_ctx, obj_sdr_repository_info_rs) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "ipmi_cmd_get_sdr_repository_info: %s\n",
+                       ipmi_ctx_errormsg (ipmi_ctx));
+      goto cleanup;
+    }
+
+  if (FIID_OBJ_GET (obj_sdr_repository_info_rs, "record_count", &val) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_get: 'record_count': %s\n",
+                       fiid_obj_errormsg (obj_sdr_repository_info_rs));
+      goto cleanup;
+    }
+  (*record_count) = val;
+
+  if (FIID_OBJ_GET (obj_sdr_repository_info_rs, "most_recent_addition_timestamp", &val) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_get: 'most_recent_addition_timestamp': %s\n",
+                       fiid_obj_errormsg (obj_sdr_repository_info_rs));
+      goto cleanup;
+    }
+  most_recent_addition_timestamp = val;
+
+  if (FIID_OBJ_GET (obj_sdr_repository_info_rs, "most_recent_erase_timestamp", &val) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_get: 'most_recent_erase_timestamp': %s\n",
+                       fiid_obj_errormsg (obj_sdr_repository_info_rs));
+      goto cleanup;
+    }
+  most_recent_erase_timestamp = val;
+
+  if (!most_recent_addition_timestamp
+      && !most_recent_erase_timestamp)
+    {
+      rv = 0;
+      goto cleanup;
+    }
+
+  /* SDR version, record count, free space, and timestamps */
+  if ((len = fiid_obj_get_block (obj_sdr_repository_info_rs,
+                                 "sdr_version_major",
+                                 "most_recent_erase_timestamp",
+                                 databuf,
+                                 IPMI_MAX_PAYLOAD_LENGTH)) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "fiid_obj_get_block: %s\n",
+                       fiid_obj_errormsg (obj_sdr_repository_info_rs));
+      goto cleanup;
+    }
+  hash = _sdr_cache_shared_hash (hash, databuf, len);
+
+  if ((ret = snprintf (namebuf,
+                       MAXPATHLEN + 1,
+                       "%s-platform-%u-%u-%u-%016llX",
+                       SDR_CACHE_FILENAME_PREFIX,
+                       manufacturer_id,
+                       product_id,
+                       (*record_count),
+                       (unsigned long long)hash)) < 0)
+    {
+      PSTDOUT_PERROR (pstate, "snprintf");
+      goto cleanup;
+    }
+
+  if (ret > MAXPATHLEN
+      || _sdr_cache_shared_filename (cachefilename, namebuf, buf, buflen) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "snprintf invalid bytes written\n");
+      goto cleanup;
+    }
+
+  rv = 1;
+ cleanup:
+  fiid_obj_destroy (obj_device_id_rs);
+  fiid_obj_destroy (obj_sdr_repository_info_rs);
+  return (rv);
+}
+
+/* returns 1 if the host's first SDR record matches the current record
+ * of sdr_ctx, 0 if not
+ */
+static int
+_sdr_cache_shared_first_record_match (ipmi_sdr_ctx_t sdr_ctx,
+                                      ipmi_ctx_t ipmi_ctx)
+{
+  fiid_obj_t obj_cmd_rs = NULL;
+  uint8_t cachebuf[IPMI_SDR_MAX_RECORD_LENGTH];
+  uint8_t recordbuf[IPMI_SDR_MAX_RECORD_LENGTH];
+  int cachelen, recordlen;
+  int rv = 0;
+
+  assert (sdr_ctx);
+  assert (ipmi_ctx);
+
+  if ((cachelen = ipmi_sdr_cache_record_read (sdr_ctx,
+                                              cachebuf,
+                                              IPMI_SDR_MAX_RECORD_LENGTH)) <= 0)
+    goto cleanup;
+
+  if (!(obj_cmd_rs = fiid_obj_create (tmpl_cmd_get_sdr_rs)))
+    goto cleanup;
+
+  /* A reservation is not needed to read a whole record.  If the BMC
+   * can't return the whole record at once, just don't share.
+   */
+  if (ipmi_cmd_get_sdr (ipmi_ctx,
+                        0,
+                        IPMI_SDR_RECORD_ID_FIRST,
+                        0,
+                        IPMI_SDR_READ_ENTIRE_RECORD_BYTES_TO_READ,
+                        obj_cmd_rs) < 0)
+    goto cleanup;
+
+  if ((recordlen = fiid_obj_get_data (obj_cmd_rs,
+                                      "record_data",
+                                      recordbuf,
+                                      IPMI_SDR_MAX_RECORD_LENGTH)) < 0)
+    goto cleanup;
+
+  if (recordlen == cachelen
+      && !memcmp (recordbuf, cachebuf, cachelen))
+    rv = 1;
+
+ cleanup:
+  fiid_obj_destroy (obj_cmd_rs);
+  return (rv);
+}
+
+/* returns 1 if cachefilename now links to a valid platform blob, 0 if
+ * not, -1 on error
+ */
+static int
+_sdr_cache_shared_link (ipmi_sdr_ctx_t sdr_ctx,
+                        pstdout_state_t pstate,
+                        ipmi_ctx_t ipmi_ctx,
+                        const char *cachefilename,
+                        const char *platformfilename,
+                        uint16_t record_count)
+{
+  char blobbuf[MAXPATHLEN+1];
+  char blobnamebuf[MAXPATHLEN+1];
+  char blobfilenamebuf[MAXPATHLEN+1];
+  uint8_t *cachebuf = NULL;
+  unsigned int cachebuflen;
+  uint16_t cache_record_count;
+  int match;
+  ssize_t len;
+  int rv = -1;
+
+  assert (sdr_ctx);
+  assert (ipmi_ctx);
+  assert (cachefilename);
+  assert (platformfilename);
+
+  memset (blobbuf, '\0', MAXPATHLEN+1);
+  if ((len = readlink (platformfilename, blobbuf, MAXPATHLEN)) < 0)
+    return (0);
+
+  /* The blob's contents must still match its name */
+  if (_sdr_cache_shared_filename (platformfilename,
+                                  blobbuf,
+                                  blobfilenamebuf,
+                                  MAXPATHLEN + 1) < 0
+      || _sdr_cache_shared_read_file (blobfilenamebuf, &cachebuf, &cachebuflen) < 0
+      || _sdr_cache_shared_blobname (cachebuf, cachebuflen, blobnamebuf, MAXPATHLEN + 1) < 0
+      || strcmp (blobbuf, blobnamebuf))
+    {
+      rv = 0;
+      goto cleanup;
+    }
+
+  /* Validates the blob against this host's SDR version and timestamps */
+  if (ipmi_sdr_cache_open (sdr_ctx, ipmi_ctx, platformfilename) < 0)
+    {
+      rv = 0;
+      goto cleanup;
+    }
+
+  if (ipmi_sdr_cache_record_count (sdr_ctx, &cache_record_count) < 0)
+    cache_record_count = 0;
+
+  match = (cache_record_count == record_count
+           && _sdr_cache_shared_first_record_match (sdr_ctx, ipmi_ctx));
+
+  if (ipmi_sdr_cache_close (sdr_ctx) < 0)
+    {
+      PSTDOUT_FPRINTF (pstate,
+                       stderr,
+                       "ipmi_sdr_cache_close: %s\n",
+                       ipmi_sdr_ctx_errormsg (sdr_ctx));
+      goto cleanup;
+    }
+
+  if (!match)
+    {
+      rv = 0;
+      goto cleanup;
+    }
+
+  if (_sdr_cache_shared_symlink (pstate, blobbuf, cachefilename) < 0)
+    goto cleanup;
+
+  rv = 1;
+ cleanup:
+  free (cachebuf);
+  return (rv);
+}
+
+/* Move a newly created per-host cache into the shared blob store and
+ * replace it with a link to the blob.  Failures are not fatal, the
+ * per-host cache is still usable.
+ */
+static void
+_sdr_cache_shared_publish (pstdout_state_t pstate,
+                           const char *cachefilename,
+                           const char *platformfilename)
+{
+  char blobnamebuf[MAXPATHLEN+1];
+  char blobfilenamebuf[MAXPATHLEN+1];
+  uint8_t *cachebuf = NULL;
+  unsigned int cachebuflen;
+  uint8_t *blobbuf = NULL;
+  unsigned int blobbuflen;
+  struct stat statbuf;
+  int renamed = 0;
+
+  assert (cachefilename);
+  assert (platformfilename);
+
+  if (lstat (cachefilename, &statbuf) < 0
+      || !S_ISREG (statbuf.st_mode))
+    goto cleanup;
+
+  if (_sdr_cache_shared_read_file (cachefilename, &cachebuf, &cachebuflen) < 0)
+    goto cleanup;
+
+  if (_sdr_cache_shared_blobname (cachebuf,
+                                  cachebuflen,
+                                  blobnamebuf,
+                                  MAXPATHLEN + 1) < 0)
+    goto cleanup;
+
+  if (_sdr_cache_shared_filename (cachefilename,
+                                  blobnamebuf,
+                                  blobfilenamebuf,
+                                  MAXPATHLEN + 1) < 0)
+    goto cleanup;
+
+  if (!_sdr_cache_shared_read_file (blobfilenamebuf, &blobbuf, &blobbuflen))
+    {
+      /* hash collision, keep the per-host cache private */
+      if (blobbuflen != cachebuflen
+          || memcmp (blobbuf, cachebuf, cachebuflen))
+        goto cleanup;
+    }
+  else
+    {
+      if (rename (cachefilename, blobfilenamebuf) < 0)
+        goto cleanup;
+      renamed++;
+    }
+
+  if (_sdr_cache_shared_symlink (pstate, blobnamebuf, cachefilename) < 0)
+    {
+      /* ignore potential error, cleanup path */
+      if (renamed)
+        rename (blobfilenamebuf, cachefilename);
+      goto cleanup;
+    }
+
+  /* ignore potential error, the platform link is only an optimization */
+  _sdr_cache_shared_symlink (pstate, blobnamebuf, platformfilename);
+
+ cleanup:
+  free (cachebuf);
+  free (blobbuf);
+}
+
+/* Remove blobs that no per-host cache links to anymore, and platform
+ * links to blobs that no longer exist.  Failures are ignored, garbage
+ * collection is only housekeeping.
+ */
+static void
+_sdr_cache_shared_gc (const char *cachefilename)
+{
+  char cachedirbuf[MAXPATHLEN+1];
+  char filenamebuf[MAXPATHLEN+1];
+  char targetbuf[MAXPATHLEN+1];
+  char blobprefix[MAXPATHLEN+1];
+  char platformprefix[MAXPATHLEN+1];
+  char **linked = NULL;
+  unsigned int linked_count = 0;
+  unsigned int linked_len = 0;
+  struct dirent *dirent;
+  struct stat statbuf;
+  DIR *dir = NULL;
+  char *dirnameptr;
+  time_t now;
+  unsigned int i;
+
+  assert (cachefilename);
+
+  if (strlen (cachefilename) > MAXPATHLEN)
+    return;
+
+  strcpy (cachedirbuf, cachefilename);
+  dirnameptr = dirname (cachedirbuf);
+
+  snprintf (blobprefix, MAXPATHLEN + 1, "%s-blob-", SDR_CACHE_FILENAME_PREFIX);
+  snprintf (platformprefix, MAXPATHLEN + 1, "%s-platform-", SDR_CACHE_FILENAME_PREFIX);
+
+  now = time (NULL);
+
+  /* First pass, collect the blobs per-host caches link to */
+  if (!(dir = opendir (dirnameptr)))
+    return;
+
+  while ((dirent = readdir (dir)))
+    {
+      ssize_t len;
+
+      if (strncmp (dirent->d_name, SDR_CACHE_FILENAME_PREFIX, strlen (SDR_CACHE_FILENAME_PREFIX))
+          || !strncmp (dirent->d_name, blobprefix, strlen (blobprefix))
+          || !strncmp (dirent->d_name, platformprefix, strlen (platformprefix)))
+        continue;
+
+      if (_sdr_cache_shared_filename (cachefilename,
+                                      dirent->d_name,
+                                      filenamebuf,
+                                      MAXPATHLEN + 1) < 0)
+        continue;
+
+      memset (targetbuf, '\0', MAXPATHLEN + 1);
+      if ((len = readlink (filenamebuf, targetbuf, MAXPATHLEN)) <= 0)
+        continue;
+
+      if (linked_count == linked_len)
+        {
+          char **tmp;
+
+          linked_len = linked_len ? linked_len * 2 : 64;
+          if (!(tmp = realloc (linked, linked_len * sizeof (char *))))
+            goto cleanup;
+          linked = tmp;
+        }
+
+      if (!(linked[linked_count] = strdup (targetbuf)))
+        goto cleanup;
+      linked_count++;
+    }
+
+  rewinddir (dir);
+
+  /* Second pass, remove unreferenced blobs and dangling platform links */
+  while ((dirent = readdir (dir)))
+    {
+      int is_blob = 0;
+
+      if (!strncmp (dirent->d_name, blobprefix, strlen (blobprefix)))
+        is_blob++;
+      else if (strncmp (dirent->d_name, platformprefix, strlen (platformprefix)))
+        continue;
+
+      if (_sdr_cache_shared_filename (cachefilename,
+                                      dirent->d_name,
+                                      filenamebuf,
+                                      MAXPATHLEN + 1) < 0)
+        continue;
+
+      if (lstat (filenamebuf, &statbuf) < 0
+          || (now - statbuf.st_ctime) < SDR_CACHE_SHARED_GC_GRACE)
+        continue;
+
+      if (is_blob)
+        {
+          for (i = 0; i < linked_count; i++)
+            {
+              if (!strcmp (linked[i], dirent->d_name))
+                break;
+            }
+
+          if (i < linked_count)
+            continue;
+        }
+      else
+        {
+          /* stat follows the link, a dangling link fails */
+          if (!stat (filenamebuf, &statbuf))
+            continue;
+        }
+
+      /* ignore potential error, cleanup path */
+      unlink (filenamebuf);
+    }
+
+ cleanup:
+  closedir (dir);
+  for (i = 0; i < linked_count; i++)
+    free (linked[i]);
+  free (linked);
+}
+
 int
 sdr_cache_create_and_load (ipmi_sdr_ctx_t sdr_ctx,
                            pstdout_state_t pstate,
@@ -598,6 +1299,8 @@ sdr_cache_create_and_load (ipmi_sdr_ctx_t sdr_ctx,
                            const struct common_cmd_args *common_args)
 {
   char cachefilenamebuf[MAXPATHLEN+1];
+  char platformfilenamebuf[MAXPATHLEN+1];
+  int shared = 0;
   int rv = -1;
 
   assert (sdr_ctx);
@@ -611,6 +1314,11 @@ sdr_cache_create_and_load (ipmi_sdr_ctx_t sdr_ctx,
                                      MAXPATHLEN) < 0)
     goto cleanup;
 
+  if (common_args->sdr_cache_shared
+      && !common_args->sdr_cache_file
+      && ipmi_ctx)
+    shared++;
+
   /* If user specifies cache file, don't check timestamps, just load it */
 
   if (ipmi_sdr_cache_open (sdr_ctx,
@@ -656,12 +1364,62 @@ sdr_cache_create_and_load (ipmi_sdr_ctx_t sdr_ctx,
            || ipmi_sdr_ctx_errnum (sdr_ctx) == IPMI_SDR_ERR_CACHE_OUT_OF_DATE)
           && common_args->sdr_cache_recreate))
     {
-      if (_sdr_cache_create (sdr_ctx,
-                             pstate,
-                             ipmi_ctx,
-                             hostname,
-                             common_args) < 0)
-        goto cleanup;
+      int errnum = ipmi_sdr_ctx_errnum (sdr_ctx);
+      int linked = 0;
+
+      /* Never write through a link to a shared blob, other hosts
+       * may be using it.
+       */
+      if (!common_args->sdr_cache_file)
+        {
+          struct stat statbuf;
+
+          if (!lstat (cachefilenamebuf, &statbuf)
+              && S_ISLNK (statbuf.st_mode))
+            unlink (cachefilenamebuf);
+        }
+
+      if (shared)
+        {
+          uint16_t record_count = 0;
+
+          memset (platformfilenamebuf, '\0', MAXPATHLEN+1);
+          if (_sdr_cache_shared_platform_filename (pstate,
+                                                   ipmi_ctx,
+                                                   cachefilenamebuf,
+                                                   platformfilenamebuf,
+                                                   MAXPATHLEN,
+                                                   &record_count) <= 0)
+            shared = 0;
+          else if (errnum != IPMI_SDR_ERR_CACHE_INVALID)
+            {
+              if ((linked = _sdr_cache_shared_link (sdr_ctx,
+                                                    pstate,
+                                                    ipmi_ctx,
+                                                    cachefilenamebuf,
+                                                    platformfilenamebuf,
+                                                    record_count)) < 0)
+                goto cleanup;
+            }
+        }
+
+      if (!linked)
+        {
+          if (_sdr_cache_create (sdr_ctx,
+                                 pstate,
+                                 ipmi_ctx,
+                                 hostname,
+                                 common_args) < 0)
+            goto cleanup;
+
+          if (shared)
+            _sdr_cache_shared_publish (pstate,
+                                       cachefilenamebuf,
+                                       platformfilenamebuf);
+        }
+
+      if (shared)
+        _sdr_cache_shared_gc (cachefilenamebuf);
 
       if (ipmi_sdr_cache_open (sdr_ctx,
                                common_args->sdr_cache_file ? NULL : ipmi_ctx,
@@ -0,0 +1,29 @@
+##*****************************************************************************
+## $Id: ac_ipmisensorsd_cache_dir.m4,v 1.1 $
+##*****************************************************************************
+
+AC_DEFUN([AC_IPMISENSORSD_CACHE_DIRECTORY],
+[
+# Must expand nested unquoting
+  IPMISENSORSD_CACHE_DIRECTORY_TMP1="`eval echo ${localstatedir}/cache/ipmisensorsd/`"
+  IPMISENSORSD_CACHE_DIRECTORY_TMP2="`echo $IPMISENSORSD_CACHE_DIRECTORY_TMP1 | sed 's/^NONE/$ac_default_prefix/'`"
+  IPMISENSORSD_CACHE_DIRECTORY="`eval echo $IPMISENSORSD_CACHE_DIRECTORY_TMP2`"
+
+  AC_MSG_CHECKING([for ipmisensorsd cache dir default path])
+  AC_ARG_WITH([ipmisensorsd-cache-dir],
+    AC_HELP_STRING([--with-ipmisensorsd-cache-dir=PATH], 
+                   [Specify default ipmisensorsd cache dir path]),
+    [ case "$withval" in
+        no)  ;;
+        yes) ;;
+        *)   IPMISENSORSD_CACHE_DIRECTORY=$withval 
+      esac
+    ]
+  )
+  AC_MSG_RESULT($IPMISENSORSD_CACHE_DIRECTORY)
+
+  AC_DEFINE_UNQUOTED([IPMISENSORSD_CACHE_DIRECTORY], 
+                     ["$IPMISENSORSD_CACHE_DIRECTORY"], 
+                     [Define default ipmisensorsd cache dir.])
+  AC_SUBST(IPMISENSORSD_CACHE_DIRECTORY)
+])
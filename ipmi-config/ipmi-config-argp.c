@@ -76,6 +76,7 @@ static struct argp_option cmdline_options[] = {
   ARGP_COMMON_SDR_CACHE_OPTIONS_FILE_DIRECTORY,
   ARGP_COMMON_HOSTRANGED_OPTIONS,
   ARGP_COMMON_OPTIONS_DEBUG,
+  ARGP_COMMON_OPTIONS_PACKET_TRACE,
   { "category", IPMI_CONFIG_ARGP_CATEGORY_KEY, "CATEGORY", 0,
     "Specify category (categories) to configure.  Defaults to 'core'.", 40},
   { "checkout", IPMI_CONFIG_ARGP_CHECKOUT_KEY, 0, 0,
@@ -40,6 +40,7 @@
 #endif /* !HAVE_ARGP_H */
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
 
 #include "ipmi-dcmi.h"
 #include "ipmi-dcmi-argp.h"
@@ -75,6 +76,7 @@ static struct argp_option cmdline_options[] =
     ARGP_COMMON_TIME_OPTIONS,
     ARGP_COMMON_HOSTRANGED_OPTIONS,
     ARGP_COMMON_OPTIONS_DEBUG,
+    ARGP_COMMON_OPTIONS_PACKET_TRACE,
     { "get-dcmi-capability-info", GET_DCMI_CAPABILITY_INFO, NULL, 0,
       "Get DCMI capability information.", 40},
     { "get-asset-tag", GET_ASSET_TAG, NULL, 0,
@@ -107,6 +109,16 @@ static struct argp_option cmdline_options[] =
       "Activate or deactivate power limit.", 54},
     { "interpret-oem-data", INTERPRET_OEM_DATA_KEY, NULL, 0,
       "Attempt to interpret OEM data.", 55},
+    { "sample-power", SAMPLE_POWER_KEY, NULL, 0,
+      "Continuously sample system power readings.", 56},
+    { "sample-interval", SAMPLE_INTERVAL_KEY, "MILLISECONDS", 0,
+      "Specify the interval between power samples of each host.", 57},
+    { "sample-count", SAMPLE_COUNT_KEY, "COUNT", 0,
+      "Specify the number of power samples to take from each host.", 58},
+    { "sample-file", SAMPLE_FILE_KEY, "FILE", 0,
+      "Write power samples to a ring file instead of standard output.", 59},
+    { "sample-file-records", SAMPLE_FILE_RECORDS_KEY, "COUNT", 0,
+      "Specify the number of records kept in the sample ring file.", 60},
     { NULL, 0, NULL, 0, NULL, 0}
   };
 
@@ -292,6 +304,56 @@ cmdline_parse (int key, char *arg, struct argp_state *state)
     case INTERPRET_OEM_DATA_KEY:
       cmd_args->interpret_oem_data = 1;
       break;
+    case SAMPLE_POWER_KEY:
+      cmd_args->sample_power++;
+      break;
+    case SAMPLE_INTERVAL_KEY:
+      errno = 0;
+      lltmp = strtoll (arg, &endptr, 10);
+      if (errno
+          || endptr[0] != '\0'
+          || lltmp <= 0
+          || lltmp > UINT_MAX)
+        {
+          fprintf (stderr, "invalid value for sample interval\n");
+          exit (EXIT_FAILURE);
+        }
+      cmd_args->sample_interval = lltmp;
+      break;
+    case SAMPLE_COUNT_KEY:
+      errno = 0;
+      lltmp = strtoll (arg, &endptr, 10);
+      if (errno
+          || endptr[0] != '\0'
+          || lltmp < 0
+          || lltmp > UINT_MAX)
+        {
+          fprintf (stderr, "invalid value for sample count\n");
+          exit (EXIT_FAILURE);
+        }
+      cmd_args->sample_count = lltmp;
+      break;
+    case SAMPLE_FILE_KEY:
+      free (cmd_args->sample_file);
+      if (!(cmd_args->sample_file = strdup (arg)))
+        {
+          perror ("strdup");
+          exit (EXIT_FAILURE);
+        }
+      break;
+    case SAMPLE_FILE_RECORDS_KEY:
+      errno = 0;
+      lltmp = strtoll (arg, &endptr, 10);
+      if (errno
+          || endptr[0] != '\0'
+          || lltmp <= 0
+          || lltmp > UINT_MAX)
+        {
+          fprintf (stderr, "invalid value for sample file records\n");
+          exit (EXIT_FAILURE);
+        }
+      cmd_args->sample_file_records = lltmp;
+      break;
     case ARGP_KEY_ARG:
       /* Too many arguments. */
       argp_usage (state);
@@ -346,7 +408,8 @@ _ipmi_dcmi_args_validate (struct ipmi_dcmi_arguments *cmd_args)
       && !cmd_args->get_enhanced_system_power_statistics
       && !cmd_args->get_power_limit
       && !cmd_args->set_power_limit
-      && !cmd_args->activate_deactivate_power_limit)
+      && !cmd_args->activate_deactivate_power_limit
+      && !cmd_args->sample_power)
     {
       fprintf (stderr,
                "No command specified.\n");
@@ -363,7 +426,8 @@ _ipmi_dcmi_args_validate (struct ipmi_dcmi_arguments *cmd_args)
        + cmd_args->get_enhanced_system_power_statistics
        + cmd_args->get_power_limit
        + cmd_args->set_power_limit
-       + cmd_args->activate_deactivate_power_limit) > 1)
+       + cmd_args->activate_deactivate_power_limit
+       + cmd_args->sample_power) > 1)
     {
       fprintf (stderr,
                "Multiple commands specified.\n");
@@ -409,6 +473,11 @@ ipmi_dcmi_argp_parse (int argc, char **argv, struct ipmi_dcmi_arguments *cmd_arg
   cmd_args->statistics_sampling_period = 0;
   cmd_args->activate_deactivate_power_limit = 0;
   cmd_args->interpret_oem_data = 0;
+  cmd_args->sample_power = 0;
+  cmd_args->sample_interval = IPMI_DCMI_SAMPLE_INTERVAL_DEFAULT;
+  cmd_args->sample_count = 0;
+  cmd_args->sample_file = NULL;
+  cmd_args->sample_file_records = IPMI_DCMI_SAMPLE_FILE_RECORDS_DEFAULT;
 
   argp_parse (&cmdline_config_file_argp,
               argc,
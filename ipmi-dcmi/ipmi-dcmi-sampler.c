@@ -0,0 +1,616 @@
+/*****************************************************************************\
+ *  Copyright (C) 2009-2015 Lawrence Livermore National Security, LLC.
+ *  Produced at Lawrence Livermore National Laboratory (cf, DISCLAIMER).
+ *  Written by Albert Chu <chu11@llnl.gov>
+ *  LLNL-CODE-413270
+ *
+ *  This file is part of Ipmi-Dcmi, tools and libraries to support the
+ *  data center manageability interface (DCMI).  For details, see
+ *  http://www.llnl.gov/linux/.
+ *
+ *  Ipmi-Dcmi is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  Ipmi-Dcmi is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Ipmi-Dcmi.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#if STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+#if HAVE_FCNTL_H
+#include <fcntl.h>
+#endif /* HAVE_FCNTL_H */
+#include <sys/types.h>
+#include <sys/stat.h>
+#if TIME_WITH_SYS_TIME
+#include <sys/time.h>
+#include <time.h>
+#else /* !TIME_WITH_SYS_TIME */
+#if HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else /* !HAVE_SYS_TIME_H */
+#include <time.h>
+#endif /* !HAVE_SYS_TIME_H */
+#endif /* !TIME_WITH_SYS_TIME */
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include <freeipmi/freeipmi.h>
+
+#include "ipmi-dcmi.h"
+#include "ipmi-dcmi-sampler.h"
+
+#include "freeipmi-portability.h"
+#include "fi_hostlist.h"
+#include "pstdout.h"
+#include "tool-common.h"
+
+/* Records in a sample file are fixed width, padded with spaces, so
+ * record N always lives at offset N * IPMI_DCMI_SAMPLE_RECORD_LEN and
+ * the file can be used as a ring.
+ */
+#define IPMI_DCMI_SAMPLE_RECORD_LEN       128
+
+#define IPMI_DCMI_SAMPLE_INBAND_HOSTNAME  "localhost"
+
+#define IPMI_DCMI_SAMPLE_STATE_ACTIVE     "active"
+#define IPMI_DCMI_SAMPLE_STATE_INACTIVE   "inactive"
+#define IPMI_DCMI_SAMPLE_STATE_ERROR      "error"
+#define IPMI_DCMI_SAMPLE_STATE_MISSED     "missed"
+
+/* seconds */
+#define IPMI_DCMI_SAMPLE_REOPEN_BACKOFF_MIN 1
+#define IPMI_DCMI_SAMPLE_REOPEN_BACKOFF_MAX 64
+
+struct ipmi_dcmi_sample_host
+{
+  const char *hostname;         /* NULL for inband */
+  ipmi_ctx_t ipmi_ctx;
+  uint64_t offset;              /* milliseconds into each interval */
+  uint64_t next_open;           /* milliseconds, earliest session reopen */
+  uint64_t last_used;           /* milliseconds */
+  unsigned int backoff;         /* seconds */
+};
+
+struct ipmi_dcmi_sampler
+{
+  ipmi_dcmi_prog_data_t *prog_data;
+  struct ipmi_dcmi_sample_host *hosts;
+  unsigned int hosts_count;
+  uint64_t start;               /* milliseconds */
+  uint64_t session_timeout;     /* milliseconds */
+  pthread_mutex_t output_mutex;
+  int fd;                       /* -1 for stdout */
+  unsigned int records;
+  unsigned int next_record;
+};
+
+struct ipmi_dcmi_sample_worker
+{
+  struct ipmi_dcmi_sampler *sampler;
+  unsigned int first;
+  unsigned int stride;
+  pthread_t thread;
+};
+
+static uint64_t
+_now_ms (void)
+{
+  struct timeval tv;
+
+  gettimeofday (&tv, NULL);
+  return ((uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000);
+}
+
+static void
+_sleep_ms (uint64_t ms)
+{
+  struct timespec request, remain;
+
+  request.tv_sec = ms / 1000;
+  request.tv_nsec = (ms % 1000) * 1000000;
+
+  while (nanosleep (&request, &remain) < 0 && errno == EINTR)
+    request = remain;
+}
+
+static void
+_sample_output (struct ipmi_dcmi_sampler *sampler,
+                uint64_t timestamp,
+                struct ipmi_dcmi_sample_host *host,
+                const char *power_str,
+                const char *state)
+{
+  char buf[IPMI_DCMI_SAMPLE_RECORD_LEN + 1];
+  int len;
+
+  assert (sampler);
+  assert (host);
+  assert (power_str);
+  assert (state);
+
+  /* time is output as seconds.milliseconds */
+  len = snprintf (buf,
+                  IPMI_DCMI_SAMPLE_RECORD_LEN,
+                  "%llu.%03u,%s,%s,%s",
+                  (unsigned long long)(timestamp / 1000),
+                  (unsigned int)(timestamp % 1000),
+                  host->hostname ? host->hostname : IPMI_DCMI_SAMPLE_INBAND_HOSTNAME,
+                  power_str,
+                  state);
+  if (len < 0 || len > IPMI_DCMI_SAMPLE_RECORD_LEN - 1)
+    len = IPMI_DCMI_SAMPLE_RECORD_LEN - 1;
+
+  pthread_mutex_lock (&sampler->output_mutex);
+
+  if (sampler->fd < 0)
+    {
+      printf ("%.*s\n", len, buf);
+      fflush (stdout);
+    }
+  else
+    {
+      off_t offset;
+
+      memset (buf + len, ' ', IPMI_DCMI_SAMPLE_RECORD_LEN - 1 - len);
+      buf[IPMI_DCMI_SAMPLE_RECORD_LEN - 1] = '\n';
+
+      offset = (off_t)sampler->next_record * IPMI_DCMI_SAMPLE_RECORD_LEN;
+      if (pwrite (sampler->fd, buf, IPMI_DCMI_SAMPLE_RECORD_LEN, offset) != IPMI_DCMI_SAMPLE_RECORD_LEN)
+        fprintf (stderr, "pwrite: %s\n", strerror (errno));
+
+      sampler->next_record = (sampler->next_record + 1) % sampler->records;
+    }
+
+  pthread_mutex_unlock (&sampler->output_mutex);
+}
+
+static int
+_sample_open (struct ipmi_dcmi_sampler *sampler,
+              struct ipmi_dcmi_sample_host *host)
+{
+  ipmi_dcmi_prog_data_t *prog_data;
+
+  assert (sampler);
+  assert (host);
+  assert (!host->ipmi_ctx);
+
+  prog_data = sampler->prog_data;
+
+  if (_now_ms () < host->next_open)
+    return (-1);
+
+  if (!(host->ipmi_ctx = ipmi_open (prog_data->progname,
+                                    host->hostname,
+                                    &(prog_data->args->common_args),
+                                    NULL,
+                                    0)))
+    {
+      if (!host->backoff)
+        host->backoff = IPMI_DCMI_SAMPLE_REOPEN_BACKOFF_MIN;
+      else if (host->backoff < IPMI_DCMI_SAMPLE_REOPEN_BACKOFF_MAX)
+        host->backoff *= 2;
+
+      fprintf (stderr,
+               "%s: unable to open session, retrying in %u seconds\n",
+               host->hostname ? host->hostname : IPMI_DCMI_SAMPLE_INBAND_HOSTNAME,
+               host->backoff);
+
+      host->next_open = _now_ms () + (uint64_t)host->backoff * 1000;
+      return (-1);
+    }
+
+  host->backoff = 0;
+  host->last_used = _now_ms ();
+  return (0);
+}
+
+static void
+_sample_close (struct ipmi_dcmi_sample_host *host)
+{
+  assert (host);
+
+  ipmi_ctx_close (host->ipmi_ctx);
+  ipmi_ctx_destroy (host->ipmi_ctx);
+  host->ipmi_ctx = NULL;
+}
+
+static void
+_sample (struct ipmi_dcmi_sampler *sampler,
+         struct ipmi_dcmi_sample_host *host,
+         fiid_obj_t obj_cmd_rs)
+{
+  char power_str[IPMI_DCMI_SAMPLE_RECORD_LEN];
+  uint16_t current_power;
+  uint16_t minimum_power;
+  uint16_t maximum_power;
+  uint16_t average_power;
+  uint8_t power_measurement;
+  uint64_t timestamp;
+  uint64_t val;
+
+  assert (sampler);
+  assert (host);
+  assert (obj_cmd_rs);
+
+  timestamp = _now_ms ();
+
+  /* libfreeipmi considers a session idle for longer than the session
+   * timeout gone, as would most BMCs, so with long intervals open a
+   * fresh one rather than fail every sample.
+   */
+  if (host->ipmi_ctx
+      && host->hostname
+      && timestamp - host->last_used >= sampler->session_timeout)
+    _sample_close (host);
+
+  if (!host->ipmi_ctx
+      && _sample_open (sampler, host) < 0)
+    goto error;
+
+  if (fiid_obj_clear (obj_cmd_rs) < 0)
+    {
+      fprintf (stderr,
+               "fiid_obj_clear: %s\n",
+               fiid_obj_errormsg (obj_cmd_rs));
+      goto error;
+    }
+
+  if (ipmi_cmd_dcmi_get_power_reading (host->ipmi_ctx,
+                                       IPMI_DCMI_POWER_READING_MODE_SYSTEM_POWER_STATISTICS,
+                                       0,
+                                       obj_cmd_rs) < 0)
+    {
+      int errnum = ipmi_ctx_errnum (host->ipmi_ctx);
+
+      fprintf (stderr,
+               "%s: ipmi_cmd_dcmi_get_power_reading: %s\n",
+               host->hostname ? host->hostname : IPMI_DCMI_SAMPLE_INBAND_HOSTNAME,
+               ipmi_ctx_errormsg (host->ipmi_ctx));
+
+      /* A completion code from the BMC says nothing about the
+       * session, anything else and the session is re-established.
+       */
+      if (errnum != IPMI_ERR_BAD_COMPLETION_CODE
+          && errnum != IPMI_ERR_COMMAND_INVALID_OR_UNSUPPORTED)
+        _sample_close (host);
+      goto error;
+    }
+
+  host->last_used = _now_ms ();
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "current_power", &val) < 0)
+    goto fiid_error;
+  current_power = val;
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "minimum_power_over_sampling_duration", &val) < 0)
+    goto fiid_error;
+  minimum_power = val;
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "maximum_power_over_sampling_duration", &val) < 0)
+    goto fiid_error;
+  maximum_power = val;
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "average_power_over_sampling_duration", &val) < 0)
+    goto fiid_error;
+  average_power = val;
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "power_reading_state.power_measurement", &val) < 0)
+    goto fiid_error;
+  power_measurement = val;
+
+  snprintf (power_str,
+            IPMI_DCMI_SAMPLE_RECORD_LEN,
+            "%u,%u,%u,%u",
+            current_power,
+            minimum_power,
+            maximum_power,
+            average_power);
+
+  _sample_output (sampler,
+                  timestamp,
+                  host,
+                  power_str,
+                  power_measurement ? IPMI_DCMI_SAMPLE_STATE_ACTIVE : IPMI_DCMI_SAMPLE_STATE_INACTIVE);
+  return;
+
+ fiid_error:
+  fprintf (stderr,
+           "%s: fiid_obj_get: %s\n",
+           host->hostname ? host->hostname : IPMI_DCMI_SAMPLE_INBAND_HOSTNAME,
+           fiid_obj_errormsg (obj_cmd_rs));
+ error:
+  _sample_output (sampler, timestamp, host, ",,,", IPMI_DCMI_SAMPLE_STATE_ERROR);
+}
+
+/* Sample k of host i is due at start + k * interval + offset(i), where
+ * the offsets spread the hosts evenly across one interval.  Because
+ * due times are absolute, a slow response delays only the samples
+ * behind it on the same worker and error does not accumulate.  A
+ * sample more than one interval late is recorded as missed rather
+ * than sent, so a worker that falls behind does not burst.
+ */
+static void *
+_sample_worker (void *arg)
+{
+  struct ipmi_dcmi_sample_worker *worker;
+  struct ipmi_dcmi_sampler *sampler;
+  struct ipmi_dcmi_arguments *args;
+  fiid_obj_t obj_cmd_rs = NULL;
+  unsigned int i;
+  uint64_t k;
+
+  assert (arg);
+
+  worker = (struct ipmi_dcmi_sample_worker *)arg;
+  sampler = worker->sampler;
+  args = sampler->prog_data->args;
+
+  if (!(obj_cmd_rs = fiid_obj_create (tmpl_cmd_dcmi_get_power_reading_rs)))
+    {
+      fprintf (stderr,
+               "fiid_obj_create: %s\n",
+               strerror (errno));
+      return (NULL);
+    }
+
+  for (k = 0; !args->sample_count || k < args->sample_count; k++)
+    {
+      for (i = worker->first; i < sampler->hosts_count; i += worker->stride)
+        {
+          struct ipmi_dcmi_sample_host *host = &sampler->hosts[i];
+          uint64_t due, now;
+
+          due = sampler->start + k * args->sample_interval + host->offset;
+          now = _now_ms ();
+
+          if (now < due)
+            _sleep_ms (due - now);
+          else if (now - due >= args->sample_interval)
+            {
+              _sample_output (sampler, due, host, ",,,", IPMI_DCMI_SAMPLE_STATE_MISSED);
+              continue;
+            }
+
+          _sample (sampler, host, obj_cmd_rs);
+        }
+    }
+
+  for (i = worker->first; i < sampler->hosts_count; i += worker->stride)
+    {
+      if (sampler->hosts[i].ipmi_ctx)
+        _sample_close (&sampler->hosts[i]);
+    }
+
+  fiid_obj_destroy (obj_cmd_rs);
+  return (NULL);
+}
+
+/* Resume a ring after the newest record already in it */
+static int
+_sample_file_open (struct ipmi_dcmi_sampler *sampler,
+                   const char *filename)
+{
+  char buf[IPMI_DCMI_SAMPLE_RECORD_LEN + 1];
+  struct stat statbuf;
+  unsigned long long newest = 0;
+  unsigned int existing;
+  unsigned int i;
+
+  assert (sampler);
+  assert (filename);
+
+  if ((sampler->fd = open (filename, O_RDWR | O_CREAT, 0644)) < 0)
+    {
+      fprintf (stderr,
+               "open: %s: %s\n",
+               filename,
+               strerror (errno));
+      return (-1);
+    }
+
+  if (fstat (sampler->fd, &statbuf) < 0)
+    {
+      fprintf (stderr,
+               "fstat: %s: %s\n",
+               filename,
+               strerror (errno));
+      return (-1);
+    }
+
+  existing = statbuf.st_size / IPMI_DCMI_SAMPLE_RECORD_LEN;
+  if (existing > sampler->records)
+    existing = sampler->records;
+
+  /* drop a partially written record and anything past the ring */
+  if (statbuf.st_size != (off_t)existing * IPMI_DCMI_SAMPLE_RECORD_LEN)
+    {
+      if (ftruncate (sampler->fd, (off_t)existing * IPMI_DCMI_SAMPLE_RECORD_LEN) < 0)
+        {
+          fprintf (stderr,
+                   "ftruncate: %s: %s\n",
+                   filename,
+                   strerror (errno));
+          return (-1);
+        }
+    }
+
+  sampler->next_record = existing % sampler->records;
+
+  for (i = 0; i < existing; i++)
+    {
+      unsigned long long timestamp;
+      unsigned int msec = 0;
+
+      if (pread (sampler->fd,
+                 buf,
+                 IPMI_DCMI_SAMPLE_RECORD_LEN,
+                 (off_t)i * IPMI_DCMI_SAMPLE_RECORD_LEN) != IPMI_DCMI_SAMPLE_RECORD_LEN)
+        {
+          fprintf (stderr,
+                   "pread: %s: %s\n",
+                   filename,
+                   strerror (errno));
+          return (-1);
+        }
+      buf[IPMI_DCMI_SAMPLE_RECORD_LEN] = '\0';
+
+      if (sscanf (buf, "%llu.%u", &timestamp, &msec) < 1)
+        continue;
+
+      timestamp = timestamp * 1000 + msec;
+      if (timestamp >= newest)
+        {
+          newest = timestamp;
+          sampler->next_record = (i + 1) % sampler->records;
+        }
+    }
+
+  return (0);
+}
+
+int
+ipmi_dcmi_sampler (ipmi_dcmi_prog_data_t *prog_data)
+{
+  struct ipmi_dcmi_arguments *args;
+  struct ipmi_dcmi_sampler sampler;
+  struct ipmi_dcmi_sample_worker *workers = NULL;
+  unsigned int workers_count = 0;
+  fi_hostlist_t hlist = NULL;
+  fi_hostlist_iterator_t hitr = NULL;
+  char *host;
+  int mutex_init = 0;
+  unsigned int i;
+  int rv = EXIT_FAILURE;
+
+  assert (prog_data);
+
+  args = prog_data->args;
+
+  memset (&sampler, '\0', sizeof (struct ipmi_dcmi_sampler));
+  sampler.prog_data = prog_data;
+  sampler.fd = -1;
+  sampler.records = args->sample_file_records;
+  sampler.session_timeout = args->common_args.session_timeout ? args->common_args.session_timeout : IPMI_SESSION_TIMEOUT_DEFAULT;
+
+  if (args->common_args.hostname)
+    {
+      if (!(hlist = fi_hostlist_create (args->common_args.hostname)))
+        {
+          fprintf (stderr, "fi_hostlist_create: %s\n", strerror (errno));
+          goto cleanup;
+        }
+
+      if (!(sampler.hosts_count = fi_hostlist_count (hlist)))
+        {
+          rv = EXIT_SUCCESS;
+          goto cleanup;
+        }
+    }
+  else
+    sampler.hosts_count = 1;
+
+  if (!(sampler.hosts = calloc (sampler.hosts_count, sizeof (struct ipmi_dcmi_sample_host))))
+    {
+      perror ("calloc");
+      goto cleanup;
+    }
+
+  if (hlist)
+    {
+      if (!(hitr = fi_hostlist_iterator_create (hlist)))
+        {
+          fprintf (stderr, "fi_hostlist_iterator_create: %s\n", strerror (errno));
+          goto cleanup;
+        }
+
+      i = 0;
+      while ((host = fi_hostlist_next (hitr)) && i < sampler.hosts_count)
+        sampler.hosts[i++].hostname = host;
+    }
+
+  for (i = 0; i < sampler.hosts_count; i++)
+    sampler.hosts[i].offset = ((uint64_t)i * args->sample_interval) / sampler.hosts_count;
+
+  if (args->sample_file
+      && _sample_file_open (&sampler, args->sample_file) < 0)
+    goto cleanup;
+
+  if ((errno = pthread_mutex_init (&sampler.output_mutex, NULL)))
+    {
+      perror ("pthread_mutex_init");
+      goto cleanup;
+    }
+  mutex_init++;
+
+  /* one session per host, at most fanout sessions in flight */
+  workers_count = args->common_args.fanout ? args->common_args.fanout : PSTDOUT_FANOUT_DEFAULT;
+  if (workers_count > sampler.hosts_count)
+    workers_count = sampler.hosts_count;
+
+  if (!(workers = calloc (workers_count, sizeof (struct ipmi_dcmi_sample_worker))))
+    {
+      perror ("calloc");
+      goto cleanup;
+    }
+
+  sampler.start = _now_ms ();
+
+  for (i = 0; i < workers_count; i++)
+    {
+      workers[i].sampler = &sampler;
+      workers[i].first = i;
+      workers[i].stride = workers_count;
+
+      if ((errno = pthread_create (&workers[i].thread,
+                                   NULL,
+                                   _sample_worker,
+                                   &workers[i])))
+        {
+          /* earlier workers are already sampling, can't clean up under them */
+          perror ("pthread_create");
+          exit (EXIT_FAILURE);
+        }
+    }
+
+  for (i = 0; i < workers_count; i++)
+    pthread_join (workers[i].thread, NULL);
+
+  rv = EXIT_SUCCESS;
+ cleanup:
+  if (mutex_init)
+    pthread_mutex_destroy (&sampler.output_mutex);
+  if (sampler.fd >= 0)
+    close (sampler.fd);
+  if (sampler.hosts)
+    {
+      for (i = 0; i < sampler.hosts_count; i++)
+        free ((char *)sampler.hosts[i].hostname);
+      free (sampler.hosts);
+    }
+  free (workers);
+  if (hitr)
+    fi_hostlist_iterator_destroy (hitr);
+  if (hlist)
+    fi_hostlist_destroy (hlist);
+  return (rv);
+}
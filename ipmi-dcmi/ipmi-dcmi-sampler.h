@@ -0,0 +1,32 @@
+/*****************************************************************************\
+ *  Copyright (C) 2009-2015 Lawrence Livermore National Security, LLC.
+ *  Produced at Lawrence Livermore National Laboratory (cf, DISCLAIMER).
+ *  Written by Albert Chu <chu11@llnl.gov>
+ *  LLNL-CODE-413270
+ *
+ *  This file is part of Ipmi-Dcmi, tools and libraries to support the
+ *  data center manageability interface (DCMI).  For details, see
+ *  http://www.llnl.gov/linux/.
+ *
+ *  Ipmi-Dcmi is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  Ipmi-Dcmi is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Ipmi-Dcmi.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+#ifndef IPMI_DCMI_SAMPLER_H
+#define IPMI_DCMI_SAMPLER_H
+
+#include "ipmi-dcmi.h"
+
+int ipmi_dcmi_sampler (ipmi_dcmi_prog_data_t *prog_data);
+
+#endif /* IPMI_DCMI_SAMPLER_H */
@@ -50,6 +50,7 @@
 
 #include "ipmi-dcmi.h"
 #include "ipmi-dcmi-argp.h"
+#include "ipmi-dcmi-sampler.h"
 
 #include "freeipmi-portability.h"
 #include "pstdout.h"
@@ -2415,6 +2416,10 @@ main (int argc, char **argv)
   if (!hosts_count)
     return (EXIT_SUCCESS);
 
+  /* sampling keeps its own sessions open, it does not go through pstdout */
+  if (prog_data.args->sample_power)
+    return (ipmi_dcmi_sampler (&prog_data));
+
   if ((rv = pstdout_launch (prog_data.args->common_args.hostname,
                             _ipmi_dcmi,
                             &prog_data)) < 0)
@@ -51,8 +51,16 @@ enum ipmi_dcmi_argp_option_keys
     STATISTICS_SAMPLING_PERIOD = 173,
     ACTIVATE_DEACTIVATE_POWER_LIMIT = 174,
     INTERPRET_OEM_DATA_KEY = 175,
+    SAMPLE_POWER_KEY = 176,
+    SAMPLE_INTERVAL_KEY = 177,
+    SAMPLE_COUNT_KEY = 178,
+    SAMPLE_FILE_KEY = 179,
+    SAMPLE_FILE_RECORDS_KEY = 180,
   };
 
+#define IPMI_DCMI_SAMPLE_INTERVAL_DEFAULT     1000
+#define IPMI_DCMI_SAMPLE_FILE_RECORDS_DEFAULT 86400
+
 struct ipmi_dcmi_arguments
 {
   struct common_cmd_args common_args;
@@ -79,6 +87,11 @@ struct ipmi_dcmi_arguments
   int activate_deactivate_power_limit;
   uint8_t activate_deactivate_power_limit_arg;
   int interpret_oem_data;
+  int sample_power;
+  unsigned int sample_interval;
+  unsigned int sample_count;
+  char *sample_file;
+  unsigned int sample_file_records;
 };
 
 typedef struct ipmi_dcmi_prog_data
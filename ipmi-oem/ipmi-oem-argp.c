@@ -71,6 +71,7 @@ static struct argp_option cmdline_options[] =
     ARGP_COMMON_TIME_OPTIONS,
     ARGP_COMMON_HOSTRANGED_OPTIONS,
     ARGP_COMMON_OPTIONS_DEBUG,
+    ARGP_COMMON_OPTIONS_PACKET_TRACE,
     { "list", LIST_KEY, 0, 0,
       "List supported OEM IDs and Commands.", 30},
     { "verbose", VERBOSE_KEY, 0, 0,
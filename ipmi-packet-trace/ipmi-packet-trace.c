@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2005-2015 FreeIPMI Core Team
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#if STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <freeipmi/freeipmi.h>
+
+#include "ipmi-packet-trace.h"
+#include "ipmi-packet-trace-argp.h"
+
+#include "freeipmi-portability.h"
+
+/* Records are decoded as they are read, a partial record at the end
+ * of the buffer is moved to the front and completed by the next read.
+ * The library never writes a record larger than the buffer.
+ */
+static int
+_decode_fd (const char *filename, int fd)
+{
+  uint8_t *buf = NULL;
+  unsigned int buf_len = 0;
+  ssize_t n;
+  int ret;
+  int rv = -1;
+
+  assert (filename);
+
+  if (!(buf = malloc (IPMI_PACKET_TRACE_BUFLEN)))
+    {
+      perror ("malloc");
+      goto cleanup;
+    }
+
+  while (1)
+    {
+      if ((n = read (fd, buf + buf_len, IPMI_PACKET_TRACE_BUFLEN - buf_len)) < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          fprintf (stderr, "read: %s: %s\n", filename, strerror (errno));
+          goto cleanup;
+        }
+
+      if (!n)
+        break;
+
+      buf_len += n;
+
+      if ((ret = ipmi_dump_packet_trace (STDOUT_FILENO, buf, buf_len)) < 0)
+        {
+          fprintf (stderr, "%s: corrupt packet trace\n", filename);
+          goto cleanup;
+        }
+
+      buf_len -= ret;
+      memmove (buf, buf + ret, buf_len);
+    }
+
+  if (buf_len)
+    fprintf (stderr, "%s: partial record at end of file\n", filename);
+
+  rv = 0;
+ cleanup:
+  free (buf);
+  return (rv);
+}
+
+int
+main (int argc, char **argv)
+{
+  struct ipmi_packet_trace_arguments cmd_args;
+  unsigned int i;
+  int exit_code = EXIT_SUCCESS;
+
+  ipmi_packet_trace_argp_parse (argc, argv, &cmd_args);
+
+  if (!cmd_args.files_count)
+    {
+      if (_decode_fd ("stdin", STDIN_FILENO) < 0)
+        exit_code = EXIT_FAILURE;
+      return (exit_code);
+    }
+
+  for (i = 0; i < cmd_args.files_count; i++)
+    {
+      int fd;
+
+      if (!strcmp (cmd_args.files[i], "-"))
+        {
+          if (_decode_fd ("stdin", STDIN_FILENO) < 0)
+            exit_code = EXIT_FAILURE;
+          continue;
+        }
+
+      if ((fd = open (cmd_args.files[i], O_RDONLY)) < 0)
+        {
+          fprintf (stderr, "open: %s: %s\n", cmd_args.files[i], strerror (errno));
+          exit_code = EXIT_FAILURE;
+          continue;
+        }
+
+      if (_decode_fd (cmd_args.files[i], fd) < 0)
+        exit_code = EXIT_FAILURE;
+
+      /* ignore potential error, read only */
+      close (fd);
+    }
+
+  return (exit_code);
+}
@@ -69,6 +69,7 @@ static struct argp_option cmdline_options[] =
     ARGP_COMMON_SDR_CACHE_OPTIONS_FILE_DIRECTORY,
     ARGP_COMMON_SDR_CACHE_OPTIONS_LEGACY,
     ARGP_COMMON_OPTIONS_DEBUG,
+    ARGP_COMMON_OPTIONS_PACKET_TRACE,
     { "verbose",    VERBOSE_KEY,    0, 0,
       "Increase verbosity in output.", 40},
     { "pet-acknowledge", PET_ACKNOWLEDGE_KEY, 0, 0,
@@ -97,6 +98,12 @@ static struct argp_option cmdline_options[] =
       "Do not output column headers.", 52},
     { "non-abbreviated-units", NON_ABBREVIATED_UNITS_KEY, 0, 0,
       "Output non-abbreviated units (e.g. 'Amps' instead of 'A').", 53},
+    { "daemon", DAEMON_KEY, 0, 0,
+      "Continuously interpret traps prefixed with a hostname, keeping SDR caches loaded.", 54},
+    { "listen", LISTEN_KEY, "ADDRESS", 0,
+      "Read traps from a UNIX datagram socket path or UDP [HOST:]PORT in daemon mode.", 55},
+    { "host-cache-size", HOST_CACHE_SIZE_KEY, "COUNT", 0,
+      "Specify the number of hosts to keep loaded in daemon mode.", 56},
     { NULL, 0, NULL, 0, NULL, 0}
   };
 
@@ -195,6 +202,29 @@ cmdline_parse (int key, char *arg, struct argp_state *state)
     case NON_ABBREVIATED_UNITS_KEY:
       cmd_args->non_abbreviated_units = 1;
       break;
+    case DAEMON_KEY:
+      cmd_args->daemon = 1;
+      break;
+    case LISTEN_KEY:
+      if (!(cmd_args->listen = strdup (arg)))
+        {
+          perror ("strdup");
+          exit (EXIT_FAILURE);
+        }
+      break;
+    case HOST_CACHE_SIZE_KEY:
+      errno = 0;
+      tmp = strtoul (arg, &endptr, 10);
+      if (errno
+          || endptr[0] != '\0'
+          || !tmp
+          || tmp > UINT_MAX)
+        {
+          fprintf (stderr, "invalid host cache size: %s\n", arg);
+          exit (EXIT_FAILURE);
+        }
+      cmd_args->host_cache_size = tmp;
+      break;
     case ARGP_KEY_ARG:
       {
         unsigned int i;
@@ -337,6 +367,28 @@ _ipmi_pet_args_validate (struct ipmi_pet_arguments *cmd_args)
       exit (EXIT_FAILURE);
     }
 
+  if (cmd_args->daemon
+      && (cmd_args->pet_acknowledge
+          || cmd_args->specific_trap_set))
+    {
+      fprintf (stderr, "Cannot specify PET acknowledge or trap data in daemon mode\n");
+      exit (EXIT_FAILURE);
+    }
+
+  if (cmd_args->listen
+      && !cmd_args->daemon)
+    {
+      fprintf (stderr, "Must specify daemon mode if listen address specified\n");
+      exit (EXIT_FAILURE);
+    }
+
+  if (cmd_args->listen
+      && cmd_args->cmd_file)
+    {
+      fprintf (stderr, "Cannot specify both a listen address and a file\n");
+      exit (EXIT_FAILURE);
+    }
+
   if ((cmd_args->manufacturer_id_set
        && !cmd_args->product_id_set)
       || (!cmd_args->manufacturer_id_set
@@ -372,6 +424,9 @@ ipmi_pet_argp_parse (int argc, char **argv, struct ipmi_pet_arguments *cmd_args)
   cmd_args->comma_separated_output = 0;
   cmd_args->no_header_output = 0;
   cmd_args->non_abbreviated_units = 0;
+  cmd_args->daemon = 0;
+  cmd_args->listen = NULL;
+  cmd_args->host_cache_size = IPMI_PET_HOST_CACHE_SIZE_DEFAULT;
   cmd_args->specific_trap = 0;
   cmd_args->specific_trap_na_specified = 0;
   cmd_args->specific_trap_set = 0;
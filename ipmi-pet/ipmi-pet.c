@@ -38,6 +38,11 @@
 #include <time.h>
 #endif  /* !HAVE_SYS_TIME_H */
 #endif /* !TIME_WITH_SYS_TIME */
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netdb.h>
 #include <assert.h>
 #include <errno.h>
 
@@ -47,6 +52,7 @@
 #include "ipmi-pet-argp.h"
 
 #include "freeipmi-portability.h"
+#include "hash.h"
 #include "tool-common.h"
 #include "tool-cmdline-common.h"
 #include "tool-event-common.h"
@@ -61,6 +67,14 @@
 #define IPMI_PET_SYSTEM_ID_HEADER       "System ID"
 #define IPMI_PET_EVENT_SEVERITY_HEADER  "Severity"
 
+#define IPMI_PET_DAEMON_BUFLEN          65536
+
+/* seconds before retrying a host whose data could not be loaded,
+ * doubled on every failure
+ */
+#define IPMI_PET_HOST_RETRY_MIN         30
+#define IPMI_PET_HOST_RETRY_MAX         960
+
 struct ipmi_pet_input
 {
   uint32_t specific_trap;
@@ -96,6 +110,47 @@ struct ipmi_pet_trap_data
   unsigned int oem_custom_length;
 };
 
+static ipmi_sel_ctx_t
+_ipmi_pet_sel_ctx_create (ipmi_pet_state_data_t *state_data,
+                          ipmi_sdr_ctx_t sdr_ctx,
+                          const char *hostname)
+{
+  ipmi_sel_ctx_t sel_ctx = NULL;
+
+  assert (state_data);
+
+  if (!(sel_ctx = ipmi_sel_ctx_create (NULL, sdr_ctx)))
+    {
+      perror ("ipmi_sel_ctx_create()");
+      return (NULL);
+    }
+
+  if (state_data->prog_data->args->common_args.debug
+      && hostname)
+    {
+      if (ipmi_sel_ctx_set_debug_prefix (sel_ctx, hostname) < 0)
+        fprintf (stderr,
+                 "ipmi_sel_ctx_set_debug_prefix: %s\n",
+                 ipmi_sel_ctx_errormsg (sel_ctx));
+    }
+
+  if (state_data->interpret_ctx)
+    {
+      if (ipmi_sel_ctx_set_parameter (sel_ctx,
+                                      IPMI_SEL_PARAMETER_INTERPRET_CONTEXT,
+                                      &(state_data->interpret_ctx)) < 0)
+        {
+          fprintf (stderr,
+                   "ipmi_sel_ctx_set_interpret: %s\n",
+                   ipmi_sel_ctx_errormsg (sel_ctx));
+          ipmi_sel_ctx_destroy (sel_ctx);
+          return (NULL);
+        }
+    }
+
+  return (sel_ctx);
+}
+
 static int
 _ipmi_pet_init (ipmi_pet_state_data_t *state_data)
 {
@@ -2070,6 +2125,542 @@ run_cmd_args (ipmi_pet_state_data_t *state_data)
   return (rv);
 }
 
+/* Per host data kept loaded in daemon mode, so an event storm does
+ * not reload SDR caches for every trap.
+ */
+struct ipmi_pet_host
+{
+  char *hostname;
+  ipmi_sdr_ctx_t sdr_ctx;
+  ipmi_sel_ctx_t sel_ctx;
+  struct sensor_column_width column_width;
+  struct ipmi_oem_data oem_data;
+  /* non-zero if host data could not be loaded, no retry until then */
+  time_t retry_time;
+  unsigned int retry_interval;
+  struct ipmi_pet_host *prev;
+  struct ipmi_pet_host *next;
+};
+
+/* hosts are kept in most recently used order, the least recently
+ * used host is dropped when the cache is full.
+ */
+struct ipmi_pet_host_cache
+{
+  hash_t hosts;
+  struct ipmi_pet_host *head;
+  struct ipmi_pet_host *tail;
+  unsigned int count;
+};
+
+static void
+_ipmi_pet_host_destroy (struct ipmi_pet_host *host)
+{
+  if (!host)
+    return;
+
+  ipmi_sel_ctx_destroy (host->sel_ctx);
+  ipmi_sdr_ctx_destroy (host->sdr_ctx);
+  free (host->hostname);
+  free (host);
+}
+
+static struct ipmi_pet_host *
+_ipmi_pet_host_create (ipmi_pet_state_data_t *state_data, const char *hostname)
+{
+  struct ipmi_pet_arguments *args;
+  struct ipmi_pet_host *host = NULL;
+  ipmi_ctx_t ipmi_ctx = NULL;
+  struct ipmi_pet_host *rv = NULL;
+
+  assert (state_data);
+  assert (hostname);
+
+  args = state_data->prog_data->args;
+
+  if (!(host = (struct ipmi_pet_host *)malloc (sizeof (struct ipmi_pet_host))))
+    {
+      perror ("malloc");
+      goto cleanup;
+    }
+  memset (host, '\0', sizeof (struct ipmi_pet_host));
+
+  if (!(host->hostname = strdup (hostname)))
+    {
+      perror ("strdup");
+      goto cleanup;
+    }
+
+  if (!args->common_args.ignore_sdr_cache)
+    {
+      if (!(ipmi_ctx = ipmi_open (state_data->prog_data->progname,
+                                  host->hostname,
+                                  &(args->common_args),
+                                  NULL,
+                                  0)))
+        goto cleanup;
+
+      if (!(host->sdr_ctx = ipmi_sdr_ctx_create ()))
+        {
+          perror ("ipmi_sdr_ctx_create()");
+          goto cleanup;
+        }
+
+      if (sdr_cache_create_and_load (host->sdr_ctx,
+                                     NULL,
+                                     ipmi_ctx,
+                                     host->hostname,
+                                     &(args->common_args)) < 0)
+        goto cleanup;
+    }
+
+  if (!(host->sel_ctx = _ipmi_pet_sel_ctx_create (state_data,
+                                                  host->sdr_ctx,
+                                                  host->hostname)))
+    goto cleanup;
+
+  /* _ipmi_pet_init() calculates into state_data, save the results */
+  state_data->ipmi_ctx = ipmi_ctx;
+  state_data->sdr_ctx = host->sdr_ctx;
+  memset (&(state_data->column_width), '\0', sizeof (struct sensor_column_width));
+  memset (&(state_data->oem_data), '\0', sizeof (struct ipmi_oem_data));
+
+  if (_ipmi_pet_init (state_data) < 0)
+    goto cleanup;
+
+  memcpy (&(host->column_width),
+          &(state_data->column_width),
+          sizeof (struct sensor_column_width));
+  memcpy (&(host->oem_data),
+          &(state_data->oem_data),
+          sizeof (struct ipmi_oem_data));
+
+  rv = host;
+ cleanup:
+  state_data->ipmi_ctx = NULL;
+  state_data->sdr_ctx = NULL;
+  /* the BMC is not needed again once the SDR cache is loaded */
+  ipmi_ctx_close (ipmi_ctx);
+  ipmi_ctx_destroy (ipmi_ctx);
+  if (!rv)
+    _ipmi_pet_host_destroy (host);
+  return (rv);
+}
+
+static void
+_ipmi_pet_host_unlink (struct ipmi_pet_host_cache *cache, struct ipmi_pet_host *host)
+{
+  assert (cache);
+  assert (host);
+
+  if (host->prev)
+    host->prev->next = host->next;
+  else
+    cache->head = host->next;
+
+  if (host->next)
+    host->next->prev = host->prev;
+  else
+    cache->tail = host->prev;
+
+  host->prev = NULL;
+  host->next = NULL;
+}
+
+static void
+_ipmi_pet_host_push (struct ipmi_pet_host_cache *cache, struct ipmi_pet_host *host)
+{
+  assert (cache);
+  assert (host);
+
+  host->prev = NULL;
+  host->next = cache->head;
+  if (cache->head)
+    cache->head->prev = host;
+  else
+    cache->tail = host;
+  cache->head = host;
+}
+
+/* Negative cache entry for a host whose data could not be loaded.
+ * Every trap from an unreachable BMC would otherwise wait out the
+ * full session timeout again.
+ */
+static struct ipmi_pet_host *
+_ipmi_pet_host_failed_create (const char *hostname, unsigned int retry_interval)
+{
+  struct ipmi_pet_host *host;
+
+  assert (hostname);
+
+  if (!(host = (struct ipmi_pet_host *)malloc (sizeof (struct ipmi_pet_host))))
+    {
+      perror ("malloc");
+      return (NULL);
+    }
+  memset (host, '\0', sizeof (struct ipmi_pet_host));
+
+  if (!(host->hostname = strdup (hostname)))
+    {
+      perror ("strdup");
+      free (host);
+      return (NULL);
+    }
+
+  host->retry_interval = retry_interval;
+  host->retry_time = time (NULL) + retry_interval;
+  return (host);
+}
+
+/* returns host on success, NULL if host data could not be loaded */
+static struct ipmi_pet_host *
+_ipmi_pet_host_get (ipmi_pet_state_data_t *state_data,
+                    struct ipmi_pet_host_cache *cache,
+                    const char *hostname)
+{
+  struct ipmi_pet_host *host;
+  unsigned int retry_interval = IPMI_PET_HOST_RETRY_MIN;
+  int failed = 0;
+
+  assert (state_data);
+  assert (cache);
+  assert (hostname);
+
+  if ((host = hash_find (cache->hosts, hostname)))
+    {
+      _ipmi_pet_host_unlink (cache, host);
+      _ipmi_pet_host_push (cache, host);
+
+      if (!host->retry_time)
+        return (host);
+
+      if (time (NULL) < host->retry_time)
+        return (NULL);
+
+      retry_interval = host->retry_interval * 2;
+      if (retry_interval > IPMI_PET_HOST_RETRY_MAX)
+        retry_interval = IPMI_PET_HOST_RETRY_MAX;
+
+      hash_remove (cache->hosts, host->hostname);
+      _ipmi_pet_host_unlink (cache, host);
+      _ipmi_pet_host_destroy (host);
+      cache->count--;
+    }
+
+  if (!(host = _ipmi_pet_host_create (state_data, hostname)))
+    {
+      if (!(host = _ipmi_pet_host_failed_create (hostname, retry_interval)))
+        return (NULL);
+      failed++;
+    }
+
+  if (cache->count >= state_data->prog_data->args->host_cache_size)
+    {
+      struct ipmi_pet_host *lru = cache->tail;
+
+      assert (lru);
+
+      hash_remove (cache->hosts, lru->hostname);
+      _ipmi_pet_host_unlink (cache, lru);
+      _ipmi_pet_host_destroy (lru);
+      cache->count--;
+    }
+
+  if (!hash_insert (cache->hosts, host->hostname, host))
+    {
+      perror ("hash_insert");
+      _ipmi_pet_host_destroy (host);
+      return (NULL);
+    }
+
+  _ipmi_pet_host_push (cache, host);
+  cache->count++;
+  return (failed ? NULL : host);
+}
+
+/* returns -1 on fatal error, 0 otherwise */
+static int
+_ipmi_pet_daemon_record (ipmi_pet_state_data_t *state_data,
+                         struct ipmi_pet_host_cache *cache,
+                         char *line,
+                         unsigned int line_count)
+{
+  const char delim[] = " \t\f\v\r\n";
+  struct ipmi_pet_input input;
+  struct ipmi_pet_host *host;
+  char *hostname;
+  char *ptr;
+  int ret;
+
+  assert (state_data);
+  assert (cache);
+  assert (line);
+
+  /* records are "HOSTNAME SPECIFIC_TRAP VARIABLE_BINDINGS ..." */
+  ptr = line;
+  while (*ptr != '\0' && strchr (delim, *ptr))
+    ptr++;
+
+  if (*ptr == '\0')
+    return (0);
+
+  hostname = ptr;
+  while (*ptr != '\0' && !strchr (delim, *ptr))
+    ptr++;
+
+  if (*ptr != '\0')
+    *ptr++ = '\0';
+
+  if ((ret = _ipmi_pet_parse (state_data, ptr, &input, line_count)) < 0)
+    return (-1);
+
+  if (!ret)
+    return (0);
+
+  if (!(host = _ipmi_pet_host_get (state_data, cache, hostname)))
+    {
+      fprintf (stderr, "%s: unable to load host data on line %u\n", hostname, line_count);
+      return (0);
+    }
+
+  state_data->hostname = host->hostname;
+  state_data->sdr_ctx = host->sdr_ctx;
+  state_data->sel_ctx = host->sel_ctx;
+  memcpy (&(state_data->column_width),
+          &(host->column_width),
+          sizeof (struct sensor_column_width));
+  memcpy (&(state_data->oem_data),
+          &(host->oem_data),
+          sizeof (struct ipmi_oem_data));
+
+  printf ("%s: ", host->hostname);
+
+  /* one bad trap must not stop the daemon, end the partial line */
+  if (_ipmi_pet_process (state_data, &input) < 0)
+    {
+      printf ("\n");
+      fprintf (stderr, "%s: unable to decode trap on line %u\n", host->hostname, line_count);
+    }
+
+  /* consumers read events line by line as they are decoded */
+  fflush (stdout);
+
+  /* contexts belong to the host cache */
+  state_data->hostname = NULL;
+  state_data->sdr_ctx = NULL;
+  state_data->sel_ctx = NULL;
+  return (0);
+}
+
+static int
+_ipmi_pet_daemon_listen (const char *address)
+{
+  int fd = -1;
+
+  assert (address);
+
+  if (strchr (address, '/'))
+    {
+      struct sockaddr_un addr;
+      struct stat buf;
+
+      if (strlen (address) >= sizeof (addr.sun_path))
+        {
+          fprintf (stderr, "listen path too long: %s\n", address);
+          return (-1);
+        }
+
+      memset (&addr, '\0', sizeof (struct sockaddr_un));
+      addr.sun_family = AF_UNIX;
+      strcpy (addr.sun_path, address);
+
+      /* remove a stale socket left by a previous run */
+      if (!stat (address, &buf) && S_ISSOCK (buf.st_mode))
+        unlink (address);
+
+      if ((fd = socket (AF_UNIX, SOCK_DGRAM, 0)) < 0)
+        {
+          perror ("socket");
+          return (-1);
+        }
+
+      if (bind (fd, (struct sockaddr *)&addr, sizeof (struct sockaddr_un)) < 0)
+        {
+          fprintf (stderr, "bind %s: %s\n", address, strerror (errno));
+          close (fd);
+          return (-1);
+        }
+    }
+  else
+    {
+      struct addrinfo hints, *res = NULL, *ai;
+      char *str = NULL;
+      char *host = NULL;
+      char *port;
+      int ret;
+
+      if (!(str = strdup (address)))
+        {
+          perror ("strdup");
+          return (-1);
+        }
+
+      /* [HOST:]PORT, default is the IPv4 loopback address */
+      if ((port = strrchr (str, ':')))
+        {
+          *port++ = '\0';
+          host = str;
+          if (host[0] == '[' && host[strlen (host) - 1] == ']')
+            {
+              host[strlen (host) - 1] = '\0';
+              host++;
+            }
+        }
+      else
+        port = str;
+
+      memset (&hints, '\0', sizeof (struct addrinfo));
+      hints.ai_family = host ? AF_UNSPEC : AF_INET;
+      hints.ai_socktype = SOCK_DGRAM;
+
+      if ((ret = getaddrinfo (host, port, &hints, &res)))
+        {
+          fprintf (stderr, "getaddrinfo %s: %s\n", address, gai_strerror (ret));
+          free (str);
+          return (-1);
+        }
+
+      for (ai = res; ai; ai = ai->ai_next)
+        {
+          if ((fd = socket (ai->ai_family, ai->ai_socktype, ai->ai_protocol)) < 0)
+            continue;
+
+          if (!bind (fd, ai->ai_addr, ai->ai_addrlen))
+            break;
+
+          close (fd);
+          fd = -1;
+        }
+
+      if (fd < 0)
+        fprintf (stderr, "unable to listen on %s\n", address);
+
+      freeaddrinfo (res);
+      free (str);
+    }
+
+  return (fd);
+}
+
+static int
+_ipmi_pet_daemon (ipmi_pet_state_data_t *state_data)
+{
+  struct ipmi_pet_arguments *args;
+  struct ipmi_pet_host_cache cache;
+  FILE *infile = NULL;
+  char *line = NULL;
+  size_t n = 0;
+  char *buf = NULL;
+  unsigned int line_count = 0;
+  int fd = -1;
+  int rv = -1;
+
+  assert (state_data);
+
+  args = state_data->prog_data->args;
+
+  memset (&cache, '\0', sizeof (struct ipmi_pet_host_cache));
+
+  if (!(cache.hosts = hash_create (args->host_cache_size,
+                                   (hash_key_f)hash_key_string,
+                                   (hash_cmp_f)strcmp,
+                                   NULL)))
+    {
+      perror ("hash_create");
+      goto cleanup;
+    }
+
+  if (args->listen)
+    {
+      if ((fd = _ipmi_pet_daemon_listen (args->listen)) < 0)
+        goto cleanup;
+
+      if (!(buf = (char *)malloc (IPMI_PET_DAEMON_BUFLEN + 1)))
+        {
+          perror ("malloc");
+          goto cleanup;
+        }
+    }
+  else if (args->cmd_file)
+    {
+      if (!(infile = fopen (args->cmd_file, "r")))
+        {
+          perror ("fopen()");
+          goto cleanup;
+        }
+    }
+  else
+    infile = stdin;
+
+  while (1)
+    {
+      if (fd >= 0)
+        {
+          char *ptr;
+          char *record;
+          ssize_t len;
+
+          if ((len = recv (fd, buf, IPMI_PET_DAEMON_BUFLEN, 0)) < 0)
+            {
+              if (errno == EINTR)
+                continue;
+              perror ("recv");
+              goto cleanup;
+            }
+          buf[len] = '\0';
+
+          /* a datagram may carry several records */
+          ptr = buf;
+          while ((record = strsep (&ptr, "\n")))
+            {
+              line_count++;
+              if (_ipmi_pet_daemon_record (state_data, &cache, record, line_count) < 0)
+                goto cleanup;
+            }
+        }
+      else
+        {
+          if (getline (&line, &n, infile) < 0)
+            break;
+          line_count++;
+
+          if (_ipmi_pet_daemon_record (state_data, &cache, line, line_count) < 0)
+            goto cleanup;
+        }
+    }
+
+  rv = 0;
+ cleanup:
+  if (cache.hosts)
+    {
+      while (cache.head)
+        {
+          struct ipmi_pet_host *host = cache.head;
+
+          _ipmi_pet_host_unlink (&cache, host);
+          _ipmi_pet_host_destroy (host);
+        }
+      hash_destroy (cache.hosts);
+    }
+  if (fd >= 0)
+    close (fd);
+  if (infile && infile != stdin)
+    fclose (infile);
+  free (line);
+  free (buf);
+  return (rv);
+}
+
 static int
 _ipmi_pet (ipmi_pet_prog_data_t *prog_data)
 {
@@ -2091,8 +2682,10 @@ _ipmi_pet (ipmi_pet_prog_data_t *prog_data)
   state_data.prog_data = prog_data;
   state_data.hostname = prog_data->args->common_args.hostname;
 
+  /* In daemon mode, contexts are opened per host as traps arrive */
   if (!prog_data->args->common_args.ignore_sdr_cache
-      && !prog_data->args->pet_acknowledge)
+      && !prog_data->args->pet_acknowledge
+      && !prog_data->args->daemon)
     {
       if (!(state_data.ipmi_ctx = ipmi_open (prog_data->progname,
                                              prog_data->args->common_args.hostname,
@@ -2110,6 +2703,18 @@ _ipmi_pet (ipmi_pet_prog_data_t *prog_data)
           goto cleanup;
         }
 
+      if (prog_data->args->common_args.packet_trace_file)
+        {
+          if (ipmi_ctx_set_packet_trace_file (state_data.ipmi_ctx,
+                                              prog_data->args->common_args.packet_trace_file) < 0)
+            {
+              fprintf (stderr,
+                       "ipmi_ctx_set_packet_trace_file: %s\n",
+                       ipmi_ctx_errormsg (state_data.ipmi_ctx));
+              goto cleanup;
+            }
+        }
+
       if (ipmi_ctx_open_outofband (state_data.ipmi_ctx,
                                    state_data.hostname,
                                    NULL,
@@ -2130,7 +2735,8 @@ _ipmi_pet (ipmi_pet_prog_data_t *prog_data)
     }
 
   if (!prog_data->args->common_args.ignore_sdr_cache
-       && !prog_data->args->pet_acknowledge)
+      && !prog_data->args->pet_acknowledge
+      && !prog_data->args->daemon)
     {
       if (!(state_data.sdr_ctx = ipmi_sdr_ctx_create ()))
         {
@@ -2151,22 +2757,6 @@ _ipmi_pet (ipmi_pet_prog_data_t *prog_data)
   else
     state_data.sdr_ctx = NULL;
   
-  if (!(state_data.sel_ctx = ipmi_sel_ctx_create (NULL, state_data.sdr_ctx)))
-    {
-      perror ("ipmi_sel_ctx_create()");
-      goto cleanup;
-    }
-  
-  if (state_data.prog_data->args->common_args.debug
-      && prog_data->args->common_args.hostname)
-    {
-      if (ipmi_sel_ctx_set_debug_prefix (state_data.sel_ctx,
-                                         prog_data->args->common_args.hostname) < 0)
-        fprintf (stderr,
-                 "ipmi_sel_ctx_set_debug_prefix: %s\n",
-                 ipmi_sel_ctx_errormsg (state_data.sel_ctx));
-    }
-  
   /* Only for outputting type/length fields */
   if (!(state_data.fru_ctx = ipmi_fru_ctx_create (NULL)))
     {
@@ -2203,19 +2793,23 @@ _ipmi_pet (ipmi_pet_prog_data_t *prog_data)
             }
         }
 
-      if (ipmi_sel_ctx_set_parameter (state_data.sel_ctx,
-                                      IPMI_SEL_PARAMETER_INTERPRET_CONTEXT,
-                                      &(state_data.interpret_ctx)) < 0)
-        {
-          fprintf (stderr,
-                   "ipmi_sel_ctx_set_interpret: %s\n",
-                   ipmi_sel_ctx_errormsg (state_data.sel_ctx));
-          goto cleanup;
-        }
     }
-  
-  if (run_cmd_args (&state_data) < 0)
-    goto cleanup;
+
+  if (prog_data->args->daemon)
+    {
+      if (_ipmi_pet_daemon (&state_data) < 0)
+        goto cleanup;
+    }
+  else
+    {
+      if (!(state_data.sel_ctx = _ipmi_pet_sel_ctx_create (&state_data,
+                                                           state_data.sdr_ctx,
+                                                           prog_data->args->common_args.hostname)))
+        goto cleanup;
+
+      if (run_cmd_args (&state_data) < 0)
+        goto cleanup;
+    }
 
   exit_code = EXIT_SUCCESS;
  cleanup:
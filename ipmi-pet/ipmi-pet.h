@@ -29,6 +29,8 @@
 /* seems like a nice size */
 #define IPMI_PET_MAX_ARGS 1024
 
+#define IPMI_PET_HOST_CACHE_SIZE_DEFAULT 256
+
 enum ipmi_pet_argp_option_keys
   {
     VERBOSE_KEY = 'v',
@@ -45,6 +47,9 @@ enum ipmi_pet_argp_option_keys
     COMMA_SEPARATED_OUTPUT_KEY = 170,
     NO_HEADER_OUTPUT_KEY = 171,
     NON_ABBREVIATED_UNITS_KEY = 172,
+    DAEMON_KEY = 173,
+    LISTEN_KEY = 174,
+    HOST_CACHE_SIZE_KEY = 175,
   };
 
 struct ipmi_pet_arguments
@@ -66,6 +71,9 @@ struct ipmi_pet_arguments
   int comma_separated_output;
   int no_header_output;
   int non_abbreviated_units;
+  int daemon;
+  char *listen;
+  unsigned int host_cache_size;
   uint32_t specific_trap;
   int specific_trap_na_specified;
   int specific_trap_set;
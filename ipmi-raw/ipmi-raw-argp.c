@@ -67,6 +67,7 @@ static struct argp_option cmdline_options[] =
     ARGP_COMMON_OPTIONS_WORKAROUND_FLAGS,
     ARGP_COMMON_HOSTRANGED_OPTIONS,
     ARGP_COMMON_OPTIONS_DEBUG,
+    ARGP_COMMON_OPTIONS_PACKET_TRACE,
     /* legacy - overriden by general option in inband options  */
     { "channel-number", CHANNEL_NUMBER_KEY, "NUMBER", OPTION_HIDDEN,
       "Specify an alternate channel number to bridge raw commands to.", 40},
@@ -77,6 +78,10 @@ static struct argp_option cmdline_options[] =
       "Specify a file to read command requests from.", 42},
     { "no-session", NO_SESSION_KEY, NULL, 0,
       "Do not establish an IPMI session if doing out of band IPMI.", 43},
+    { "batch", BATCH_KEY, NULL, 0,
+      "Read all command requests first, then execute them concurrently.", 44},
+    { "batch-window", BATCH_WINDOW_KEY, "COUNT", 0,
+      "Specify the number of command requests executed concurrently in batch mode.", 45},
     { NULL, 0, NULL, 0, NULL, 0}
   };
 
@@ -98,6 +103,7 @@ cmdline_parse (int key, char *arg, struct argp_state *state)
   struct ipmi_raw_arguments *cmd_args;
   error_t ret;
   char *endptr;
+  long tmp;
 
   assert (state);
   
@@ -125,6 +131,22 @@ cmdline_parse (int key, char *arg, struct argp_state *state)
     case NO_SESSION_KEY:
       cmd_args->no_session = 1;
       break;
+    case BATCH_KEY:
+      cmd_args->batch = 1;
+      break;
+    case BATCH_WINDOW_KEY:
+      errno = 0;
+      tmp = strtol (arg, &endptr, 10);
+      if (errno
+          || endptr[0] != '\0'
+          || tmp <= 0
+          || tmp > IPMI_RAW_BATCH_WINDOW_MAX)
+        {
+          fprintf (stderr, "invalid batch window\n");
+          exit (EXIT_FAILURE);
+        }
+      cmd_args->batch_window = tmp;
+      break;
     case ARGP_KEY_ARG:
       {
         unsigned int i;
@@ -214,6 +236,8 @@ ipmi_raw_argp_parse (int argc, char **argv, struct ipmi_raw_arguments *cmd_args)
 
   cmd_args->cmd_file = NULL;
   cmd_args->no_session = 0;
+  cmd_args->batch = 0;
+  cmd_args->batch_window = IPMI_RAW_BATCH_WINDOW_DEFAULT;
   memset (cmd_args->cmd, '\0', sizeof (uint8_t) * IPMI_RAW_MAX_ARGS);
   cmd_args->cmd_length = 0;
 
@@ -234,4 +258,11 @@ ipmi_raw_argp_parse (int argc, char **argv, struct ipmi_raw_arguments *cmd_args)
               cmd_args);
 
   verify_common_cmd_args (&(cmd_args->common_args));
+
+  if (cmd_args->batch
+      && cmd_args->cmd_length)
+    {
+      fprintf (stderr, "cannot specify batch mode with command line hex bytes\n");
+      exit (EXIT_FAILURE);
+    }
 }
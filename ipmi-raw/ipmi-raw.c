@@ -28,8 +28,19 @@
 #if HAVE_UNISTD_H
 #include <unistd.h>
 #endif /* HAVE_UNISTD_H */
+#if TIME_WITH_SYS_TIME
+#include <sys/time.h>
+#include <time.h>
+#else  /* !TIME_WITH_SYS_TIME */
+#if HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else /* !HAVE_SYS_TIME_H */
+#include <time.h>
+#endif  /* !HAVE_SYS_TIME_H */
+#endif /* !TIME_WITH_SYS_TIME */
 #include <errno.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include <freeipmi/freeipmi.h>
 
@@ -43,6 +54,10 @@
 #include "tool-hostrange-common.h"
 #include "tool-util-common.h"
 
+#define IPMI_RAW_BATCH_BARRIER_STR "barrier"
+
+#define IPMI_RAW_BATCH_ERRMSG_LEN  1024
+
 static int
 ipmi_raw_cmdline (ipmi_raw_state_data_t *state_data)
 {
@@ -242,6 +257,31 @@ string2bytes (ipmi_raw_state_data_t *state_data,
   return (rv);
 }
 
+/* returns 1 if line is a batch barrier, 0 if not */
+static int
+_is_barrier (const char *line)
+{
+  const char delim[] = " \t\f\v\r\n";
+  const char *start;
+  unsigned int len;
+
+  assert (line);
+
+  start = line;
+  while (*start != '\0' && strchr (delim, *start))
+    start++;
+
+  len = strlen (IPMI_RAW_BATCH_BARRIER_STR);
+  if (strncasecmp (start, IPMI_RAW_BATCH_BARRIER_STR, len))
+    return (0);
+
+  start += len;
+  while (*start != '\0' && strchr (delim, *start))
+    start++;
+
+  return (*start == '\0' ? 1 : 0);
+}
+
 static int
 ipmi_raw_stream (ipmi_raw_state_data_t *state_data, FILE *stream)
 {
@@ -266,6 +306,10 @@ ipmi_raw_stream (ipmi_raw_state_data_t *state_data, FILE *stream)
           break;
         }
       line_count++;
+
+      /* barriers only matter in batch mode */
+      if (_is_barrier (line))
+        goto end_loop;
       
       /* On invalid inputs, we exit instead of goto end loop.
        *
@@ -344,6 +388,358 @@ ipmi_raw_stream (ipmi_raw_state_data_t *state_data, FILE *stream)
   return (rv);
 }
 
+struct ipmi_raw_batch_cmd
+{
+  unsigned int line_count;
+  int barrier;
+  uint8_t *bytes_rq;
+  unsigned int send_len;
+  uint8_t *bytes_rs;
+  int rs_len;
+  int error;
+  char errmsg[IPMI_RAW_BATCH_ERRMSG_LEN + 1];
+  unsigned long latency;        /* microseconds */
+};
+
+struct ipmi_raw_batch
+{
+  pthread_mutex_t mutex;
+  struct ipmi_raw_batch_cmd *cmds;
+  unsigned int next;
+  unsigned int end;
+};
+
+struct ipmi_raw_batch_worker
+{
+  struct ipmi_raw_batch *batch;
+  ipmi_ctx_t ipmi_ctx;
+  uint8_t *bytes_rs;
+  pthread_t thread;
+};
+
+static void
+_ipmi_raw_batch_execute (struct ipmi_raw_batch_worker *worker,
+                         struct ipmi_raw_batch_cmd *cmd)
+{
+  struct timeval start, end;
+
+  assert (worker);
+  assert (cmd);
+
+  /* invalid requests are reported in order, not executed */
+  if (cmd->error)
+    return;
+
+  gettimeofday (&start, NULL);
+
+  if ((cmd->rs_len = ipmi_cmd_raw (worker->ipmi_ctx,
+                                   cmd->bytes_rq[0],
+                                   cmd->bytes_rq[1],
+                                   &cmd->bytes_rq[2],
+                                   cmd->send_len - 2,
+                                   worker->bytes_rs,
+                                   IPMI_RAW_MAX_ARGS)) < 0)
+    {
+      snprintf (cmd->errmsg,
+                IPMI_RAW_BATCH_ERRMSG_LEN,
+                "ipmi_cmd_raw: %s",
+                ipmi_ctx_errormsg (worker->ipmi_ctx));
+      cmd->error = 1;
+      return;
+    }
+
+  gettimeofday (&end, NULL);
+
+  cmd->latency = (end.tv_sec - start.tv_sec) * 1000000 + end.tv_usec - start.tv_usec;
+
+  if (cmd->rs_len)
+    {
+      if (!(cmd->bytes_rs = malloc (cmd->rs_len)))
+        {
+          snprintf (cmd->errmsg,
+                    IPMI_RAW_BATCH_ERRMSG_LEN,
+                    "malloc: %s",
+                    strerror (errno));
+          cmd->error = 1;
+          return;
+        }
+      memcpy (cmd->bytes_rs, worker->bytes_rs, cmd->rs_len);
+    }
+}
+
+static void *
+_ipmi_raw_batch_worker (void *arg)
+{
+  struct ipmi_raw_batch_worker *worker;
+  struct ipmi_raw_batch *batch;
+
+  assert (arg);
+
+  worker = (struct ipmi_raw_batch_worker *)arg;
+  batch = worker->batch;
+
+  while (1)
+    {
+      unsigned int i;
+
+      pthread_mutex_lock (&batch->mutex);
+      if (batch->next >= batch->end)
+        {
+          pthread_mutex_unlock (&batch->mutex);
+          break;
+        }
+      i = batch->next++;
+      pthread_mutex_unlock (&batch->mutex);
+
+      _ipmi_raw_batch_execute (worker, &batch->cmds[i]);
+    }
+
+  return (NULL);
+}
+
+static void
+_ipmi_raw_batch_output (ipmi_raw_state_data_t *state_data,
+                        struct ipmi_raw_batch_cmd *cmd)
+{
+  int i;
+
+  assert (state_data);
+  assert (cmd);
+
+  if (cmd->error)
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "%s\n",
+                       cmd->errmsg);
+      return;
+    }
+
+  pstdout_printf (state_data->pstate, "rcvd: ");
+  for (i = 0; i < cmd->rs_len; i++)
+    pstdout_printf (state_data->pstate, "%02X ", cmd->bytes_rs[i]);
+  pstdout_printf (state_data->pstate,
+                  "(%lu.%03lu ms)\n",
+                  cmd->latency / 1000,
+                  cmd->latency % 1000);
+}
+
+/* Read all requests up front, then execute the requests between
+ * barriers concurrently, each worker using its own session.
+ * Responses are output in input order.
+ */
+static int
+ipmi_raw_batch (ipmi_raw_state_data_t *state_data, FILE *stream)
+{
+  struct ipmi_raw_arguments *args;
+  struct ipmi_raw_batch batch;
+  struct ipmi_raw_batch_worker *workers = NULL;
+  struct ipmi_raw_batch_cmd *cmds = NULL;
+  unsigned int cmds_count = 0;
+  unsigned int cmds_len = 0;
+  unsigned int workers_count = 0;
+  unsigned int segment_max = 0;
+  unsigned int segment = 0;
+  unsigned int start;
+  char *line = NULL;
+  unsigned int line_count = 0;
+  size_t n = 0;
+  int mutex_init = 0;
+  unsigned int i;
+  int rv = -1;
+
+  assert (state_data);
+  assert (stream);
+
+  args = state_data->prog_data->args;
+
+  while (1)
+    {
+      struct ipmi_raw_batch_cmd *cmd;
+
+      if (getline (&line, &n, stream) < 0)
+        break;
+      line_count++;
+
+      if (cmds_count == cmds_len)
+        {
+          struct ipmi_raw_batch_cmd *tmp;
+
+          cmds_len = cmds_len ? cmds_len * 2 : 64;
+          if (!(tmp = realloc (cmds, cmds_len * sizeof (struct ipmi_raw_batch_cmd))))
+            {
+              pstdout_perror (state_data->pstate, "realloc");
+              goto cleanup;
+            }
+          cmds = tmp;
+        }
+
+      cmd = &cmds[cmds_count];
+      memset (cmd, '\0', sizeof (struct ipmi_raw_batch_cmd));
+      cmd->line_count = line_count;
+
+      if (_is_barrier (line))
+        {
+          cmd->barrier = 1;
+          cmds_count++;
+          if (segment > segment_max)
+            segment_max = segment;
+          segment = 0;
+          continue;
+        }
+
+      /* As in ipmi_raw_stream(), invalid hex input fails the whole
+       * run.  Since all input is read first, nothing has been sent
+       * yet.
+       */
+      if (string2bytes (state_data, line, &cmd->bytes_rq, &cmd->send_len, line_count) < 0)
+        goto cleanup;
+
+      /* Check for empty line */
+      if (!cmd->send_len)
+        continue;
+
+      cmds_count++;
+      segment++;
+
+      if (cmd->send_len <= 2)
+        {
+          snprintf (cmd->errmsg,
+                    IPMI_RAW_BATCH_ERRMSG_LEN,
+                    "Invalid number of hex bytes on line %u",
+                    line_count);
+          cmd->error = 1;
+        }
+      else if (!IPMI_NET_FN_RQ_VALID (cmd->bytes_rq[1]))
+        {
+          snprintf (cmd->errmsg,
+                    IPMI_RAW_BATCH_ERRMSG_LEN,
+                    "Invalid netfn value on line %u",
+                    line_count);
+          cmd->error = 1;
+        }
+    }
+
+  if (segment > segment_max)
+    segment_max = segment;
+
+  if (!segment_max)
+    {
+      rv = 0;
+      goto cleanup;
+    }
+
+  /* No point in opening more sessions than can be used at once */
+  workers_count = args->batch_window < segment_max ? args->batch_window : segment_max;
+
+  if (!(workers = calloc (workers_count, sizeof (struct ipmi_raw_batch_worker))))
+    {
+      pstdout_perror (state_data->pstate, "calloc");
+      goto cleanup;
+    }
+
+  for (i = 0; i < workers_count; i++)
+    {
+      workers[i].batch = &batch;
+
+      if (!(workers[i].bytes_rs = calloc (IPMI_RAW_MAX_ARGS, sizeof (uint8_t))))
+        {
+          pstdout_perror (state_data->pstate, "calloc");
+          goto cleanup;
+        }
+
+      /* first worker uses the already open session */
+      if (!i)
+        {
+          workers[i].ipmi_ctx = state_data->ipmi_ctx;
+          continue;
+        }
+
+      if (!(workers[i].ipmi_ctx = ipmi_open (state_data->prog_data->progname,
+                                             state_data->hostname,
+                                             &(args->common_args),
+                                             state_data->pstate,
+                                             args->no_session ? IPMI_FLAGS_NOSESSION : 0)))
+        goto cleanup;
+    }
+
+  memset (&batch, '\0', sizeof (struct ipmi_raw_batch));
+  batch.cmds = cmds;
+
+  if ((errno = pthread_mutex_init (&batch.mutex, NULL)))
+    {
+      pstdout_perror (state_data->pstate, "pthread_mutex_init");
+      goto cleanup;
+    }
+  mutex_init++;
+
+  start = 0;
+  while (start < cmds_count)
+    {
+      unsigned int end = start;
+      unsigned int threads_count = 0;
+
+      while (end < cmds_count && !cmds[end].barrier)
+        end++;
+
+      batch.next = start;
+      batch.end = end;
+
+      for (i = 1; i < workers_count && i < (end - start); i++)
+        {
+          if ((errno = pthread_create (&workers[i].thread,
+                                       NULL,
+                                       _ipmi_raw_batch_worker,
+                                       &workers[i])))
+            {
+              pstdout_perror (state_data->pstate, "pthread_create");
+              break;
+            }
+          threads_count++;
+        }
+
+      /* This thread works too, and finishes the segment if no
+       * threads could be created.
+       */
+      _ipmi_raw_batch_worker (&workers[0]);
+
+      for (i = 1; i <= threads_count; i++)
+        pthread_join (workers[i].thread, NULL);
+
+      for (i = start; i < end; i++)
+        _ipmi_raw_batch_output (state_data, &cmds[i]);
+
+      /* skip barrier */
+      start = end + 1;
+    }
+
+  rv = 0;
+ cleanup:
+  if (mutex_init)
+    pthread_mutex_destroy (&batch.mutex);
+  if (workers)
+    {
+      for (i = 0; i < workers_count; i++)
+        {
+          if (i && workers[i].ipmi_ctx)
+            {
+              ipmi_ctx_close (workers[i].ipmi_ctx);
+              ipmi_ctx_destroy (workers[i].ipmi_ctx);
+            }
+          free (workers[i].bytes_rs);
+        }
+      free (workers);
+    }
+  for (i = 0; i < cmds_count; i++)
+    {
+      free (cmds[i].bytes_rq);
+      free (cmds[i].bytes_rs);
+    }
+  free (cmds);
+  free (line);
+  return (rv);
+}
+
 int
 run_cmd_args (ipmi_raw_state_data_t *state_data)
 {
@@ -373,8 +769,16 @@ run_cmd_args (ipmi_raw_state_data_t *state_data)
   else
     infile = stdin;
 
-  if (ipmi_raw_stream (state_data, infile) < 0)
-    goto cleanup;
+  if (args->batch)
+    {
+      if (ipmi_raw_batch (state_data, infile) < 0)
+        goto cleanup;
+    }
+  else
+    {
+      if (ipmi_raw_stream (state_data, infile) < 0)
+        goto cleanup;
+    }
 
   rv = 0;
  cleanup:
@@ -400,6 +804,7 @@ _ipmi_raw (pstdout_state_t pstate,
 
   state_data.prog_data = prog_data;
   state_data.pstate = pstate;
+  state_data.hostname = hostname;
 
   if (!(state_data.ipmi_ctx = ipmi_open (prog_data->progname,
                                          hostname,
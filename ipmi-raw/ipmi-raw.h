@@ -27,12 +27,17 @@
 /* IPMI 2.0 Payload is 2 bytes, so we'll assume that size * 2 for good measure */
 #define IPMI_RAW_MAX_ARGS (65536*2)
 
+#define IPMI_RAW_BATCH_WINDOW_DEFAULT 4
+#define IPMI_RAW_BATCH_WINDOW_MAX     64
+
 enum ipmi_raw_argp_option_keys
   {
     CHANNEL_NUMBER_KEY = 160,   /* legacy */
     SLAVE_ADDRESS_KEY = 161,    /* legacy */
     CMD_FILE_KEY = 162,
     NO_SESSION_KEY = 163,
+    BATCH_KEY = 164,
+    BATCH_WINDOW_KEY = 165,
   };
 
 struct ipmi_raw_arguments
@@ -40,6 +45,8 @@ struct ipmi_raw_arguments
   struct common_cmd_args common_args;
   char *cmd_file;
   int no_session;
+  int batch;
+  unsigned int batch_window;
   uint8_t cmd[IPMI_RAW_MAX_ARGS];
   unsigned int cmd_length;
 };
@@ -55,6 +62,7 @@ typedef struct ipmi_raw_state_data
   ipmi_raw_prog_data_t *prog_data;
   ipmi_ctx_t ipmi_ctx;
   pstdout_state_t pstate;
+  const char *hostname;
 } ipmi_raw_state_data_t;
 
 #endif /* IPMI_RAW_H */
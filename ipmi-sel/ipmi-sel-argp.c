@@ -52,6 +52,7 @@
 #include "freeipmi-portability.h"
 #include "tool-cmdline-common.h"
 #include "tool-config-file-common.h"
+#include "tool-output-common.h"
 
 const char *argp_program_version =
   "ipmi-sel - " PACKAGE_VERSION "\n"
@@ -84,6 +85,7 @@ static struct argp_option cmdline_options[] =
     ARGP_COMMON_TIME_OPTIONS,
     ARGP_COMMON_HOSTRANGED_OPTIONS,
     ARGP_COMMON_OPTIONS_DEBUG,
+    ARGP_COMMON_OPTIONS_PACKET_TRACE,
     { "verbose",    VERBOSE_KEY,    0, 0,
       "Increase verbosity in output.", 40},
     { "info",       INFO_KEY,       0, 0,
@@ -150,6 +152,12 @@ static struct argp_option cmdline_options[] =
       "Output non-abbreviated units (e.g. 'Amps' instead of 'A').", 68},
     { "legacy-output", LEGACY_OUTPUT_KEY, 0, 0,
       "Output in legacy format.", 69},
+    { "follow", FOLLOW_KEY, 0, 0,
+      "Continue to output new SEL records as they are added.", 70},
+    { "follow-interval", FOLLOW_INTERVAL_KEY, "SECONDS", 0,
+      "Specify the interval at which the SEL is polled for new records in follow mode.", 71},
+    { "output-format", OUTPUT_FORMAT_KEY, "FORMAT", 0,
+      "Specify the output format, text (default), json or binary.", 72},
     { NULL, 0, NULL, 0, NULL, 0}
   };
 
@@ -565,6 +573,30 @@ cmdline_parse (int key, char *arg, struct argp_state *state)
       cmd_args->tail = 1;
       cmd_args->tail_count = value;
       break;
+    case FOLLOW_KEY:
+      cmd_args->follow = 1;
+      break;
+    case FOLLOW_INTERVAL_KEY:
+      errno = 0;
+      value = strtol (arg, &endptr, 10);
+
+      if (errno
+          || endptr[0] != '\0'
+          || value <= 0)
+        {
+          fprintf (stderr, "invalid follow interval: %s\n", arg);
+          exit (EXIT_FAILURE);
+        }
+
+      cmd_args->follow_interval = value;
+      break;
+    case OUTPUT_FORMAT_KEY:
+      if ((cmd_args->output_format = tool_output_format_parse (arg)) < 0)
+        {
+          fprintf (stderr, "invalid output format: %s\n", arg);
+          exit (EXIT_FAILURE);
+        }
+      break;
     case CLEAR_KEY:
     case DELETE_ALL_KEY:        /* legacy */
       cmd_args->clear = 1;
@@ -746,6 +778,65 @@ _ipmi_sel_args_validate (struct ipmi_sel_arguments *cmd_args)
                               cmd_args->exclude_sensor_types_length) < 0)
         exit (EXIT_FAILURE);
     }
+
+  if (cmd_args->output_format != TOOL_OUTPUT_FORMAT_TEXT
+      && (cmd_args->legacy_output
+          || cmd_args->hex_dump))
+    {
+      fprintf (stderr, "output format cannot be used with legacy or hex-dump output\n");
+      exit (EXIT_FAILURE);
+    }
+
+  /* records are written straight to stdout, not through pstdout */
+  if (cmd_args->output_format != TOOL_OUTPUT_FORMAT_TEXT
+      && (cmd_args->common_args.buffer_output
+          || cmd_args->common_args.consolidate_output))
+    {
+      fprintf (stderr, "output format cannot buffer or consolidate hostrange output\n");
+      exit (EXIT_FAILURE);
+    }
+
+  if (cmd_args->follow)
+    {
+      unsigned int session_timeout;
+
+      if (cmd_args->info
+          || cmd_args->clear
+          || cmd_args->delete
+          || cmd_args->delete_range
+          || cmd_args->display
+          || cmd_args->display_range
+          || cmd_args->post_clear)
+        {
+          fprintf (stderr, "follow mode can only be used when displaying all or the tail of the SEL\n");
+          exit (EXIT_FAILURE);
+        }
+
+      /* Buffered and consolidated output would only be written when
+       * the follow loop exits, i.e. never.
+       */
+      if (cmd_args->common_args.buffer_output
+          || cmd_args->common_args.consolidate_output)
+        {
+          fprintf (stderr, "follow mode cannot buffer or consolidate hostrange output\n");
+          exit (EXIT_FAILURE);
+        }
+
+      /* The poll is the only traffic on the session, it must come
+       * often enough that the session never times out.
+       */
+      if (cmd_args->common_args.session_timeout)
+        session_timeout = cmd_args->common_args.session_timeout;
+      else
+        session_timeout = IPMI_SESSION_TIMEOUT_DEFAULT;
+
+      if (cmd_args->common_args.hostname
+          && cmd_args->follow_interval >= session_timeout / 1000)
+        {
+          fprintf (stderr, "follow interval must be shorter than the session timeout\n");
+          exit (EXIT_FAILURE);
+        }
+    }
 }
 
 void
@@ -800,6 +891,8 @@ ipmi_sel_argp_parse (int argc, char **argv, struct ipmi_sel_arguments *cmd_args)
 
   cmd_args->tail = 0;
   cmd_args->tail_count = 0;
+  cmd_args->follow = 0;
+  cmd_args->follow_interval = IPMI_SEL_FOLLOW_INTERVAL_DEFAULT;
   cmd_args->clear = 0;
   cmd_args->post_clear = 0;
   cmd_args->delete = 0;
@@ -826,6 +919,7 @@ ipmi_sel_argp_parse (int argc, char **argv, struct ipmi_sel_arguments *cmd_args)
   cmd_args->no_header_output = 0;
   cmd_args->non_abbreviated_units = 0;
   cmd_args->legacy_output = 0;
+  cmd_args->output_format = TOOL_OUTPUT_FORMAT_TEXT;
 
   argp_parse (&cmdline_config_file_argp,
               argc,
@@ -25,6 +25,9 @@
 #if STDC_HEADERS
 #include <string.h>
 #endif /* STDC_HEADERS */
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif /* HAVE_UNISTD_H */
 #if TIME_WITH_SYS_TIME
 #include <sys/time.h>
 #include <time.h>
@@ -1139,6 +1142,30 @@ _normal_output_oem_data (ipmi_sel_state_data_t *state_data,
   return (1);
 }
 
+static unsigned int
+_normal_output_string_flags (ipmi_sel_state_data_t *state_data)
+{
+  unsigned int flags;
+
+  assert (state_data);
+
+  flags = IPMI_SEL_STRING_FLAGS_IGNORE_UNAVAILABLE_FIELD;
+  if (state_data->prog_data->args->verbose_count >= 2)
+    flags |= IPMI_SEL_STRING_FLAGS_VERBOSE;
+  if (state_data->prog_data->args->entity_sensor_names)
+    flags |= IPMI_SEL_STRING_FLAGS_ENTITY_SENSOR_NAMES;
+  if (state_data->prog_data->args->non_abbreviated_units)
+    flags |= IPMI_SEL_STRING_FLAGS_NON_ABBREVIATED_UNITS;
+  if (state_data->prog_data->args->interpret_oem_data)
+    flags |= IPMI_SEL_STRING_FLAGS_INTERPRET_OEM_DATA;
+  if (state_data->prog_data->args->common_args.utc_to_localtime)
+    flags |= IPMI_SEL_STRING_FLAGS_UTC_TO_LOCALTIME;
+  if (state_data->prog_data->args->common_args.localtime_to_utc)
+    flags |= IPMI_SEL_STRING_FLAGS_LOCALTIME_TO_UTC;
+
+  return (flags);
+}
+
 static int
 _normal_output (ipmi_sel_state_data_t *state_data, uint8_t record_type)
 {
@@ -1228,21 +1255,9 @@ _normal_output (ipmi_sel_state_data_t *state_data, uint8_t record_type)
       state_data->output_headers++;
     }
 
-  flags = IPMI_SEL_STRING_FLAGS_IGNORE_UNAVAILABLE_FIELD;
-  flags |= IPMI_SEL_STRING_FLAGS_OUTPUT_NOT_AVAILABLE;
+  flags = IPMI_SEL_STRING_FLAGS_OUTPUT_NOT_AVAILABLE;
   flags |= IPMI_SEL_STRING_FLAGS_DATE_MONTH_STRING;
-  if (state_data->prog_data->args->verbose_count >= 2)
-    flags |= IPMI_SEL_STRING_FLAGS_VERBOSE;
-  if (state_data->prog_data->args->entity_sensor_names)
-    flags |= IPMI_SEL_STRING_FLAGS_ENTITY_SENSOR_NAMES;
-  if (state_data->prog_data->args->non_abbreviated_units)
-    flags |= IPMI_SEL_STRING_FLAGS_NON_ABBREVIATED_UNITS;
-  if (state_data->prog_data->args->interpret_oem_data)
-    flags |= IPMI_SEL_STRING_FLAGS_INTERPRET_OEM_DATA;
-  if (state_data->prog_data->args->common_args.utc_to_localtime)
-    flags |= IPMI_SEL_STRING_FLAGS_UTC_TO_LOCALTIME;
-  if (state_data->prog_data->args->common_args.localtime_to_utc)
-    flags |= IPMI_SEL_STRING_FLAGS_LOCALTIME_TO_UTC;
+  flags |= _normal_output_string_flags (state_data);
 
   /* IPMI Workaround
    *
@@ -1451,6 +1466,230 @@ _normal_output (ipmi_sel_state_data_t *state_data, uint8_t record_type)
   return (rv);
 }
 
+/* return 0 on success, -1 on error
+ *
+ * Unavailable fields and SEL strings that can't be read are output
+ * as null rather than "N/A".
+ */
+static int
+_machine_output_string (ipmi_sel_state_data_t *state_data,
+                        const char *name,
+                        const char *fmt,
+                        unsigned int flags)
+{
+  char outbuf[EVENT_OUTPUT_BUFLEN+1];
+  int outbuf_len;
+
+  assert (state_data);
+  assert (name);
+  assert (fmt);
+
+  memset (outbuf, '\0', EVENT_OUTPUT_BUFLEN+1);
+  if ((outbuf_len = ipmi_sel_parse_read_record_string (state_data->sel_ctx,
+                                                       fmt,
+                                                       NULL,
+                                                       0,
+                                                       outbuf,
+                                                       EVENT_OUTPUT_BUFLEN,
+                                                       flags)) < 0)
+    {
+      if (_sel_parse_err_handle (state_data, "ipmi_sel_parse_read_record_string") < 0)
+        return (-1);
+      outbuf_len = 0;
+    }
+
+  if (tool_output_record_add_string (&state_data->output_record,
+                                     name,
+                                     outbuf_len ? outbuf : NULL) < 0)
+    {
+      pstdout_perror (state_data->pstate, "tool_output_record");
+      return (-1);
+    }
+
+  return (0);
+}
+
+/* Machine readable output skips column widths and formatting, the
+ * record id, type and timestamp are output as the values read from
+ * the SEL record.
+ */
+static int
+_machine_output (ipmi_sel_state_data_t *state_data, uint8_t record_type)
+{
+  struct tool_output_record *record;
+  unsigned int flags;
+  int record_type_class;
+  uint16_t record_id;
+  uint32_t timestamp;
+
+  assert (state_data);
+  assert (state_data->prog_data->args->output_format != TOOL_OUTPUT_FORMAT_TEXT);
+
+  record = &(state_data->output_record);
+
+  flags = _normal_output_string_flags (state_data);
+
+  record_type_class = ipmi_sel_record_type_class (record_type);
+  if (record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_SYSTEM_EVENT_RECORD
+      && record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_TIMESTAMPED_OEM_RECORD
+      && record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_NON_TIMESTAMPED_OEM_RECORD)
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "Unknown SEL Record Type: %Xh\n",
+                       record_type);
+      return (0);
+    }
+
+  if (ipmi_sel_parse_read_record_id (state_data->sel_ctx,
+                                     NULL,
+                                     0,
+                                     &record_id) < 0)
+    {
+      if (_sel_parse_err_handle (state_data, "ipmi_sel_parse_read_record_id") < 0)
+        return (-1);
+      return (0);
+    }
+
+  if (tool_output_record_start (record, state_data->hostname) < 0)
+    goto record_error;
+
+  if (tool_output_record_add_unsigned (record, "record_id", record_id) < 0)
+    goto record_error;
+
+  if (tool_output_record_add_unsigned (record, "record_type", record_type) < 0)
+    goto record_error;
+
+  if (record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_NON_TIMESTAMPED_OEM_RECORD
+      && ipmi_sel_parse_read_timestamp (state_data->sel_ctx,
+                                        NULL,
+                                        0,
+                                        &timestamp) >= 0)
+    {
+      if (tool_output_record_add_unsigned (record, "timestamp", timestamp) < 0)
+        goto record_error;
+    }
+  else
+    {
+      if (tool_output_record_add_null (record, "timestamp") < 0)
+        goto record_error;
+    }
+
+  if (record_type_class == IPMI_SEL_RECORD_TYPE_CLASS_SYSTEM_EVENT_RECORD)
+    {
+      uint8_t sensor_number;
+
+      if (ipmi_sel_parse_read_sensor_number (state_data->sel_ctx,
+                                             NULL,
+                                             0,
+                                             &sensor_number) < 0)
+        {
+          if (_sel_parse_err_handle (state_data, "ipmi_sel_parse_read_sensor_number") < 0)
+            return (-1);
+          if (tool_output_record_add_null (record, "sensor_number") < 0)
+            goto record_error;
+        }
+      else
+        {
+          if (tool_output_record_add_unsigned (record, "sensor_number", sensor_number) < 0)
+            goto record_error;
+        }
+
+      if (_machine_output_string (state_data, "sensor_name", "%s", flags) < 0)
+        return (-1);
+
+      if (!state_data->prog_data->args->no_sensor_type_output)
+        {
+          if (_machine_output_string (state_data, "sensor_type", "%T", flags) < 0)
+            return (-1);
+        }
+    }
+
+  if (state_data->prog_data->args->output_event_state)
+    {
+      if (_machine_output_string (state_data, "event_state", "%I", flags) < 0)
+        return (-1);
+    }
+
+  if (record_type_class == IPMI_SEL_RECORD_TYPE_CLASS_SYSTEM_EVENT_RECORD)
+    {
+      if (state_data->prog_data->args->verbose_count >= 1)
+        {
+          if (_machine_output_string (state_data, "event_direction", "%k", flags) < 0)
+            return (-1);
+        }
+
+      /* fall back to the standard event string if there is no OEM one */
+      if (state_data->prog_data->args->output_oem_event_strings)
+        {
+          char outbuf[EVENT_OUTPUT_BUFLEN+1];
+          int ret;
+
+          memset (outbuf, '\0', EVENT_OUTPUT_BUFLEN+1);
+          if ((ret = _output_oem_event_strings (state_data,
+                                                outbuf,
+                                                EVENT_OUTPUT_BUFLEN,
+                                                flags)) < 0)
+            return (-1);
+
+          if (ret)
+            {
+              if (tool_output_record_add_string (record, "event", outbuf) < 0)
+                goto record_error;
+            }
+          else
+            {
+              if (_machine_output_string (state_data, "event", "%E", flags) < 0)
+                return (-1);
+            }
+        }
+      else
+        {
+          if (_machine_output_string (state_data, "event", "%E", flags) < 0)
+            return (-1);
+        }
+    }
+  else
+    {
+      if (state_data->prog_data->args->output_manufacturer_id
+          && record_type_class == IPMI_SEL_RECORD_TYPE_CLASS_TIMESTAMPED_OEM_RECORD)
+        {
+          uint32_t manufacturer_id;
+
+          if (ipmi_sel_parse_read_manufacturer_id (state_data->sel_ctx,
+                                                   NULL,
+                                                   0,
+                                                   &manufacturer_id) < 0)
+            {
+              if (_sel_parse_err_handle (state_data, "ipmi_sel_parse_read_manufacturer_id") < 0)
+                return (-1);
+              if (tool_output_record_add_null (record, "manufacturer_id") < 0)
+                goto record_error;
+            }
+          else
+            {
+              if (tool_output_record_add_unsigned (record, "manufacturer_id", manufacturer_id) < 0)
+                goto record_error;
+            }
+        }
+
+      if (_machine_output_string (state_data, "oem_data", "%o", flags) < 0)
+        return (-1);
+    }
+
+  if (tool_output_record_write (record, stdout) < 0)
+    {
+      pstdout_perror (state_data->pstate, "fwrite");
+      return (-1);
+    }
+
+  return (0);
+
+ record_error:
+  pstdout_perror (state_data->pstate, "tool_output_record");
+  return (-1);
+}
+
 static int
 _sel_parse_callback (ipmi_sel_ctx_t ctx, void *callback_data)
 {
@@ -1464,6 +1703,33 @@ _sel_parse_callback (ipmi_sel_ctx_t ctx, void *callback_data)
 
   state_data = (ipmi_sel_state_data_t *)callback_data;
 
+  if (state_data->prog_data->args->follow)
+    {
+      uint16_t record_id;
+
+      if (ipmi_sel_parse_read_record_id (state_data->sel_ctx,
+                                         NULL,
+                                         0,
+                                         &record_id) < 0)
+        {
+          if (_sel_parse_err_handle (state_data, "ipmi_sel_parse_read_record_id") < 0)
+            goto cleanup;
+          goto out;
+        }
+
+      /* A follow-up parse starts at the last record already output */
+      if (state_data->follow_skip_record_id)
+        {
+          state_data->follow_skip_record_id = 0;
+          if (state_data->follow_record_id_loaded
+              && record_id == state_data->follow_record_id)
+            goto out;
+        }
+
+      state_data->follow_record_id = record_id;
+      state_data->follow_record_id_loaded = 1;
+    }
+
   if (state_data->prog_data->args->exclude_display
       || state_data->prog_data->args->exclude_display_range)
     {
@@ -1625,6 +1891,11 @@ _sel_parse_callback (ipmi_sel_ctx_t ctx, void *callback_data)
           if (_legacy_normal_output (state_data, record_type) < 0)
             goto cleanup;
         }
+      else if (state_data->prog_data->args->output_format != TOOL_OUTPUT_FORMAT_TEXT)
+        {
+          if (_machine_output (state_data, record_type) < 0)
+            goto cleanup;
+        }
       else
         {
           if (_normal_output (state_data, record_type) < 0)
@@ -1732,11 +2003,192 @@ _sel_record_id_last_callback (ipmi_sel_ctx_t ctx, void *callback_data)
   return (rv);
 }
 
+static int
+_get_sel_info_timestamps (ipmi_sel_state_data_t *state_data,
+                          uint16_t *entries,
+                          uint32_t *most_recent_addition_timestamp,
+                          uint32_t *most_recent_erase_timestamp)
+{
+  fiid_obj_t obj_cmd_rs = NULL;
+  uint64_t val;
+  int rv = -1;
+
+  assert (state_data);
+  assert (entries);
+  assert (most_recent_addition_timestamp);
+  assert (most_recent_erase_timestamp);
+
+  if (!(obj_cmd_rs = fiid_obj_create (tmpl_cmd_get_sel_info_rs)))
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "fiid_obj_create: %s\n",
+                       strerror (errno));
+      goto cleanup;
+    }
+
+  if (ipmi_cmd_get_sel_info (state_data->ipmi_ctx, obj_cmd_rs) < 0)
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "ipmi_cmd_get_sel_info: %s\n",
+                       ipmi_ctx_errormsg (state_data->ipmi_ctx));
+      goto cleanup;
+    }
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "entries", &val) < 0)
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "fiid_obj_get: 'entries': %s\n",
+                       fiid_obj_errormsg (obj_cmd_rs));
+      goto cleanup;
+    }
+  (*entries) = val;
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "most_recent_addition_timestamp", &val) < 0)
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "fiid_obj_get: 'most_recent_addition_timestamp': %s\n",
+                       fiid_obj_errormsg (obj_cmd_rs));
+      goto cleanup;
+    }
+  (*most_recent_addition_timestamp) = val;
+
+  if (FIID_OBJ_GET (obj_cmd_rs, "most_recent_erase_timestamp", &val) < 0)
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "fiid_obj_get: 'most_recent_erase_timestamp': %s\n",
+                       fiid_obj_errormsg (obj_cmd_rs));
+      goto cleanup;
+    }
+  (*most_recent_erase_timestamp) = val;
+
+  rv = 0;
+ cleanup:
+  fiid_obj_destroy (obj_cmd_rs);
+  return (rv);
+}
+
+/* Poll the SEL info until the program is killed, outputting only the
+ * records added since the last one output.  Get SEL Info is a single
+ * small command, so nothing else is sent to the BMC until the
+ * addition or erase timestamps change.
+ */
+static int
+_follow_sel_records (ipmi_sel_state_data_t *state_data,
+                     uint32_t most_recent_addition_timestamp,
+                     uint32_t most_recent_erase_timestamp)
+{
+  assert (state_data);
+  assert (state_data->prog_data->args->follow);
+
+  while (1)
+    {
+      uint16_t entries;
+      uint32_t addition_timestamp;
+      uint32_t erase_timestamp;
+      uint16_t record_id_start;
+
+      sleep (state_data->prog_data->args->follow_interval);
+
+      if (_get_sel_info_timestamps (state_data,
+                                    &entries,
+                                    &addition_timestamp,
+                                    &erase_timestamp) < 0)
+        {
+          /* A busy BMC is ok, it happens, try again next interval */
+          if (ipmi_ctx_errnum (state_data->ipmi_ctx) == IPMI_ERR_BMC_BUSY
+              || ipmi_ctx_errnum (state_data->ipmi_ctx) == IPMI_ERR_DRIVER_BUSY
+              || ipmi_ctx_errnum (state_data->ipmi_ctx) == IPMI_ERR_MESSAGE_TIMEOUT)
+            continue;
+          return (-1);
+        }
+
+      /* most common case, nothing has changed */
+      if (addition_timestamp == most_recent_addition_timestamp
+          && erase_timestamp == most_recent_erase_timestamp)
+        continue;
+
+      if (erase_timestamp != most_recent_erase_timestamp)
+        {
+          /* Some records were deleted or the SEL was cleared.  Like
+           * ipmiseld, use the last record id to guess which.  If it
+           * is beyond the last record output, assume old records were
+           * deleted and continue from where we left off.  Otherwise
+           * assume a clear and start over from the beginning.
+           */
+          if (!entries)
+            state_data->follow_record_id_loaded = 0;
+          else if (state_data->follow_record_id_loaded)
+            {
+              state_data->last_record_id = 0;
+
+              if (ipmi_sel_parse (state_data->sel_ctx,
+                                  IPMI_SEL_RECORD_ID_LAST,
+                                  IPMI_SEL_RECORD_ID_LAST,
+                                  _sel_record_id_last_callback,
+                                  state_data) < 0)
+                {
+                  pstdout_fprintf (state_data->pstate,
+                                   stderr,
+                                   "ipmi_sel_parse: %s\n",
+                                   ipmi_sel_ctx_errormsg (state_data->sel_ctx));
+                  return (-1);
+                }
+
+              if (state_data->last_record_id < state_data->follow_record_id)
+                state_data->follow_record_id_loaded = 0;
+            }
+        }
+
+      most_recent_addition_timestamp = addition_timestamp;
+      most_recent_erase_timestamp = erase_timestamp;
+
+      if (!entries)
+        continue;
+
+      if (state_data->follow_record_id_loaded)
+        {
+          record_id_start = state_data->follow_record_id;
+          state_data->follow_skip_record_id = 1;
+        }
+      else
+        record_id_start = IPMI_SEL_RECORD_ID_FIRST;
+
+      if (ipmi_sel_parse (state_data->sel_ctx,
+                          record_id_start,
+                          IPMI_SEL_RECORD_ID_LAST,
+                          _sel_parse_callback,
+                          state_data) < 0)
+        {
+          pstdout_fprintf (state_data->pstate,
+                           stderr,
+                           "ipmi_sel_parse: %s\n",
+                           ipmi_sel_ctx_errormsg (state_data->sel_ctx));
+          return (-1);
+        }
+
+      state_data->follow_skip_record_id = 0;
+
+      /* machine readable records bypass pstdout's line flushing */
+      if (state_data->prog_data->args->output_format != TOOL_OUTPUT_FORMAT_TEXT)
+        fflush (stdout);
+    }
+
+  /* NOT REACHED */
+  return (0);
+}
+
 static int
 _display_sel_records (ipmi_sel_state_data_t *state_data)
 {
   struct ipmi_sel_arguments *args;
   fiid_obj_t obj_cmd_rs = NULL;
+  uint32_t most_recent_addition_timestamp = 0;
+  uint32_t most_recent_erase_timestamp = 0;
   int rv = -1;
   uint64_t val;
 
@@ -1768,7 +2220,9 @@ _display_sel_records (ipmi_sel_state_data_t *state_data)
         }
     }
 
-  if (!args->legacy_output)
+  /* machine readable output has no columns */
+  if (!args->legacy_output
+      && args->output_format == TOOL_OUTPUT_FORMAT_TEXT)
     {
       if (!args->common_args.ignore_sdr_cache)
         {
@@ -1957,6 +2411,20 @@ _display_sel_records (ipmi_sel_state_data_t *state_data)
         }
     }
 
+  /* Get the baseline before outputting anything, records added in
+   * between are output now and skipped by the first follow parse.
+   */
+  if (args->follow)
+    {
+      uint16_t entries;
+
+      if (_get_sel_info_timestamps (state_data,
+                                    &entries,
+                                    &most_recent_addition_timestamp,
+                                    &most_recent_erase_timestamp) < 0)
+        goto cleanup;
+    }
+
   if (state_data->prog_data->args->display)
     {
       if (ipmi_sel_parse_record_ids (state_data->sel_ctx,
@@ -2132,6 +2600,13 @@ _display_sel_records (ipmi_sel_state_data_t *state_data)
     }
 
  out:
+  if (args->follow)
+    {
+      if (_follow_sel_records (state_data,
+                               most_recent_addition_timestamp,
+                               most_recent_erase_timestamp) < 0)
+        goto cleanup;
+    }
   rv = 0;
  cleanup:
   fiid_obj_destroy (obj_cmd_rs);
@@ -2200,6 +2675,10 @@ _ipmi_sel (pstdout_state_t pstate,
   state_data.pstate = pstate;
   state_data.hostname = (char *)hostname;
 
+  if (prog_data->args->output_format != TOOL_OUTPUT_FORMAT_TEXT)
+    tool_output_record_init (&state_data.output_record,
+                             prog_data->args->output_format);
+
   if (!(state_data.ipmi_ctx = ipmi_open (prog_data->progname,
                                          hostname,
                                          &(prog_data->args->common_args),
@@ -2327,6 +2806,7 @@ _ipmi_sel (pstdout_state_t pstate,
 
   exit_code = EXIT_SUCCESS;
  cleanup:
+  tool_output_record_cleanup (&state_data.output_record);
   ipmi_sdr_ctx_destroy (state_data.sdr_ctx);
   ipmi_sel_ctx_destroy (state_data.sel_ctx);
   ipmi_ctx_close (state_data.ipmi_ctx);
@@ -32,11 +32,14 @@
 
 #include "tool-cmdline-common.h"
 #include "tool-oem-common.h"
+#include "tool-output-common.h"
 #include "tool-sensor-common.h"
 #include "pstdout.h"
 
 #define IPMI_SEL_MAX_RECORD 4096
 
+#define IPMI_SEL_FOLLOW_INTERVAL_DEFAULT 5
+
 enum ipmi_sel_argp_option_keys
   {
     VERBOSE_KEY = 'v',
@@ -71,6 +74,9 @@ enum ipmi_sel_argp_option_keys
     NO_HEADER_OUTPUT_KEY = 184,
     NON_ABBREVIATED_UNITS_KEY = 185,
     LEGACY_OUTPUT_KEY = 186,
+    FOLLOW_KEY = 187,
+    FOLLOW_INTERVAL_KEY = 188,
+    OUTPUT_FORMAT_KEY = 189,
   };
 
 struct ipmi_sel_arguments
@@ -103,6 +109,8 @@ struct ipmi_sel_arguments
   int list_sensor_types;
   int tail;
   uint16_t tail_count;
+  int follow;
+  unsigned int follow_interval;
   int clear;
   int post_clear;
   int delete;
@@ -126,6 +134,7 @@ struct ipmi_sel_arguments
   int no_header_output;
   int non_abbreviated_units;
   int legacy_output;
+  int output_format;
 };
 
 typedef struct ipmi_sel_prog_data
@@ -145,10 +154,15 @@ typedef struct ipmi_sel_state_data
   ipmi_interpret_ctx_t interpret_ctx;
   int output_headers;
   struct sensor_column_width column_width;
+  struct tool_output_record output_record;
   struct ipmi_oem_data oem_data;
   /* for tail usage */
   uint16_t first_record_id;
   uint16_t last_record_id;
+  /* for follow usage */
+  int follow_record_id_loaded;
+  uint16_t follow_record_id;
+  int follow_skip_record_id;
 } ipmi_sel_state_data_t;
 
 #endif /* IPMI_SEL__H */
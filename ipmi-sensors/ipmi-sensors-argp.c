@@ -42,6 +42,7 @@
 #include "freeipmi-portability.h"
 #include "tool-cmdline-common.h"
 #include "tool-config-file-common.h"
+#include "tool-output-common.h"
 #include "tool-sensor-common.h"
 
 const char *argp_program_version =
@@ -74,6 +75,7 @@ static struct argp_option cmdline_options[] =
     ARGP_COMMON_TIME_OPTIONS,
     ARGP_COMMON_HOSTRANGED_OPTIONS,
     ARGP_COMMON_OPTIONS_DEBUG,
+    ARGP_COMMON_OPTIONS_PACKET_TRACE,
     { "verbose",        VERBOSE_KEY,        0, 0,
       "Increase verbosity in output.  May be specified multiple times.", 40},
     { "sdr-info",       SDR_INFO_KEY,       0, 0,
@@ -144,6 +146,8 @@ static struct argp_option cmdline_options[] =
     /* ipmimonitoring legacy support */
     { "ipmimonitoring-legacy-output", IPMIMONITORING_LEGACY_OUTPUT_KEY, 0, 0,
       "Output in ipmimonitoring legacy format.", 70},
+    { "output-format", OUTPUT_FORMAT_KEY, "FORMAT", 0,
+      "Specify the output format, text (default), json or binary.", 71},
     { NULL, 0, NULL, 0, NULL, 0}
   };
 
@@ -319,6 +323,13 @@ cmdline_parse (int key, char *arg, struct argp_state *state)
     case IPMIMONITORING_LEGACY_OUTPUT_KEY:
       cmd_args->ipmimonitoring_legacy_output = 1;
       break;
+    case OUTPUT_FORMAT_KEY:
+      if ((cmd_args->output_format = tool_output_format_parse (arg)) < 0)
+        {
+          fprintf (stderr, "invalid output format: %s\n", arg);
+          exit (EXIT_FAILURE);
+        }
+      break;
     case ARGP_KEY_ARG:
       /* Too many arguments. */
       argp_usage (state);
@@ -456,6 +467,24 @@ _ipmi_sensors_args_validate (struct ipmi_sensors_arguments *cmd_args)
                               cmd_args->exclude_sensor_types_length) < 0)
         exit (EXIT_FAILURE);
     }
+
+  if (cmd_args->output_format != TOOL_OUTPUT_FORMAT_TEXT
+      && (cmd_args->verbose_count
+          || cmd_args->legacy_output
+          || cmd_args->ipmimonitoring_legacy_output))
+    {
+      fprintf (stderr, "output format cannot be used with verbose or legacy output\n");
+      exit (EXIT_FAILURE);
+    }
+
+  /* records are written straight to stdout, not through pstdout */
+  if (cmd_args->output_format != TOOL_OUTPUT_FORMAT_TEXT
+      && (cmd_args->common_args.buffer_output
+          || cmd_args->common_args.consolidate_output))
+    {
+      fprintf (stderr, "output format cannot buffer or consolidate hostrange output\n");
+      exit (EXIT_FAILURE);
+    }
 }
 
 void
@@ -513,6 +542,7 @@ ipmi_sensors_argp_parse (int argc, char **argv, struct ipmi_sensors_arguments *c
   cmd_args->non_abbreviated_units = 0;
   cmd_args->legacy_output = 0;
   cmd_args->ipmimonitoring_legacy_output = 0;
+  cmd_args->output_format = TOOL_OUTPUT_FORMAT_TEXT;
 
   argp_parse (&cmdline_config_file_argp,
               argc,
@@ -46,7 +46,8 @@ ipmi_sensors_simple_output_setup (ipmi_sensors_state_data_t *state_data)
   assert (state_data);
   
   if (!state_data->prog_data->args->legacy_output
-      && !state_data->prog_data->args->comma_separated_output)
+      && !state_data->prog_data->args->comma_separated_output
+      && state_data->prog_data->args->output_format == TOOL_OUTPUT_FORMAT_TEXT)
     {
       if (calculate_column_widths (state_data->pstate,
                                    state_data->sdr_ctx,
@@ -523,23 +524,17 @@ _ipmimonitoring_legacy_simple_output_compact_record (ipmi_sensors_state_data_t *
 }
 
 static int
-_simple_output_header (ipmi_sensors_state_data_t *state_data,
-                       uint16_t record_id,
-                       uint8_t sensor_number,
-                       int event_message_output_type,
-                       uint16_t sensor_event_bitmask)
+_simple_output_sensor_name (ipmi_sensors_state_data_t *state_data,
+                            uint8_t sensor_number,
+                            char *sensor_name)
 {
-  char fmt[IPMI_SENSORS_FMT_BUFLEN + 1];
-  char sensor_name[IPMI_SDR_MAX_SENSOR_NAME_LENGTH + 1];
   unsigned int sensor_name_flags = 0;
-  const char *sensor_type_string;
-  uint8_t event_reading_type_code;
 
   assert (state_data);
-  assert (IPMI_SENSORS_EVENT_VALID (event_message_output_type));
+  assert (sensor_name);
 
   memset (sensor_name, '\0', IPMI_SDR_MAX_SENSOR_NAME_LENGTH + 1);
-      
+
   if (!state_data->prog_data->args->shared_sensors)
     sensor_name_flags |= IPMI_SDR_SENSOR_NAME_FLAGS_IGNORE_SHARED_SENSORS;
 
@@ -578,6 +573,49 @@ _simple_output_header (ipmi_sensors_state_data_t *state_data,
         }
     }
   
+  return (0);
+}
+
+static const char *
+_simple_output_sensor_type_string (ipmi_sensors_state_data_t *state_data,
+                                   uint8_t sensor_type)
+{
+  uint8_t event_reading_type_code;
+
+  assert (state_data);
+
+  if ((state_data->prog_data->args->interpret_oem_data)
+      && (ipmi_sdr_parse_event_reading_type_code (state_data->sdr_ctx,
+                                                  NULL,
+                                                  0,
+                                                  &event_reading_type_code) >= 0))
+    return (get_oem_sensor_type_output_string (sensor_type,
+                                               event_reading_type_code,
+                                               state_data->oem_data.manufacturer_id,
+                                               state_data->oem_data.product_id));
+
+  return (get_sensor_type_output_string (sensor_type));
+}
+
+static int
+_simple_output_header (ipmi_sensors_state_data_t *state_data,
+                       uint16_t record_id,
+                       uint8_t sensor_number,
+                       int event_message_output_type,
+                       uint16_t sensor_event_bitmask)
+{
+  char fmt[IPMI_SENSORS_FMT_BUFLEN + 1];
+  char sensor_name[IPMI_SDR_MAX_SENSOR_NAME_LENGTH + 1];
+  const char *sensor_type_string;
+
+  assert (state_data);
+  assert (IPMI_SENSORS_EVENT_VALID (event_message_output_type));
+
+  if (_simple_output_sensor_name (state_data,
+                                  sensor_number,
+                                  sensor_name) < 0)
+    return (-1);
+  
   memset (fmt, '\0', IPMI_SENSORS_FMT_BUFLEN + 1);
   if (state_data->prog_data->args->no_sensor_type_output)
     {
@@ -625,17 +663,8 @@ _simple_output_header (ipmi_sensors_state_data_t *state_data,
                   state_data->column_width.sensor_name,
                   state_data->column_width.sensor_type);
       
-      if ((state_data->prog_data->args->interpret_oem_data)
-          && (ipmi_sdr_parse_event_reading_type_code (state_data->sdr_ctx,
-                                                      NULL,
-                                                      0,
-                                                      &event_reading_type_code) >= 0))
-        sensor_type_string = get_oem_sensor_type_output_string (sensor_type,
-                                                                event_reading_type_code,
-                                                                state_data->oem_data.manufacturer_id,
-                                                                state_data->oem_data.product_id);
-      else 
-        sensor_type_string = get_sensor_type_output_string (sensor_type);
+      sensor_type_string = _simple_output_sensor_type_string (state_data,
+                                                              sensor_type);
       
       pstdout_printf (state_data->pstate,
                       fmt,
@@ -1059,6 +1088,215 @@ _simple_output_compact_record (ipmi_sensors_state_data_t *state_data,
   return (0);
 }
 
+/* Machine readable output skips column widths and formatting, the
+ * reading and thresholds are output as the decoded doubles.
+ */
+static int
+_machine_output_record (ipmi_sensors_state_data_t *state_data,
+                        uint16_t record_id,
+                        uint8_t record_type,
+                        uint8_t sensor_number,
+                        double *sensor_reading,
+                        int event_message_output_type,
+                        uint16_t sensor_event_bitmask,
+                        char **event_message_list,
+                        unsigned int event_message_list_len)
+{
+  struct tool_output_record *record;
+  char sensor_name[IPMI_SDR_MAX_SENSOR_NAME_LENGTH + 1];
+  uint8_t event_reading_type_code;
+  int threshold_sensor = 0;
+  double *lower_non_critical_threshold = NULL;
+  double *upper_non_critical_threshold = NULL;
+  double *lower_critical_threshold = NULL;
+  double *upper_critical_threshold = NULL;
+  double *lower_non_recoverable_threshold = NULL;
+  double *upper_non_recoverable_threshold = NULL;
+  int rv = -1;
+
+  assert (state_data);
+  assert (state_data->prog_data->args->output_format != TOOL_OUTPUT_FORMAT_TEXT);
+  assert (record_type == IPMI_SDR_FORMAT_FULL_SENSOR_RECORD
+          || record_type == IPMI_SDR_FORMAT_COMPACT_SENSOR_RECORD);
+  assert (IPMI_SENSORS_EVENT_VALID (event_message_output_type));
+
+  record = &(state_data->output_record);
+
+  if (_simple_output_sensor_name (state_data,
+                                  sensor_number,
+                                  sensor_name) < 0)
+    goto cleanup;
+
+  if (ipmi_sdr_parse_event_reading_type_code (state_data->sdr_ctx,
+                                              NULL,
+                                              0,
+                                              &event_reading_type_code) < 0)
+    {
+      pstdout_fprintf (state_data->pstate,
+                       stderr,
+                       "ipmi_sdr_parse_event_reading_type_code: %s\n",
+                       ipmi_sdr_ctx_errormsg (state_data->sdr_ctx));
+      goto cleanup;
+    }
+
+  /* readings and thresholds are only available on full records */
+  if (record_type == IPMI_SDR_FORMAT_FULL_SENSOR_RECORD
+      && ipmi_event_reading_type_code_class (event_reading_type_code) == IPMI_EVENT_READING_TYPE_CODE_CLASS_THRESHOLD)
+    threshold_sensor++;
+
+  if (tool_output_record_start (record, state_data->hostname) < 0)
+    goto record_error;
+
+  if (tool_output_record_add_unsigned (record, "record_id", record_id) < 0)
+    goto record_error;
+
+  if (tool_output_record_add_unsigned (record, "sensor_number", sensor_number) < 0)
+    goto record_error;
+
+  if (tool_output_record_add_string (record, "sensor_name", sensor_name) < 0)
+    goto record_error;
+
+  if (!state_data->prog_data->args->no_sensor_type_output)
+    {
+      uint8_t sensor_type;
+
+      if (ipmi_sdr_parse_sensor_type (state_data->sdr_ctx,
+                                      NULL,
+                                      0,
+                                      &sensor_type) < 0)
+        {
+          pstdout_fprintf (state_data->pstate,
+                           stderr,
+                           "ipmi_sdr_parse_sensor_type: %s\n",
+                           ipmi_sdr_ctx_errormsg (state_data->sdr_ctx));
+          goto cleanup;
+        }
+
+      if (tool_output_record_add_string (record,
+                                         "sensor_type",
+                                         _simple_output_sensor_type_string (state_data,
+                                                                            sensor_type)) < 0)
+        goto record_error;
+    }
+
+  if (state_data->prog_data->args->output_sensor_state)
+    {
+      char *sensor_state_str = NULL;
+
+      if (ipmi_sensors_get_sensor_state (state_data,
+                                         event_message_output_type,
+                                         sensor_event_bitmask,
+                                         &sensor_state_str) < 0)
+        goto cleanup;
+
+      if (tool_output_record_add_string (record, "sensor_state", sensor_state_str) < 0)
+        goto record_error;
+    }
+
+  if (!state_data->prog_data->args->quiet_readings)
+    {
+      if (record_type == IPMI_SDR_FORMAT_FULL_SENSOR_RECORD
+          && sensor_reading
+          && (threshold_sensor
+              || state_data->prog_data->args->common_args.section_specific_workaround_flags & IPMI_PARSE_SECTION_SPECIFIC_WORKAROUND_FLAGS_DISCRETE_READING))
+        {
+          char sensor_units_buf[IPMI_SENSORS_UNITS_BUFLEN+1];
+
+          memset (sensor_units_buf, '\0', IPMI_SENSORS_UNITS_BUFLEN+1);
+          if (get_sensor_units_output_string (state_data->pstate,
+                                              state_data->sdr_ctx,
+                                              sensor_units_buf,
+                                              IPMI_SENSORS_UNITS_BUFLEN,
+                                              state_data->prog_data->args->non_abbreviated_units) < 0)
+            goto cleanup;
+
+          if (tool_output_record_add_double (record, "reading", sensor_reading) < 0)
+            goto record_error;
+
+          if (tool_output_record_add_string (record, "units", sensor_units_buf) < 0)
+            goto record_error;
+        }
+      else
+        {
+          if (tool_output_record_add_null (record, "reading") < 0)
+            goto record_error;
+
+          if (tool_output_record_add_null (record, "units") < 0)
+            goto record_error;
+        }
+    }
+
+  if (state_data->prog_data->args->output_sensor_thresholds)
+    {
+      if (threshold_sensor)
+        {
+          if (ipmi_sensors_get_thresholds (state_data,
+                                           &lower_non_critical_threshold,
+                                           &lower_critical_threshold,
+                                           &lower_non_recoverable_threshold,
+                                           &upper_non_critical_threshold,
+                                           &upper_critical_threshold,
+                                           &upper_non_recoverable_threshold) < 0)
+            goto cleanup;
+        }
+
+      if (tool_output_record_add_double (record, "lower_non_recoverable", lower_non_recoverable_threshold) < 0
+          || tool_output_record_add_double (record, "lower_critical", lower_critical_threshold) < 0
+          || tool_output_record_add_double (record, "lower_non_critical", lower_non_critical_threshold) < 0
+          || tool_output_record_add_double (record, "upper_non_critical", upper_non_critical_threshold) < 0
+          || tool_output_record_add_double (record, "upper_critical", upper_critical_threshold) < 0
+          || tool_output_record_add_double (record, "upper_non_recoverable", upper_non_recoverable_threshold) < 0)
+        goto record_error;
+    }
+
+  if (event_message_output_type == IPMI_SENSORS_EVENT_NORMAL
+      && state_data->prog_data->args->output_event_bitmask)
+    {
+      if (tool_output_record_add_unsigned (record, "event_bitmask", sensor_event_bitmask) < 0)
+        goto record_error;
+    }
+  else if (event_message_output_type == IPMI_SENSORS_EVENT_NORMAL)
+    {
+      if (tool_output_record_add_string_list (record,
+                                              "event",
+                                              event_message_list,
+                                              event_message_list_len) < 0)
+        goto record_error;
+    }
+  else if (event_message_output_type == IPMI_SENSORS_EVENT_UNKNOWN)
+    {
+      char *unknown_list[] = { "Unknown" };
+
+      if (tool_output_record_add_string_list (record, "event", unknown_list, 1) < 0)
+        goto record_error;
+    }
+  else
+    {
+      if (tool_output_record_add_null (record, "event") < 0)
+        goto record_error;
+    }
+
+  if (tool_output_record_write (record, stdout) < 0)
+    {
+      pstdout_perror (state_data->pstate, "fwrite");
+      goto cleanup;
+    }
+
+  rv = 0;
+  goto cleanup;
+
+ record_error:
+  pstdout_perror (state_data->pstate, "tool_output_record");
+ cleanup:
+  free (lower_non_critical_threshold);
+  free (upper_non_critical_threshold);
+  free (lower_critical_threshold);
+  free (upper_critical_threshold);
+  free (lower_non_recoverable_threshold);
+  free (upper_non_recoverable_threshold);
+  return (rv);
+}
+
 static void
 _output_headers (ipmi_sensors_state_data_t *state_data)
 {
@@ -1219,6 +1457,24 @@ ipmi_sensors_simple_output (ipmi_sensors_state_data_t *state_data,
       return (-1);
     }
 
+  if (state_data->prog_data->args->output_format != TOOL_OUTPUT_FORMAT_TEXT)
+    {
+      /* don't output any other types in simple mode */
+      if (record_type != IPMI_SDR_FORMAT_FULL_SENSOR_RECORD
+          && record_type != IPMI_SDR_FORMAT_COMPACT_SENSOR_RECORD)
+        return (0);
+
+      return (_machine_output_record (state_data,
+                                      record_id,
+                                      record_type,
+                                      sensor_number,
+                                      sensor_reading,
+                                      event_message_output_type,
+                                      sensor_event_bitmask,
+                                      event_message_list,
+                                      event_message_list_len));
+    }
+
   if (!state_data->output_headers)
     {
       _output_headers (state_data);
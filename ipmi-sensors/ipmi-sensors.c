@@ -1403,6 +1403,10 @@ _ipmi_sensors (pstdout_state_t pstate,
   state_data.prog_data = prog_data;
   state_data.pstate = pstate;
   state_data.hostname = (char *)hostname;
+
+  if (prog_data->args->output_format != TOOL_OUTPUT_FORMAT_TEXT)
+    tool_output_record_init (&state_data.output_record,
+                             prog_data->args->output_format);
   
   if (!(state_data.ipmi_ctx = ipmi_open (prog_data->progname,
                                          hostname,
@@ -1525,6 +1529,7 @@ _ipmi_sensors (pstdout_state_t pstate,
   ipmi_interpret_ctx_destroy (state_data.interpret_ctx);
   ipmi_ctx_close (state_data.ipmi_ctx);
   ipmi_ctx_destroy (state_data.ipmi_ctx);
+  tool_output_record_cleanup (&state_data.output_record);
   return (exit_code);
 }
 
@@ -23,6 +23,7 @@
 
 #include "tool-cmdline-common.h"
 #include "tool-oem-common.h"
+#include "tool-output-common.h"
 #include "tool-sensor-common.h"
 #include "pstdout.h"
 
@@ -58,6 +59,7 @@ enum ipmi_sensors_argp_option_keys
     NON_ABBREVIATED_UNITS_KEY = 176,
     LEGACY_OUTPUT_KEY = 177,
     IPMIMONITORING_LEGACY_OUTPUT_KEY = 178,
+    OUTPUT_FORMAT_KEY = 179,
   };
 
 struct ipmi_sensors_arguments
@@ -91,6 +93,7 @@ struct ipmi_sensors_arguments
   int non_abbreviated_units;
   int legacy_output;
   int ipmimonitoring_legacy_output;
+  int output_format;
 };
 
 typedef struct ipmi_sensors_prog_data
@@ -118,6 +121,7 @@ typedef struct ipmi_sensors_state_data
   ipmi_interpret_ctx_t interpret_ctx;
   int output_headers;
   struct sensor_column_width column_width;
+  struct tool_output_record output_record;
   struct ipmi_oem_data oem_data;
   struct ipmi_sensors_interpret_oem_data_intel_node_manager intel_node_manager;
 } ipmi_sensors_state_data_t;
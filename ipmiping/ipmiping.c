@@ -467,7 +467,7 @@ endresult (const char *progname,
 int
 main (int argc, char **argv)
 {
-  ipmi_ping_setup (argc, argv, 0, IPMI_RQ_SEQ_MAX, "hVc:i:I:t:vr:s:d");
+  ipmi_ping_setup (argc, argv, 0, IPMI_RQ_SEQ_MAX, "hVc:i:I:t:vr:s:R:d");
   ipmi_ping_loop (createpacket, parsepacket, latepacket, endresult);
   exit (EXIT_FAILURE);                    /* NOT REACHED */
 }
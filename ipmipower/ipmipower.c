@@ -66,6 +66,7 @@
 #include "ipmipower_powercmd.h"
 #include "ipmipower_prompt.h"
 #include "ipmipower_ping.h"
+#include "ipmipower_schedule.h"
 #include "ipmipower_util.h"
 
 #include "freeipmi-portability.h"
@@ -268,10 +269,50 @@ _sendto (cbuf_t cbuf, int fd, struct sockaddr *destaddr, socklen_t destaddrlen)
     }
 }
 
+/* _recvfrom_store
+ * - store a received packet into a connection's input buffer
+ */
+static void
+_recvfrom_store (cbuf_t cbuf, uint8_t *buf, int rv)
+{
+  int n, dropped = 0;
+
+  /* cbuf should be empty, but if it isn't, empty it */
+  if (!cbuf_is_empty (cbuf))
+    {
+      IPMIPOWER_DEBUG (("cbuf not empty, draining"));
+      do
+        {
+          uint8_t tempbuf[IPMIPOWER_PACKET_BUFLEN];
+          
+          if (cbuf_read (cbuf, tempbuf, IPMIPOWER_PACKET_BUFLEN) < 0)
+            {
+              IPMIPOWER_ERROR (("cbuf_read: %s", strerror (errno)));
+              exit (EXIT_FAILURE);
+            }
+        } while(!cbuf_is_empty (cbuf));
+    }
+
+  if ((n = cbuf_write (cbuf, buf, rv, &dropped)) < 0)
+    {
+      IPMIPOWER_ERROR (("cbuf_write: %s", strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+
+  if (n != rv)
+    {
+      IPMIPOWER_ERROR (("cbuf_write: rv=%d n=%d", rv, n));
+      exit (EXIT_FAILURE);
+    }
+
+  if (dropped)
+    IPMIPOWER_DEBUG (("cbuf_write: read dropped %d bytes", dropped));
+}
+
 static void
 _recvfrom (cbuf_t cbuf, int fd, struct sockaddr *srcaddr, socklen_t srcaddrlen)
 {
-  int n, rv, dropped = 0;
+  int rv;
   uint8_t buf[IPMIPOWER_PACKET_BUFLEN];
   struct sockaddr_in6 from6;
   struct sockaddr *from = (struct sockaddr *)&from6;
@@ -364,36 +405,74 @@ _recvfrom (cbuf_t cbuf, int fd, struct sockaddr *srcaddr, socklen_t srcaddrlen)
         return;
     }
 
-  /* cbuf should be empty, but if it isn't, empty it */
-  if (!cbuf_is_empty (cbuf))
+  _recvfrom_store (cbuf, buf, rv);
+}
+
+/* _recvfrom_shared
+ * - read all packets waiting on a shared socket and pass each to the
+ *   connection it came from
+ */
+static void
+_recvfrom_shared (int fd)
+{
+  uint8_t buf[IPMIPOWER_PACKET_BUFLEN];
+  struct sockaddr_in6 from6;
+  struct sockaddr *from = (struct sockaddr *)&from6;
+  socklen_t fromlen;
+  struct ipmipower_connection *ic;
+  int rv;
+
+  while (1)
     {
-      IPMIPOWER_DEBUG (("cbuf not empty, draining"));
-      do
+      fromlen = sizeof (struct sockaddr_in6);
+      memset (&from6, '\0', sizeof (struct sockaddr_in6));
+
+      /* See comments in _recvfrom() */
+      if ((rv = ipmi_lan_recvfrom (fd,
+                                   buf,
+                                   IPMIPOWER_PACKET_BUFLEN,
+                                   MSG_DONTWAIT,
+                                   from,
+                                   &fromlen)) < 0)
         {
-          uint8_t tempbuf[IPMIPOWER_PACKET_BUFLEN];
-          
-          if (cbuf_read (cbuf, tempbuf, IPMIPOWER_PACKET_BUFLEN) < 0)
+          if (errno == EINTR)
+            continue;
+
+          if (errno == EAGAIN || errno == EWOULDBLOCK)
+            break;
+
+          if (errno == ECONNRESET || errno == ECONNREFUSED)
             {
-              IPMIPOWER_ERROR (("cbuf_read: %s", strerror (errno)));
-              exit (EXIT_FAILURE);
+              IPMIPOWER_DEBUG (("ipmi_lan_recvfrom: connection refused: %s", strerror (errno)));
+              continue;
             }
-        } while(!cbuf_is_empty (cbuf));
-    }
 
-  if ((n = cbuf_write (cbuf, buf, rv, &dropped)) < 0)
-    {
-      IPMIPOWER_ERROR (("cbuf_write: %s", strerror (errno)));
-      exit (EXIT_FAILURE);
-    }
+          IPMIPOWER_ERROR (("ipmi_lan_recvfrom: %s", strerror (errno)));
+          exit (EXIT_FAILURE);
+        }
 
-  if (n != rv)
-    {
-      IPMIPOWER_ERROR (("cbuf_write: rv=%d n=%d", rv, n));
-      exit (EXIT_FAILURE);
-    }
+      if (!(ic = ipmipower_connection_shared_find (ics, ics_len, from)))
+        {
+          IPMIPOWER_DEBUG (("packet from unknown host dropped"));
+          continue;
+        }
 
-  if (dropped)
-    IPMIPOWER_DEBUG (("cbuf_write: read dropped %d bytes", dropped));
+      /* RMCP header is 4 bytes, message class in the last byte.
+       * Pongs are ASF, everything else is IPMI.
+       */
+      if (rv < 4)
+        {
+          IPMIPOWER_DEBUG (("host = %s; short packet dropped", ic->hostname));
+          continue;
+        }
+
+      if ((buf[3] & 0x1F) == RMCP_HDR_MESSAGE_CLASS_ASF)
+        _recvfrom_store (ic->ping_in, buf, rv);
+      else if ((buf[3] & 0x1F) == RMCP_HDR_MESSAGE_CLASS_IPMI)
+        _recvfrom_store (ic->ipmi_in, buf, rv);
+      else
+        IPMIPOWER_DEBUG (("host = %s; invalid message class dropped", ic->hostname));
+    }
 }
 
 /* _poll_loop
@@ -416,6 +495,8 @@ _poll_loop (int non_interactive)
   while (non_interactive || ipmipower_prompt_process_cmdline ())
     {
       int i, num, timeout;
+      int shared_fds[IPMIPOWER_SHARED_SOCKETS_MAX];
+      unsigned int shared_fds_len, private_len, j, p;
       int powercmd_timeout = -1;
       int ping_timeout = -1;
 
@@ -453,13 +534,26 @@ _poll_loop (int non_interactive)
        * going to create a more efficient O(n) poll loop.
        */
 
-      /* Has the number of hosts changed? */
-      if (nfds != (ics_len*2) + extra_fds)
+      /* With the shared socket option, most hosts are polled through
+       * one shared socket per address family.  Only hosts that could
+       * not use a shared socket need their own pair of fds.
+       */
+      shared_fds_len = ipmipower_connection_shared_fds (shared_fds,
+                                                        IPMIPOWER_SHARED_SOCKETS_MAX);
+      private_len = 0;
+      for (i = 0; i < ics_len; i++)
+        {
+          if (!ics[i].shared)
+            private_len++;
+        }
+
+      /* Has the number of fds changed? */
+      if (nfds != shared_fds_len + (private_len*2) + extra_fds)
         {
           /* The "*2" is for each host's two fds, one for ipmi
            * (ipmi_fd) and one for rmcp (ping_fd).
            */
-          nfds = (ics_len*2) + extra_fds;
+          nfds = shared_fds_len + (private_len*2) + extra_fds;
           free (pfds);
 
           if (!(pfds = (struct pollfd *)malloc (nfds * sizeof (struct pollfd))))
@@ -469,23 +563,46 @@ _poll_loop (int non_interactive)
             }
         }
 
-      for (i = 0; i < ics_len; i++)
+      for (j = 0; j < shared_fds_len; j++)
+        {
+          pfds[j].fd = shared_fds[j];
+          pfds[j].events = POLLIN;
+          pfds[j].revents = 0;
+        }
+
+      for (i = 0, p = shared_fds_len; i < ics_len; i++)
         {
-          pfds[i*2].fd = ics[i].ipmi_fd;
-          pfds[i*2+1].fd = ics[i].ping_fd;
-          pfds[i*2].events = pfds[i*2+1].events = 0;
-          pfds[i*2].revents = pfds[i*2+1].revents = 0;
+          if (ics[i].shared)
+            {
+              if (cbuf_is_empty (ics[i].ipmi_out)
+                  && (!cmd_args.ping_interval || cbuf_is_empty (ics[i].ping_out)))
+                continue;
+
+              for (j = 0; j < shared_fds_len; j++)
+                {
+                  if (pfds[j].fd == ics[i].ipmi_fd)
+                    pfds[j].events |= POLLOUT;
+                }
+              continue;
+            }
 
-          pfds[i*2].events |= POLLIN;
+          pfds[p].fd = ics[i].ipmi_fd;
+          pfds[p+1].fd = ics[i].ping_fd;
+          pfds[p].events = pfds[p+1].events = 0;
+          pfds[p].revents = pfds[p+1].revents = 0;
+
+          pfds[p].events |= POLLIN;
           if (!cbuf_is_empty (ics[i].ipmi_out))
-            pfds[i*2].events |= POLLOUT;
+            pfds[p].events |= POLLOUT;
 
-          if (!cmd_args.ping_interval)
-            continue;
+          if (cmd_args.ping_interval)
+            {
+              pfds[p+1].events |= POLLIN;
+              if (!cbuf_is_empty (ics[i].ping_out))
+                pfds[p+1].events |= POLLOUT;
+            }
 
-          pfds[i*2+1].events |= POLLIN;
-          if (!cbuf_is_empty (ics[i].ping_out))
-            pfds[i*2+1].events |= POLLOUT;
+          p += 2;
         }
 
       if (!non_interactive)
@@ -503,9 +620,35 @@ _poll_loop (int non_interactive)
 
       ipmipower_poll (pfds, nfds, timeout);
 
-      for (i = 0; i < ics_len; i++)
+      for (j = 0; j < shared_fds_len; j++)
+        {
+          /* See comments in _recvfrom() regarding ECONNRESET/ECONNREFUSED */
+          if (pfds[j].revents & (POLLIN | POLLERR))
+            _recvfrom_shared (pfds[j].fd);
+        }
+
+      for (i = 0, p = shared_fds_len; i < ics_len; i++)
         {
-          if (pfds[i*2].revents & POLLERR)
+          if (ics[i].shared)
+            {
+              for (j = 0; j < shared_fds_len; j++)
+                {
+                  if (pfds[j].fd == ics[i].ipmi_fd)
+                    break;
+                }
+
+              if (j == shared_fds_len || !(pfds[j].revents & POLLOUT))
+                continue;
+
+              if (!cbuf_is_empty (ics[i].ipmi_out))
+                _sendto (ics[i].ipmi_out, ics[i].ipmi_fd, ics[i].destaddr, ics[i].destaddrlen);
+
+              if (cmd_args.ping_interval && !cbuf_is_empty (ics[i].ping_out))
+                _sendto (ics[i].ping_out, ics[i].ping_fd, ics[i].destaddr, ics[i].destaddrlen);
+              continue;
+            }
+
+          if (pfds[p].revents & POLLERR)
             {
               IPMIPOWER_DEBUG (("host = %s; IPMI POLLERR", ics[i].hostname));
               /* See comments in _ipmi_recvfrom() regarding ECONNRESET/ECONNREFUSED */
@@ -513,29 +656,34 @@ _poll_loop (int non_interactive)
             }
           else
             {
-              if (pfds[i*2].revents & POLLIN)
+              if (pfds[p].revents & POLLIN)
                 _recvfrom (ics[i].ipmi_in, ics[i].ipmi_fd, ics[i].destaddr, ics[i].destaddrlen);
               
-              if (pfds[i*2].revents & POLLOUT)
+              if (pfds[p].revents & POLLOUT)
                 _sendto (ics[i].ipmi_out, ics[i].ipmi_fd, ics[i].destaddr, ics[i].destaddrlen);
             }
 
           if (!cmd_args.ping_interval)
-            continue;
+            {
+              p += 2;
+              continue;
+            }
 
-          if (pfds[i*2+1].revents & POLLERR)
+          if (pfds[p+1].revents & POLLERR)
             {
               IPMIPOWER_DEBUG (("host = %s; PING_POLLERR", ics[i].hostname));
               _recvfrom (ics[i].ping_in, ics[i].ping_fd, ics[i].destaddr, ics[i].destaddrlen);
             }
           else
             {
-              if (pfds[i*2+1].revents & POLLIN)
+              if (pfds[p+1].revents & POLLIN)
                 _recvfrom (ics[i].ping_in, ics[i].ping_fd, ics[i].destaddr, ics[i].destaddrlen);
               
-              if (pfds[i*2+1].revents & POLLOUT)
+              if (pfds[p+1].revents & POLLOUT)
                 _sendto (ics[i].ping_out, ics[i].ping_fd, ics[i].destaddr, ics[i].destaddrlen);
             }
+
+          p += 2;
         }
 
       if (!non_interactive && (pfds[nfds-2].revents & POLLIN))
@@ -598,6 +746,7 @@ main (int argc, char *argv[])
   _ipmipower_setup ();
 
   ipmipower_powercmd_setup ();
+  ipmipower_schedule_setup ();
 
   if (cmd_args.common_args.hostname)
     {
@@ -709,6 +858,7 @@ main (int argc, char *argv[])
   _poll_loop ((cmd_args.powercmd != IPMIPOWER_POWER_CMD_NONE) ? 1 : 0);
 
   ipmipower_powercmd_cleanup ();
+  ipmipower_schedule_cleanup ();
   _ipmipower_cleanup ();
 
   /* If any error messages other than "on", "off", or "ok", then an
@@ -52,6 +52,7 @@
 
 #include "cbuf.h"
 #include "fi_hostlist.h"
+#include "hash.h"
 #include "list.h"
 #include "tool-cmdline-common.h"
 
@@ -74,6 +75,9 @@
 
 #define IPMIPOWER_OUTPUT_BUFLEN                          65536
 
+/* one shared socket for each of AF_INET and AF_INET6 */
+#define IPMIPOWER_SHARED_SOCKETS_MAX                     2
+
 #define IPMI_MAX_SIK_KEY_LENGTH                          64
 
 #define IPMI_MAX_INTEGRITY_KEY_LENGTH                    64
@@ -382,6 +386,7 @@ struct ipmipower_powercmd {
   /* Ipmipower variables */
   int wait_until_on_state;
   int wait_until_off_state;
+  unsigned int stage;
 
   struct ipmipower_connection *ic;
 
@@ -480,6 +485,13 @@ struct ipmipower_connection
 
   /* for eliminate option */
   int skip;
+
+  /* for shared socket option, ipmi_fd and ping_fd are a socket
+   * shared with other connections and replies are found through
+   * shared_hash, which is common to the connection array.
+   */
+  int shared;
+  hash_t shared_hash;
 };
 
 typedef struct ipmipower_powercmd *ipmipower_powercmd_t;
@@ -511,6 +523,10 @@ enum ipmipower_argp_option_keys
     PING_PACKET_COUNT_KEY = 174,
     PING_PERCENT_KEY = 175,
     PING_CONSEC_COUNT_KEY = 176,
+    SHARED_SOCKET_KEY = 177,
+    RATE_LIMIT_KEY = 178,
+    GROUP_MAP_KEY = 179,
+    STAGE_DELAY_KEY = 180,
   };
 
 struct ipmipower_arguments
@@ -533,6 +549,10 @@ struct ipmipower_arguments
   unsigned int ping_packet_count;
   unsigned int ping_percent;
   unsigned int ping_consec_count;
+  int shared_socket;
+  unsigned int rate_limit;
+  char *group_map;
+  unsigned int stage_delay;
 };
 
 #endif /* IPMIPOWER_H */
@@ -126,9 +126,17 @@ static struct argp_option cmdline_options[] =
       "Specify the ping percent value.", 57},
     { "ping-consec-count", PING_CONSEC_COUNT_KEY, "COUNT", 0,
       "Specify the ping consecutive count.", 58},
+    { "shared-socket", SHARED_SOCKET_KEY, 0, 0,
+      "Use a single socket per address family for all hosts.", 59},
+    { "rate-limit", RATE_LIMIT_KEY, "COUNT", 0,
+      "Specify the maximum number of power commands started per second.", 60},
+    { "group-map", GROUP_MAP_KEY, "FILE", 0,
+      "Specify a file mapping hosts to groups, power commands are executed one group at a time.", 61},
+    { "stage-delay", STAGE_DELAY_KEY, "MILLISECONDS", 0,
+      "Specify the delay between groups of the group map in milliseconds.", 62},
 #ifndef NDEBUG
     { "rmcpdump", RMCPDUMP_KEY, 0, 0,
-      "Turn on RMCP packet dump output.", 59},
+      "Turn on RMCP packet dump output.", 63},
 #endif
     { NULL, 0, NULL, 0, NULL, 0}
   };
@@ -312,6 +320,41 @@ cmdline_parse (int key,
         }
       cmd_args->ping_consec_count = tmp;
       break;
+    case SHARED_SOCKET_KEY:       /* --shared-socket */
+      cmd_args->shared_socket = 1;
+      break;
+    case RATE_LIMIT_KEY:       /* --rate-limit */
+      errno = 0;
+      tmp = strtol (arg, &endptr, 10);
+      if (errno
+          || endptr[0] != '\0'
+          || tmp < 0)
+        {
+          fprintf (stderr, "rate limit invalid\n");
+          exit (EXIT_FAILURE);
+        }
+      cmd_args->rate_limit = tmp;
+      break;
+    case GROUP_MAP_KEY:       /* --group-map */
+      free (cmd_args->group_map);
+      if (!(cmd_args->group_map = strdup (arg)))
+        {
+          perror ("strdup");
+          exit (EXIT_FAILURE);
+        }
+      break;
+    case STAGE_DELAY_KEY:       /* --stage-delay */
+      errno = 0;
+      tmp = strtol (arg, &endptr, 10);
+      if (errno
+          || endptr[0] != '\0'
+          || tmp < 0)
+        {
+          fprintf (stderr, "stage delay invalid\n");
+          exit (EXIT_FAILURE);
+        }
+      cmd_args->stage_delay = tmp;
+      break;
       /* removed legacy short options */
     default:
       return (common_parse_opt (key, arg, &(cmd_args->common_args)));
@@ -378,6 +421,14 @@ _ipmipower_config_file_parse (struct ipmipower_arguments *cmd_args)
     cmd_args->ping_percent = config_file_data.ping_percent;
   if (config_file_data.ping_consec_count_count)
     cmd_args->ping_consec_count = config_file_data.ping_consec_count;
+  if (config_file_data.shared_socket_count)
+    cmd_args->shared_socket = config_file_data.shared_socket;
+  if (config_file_data.rate_limit_count)
+    cmd_args->rate_limit = config_file_data.rate_limit;
+  if (config_file_data.group_map_count)
+    cmd_args->group_map = config_file_data.group_map;
+  if (config_file_data.stage_delay_count)
+    cmd_args->stage_delay = config_file_data.stage_delay;
 }
 
 static void
@@ -447,6 +498,10 @@ ipmipower_argp_parse (int argc, char **argv, struct ipmipower_arguments *cmd_arg
   cmd_args->ping_packet_count = 10;
   cmd_args->ping_percent = 50;
   cmd_args->ping_consec_count = 5;
+  cmd_args->shared_socket = 0;
+  cmd_args->rate_limit = 0;
+  cmd_args->group_map = NULL;
+  cmd_args->stage_delay = 0;
 
   argp_parse (&cmdline_config_file_argp,
               argc,
@@ -51,6 +51,7 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netdb.h>
+#include <pthread.h>
 
 #include "ipmipower_connection.h"
 #include "ipmipower_error.h"
@@ -60,6 +61,7 @@
 #include "freeipmi-portability.h"
 #include "cbuf.h"
 #include "fi_hostlist.h"
+#include "hash.h"
 #include "network.h"
 
 extern cbuf_t ttyout;
@@ -69,6 +71,43 @@ extern struct ipmipower_arguments cmd_args;
 #define IPMIPOWER_MIN_CONNECTION_BUF 1024*2
 #define IPMIPOWER_MAX_CONNECTION_BUF 1024*4
 
+/* Maximum number of threads used to resolve hostnames concurrently */
+#define IPMIPOWER_RESOLVE_THREADS_MAX 32
+
+/* Per connection hostname resolution state, hostnames are resolved
+ * concurrently after all hostnames have been parsed, so a slow
+ * resolver costs roughly the slowest lookup instead of the sum of
+ * all of them.
+ */
+struct ipmipower_connection_resolve
+{
+  int valid;
+  char port_str[MAXPORTBUFLEN + 1];
+  struct addrinfo *ai_res;
+  int ret;
+};
+
+/* Shared sockets for the shared socket option, one per address
+ * family.  They live for the life of the process, since the
+ * connection array may be recreated in interactive mode.
+ */
+static int shared_fd_inet = -1;
+static int shared_fd_inet6 = -1;
+
+/* Best effort receive buffer size for shared sockets, replies from
+ * many hosts may arrive on them at once.
+ */
+#define IPMIPOWER_SHARED_SOCKET_RCVBUF 1024*1024*4
+
+struct ipmipower_connection_resolver
+{
+  pthread_mutex_t mutex;
+  struct ipmipower_connection *ics;
+  struct ipmipower_connection_resolve *resolve;
+  unsigned int count;
+  unsigned int next;
+};
+
 /* _clean_fd
  * - Remove any extraneous packets sitting on the fd buf
  */
@@ -110,7 +149,11 @@ ipmipower_connection_clear (struct ipmipower_connection *ic)
 {
   assert (ic);
 
-  _clean_fd (ic->ipmi_fd);
+  /* can't drain a shared socket, packets may be for other hosts.
+   * Stale replies are discarded when they fail validation.
+   */
+  if (!ic->shared)
+    _clean_fd (ic->ipmi_fd);
   if (cbuf_drop (ic->ipmi_in, -1) < 0)
     {
       IPMIPOWER_ERROR (("cbuf_drop: %s", strerror (errno)));
@@ -125,7 +168,9 @@ ipmipower_connection_clear (struct ipmipower_connection *ic)
 }
 
 static int
-_connection_setup (struct ipmipower_connection *ic, const char *hostname)
+_connection_setup (struct ipmipower_connection *ic,
+                   struct ipmipower_connection_resolve *resolve,
+                   const char *hostname)
 {
   char *hostname_first_parse_copy = NULL;
   const char *hostname_first_parse_ptr = NULL;
@@ -134,12 +179,11 @@ _connection_setup (struct ipmipower_connection *ic, const char *hostname)
   const char *hostname_second_parse_ptr = NULL;
   uint16_t port = RMCP_PRIMARY_RMCP_PORT;
   const char *port_ptr = NULL;
-  char port_str[MAXPORTBUFLEN + 1];
-  struct addrinfo ai_hints, *ai_res = NULL, *ai = NULL;
   int rv = -1;
   int ret;
 
   assert (ic);
+  assert (resolve);
   assert (hostname);
 
   /* Don't use wrapper function, need to exit cleanly on EMFILE errno */
@@ -288,49 +332,274 @@ _connection_setup (struct ipmipower_connection *ic, const char *hostname)
   strncpy (ic->hostname, hostname_second_parse_ptr, MAXHOSTNAMELEN);
   ic->hostname[MAXHOSTNAMELEN] = '\0';
 
-  memset (port_str, '\0', MAXPORTBUFLEN + 1);
-  snprintf (port_str, MAXPORTBUFLEN, "%d", port);
+  memset (resolve->port_str, '\0', MAXPORTBUFLEN + 1);
+  snprintf (resolve->port_str, MAXPORTBUFLEN, "%d", port);
+  resolve->valid = 1;
+
+  rv = 0;
+ cleanup:
+  free (hostname_first_parse_copy);
+  free (hostname_second_parse_copy);
+  free (port_second_parse_copy);
+  return (rv);
+}
+
+static void
+_connection_resolve (struct ipmipower_connection *ic,
+                     struct ipmipower_connection_resolve *resolve)
+{
+  struct addrinfo ai_hints;
+
+  assert (ic);
+  assert (resolve);
+  assert (resolve->valid);
+
   memset (&ai_hints, 0, sizeof (struct addrinfo));
   ai_hints.ai_family = AF_UNSPEC;
   ai_hints.ai_socktype = SOCK_DGRAM;
   ai_hints.ai_flags = (AI_V4MAPPED | AI_ADDRCONFIG);
 
-  if ((ret = getaddrinfo (ic->hostname, port_str, &ai_hints, &ai_res)))
+  resolve->ret = getaddrinfo (ic->hostname,
+                              resolve->port_str,
+                              &ai_hints,
+                              &resolve->ai_res);
+}
+
+static void *
+_connection_resolve_thread (void *arg)
+{
+  struct ipmipower_connection_resolver *resolver;
+
+  assert (arg);
+
+  resolver = (struct ipmipower_connection_resolver *)arg;
+
+  while (1)
+    {
+      unsigned int i;
+
+      pthread_mutex_lock (&resolver->mutex);
+      i = resolver->next++;
+      pthread_mutex_unlock (&resolver->mutex);
+
+      if (i >= resolver->count)
+        break;
+
+      if (resolver->resolve[i].valid)
+        _connection_resolve (&resolver->ics[i], &resolver->resolve[i]);
+    }
+
+  return (NULL);
+}
+
+/* Resolve all hostnames using a bounded pool of threads.  If threads
+ * cannot be created, the remaining hostnames are resolved here.
+ */
+static void
+_connection_resolve_all (struct ipmipower_connection *ics,
+                         struct ipmipower_connection_resolve *resolve,
+                         unsigned int count)
+{
+  struct ipmipower_connection_resolver resolver;
+  pthread_t threads[IPMIPOWER_RESOLVE_THREADS_MAX];
+  unsigned int threads_count = 0;
+  unsigned int threads_max;
+  unsigned int i;
+
+  assert (ics);
+  assert (resolve);
+
+  resolver.ics = ics;
+  resolver.resolve = resolve;
+  resolver.count = count;
+  resolver.next = 0;
+
+  if ((errno = pthread_mutex_init (&resolver.mutex, NULL)))
+    {
+      IPMIPOWER_ERROR (("pthread_mutex_init: %s", strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+
+  threads_max = count < IPMIPOWER_RESOLVE_THREADS_MAX ? count : IPMIPOWER_RESOLVE_THREADS_MAX;
+
+  /* No point in a thread for a single host */
+  if (threads_max > 1)
+    {
+      for (i = 0; i < threads_max; i++)
+        {
+          if (pthread_create (&threads[threads_count],
+                              NULL,
+                              _connection_resolve_thread,
+                              &resolver))
+            break;
+          threads_count++;
+        }
+    }
+
+  /* Help out, or do all the work if no threads could be created */
+  _connection_resolve_thread (&resolver);
+
+  for (i = 0; i < threads_count; i++)
+    pthread_join (threads[i], NULL);
+
+  pthread_mutex_destroy (&resolver.mutex);
+}
+
+/* _connection_shared_hash_key
+ * - Hash a remote address and port for the shared socket hash
+ */
+static unsigned int
+_connection_shared_hash_key (const void *key)
+{
+  const struct sockaddr *addr = (const struct sockaddr *)key;
+  unsigned int hash = 0;
+
+  /* memcpy hacks to avoid warnings, i.e.
+   * warning: dereferencing pointer 'X' does break strict-aliasing rules
+   */
+  if (addr->sa_family == AF_INET6)
+    {
+      struct sockaddr_in6 addr6;
+      unsigned int i;
+
+      memcpy (&addr6, addr, sizeof (struct sockaddr_in6));
+      for (i = 0; i < sizeof (addr6.sin6_addr); i++)
+        hash = (hash * 31) + addr6.sin6_addr.s6_addr[i];
+      hash = (hash * 31) + addr6.sin6_port;
+    }
+  else
+    {
+      struct sockaddr_in addr4;
+
+      memcpy (&addr4, addr, sizeof (struct sockaddr_in));
+      hash = ntohl (addr4.sin_addr.s_addr);
+      hash = (hash * 31) + addr4.sin_port;
+    }
+
+  return (hash);
+}
+
+/* _connection_shared_hash_cmp
+ * - Returns zero if remote addresses and ports are equal
+ */
+static int
+_connection_shared_hash_cmp (const void *key1, const void *key2)
+{
+  const struct sockaddr *addr1 = (const struct sockaddr *)key1;
+  const struct sockaddr *addr2 = (const struct sockaddr *)key2;
+
+  if (addr1->sa_family != addr2->sa_family)
+    return (1);
+
+  if (addr1->sa_family == AF_INET6)
+    {
+      struct sockaddr_in6 addr61, addr62;
+
+      memcpy (&addr61, addr1, sizeof (struct sockaddr_in6));
+      memcpy (&addr62, addr2, sizeof (struct sockaddr_in6));
+      if (addr61.sin6_port != addr62.sin6_port
+          || memcmp (&addr61.sin6_addr, &addr62.sin6_addr, sizeof (addr61.sin6_addr)))
+        return (1);
+    }
+  else
+    {
+      struct sockaddr_in addr41, addr42;
+
+      memcpy (&addr41, addr1, sizeof (struct sockaddr_in));
+      memcpy (&addr42, addr2, sizeof (struct sockaddr_in));
+      if (addr41.sin_port != addr42.sin_port
+          || addr41.sin_addr.s_addr != addr42.sin_addr.s_addr)
+        return (1);
+    }
+
+  return (0);
+}
+
+/* _connection_shared_socket
+ * - Get shared socket for the connection's address family, creating
+ *   it if necessary
+ * - Returns fd on success, -1 if it cannot be created
+ */
+static int
+_connection_shared_socket (struct ipmipower_connection *ic)
+{
+  int *fdptr;
+  int rcvbuf = IPMIPOWER_SHARED_SOCKET_RCVBUF;
+
+  assert (ic);
+  assert (ic->srcaddr);
+
+  if (ic->srcaddr->sa_family == AF_INET6)
+    fdptr = &shared_fd_inet6;
+  else
+    fdptr = &shared_fd_inet;
+
+  if (*fdptr >= 0)
+    return (*fdptr);
+
+  if ((*fdptr = socket (ic->srcaddr->sa_family, SOCK_DGRAM, 0)) < 0)
+    {
+      IPMIPOWER_DEBUG (("socket: %s", strerror (errno)));
+      return (-1);
+    }
+
+  if (bind (*fdptr, ic->srcaddr, ic->srcaddrlen) < 0)
     {
-      if (ret == EAI_NODATA
-	  || ret == EAI_NONAME)
+      IPMIPOWER_DEBUG (("bind: %s", strerror (errno)));
+      /* ignore potential error, error path */
+      close (*fdptr);
+      *fdptr = -1;
+      return (-1);
+    }
+
+  /* best effort, ignore potential error */
+  setsockopt (*fdptr, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof (rcvbuf));
+
+  return (*fdptr);
+}
+
+static void
+_connection_close_fds (struct ipmipower_connection *ic)
+{
+  assert (ic);
+
+  /* shared sockets are never closed, they may be used again */
+  if (ic->shared)
+    return;
+
+  /* ignore potential error, cleanup path */
+  close (ic->ipmi_fd);
+  /* ignore potential error, cleanup path */
+  close (ic->ping_fd);
+}
+
+static int
+_connection_setup_socket (struct ipmipower_connection *ic,
+                          struct ipmipower_connection_resolve *resolve,
+                          hash_t shared_hash)
+{
+  struct addrinfo *ai = NULL;
+
+  assert (ic);
+  assert (resolve);
+  assert (resolve->valid);
+
+  if (resolve->ret)
+    {
+      if (resolve->ret == EAI_NODATA
+	  || resolve->ret == EAI_NONAME)
         ipmipower_output (IPMIPOWER_MSG_TYPE_HOSTNAME_INVALID, ic->hostname, NULL);
       else
         {
-          IPMIPOWER_ERROR (("getaddrinfo() %s: %s", ic->hostname, gai_strerror (ret)));
+          IPMIPOWER_ERROR (("getaddrinfo() %s: %s", ic->hostname, gai_strerror (resolve->ret)));
           exit (EXIT_FAILURE);
         }
-      goto cleanup;
+      return (-1);
     }
 
   /* Try all of the different answers we got, until we succeed. */
-  for (ai = ai_res; ai != NULL; ai = ai->ai_next)
+  for (ai = resolve->ai_res; ai != NULL; ai = ai->ai_next)
     {
-      if ((ic->ipmi_fd = socket (ai->ai_family,
-				 ai->ai_socktype, ai->ai_protocol)) < 0)
-	{
-	  if (errno == EMFILE)
-	    {
-	      IPMIPOWER_DEBUG (("file descriptor limit reached"));
-	      return (-1);
-	    }
-	}
-
-      if ((ic->ping_fd = socket (ai->ai_family,
-				 ai->ai_socktype, ai->ai_protocol)) < 0)
-	{
-	  if (errno == EMFILE)
-	    {
-	      IPMIPOWER_DEBUG (("file descriptor limit reached"));
-	      return (-1);
-	    }
-	}
-
       if (ai->ai_family == AF_INET)
         {
           memcpy (&(ic->destaddr4), ai->ai_addr, ai->ai_addrlen);
@@ -357,12 +626,53 @@ _connection_setup (struct ipmipower_connection *ic, const char *hostname)
           ic->srcaddrlen = sizeof (struct sockaddr_in6);
         }
       else
+        continue;
+
+      /* If another host already uses this address and port on the
+       * shared socket, replies could not be told apart, so fall back
+       * to per connection sockets.
+       */
+      if (shared_hash
+          && !hash_find (shared_hash, ic->destaddr))
         {
-	  close(ic->ipmi_fd);
-	  close(ic->ping_fd);
-	  continue;
+          int fd;
+
+          if ((fd = _connection_shared_socket (ic)) >= 0)
+            {
+              if (!hash_insert (shared_hash, ic->destaddr, ic))
+                {
+                  IPMIPOWER_ERROR (("hash_insert: %s", strerror (errno)));
+                  exit (EXIT_FAILURE);
+                }
+
+              ic->ipmi_fd = fd;
+              ic->ping_fd = fd;
+              ic->shared = 1;
+              ic->skip = 0;
+              break;
+            }
         }
 
+      if ((ic->ipmi_fd = socket (ai->ai_family,
+				 ai->ai_socktype, ai->ai_protocol)) < 0)
+	{
+	  if (errno == EMFILE)
+	    {
+	      IPMIPOWER_DEBUG (("file descriptor limit reached"));
+	      return (-1);
+	    }
+	}
+
+      if ((ic->ping_fd = socket (ai->ai_family,
+				 ai->ai_socktype, ai->ai_protocol)) < 0)
+	{
+	  if (errno == EMFILE)
+	    {
+	      IPMIPOWER_DEBUG (("file descriptor limit reached"));
+	      return (-1);
+	    }
+	}
+
       if ((bind (ic->ipmi_fd, ic->srcaddr, ic->srcaddrlen) < 0)
           || (bind (ic->ping_fd, ic->srcaddr, ic->srcaddrlen) < 0))
 	{
@@ -377,17 +687,11 @@ _connection_setup (struct ipmipower_connection *ic, const char *hostname)
 
   if (!ai)
     {
-      ipmipower_output (IPMIPOWER_MSG_TYPE_HOSTNAME_INVALID, hostname_second_parse_ptr, NULL);
-      goto cleanup;
+      ipmipower_output (IPMIPOWER_MSG_TYPE_HOSTNAME_INVALID, ic->hostname, NULL);
+      return (-1);
     }
 
-  rv = 0;
- cleanup:
-  freeaddrinfo (ai_res);
-  free (hostname_first_parse_copy);
-  free (hostname_second_parse_copy);
-  free (port_second_parse_copy);
-  return (rv);
+  return (0);
 }
 
 static void
@@ -573,6 +877,8 @@ ipmipower_connection_array_create (const char *hostname, unsigned int *len)
   char *hstr = NULL;
   char *h2str = NULL;
   struct ipmipower_connection *ics = NULL;
+  struct ipmipower_connection_resolve *resolve = NULL;
+  hash_t shared_hash = NULL;
   int host_count;
   int errflag = 0;
   int emfilecount = 0;
@@ -593,10 +899,31 @@ ipmipower_connection_array_create (const char *hostname, unsigned int *len)
 
   memset (ics, '\0', (sizeof (struct ipmipower_connection) * host_count));
 
+  if (!(resolve = (struct ipmipower_connection_resolve *)malloc (sizeof (struct ipmipower_connection_resolve) * host_count)))
+    {
+      IPMIPOWER_ERROR (("malloc: %s", strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+
+  memset (resolve, '\0', (sizeof (struct ipmipower_connection_resolve) * host_count));
+
+  if (cmd_args.shared_socket)
+    {
+      if (!(shared_hash = hash_create (host_count,
+                                       _connection_shared_hash_key,
+                                       _connection_shared_hash_cmp,
+                                       NULL)))
+        {
+          IPMIPOWER_ERROR (("hash_create: %s", strerror (errno)));
+          exit (EXIT_FAILURE);
+        }
+    }
+
   for (i = 0; i < host_count; i++)
     {
       ics[i].ipmi_fd = -1;
       ics[i].ping_fd = -1;
+      ics[i].shared_hash = shared_hash;
     }
  
   if (!(h = fi_hostlist_create (hostname)))
@@ -711,16 +1038,8 @@ ipmipower_connection_array_create (const char *hostname, unsigned int *len)
           /* cleanup only at the end, gather all error outputs for
            * later
            */
-          if (_connection_setup (&ics[index], h2str) < 0)
-            {
-              if (errno == EMFILE && !emfilecount)
-                {
-                  IPMIPOWER_DEBUG (("file descriptor limit reached"));
-                  /* XXX return -1? */
-                  emfilecount++;
-                }
-              errflag++;
-            }
+          if (_connection_setup (&ics[index], &resolve[index], h2str) < 0)
+            errflag++;
           
           free (h2str);
           h2str = NULL;
@@ -735,7 +1054,32 @@ ipmipower_connection_array_create (const char *hostname, unsigned int *len)
       hstr = NULL;
     }
 
+  _connection_resolve_all (ics, resolve, index);
+
+  for (i = 0; i < index; i++)
+    {
+      if (!resolve[i].valid)
+        continue;
+
+      if (_connection_setup_socket (&ics[i], &resolve[i], shared_hash) < 0)
+        {
+          if (errno == EMFILE && !emfilecount)
+            {
+              IPMIPOWER_DEBUG (("file descriptor limit reached"));
+              /* XXX return -1? */
+              emfilecount++;
+            }
+          errflag++;
+        }
+    }
+
  cleanup:
+  for (i = 0; i < host_count; i++)
+    {
+      if (resolve[i].ai_res)
+        freeaddrinfo (resolve[i].ai_res);
+    }
+  free (resolve);
   fi_hostlist_iterator_destroy (h2itr);
   fi_hostlist_destroy (h2);
   fi_hostlist_iterator_destroy (hitr);
@@ -748,10 +1092,7 @@ ipmipower_connection_array_create (const char *hostname, unsigned int *len)
       int i;
       for (i = 0; i < index; i++)
         {
-          /* ignore potential error, error path */
-          close (ics[i].ipmi_fd);
-          /* ignore potential error, error path */
-          close (ics[i].ping_fd);
+          _connection_close_fds (&ics[i]);
           if (ics[i].ipmi_in)
             cbuf_destroy (ics[i].ipmi_in);
           if (ics[i].ipmi_out)
@@ -778,6 +1119,8 @@ ipmipower_connection_array_create (const char *hostname, unsigned int *len)
                 }
             }
         }
+      if (shared_hash)
+        hash_destroy (shared_hash);
       free (ics);
       return (NULL);
     }
@@ -795,12 +1138,13 @@ ipmipower_connection_array_destroy (struct ipmipower_connection *ics,
   if (!ics)
     return;
 
+  /* common to all connections in the array */
+  if (ics_len && ics[0].shared_hash)
+    hash_destroy (ics[0].shared_hash);
+
   for (i = 0; i < ics_len; i++)
     {
-      /* ignore potential error, cleanup path */
-      close (ics[i].ipmi_fd);
-      /* ignore potential error, cleanup path */
-      close (ics[i].ping_fd);
+      _connection_close_fds (&ics[i]);
       cbuf_destroy (ics[i].ipmi_in);
       cbuf_destroy (ics[i].ipmi_out);
       cbuf_destroy (ics[i].ping_in);
@@ -844,3 +1188,35 @@ ipmipower_connection_hostname_index (struct ipmipower_connection *ics,
   IPMIPOWER_DEBUG (("host = %s not found", hostname));
   return (-1);
 }
+
+unsigned int
+ipmipower_connection_shared_fds (int *fds, unsigned int fdslen)
+{
+  unsigned int count = 0;
+
+  assert (fds);
+
+  if (shared_fd_inet >= 0 && count < fdslen)
+    fds[count++] = shared_fd_inet;
+  if (shared_fd_inet6 >= 0 && count < fdslen)
+    fds[count++] = shared_fd_inet6;
+
+  return (count);
+}
+
+struct ipmipower_connection *
+ipmipower_connection_shared_find (struct ipmipower_connection *ics,
+                                  unsigned int ics_len,
+                                  struct sockaddr *addr)
+{
+  assert (addr);
+
+  if (!ics || !ics_len || !ics[0].shared_hash)
+    return (NULL);
+
+  if (addr->sa_family != AF_INET
+      && addr->sa_family != AF_INET6)
+    return (NULL);
+
+  return ((struct ipmipower_connection *)hash_find (ics[0].shared_hash, addr));
+}
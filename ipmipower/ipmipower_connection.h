@@ -55,4 +55,19 @@ int ipmipower_connection_hostname_index (struct ipmipower_connection *ics,
                                          unsigned int ics_len,
                                          const char *hostname);
 
+/* ipmipower_connection_shared_fds
+ * - Get shared sockets created for the shared socket option
+ * - Returns number of sockets stored in fds
+ */
+unsigned int ipmipower_connection_shared_fds (int *fds, unsigned int fdslen);
+
+/* ipmipower_connection_shared_find
+ * - Find ics entry using a shared socket with the given remote
+ *   address and port
+ * - Returns pointer to entry, NULL if not found
+ */
+struct ipmipower_connection *ipmipower_connection_shared_find (struct ipmipower_connection *ics,
+                                                               unsigned int ics_len,
+                                                               struct sockaddr *addr);
+
 #endif /* IPMIPOWER_CONNECTION_H */
@@ -60,6 +60,7 @@
 #include "ipmipower_output.h"
 #include "ipmipower_powercmd.h"
 #include "ipmipower_packet.h"
+#include "ipmipower_schedule.h"
 #include "ipmipower_check.h"
 #include "ipmipower_util.h"
 
@@ -392,6 +393,7 @@ ipmipower_powercmd_queue (ipmipower_power_cmd_t cmd,
   ip->wait_until_off_state = 0;
 
   ip->ic = ic;
+  ip->stage = ipmipower_schedule_queue (ic->hostname);
 
   if (!(ip->obj_rmcp_hdr_rq = fiid_obj_create (tmpl_rmcp_hdr)))
     {
@@ -736,6 +738,8 @@ _send_packet (ipmipower_powercmd_t ip, ipmipower_packet_type_t pkt)
   if (dropped)
     IPMIPOWER_DEBUG (("cbuf_write: dropped %d bytes", dropped));
 
+  ipmipower_schedule_packet_sent ();
+
   if (cmd_args.common_args.driver_type == IPMI_DEVICE_LAN
       && cmd_args.common_args.authentication_type == IPMI_AUTHENTICATION_TYPE_STRAIGHT_PASSWORD_KEY)
     secure_memset (buf, '\0', IPMIPOWER_PACKET_BUFLEN);
@@ -1377,6 +1381,13 @@ _retry_packets (ipmipower_powercmd_t ip)
 
   ip->retransmission_count++;
 
+  /* Status polls while waiting on a power state are not lost packets */
+  if (!((ip->wait_until_on_state
+         && ip->cmd == IPMIPOWER_POWER_CMD_POWER_ON)
+        || (ip->wait_until_off_state
+            && ip->cmd == IPMIPOWER_POWER_CMD_POWER_OFF)))
+    ipmipower_schedule_packet_retransmitted ();
+
   IPMIPOWER_DEBUG (("host = %s; p = %d; Sending retry, retry count=%d",
                     ip->ic->hostname,
                     ip->protocol_state,
@@ -1409,9 +1420,18 @@ _retry_packets (ipmipower_powercmd_t ip)
          * store the old file descriptrs (which are bound to the old
          * ports) on a list, and close all of them after we have gotten
          * past the Get Session Challenge phase of the protocol.
+         *
+         * A shared socket cannot change its source port, so the
+         * workaround is not possible with the shared socket option.
          */
         int new_fd, *old_fd;
 
+        if (ip->ic->shared)
+          {
+            _send_packet (ip, IPMIPOWER_PACKET_TYPE_GET_SESSION_CHALLENGE_RQ);
+            break;
+          }
+
         if ((new_fd = socket (ip->ic->srcaddr->sa_family, SOCK_DGRAM, 0)) < 0)
           {
             if (errno != EMFILE)
@@ -1900,6 +1920,13 @@ _process_ipmi_packets (ipmipower_powercmd_t ip)
           && (executing_count >= cmd_args.common_args.fanout))
         return (cmd_args.common_args.session_timeout);
 
+      /* Don't execute if the command's stage hasn't begun or the rate
+       * limit has been reached.  ipmipower_powercmd_process_pending()
+       * shortens the timeout to when it may start.
+       */
+      if (!ipmipower_schedule_start (ip->stage))
+        return (cmd_args.common_args.session_timeout);
+
       _send_packet (ip, IPMIPOWER_PACKET_TYPE_AUTHENTICATION_CAPABILITIES_RQ);
 
       if (gettimeofday (&(ip->time_begin), NULL) < 0)
@@ -2407,6 +2434,7 @@ ipmipower_powercmd_process_pending (int *timeout)
   ListIterator itr;
   ipmipower_powercmd_t ip;
   int min_timeout = cmd_args.common_args.session_timeout;
+  int schedule_timeout;
   int num_pending;
 
   assert (pending);  /* did not run ipmipower_powercmd_setup() */
@@ -2446,6 +2474,8 @@ ipmipower_powercmd_process_pending (int *timeout)
                 }
             }
 
+          ipmipower_schedule_complete (ip->stage, &(ip->time_begin));
+
           if (!list_delete (itr))
             {
               IPMIPOWER_ERROR (("list_delete"));
@@ -2498,6 +2528,10 @@ ipmipower_powercmd_process_pending (int *timeout)
         min_timeout = cmd_args.common_args.retransmission_timeout;
     } 
 
+  if ((schedule_timeout = ipmipower_schedule_timeout ()) >= 0
+      && schedule_timeout < min_timeout)
+    min_timeout = schedule_timeout;
+
   if (!(num_pending = list_count (pending)))
     ipmipower_output_finish ();
 
@@ -0,0 +1,573 @@
+/*****************************************************************************\
+ *  Copyright (C) 2007-2015 Lawrence Livermore National Security, LLC.
+ *  Copyright (C) 2003-2007 The Regents of the University of California.
+ *  Produced at Lawrence Livermore National Laboratory (cf, DISCLAIMER).
+ *  Written by Albert Chu <chu11@llnl.gov>
+ *  UCRL-CODE-155698
+ *
+ *  This file is part of Ipmipower, a remote power control utility.
+ *  For details, see http://www.llnl.gov/linux/.
+ *
+ *  Ipmipower is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  Ipmipower is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Ipmipower.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#if STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#if TIME_WITH_SYS_TIME
+#include <sys/time.h>
+#include <time.h>
+#else  /* !TIME_WITH_SYS_TIME */
+#if HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else /* !HAVE_SYS_TIME_H */
+#include <time.h>
+#endif  /* !HAVE_SYS_TIME_H */
+#endif /* !TIME_WITH_SYS_TIME */
+#include <errno.h>
+
+#include "ipmipower_schedule.h"
+#include "ipmipower_error.h"
+
+#include "freeipmi-portability.h"
+#include "fi_hostlist.h"
+#include "timeval.h"
+
+extern struct ipmipower_arguments cmd_args;
+
+#define IPMIPOWER_SCHEDULE_UNGROUPED_STR   "ungrouped"
+#define IPMIPOWER_SCHEDULE_ALL_STR       "all"
+
+/* Retransmissions are sampled over this many milliseconds.  If at
+ * least IPMIPOWER_SCHEDULE_RETRANSMIT_HIGH percent of the packets
+ * sent were retransmissions, the rate is halved.  If at most
+ * IPMIPOWER_SCHEDULE_RETRANSMIT_LOW percent were, it is raised by a
+ * tenth of the rate limit.  Samples of fewer packets are ignored.
+ */
+#define IPMIPOWER_SCHEDULE_WINDOW            1000
+#define IPMIPOWER_SCHEDULE_WINDOW_MIN_SENT   20
+#define IPMIPOWER_SCHEDULE_RETRANSMIT_HIGH   10
+#define IPMIPOWER_SCHEDULE_RETRANSMIT_LOW    2
+
+/* Burst allowed by the rate limit, in milliseconds worth of rate */
+#define IPMIPOWER_SCHEDULE_BURST             100
+
+struct ipmipower_stage
+{
+  char *name;
+  fi_hostlist_t hosts;
+  /* commands queued but not yet completed */
+  unsigned int outstanding;
+  unsigned int completed;
+  struct timeval start;
+  uint64_t latency_total;
+  unsigned int latency_max;
+};
+
+static struct ipmipower_stage *stages = NULL;
+static unsigned int stages_len = 0;
+
+static int scheduling = 0;
+
+/* commands queued but not yet started */
+static unsigned int waiting = 0;
+
+static int stage_active = 0;
+static unsigned int current_stage = 0;
+static struct timeval next_stage_start;
+
+static unsigned int current_rate = 0;
+static double tokens = 0;
+static struct timeval tokens_last;
+
+static struct timeval window_start;
+static unsigned int window_sent = 0;
+static unsigned int window_retransmitted = 0;
+
+static void
+_gettimeofday (struct timeval *tv)
+{
+  assert (tv);
+
+  if (gettimeofday (tv, NULL) < 0)
+    {
+      IPMIPOWER_ERROR (("gettimeofday: %s", strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+}
+
+static struct ipmipower_stage *
+_stage_add (const char *name)
+{
+  struct ipmipower_stage *tmp;
+  struct ipmipower_stage *s;
+
+  assert (name);
+
+  if (!(tmp = realloc (stages, (stages_len + 1) * sizeof (struct ipmipower_stage))))
+    {
+      IPMIPOWER_ERROR (("realloc: %s", strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+  stages = tmp;
+
+  s = &stages[stages_len];
+  memset (s, '\0', sizeof (struct ipmipower_stage));
+
+  if (!(s->name = strdup (name)))
+    {
+      IPMIPOWER_ERROR (("strdup: %s", strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+
+  if (!(s->hosts = fi_hostlist_create (NULL)))
+    {
+      IPMIPOWER_ERROR (("fi_hostlist_create: %s", strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+
+  stages_len++;
+  return (s);
+}
+
+/* Each line of the group map is a group name followed by the hosts
+ * in the group, in hostrange format, separated by whitespace.  A
+ * group may be listed on multiple lines.
+ */
+static void
+_group_map_parse (const char *filename)
+{
+  FILE *fp;
+  char *line = NULL;
+  size_t n = 0;
+  unsigned int lineno = 0;
+
+  assert (filename);
+
+  if (!(fp = fopen (filename, "r")))
+    {
+      IPMIPOWER_ERROR (("group map '%s': %s", filename, strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+
+  while (getline (&line, &n, fp) >= 0)
+    {
+      struct ipmipower_stage *s = NULL;
+      char *ptr, *name, *hosts;
+      unsigned int i;
+
+      lineno++;
+
+      if ((ptr = strchr (line, '#')))
+        *ptr = '\0';
+
+      if (!(name = strtok_r (line, " \t\r\n", &ptr)))
+        continue;
+
+      for (i = 0; i < stages_len; i++)
+        {
+          if (!strcmp (stages[i].name, name))
+            {
+              s = &stages[i];
+              break;
+            }
+        }
+
+      if (!(hosts = strtok_r (NULL, " \t\r\n", &ptr)))
+        {
+          IPMIPOWER_ERROR (("group map '%s': line %u: no hosts for group '%s'",
+                            filename,
+                            lineno,
+                            name));
+          exit (EXIT_FAILURE);
+        }
+
+      if (!s)
+        s = _stage_add (name);
+
+      do
+        {
+          if (!fi_hostlist_push (s->hosts, hosts))
+            {
+              IPMIPOWER_ERROR (("group map '%s': line %u: invalid hosts '%s'",
+                                filename,
+                                lineno,
+                                hosts));
+              exit (EXIT_FAILURE);
+            }
+        } while ((hosts = strtok_r (NULL, " \t\r\n", &ptr)));
+    }
+
+  if (ferror (fp))
+    {
+      IPMIPOWER_ERROR (("group map '%s': %s", filename, strerror (errno)));
+      exit (EXIT_FAILURE);
+    }
+
+  free (line);
+  fclose (fp);
+}
+
+void
+ipmipower_schedule_setup ()
+{
+  assert (!stages);  /* need to cleanup first! */
+
+  if (cmd_args.group_map)
+    _group_map_parse (cmd_args.group_map);
+
+  /* Hosts not in the group map, or all hosts if there is none */
+  _stage_add (cmd_args.group_map ? IPMIPOWER_SCHEDULE_UNGROUPED_STR : IPMIPOWER_SCHEDULE_ALL_STR);
+
+  scheduling = (cmd_args.rate_limit || cmd_args.group_map) ? 1 : 0;
+
+  waiting = 0;
+  stage_active = 0;
+  current_stage = 0;
+  timeval_clear (&next_stage_start);
+
+  current_rate = cmd_args.rate_limit;
+  tokens = 0;
+  _gettimeofday (&tokens_last);
+
+  window_start = tokens_last;
+  window_sent = 0;
+  window_retransmitted = 0;
+}
+
+void
+ipmipower_schedule_cleanup ()
+{
+  unsigned int i;
+
+  assert (stages);  /* did not run ipmipower_schedule_setup() */
+
+  for (i = 0; i < stages_len; i++)
+    {
+      free (stages[i].name);
+      fi_hostlist_destroy (stages[i].hosts);
+    }
+  free (stages);
+  stages = NULL;
+  stages_len = 0;
+}
+
+unsigned int
+ipmipower_schedule_queue (const char *hostname)
+{
+  unsigned int i;
+
+  assert (stages);  /* did not run ipmipower_schedule_setup() */
+  assert (hostname);
+
+  /* last stage is for hosts not in the group map */
+  for (i = 0; i < stages_len - 1; i++)
+    {
+      if (fi_hostlist_find (stages[i].hosts, hostname) >= 0)
+        break;
+    }
+
+  stages[i].outstanding++;
+  waiting++;
+  return (i);
+}
+
+static unsigned int
+_burst (void)
+{
+  unsigned int burst;
+
+  burst = (current_rate * IPMIPOWER_SCHEDULE_BURST) / 1000;
+  return (burst ? burst : 1);
+}
+
+/* Adapt the rate to the retransmissions seen over the last window and
+ * refill the tokens for the time passed.
+ */
+static void
+_rate_update (struct timeval *now)
+{
+  struct timeval delta;
+  unsigned int ms;
+
+  assert (now);
+  assert (cmd_args.rate_limit);
+
+  timeval_sub (now, &window_start, &delta);
+  timeval_millisecond_calc (&delta, &ms);
+
+  if (ms >= IPMIPOWER_SCHEDULE_WINDOW)
+    {
+      if (window_sent >= IPMIPOWER_SCHEDULE_WINDOW_MIN_SENT)
+        {
+          unsigned int percent = (window_retransmitted * 100) / window_sent;
+
+          if (percent >= IPMIPOWER_SCHEDULE_RETRANSMIT_HIGH
+              && current_rate > 1)
+            {
+              current_rate /= 2;
+              IPMIPOWER_DEBUG (("%u%% retransmissions, rate reduced to %u", percent, current_rate));
+            }
+          else if (percent <= IPMIPOWER_SCHEDULE_RETRANSMIT_LOW
+                   && current_rate < cmd_args.rate_limit)
+            {
+              unsigned int increase = cmd_args.rate_limit / 10;
+
+              current_rate += increase ? increase : 1;
+              if (current_rate > cmd_args.rate_limit)
+                current_rate = cmd_args.rate_limit;
+              IPMIPOWER_DEBUG (("%u%% retransmissions, rate raised to %u", percent, current_rate));
+            }
+        }
+
+      window_start = *now;
+      window_sent = 0;
+      window_retransmitted = 0;
+    }
+
+  if (timeval_gt (now, &tokens_last))
+    {
+      timeval_sub (now, &tokens_last, &delta);
+      tokens += ((double)delta.tv_sec + (double)delta.tv_usec / 1000000.0) * current_rate;
+      if (tokens > _burst ())
+        tokens = _burst ();
+    }
+  tokens_last = *now;
+}
+
+int
+ipmipower_schedule_start (unsigned int stage)
+{
+  struct timeval now;
+
+  assert (stages);  /* did not run ipmipower_schedule_setup() */
+  assert (stage < stages_len);
+
+  if (!scheduling)
+    {
+      waiting--;
+      return (1);
+    }
+
+  _gettimeofday (&now);
+
+  if (!stage_active)
+    {
+      unsigned int i;
+
+      if (timeval_lt (&now, &next_stage_start))
+        return (0);
+
+      for (i = 0; i < stages_len; i++)
+        {
+          if (stages[i].outstanding)
+            break;
+        }
+      assert (i < stages_len);
+
+      current_stage = i;
+      stages[i].start = now;
+      stage_active = 1;
+    }
+
+  /* commands queued to an earlier stage while a later one is running
+   * are let through
+   */
+  if (stage > current_stage)
+    return (0);
+
+  if (cmd_args.rate_limit)
+    {
+      _rate_update (&now);
+
+      if (tokens < 1)
+        return (0);
+      tokens -= 1;
+    }
+
+  waiting--;
+  return (1);
+}
+
+/* Commands queued to an earlier stage while the current one ran are
+ * reported as part of the current one.
+ */
+static void
+_stage_report (struct timeval *now)
+{
+  struct ipmipower_stage *s;
+  struct timeval delta;
+  unsigned int completed = 0;
+  uint64_t latency_total = 0;
+  unsigned int latency_max = 0;
+  unsigned int ms;
+  unsigned int i;
+
+  assert (now);
+
+  s = &stages[current_stage];
+
+  for (i = 0; i <= current_stage; i++)
+    {
+      completed += stages[i].completed;
+      latency_total += stages[i].latency_total;
+      if (stages[i].latency_max > latency_max)
+        latency_max = stages[i].latency_max;
+    }
+
+  if (!completed)
+    return;
+
+  timeval_sub (now, &(s->start), &delta);
+  timeval_millisecond_calc (&delta, &ms);
+
+  if (cmd_args.rate_limit)
+    ipmipower_debug ("stage %s: %u commands completed in %u ms; latency avg %u ms, max %u ms; rate %u/s",
+                     s->name,
+                     completed,
+                     ms,
+                     (unsigned int)(latency_total / completed),
+                     latency_max,
+                     current_rate);
+  else
+    ipmipower_debug ("stage %s: %u commands completed in %u ms; latency avg %u ms, max %u ms",
+                     s->name,
+                     completed,
+                     ms,
+                     (unsigned int)(latency_total / completed),
+                     latency_max);
+}
+
+void
+ipmipower_schedule_complete (unsigned int stage, struct timeval *time_begin)
+{
+  struct ipmipower_stage *s;
+  struct timeval now, delta;
+  unsigned int latency;
+  unsigned int i;
+
+  assert (stages);  /* did not run ipmipower_schedule_setup() */
+  assert (stage < stages_len);
+  assert (time_begin);
+  assert (stages[stage].outstanding);
+
+  s = &stages[stage];
+  s->outstanding--;
+
+  if (!scheduling)
+    return;
+
+  _gettimeofday (&now);
+
+  timeval_sub (&now, time_begin, &delta);
+  timeval_millisecond_calc (&delta, &latency);
+
+  s->completed++;
+  s->latency_total += latency;
+  if (latency > s->latency_max)
+    s->latency_max = latency;
+
+  /* The last outstanding command of the current stage may belong to
+   * an earlier stage, since those are let through while a later stage
+   * runs.  The stage is done once it and every earlier stage are idle.
+   */
+  if (!stage_active || stage > current_stage)
+    return;
+
+  for (i = 0; i <= current_stage; i++)
+    {
+      if (stages[i].outstanding)
+        return;
+    }
+
+  _stage_report (&now);
+
+  for (i = 0; i < stages_len; i++)
+    {
+      stages[i].completed = 0;
+      stages[i].latency_total = 0;
+      stages[i].latency_max = 0;
+    }
+
+  stage_active = 0;
+
+  for (i = current_stage + 1; i < stages_len; i++)
+    {
+      if (stages[i].outstanding)
+        break;
+    }
+
+  if (i < stages_len)
+    timeval_add_ms (&now, cmd_args.stage_delay, &next_stage_start);
+  else
+    timeval_clear (&next_stage_start);
+}
+
+void
+ipmipower_schedule_packet_sent ()
+{
+  window_sent++;
+}
+
+void
+ipmipower_schedule_packet_retransmitted ()
+{
+  window_retransmitted++;
+}
+
+int
+ipmipower_schedule_timeout ()
+{
+  struct timeval now, delta;
+  unsigned int ms;
+
+  assert (stages);  /* did not run ipmipower_schedule_setup() */
+
+  if (!scheduling || !waiting)
+    return (-1);
+
+  _gettimeofday (&now);
+
+  if (!stage_active)
+    {
+      if (!timeval_lt (&now, &next_stage_start))
+        return (0);
+
+      timeval_sub (&next_stage_start, &now, &delta);
+      timeval_millisecond_calc (&delta, &ms);
+      return (ms);
+    }
+
+  if (cmd_args.rate_limit)
+    {
+      _rate_update (&now);
+
+      if (tokens < 1)
+        {
+          /* round up, so the poll doesn't wake up early and spin */
+          ms = (unsigned int)(((1 - tokens) * 1000) / current_rate) + 1;
+          return (ms);
+        }
+    }
+
+  return (-1);
+}
@@ -0,0 +1,82 @@
+/*****************************************************************************\
+ *  Copyright (C) 2007-2015 Lawrence Livermore National Security, LLC.
+ *  Copyright (C) 2003-2007 The Regents of the University of California.
+ *  Produced at Lawrence Livermore National Laboratory (cf, DISCLAIMER).
+ *  Written by Albert Chu <chu11@llnl.gov>
+ *  UCRL-CODE-155698
+ *
+ *  This file is part of Ipmipower, a remote power control utility.
+ *  For details, see http://www.llnl.gov/linux/.
+ *
+ *  Ipmipower is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by the
+ *  Free Software Foundation; either version 3 of the License, or (at your
+ *  option) any later version.
+ *
+ *  Ipmipower is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ *  or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ *  for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Ipmipower.  If not, see <http://www.gnu.org/licenses/>.
+\*****************************************************************************/
+
+#ifndef IPMIPOWER_SCHEDULE_H
+#define IPMIPOWER_SCHEDULE_H
+
+#include "ipmipower.h"
+
+/* Power command scheduling
+ *
+ * With --group-map, hosts are placed in stages in the order their
+ * groups appear in the map, hosts not listed go in a final stage.
+ * Power commands of a stage are started only after all commands of
+ * the previous stage have completed and --stage-delay has passed.
+ *
+ * With --rate-limit, at most that many power commands are started
+ * per second.  If too many packets are retransmitted, the rate is
+ * halved and is raised again as the retransmissions subside.
+ *
+ * When a stage completes, its completion latency is output.
+ */
+
+void ipmipower_schedule_setup ();
+
+void ipmipower_schedule_cleanup ();
+
+/* ipmipower_schedule_queue
+ * - Account for a power command queued to hostname
+ * Returns the stage of the command
+ */
+unsigned int ipmipower_schedule_queue (const char *hostname);
+
+/* ipmipower_schedule_start
+ * - Determine if a power command in the stage may start now
+ * Returns 1 if the command should start, 0 if not
+ */
+int ipmipower_schedule_start (unsigned int stage);
+
+/* ipmipower_schedule_complete
+ * - Account for a started power command that completed
+ */
+void ipmipower_schedule_complete (unsigned int stage, struct timeval *time_begin);
+
+/* ipmipower_schedule_packet_sent
+ * - Account for a packet sent, for adapting the rate limit
+ */
+void ipmipower_schedule_packet_sent ();
+
+/* ipmipower_schedule_packet_retransmitted
+ * - Account for a packet about to be retransmitted, for adapting the
+ *   rate limit
+ */
+void ipmipower_schedule_packet_retransmitted ();
+
+/* ipmipower_schedule_timeout
+ * - Returns milliseconds until a waiting power command may start, -1
+ *   if none are waiting on the schedule
+ */
+int ipmipower_schedule_timeout ();
+
+#endif /* IPMIPOWER_SCHEDULE_H */
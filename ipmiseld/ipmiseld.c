@@ -55,8 +55,6 @@
 #include "ipmiseld-cache.h"
 #include "ipmiseld-common.h"
 #include "ipmiseld-debug.h"
-#include "ipmiseld-ipmi-communication.h"
-#include "ipmiseld-threadpool.h"
 
 #include "freeipmi-portability.h"
 #include "error.h"
@@ -1298,7 +1296,11 @@ _ipmiseld_poll (void *arg)
   memset (&host_poll, '\0', sizeof (ipmiseld_host_poll_t));
   host_data->host_poll = &host_poll;
 
-  if (ipmiseld_ipmi_setup (host_data) < 0)
+  if (!(host_data->host_poll->ipmi_ctx = ipmi_open_daemon (host_data->hostname,
+                                                           &(host_data->prog_data->args->common_args),
+                                                           host_data->prog_data->args->verbose_count,
+                                                           &(host_data->last_ipmi_errnum),
+                                                           &(host_data->last_ipmi_errnum_count))))
     goto cleanup;
 
   if (!host_data->prog_data->args->ignore_sdr)
@@ -1646,9 +1648,9 @@ _ipmiseld (ipmiseld_prog_data_t *prog_data)
       host = NULL;
     }
 
-  if (ipmiseld_threadpool_init (prog_data,
-                                _ipmiseld_poll,
-                                _ipmiseld_poll_postprocess) < 0)
+  if (daemon_threadpool_init (prog_data->args->threadpool_count,
+                              _ipmiseld_poll,
+                              _ipmiseld_poll_postprocess) < 0)
     goto cleanup;
 
   if (prog_data->args->test_run)
@@ -1707,7 +1709,7 @@ _ipmiseld (ipmiseld_prog_data_t *prog_data)
               continue;
             }
               
-          if (ipmiseld_threadpool_queue (host_data) < 0)
+          if (daemon_threadpool_queue (host_data) < 0)
             {
               pthread_mutex_lock (&host_data_heap_lock);
 
@@ -1745,7 +1747,7 @@ _ipmiseld (ipmiseld_prog_data_t *prog_data)
   
   rv = 0;
  cleanup:
-  ipmiseld_threadpool_destroy ();
+  daemon_threadpool_destroy ();
   heap_destroy (host_data_heap);
   fi_hostlist_iterator_destroy (hitr);
   fi_hostlist_destroy (hlist);
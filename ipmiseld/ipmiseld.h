@@ -67,8 +67,6 @@
 
 #define IPMISELD_THREADPOOL_COUNT                                       8
 
-#define IPMISELD_ERROR_OUTPUT_LIMIT                                     20
-
 enum ipmiseld_argp_option_keys
   {
     IPMISELD_VERBOSE_KEY = 'v',
@@ -0,0 +1,325 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#if STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+#if HAVE_ARGP_H
+#include <argp.h>
+#else /* !HAVE_ARGP_H */
+#include "freeipmi-argp.h"
+#endif /* !HAVE_ARGP_H */
+#include <sys/un.h>
+#include <assert.h>
+#include <errno.h>
+
+#include "ipmisensorsd.h"
+#include "ipmisensorsd-argp.h"
+
+#include "freeipmi-portability.h"
+#include "tool-cmdline-common.h"
+#include "tool-config-file-common.h"
+#include "error.h"
+
+const char *argp_program_version =
+  "ipmisensorsd - " PACKAGE_VERSION "\n"
+  "Copyright (C) 2003-2015 FreeIPMI Core Team\n"
+  "This program is free software; you may redistribute it under the terms of\n"
+  "the GNU General Public License.  This program has absolutely no warranty.";
+
+const char *argp_program_bug_address =
+  "<" PACKAGE_BUGREPORT ">";
+
+static char cmdline_doc[] =
+  "ipmisensorsd - IPMI sensor exporter daemon";
+
+static char cmdline_args_doc[] = "";
+
+static struct argp_option cmdline_options[] =
+  {
+    ARGP_COMMON_OPTIONS_DRIVER,
+    ARGP_COMMON_OPTIONS_INBAND,
+    ARGP_COMMON_OPTIONS_OUTOFBAND_HOSTRANGED,
+    ARGP_COMMON_OPTIONS_AUTHENTICATION_TYPE,
+    ARGP_COMMON_OPTIONS_CIPHER_SUITE_ID,
+    ARGP_COMMON_OPTIONS_PRIVILEGE_LEVEL,
+    ARGP_COMMON_OPTIONS_CONFIG_FILE,
+    ARGP_COMMON_OPTIONS_WORKAROUND_FLAGS,
+    ARGP_COMMON_OPTIONS_DEBUG,
+    ARGP_COMMON_OPTIONS_PACKET_TRACE,
+    { "verbose", IPMISENSORSD_VERBOSE_KEY, 0, 0,
+      "Increase verbosity in output.", 40},
+    { "sensor-types", IPMISENSORSD_SENSOR_TYPES_KEY, "SENSOR-TYPES-LIST", 0,
+      "Export sensors of a specific type.", 41},
+    { "exclude-sensor-types", IPMISENSORSD_EXCLUDE_SENSOR_TYPES_KEY, "SENSOR-TYPES-LIST", 0,
+      "Do not export sensors of a specific type.", 42},
+    { "sensor-state-config-file", IPMISENSORSD_SENSOR_STATE_CONFIG_FILE_KEY, "FILE", 0,
+      "Specify an alternate sensor state configuration file.", 43},
+    { "interpret-oem-data", IPMISENSORSD_INTERPRET_OEM_DATA_KEY, NULL, 0,
+      "Attempt to interpret OEM data.", 44},
+    { "entity-sensor-names", IPMISENSORSD_ENTITY_SENSOR_NAMES_KEY, NULL, 0,
+      "Output sensor names with entity ids and instances.", 45},
+    { "non-abbreviated-units", IPMISENSORSD_NON_ABBREVIATED_UNITS_KEY, 0, 0,
+      "Output non-abbreviated units (e.g. 'Amps' instead of 'A').", 46},
+    { "poll-interval", IPMISENSORSD_POLL_INTERVAL_KEY, "SECONDS", 0,
+      "Specify poll interval to read sensors on each host.", 47},
+    { "cache-directory", IPMISENSORSD_CACHE_DIRECTORY_KEY, "DIRECTORY", 0,
+      "Specify alternate SDR cache directory.", 48},
+    { "socket", IPMISENSORSD_SOCKET_KEY, "PATH", 0,
+      "Specify alternate UNIX socket path readings are served on.", 49},
+    { "threadpool-count", IPMISENSORSD_THREADPOOL_COUNT_KEY, "NUM", 0,
+      "Specify threadpool count for parallel sensor polling.", 50},
+    { "test-run", IPMISENSORSD_TEST_RUN_KEY, 0, 0,
+      "Do not daemonize, output current readings as test of current settings.", 51},
+    { "foreground", IPMISENSORSD_FOREGROUND_KEY, 0, 0,
+      "Run daemon in foreground.", 52},
+    { NULL, 0, NULL, 0, NULL, 0}
+  };
+
+static error_t cmdline_parse (int key, char *arg, struct argp_state *state);
+
+static struct argp cmdline_argp = { cmdline_options,
+                                    cmdline_parse,
+                                    cmdline_args_doc,
+                                    cmdline_doc };
+
+static struct argp cmdline_config_file_argp = { cmdline_options,
+                                                cmdline_config_file_parse,
+                                                cmdline_args_doc,
+                                                cmdline_doc };
+
+static error_t
+cmdline_parse (int key, char *arg, struct argp_state *state)
+{
+  struct ipmisensorsd_arguments *cmd_args;
+  char *endptr;
+  int tmp;
+
+  assert (state);
+  
+  cmd_args = state->input;
+
+  switch (key)
+    {
+    case IPMISENSORSD_VERBOSE_KEY:
+      cmd_args->verbose_count++;
+      break;
+    case IPMISENSORSD_SENSOR_TYPES_KEY:
+      if (parse_sensor_types (SENSOR_PARSE_ALL_STRING,
+                              cmd_args->sensor_types,
+                              &(cmd_args->sensor_types_length),
+                              arg) < 0)
+        exit (EXIT_FAILURE);
+      break;
+    case IPMISENSORSD_EXCLUDE_SENSOR_TYPES_KEY:
+      if (parse_sensor_types (SENSOR_PARSE_NONE_STRING,
+                              cmd_args->exclude_sensor_types,
+                              &(cmd_args->exclude_sensor_types_length),
+                              arg) < 0)
+        exit (EXIT_FAILURE);
+      break;
+    case IPMISENSORSD_SENSOR_STATE_CONFIG_FILE_KEY:
+      if (!(cmd_args->sensor_state_config_file = strdup (arg)))
+        {
+          perror ("strdup");
+          exit (EXIT_FAILURE);
+        }
+      break;
+    case IPMISENSORSD_INTERPRET_OEM_DATA_KEY:
+      cmd_args->interpret_oem_data = 1;
+      break;
+    case IPMISENSORSD_ENTITY_SENSOR_NAMES_KEY:
+      cmd_args->entity_sensor_names = 1;
+      break;
+    case IPMISENSORSD_NON_ABBREVIATED_UNITS_KEY:
+      cmd_args->non_abbreviated_units = 1;
+      break;
+    case IPMISENSORSD_POLL_INTERVAL_KEY:
+      errno = 0;
+      tmp = strtol (arg, &endptr, 0);
+      if (errno
+          || endptr[0] != '\0'
+          || tmp <= 0) 
+        {
+          fprintf (stderr, "invalid poll interval\n");
+          exit (EXIT_FAILURE);
+        }
+      cmd_args->poll_interval = tmp;
+      break;
+    case IPMISENSORSD_CACHE_DIRECTORY_KEY:
+      if (!(cmd_args->cache_directory = strdup (arg)))
+        {
+          perror ("strdup");
+          exit (EXIT_FAILURE);
+        }
+      break;
+    case IPMISENSORSD_SOCKET_KEY:
+      if (!(cmd_args->socket_path = strdup (arg)))
+        {
+          perror ("strdup");
+          exit (EXIT_FAILURE);
+        }
+      break;
+    case IPMISENSORSD_THREADPOOL_COUNT_KEY:
+      errno = 0;
+      tmp = strtol (arg, &endptr, 0);
+      if (errno
+          || endptr[0] != '\0'
+          || tmp <= 0) 
+        {
+          fprintf (stderr, "invalid threadpool count\n");
+          exit (EXIT_FAILURE);
+        }
+      cmd_args->threadpool_count = tmp;
+      break;
+    case IPMISENSORSD_TEST_RUN_KEY:
+      cmd_args->test_run = 1;
+      break;
+    case IPMISENSORSD_FOREGROUND_KEY:
+      cmd_args->foreground = 1;
+      break;
+    case ARGP_KEY_ARG:
+      /* Too many arguments. */
+      argp_usage (state);
+      break;
+    case ARGP_KEY_END:
+      break;
+    default:
+      return (common_parse_opt (key, arg, &(cmd_args->common_args)));
+    }
+
+  return (0);
+}
+
+static void
+_ipmisensorsd_config_file_parse (struct ipmisensorsd_arguments *cmd_args)
+{
+  assert (cmd_args);
+
+  /* only the common options are read from the config file */
+  if (config_file_parse (cmd_args->common_args.config_file,
+                         0,
+                         &(cmd_args->common_args),
+                         CONFIG_FILE_INBAND | CONFIG_FILE_OUTOFBAND,
+                         CONFIG_FILE_TOOL_NONE,
+                         NULL) < 0)
+    {
+      fprintf (stderr, "config_file_parse: %s\n", strerror (errno));
+      exit (EXIT_FAILURE);
+    }
+}
+
+static void
+_ipmisensorsd_args_validate (struct ipmisensorsd_arguments *cmd_args)
+{
+  assert (cmd_args);
+
+  if (cmd_args->sensor_types_length)
+    {
+      if (valid_sensor_types (cmd_args->sensor_types,
+                              cmd_args->sensor_types_length) < 0)
+        exit (EXIT_FAILURE);
+    }
+  
+  if (cmd_args->exclude_sensor_types_length)
+    {
+      if (valid_sensor_types (cmd_args->exclude_sensor_types,
+                              cmd_args->exclude_sensor_types_length) < 0)
+        exit (EXIT_FAILURE);
+    }
+
+  if (cmd_args->cache_directory)
+    {
+      if (access (cmd_args->cache_directory, R_OK|W_OK|X_OK) < 0)
+        err_exit ("insufficient permission on cache directory '%s'",
+                  cmd_args->cache_directory);
+    }
+
+  if (cmd_args->socket_path)
+    {
+      struct sockaddr_un addr;
+
+      if (strlen (cmd_args->socket_path) >= sizeof (addr.sun_path))
+        err_exit ("socket path '%s' too long", cmd_args->socket_path);
+    }
+}
+
+void
+ipmisensorsd_argp_parse (int argc, char **argv, struct ipmisensorsd_arguments *cmd_args)
+{
+  unsigned int i;
+
+  assert (argc >= 0);
+  assert (argv);
+  assert (cmd_args);
+  
+  init_common_cmd_args_operator (&(cmd_args->common_args));
+
+  cmd_args->verbose_count = 0;
+
+  for (i = 0; i < MAX_SENSOR_TYPES; i++)
+    memset (cmd_args->sensor_types[i],
+            '\0',
+            MAX_SENSOR_TYPES_STRING_LENGTH+1);
+  cmd_args->sensor_types_length = 0;
+
+  for (i = 0; i < MAX_SENSOR_TYPES; i++)
+    memset (cmd_args->exclude_sensor_types[i],
+            '\0',
+            MAX_SENSOR_TYPES_STRING_LENGTH+1);
+  cmd_args->exclude_sensor_types_length = 0;
+
+  cmd_args->sensor_state_config_file = NULL;
+  cmd_args->interpret_oem_data = 0;
+  cmd_args->entity_sensor_names = 0;
+  cmd_args->non_abbreviated_units = 0;
+  cmd_args->poll_interval = IPMISENSORSD_POLL_INTERVAL_DEFAULT;
+  cmd_args->cache_directory = NULL;
+  cmd_args->socket_path = NULL;
+  cmd_args->threadpool_count = IPMISENSORSD_THREADPOOL_COUNT;
+  cmd_args->test_run = 0;
+  cmd_args->foreground = 0;
+
+  argp_parse (&cmdline_config_file_argp,
+              argc,
+              argv,
+              ARGP_IN_ORDER,
+              NULL,
+              &(cmd_args->common_args));
+
+  _ipmisensorsd_config_file_parse (cmd_args);
+
+  argp_parse (&cmdline_argp,
+              argc,
+              argv,
+              ARGP_IN_ORDER,
+              NULL,
+              cmd_args);
+
+  verify_common_cmd_args (&(cmd_args->common_args));
+  _ipmisensorsd_args_validate (cmd_args);
+}
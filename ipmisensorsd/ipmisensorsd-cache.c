@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#if STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#include <sys/param.h>          /* MAXPATHLEN */
+#include <assert.h>
+#include <errno.h>
+
+#include "ipmisensorsd.h"
+#include "ipmisensorsd-cache.h"
+#include "ipmisensorsd-common.h"
+
+#include "freeipmi-portability.h"
+#include "error.h"
+
+#ifndef MAXPATHLEN
+#define MAXPATHLEN 4096
+#endif /* MAXPATHLEN */
+
+#define IPMISENSORSD_CACHE_INBAND         "localhost"
+
+#define IPMISENSORSD_SDR_CACHE_FILENAME   "ipmisensorsdsdrcache"
+
+static int
+_ipmisensorsd_sdr_cache_create (ipmisensorsd_host_data_t *host_data,
+                                char *filename,
+                                int cache_create_flags)
+{
+  assert (host_data);
+  assert (host_data->session.sdr_ctx);
+  assert (host_data->session.ipmi_ctx);
+  assert (filename && strlen (filename));
+
+  if (ipmi_sdr_cache_create (host_data->session.sdr_ctx,
+                             host_data->session.ipmi_ctx,
+                             filename,
+                             cache_create_flags,
+                             NULL,
+                             NULL) < 0)
+    {
+      if (ipmi_sdr_ctx_errnum (host_data->session.sdr_ctx) == IPMI_SDR_ERR_FILENAME_INVALID
+          || ipmi_sdr_ctx_errnum (host_data->session.sdr_ctx) == IPMI_SDR_ERR_FILESYSTEM
+          || ipmi_sdr_ctx_errnum (host_data->session.sdr_ctx) == IPMI_SDR_ERR_PERMISSION)
+        ipmisensorsd_err_output (host_data,
+                                 "Error creating SDR cache  '%s': %s",
+                                 filename,
+                                 ipmi_sdr_ctx_errormsg (host_data->session.sdr_ctx));
+      else
+        ipmisensorsd_err_output (host_data,
+                                 "ipmi_sdr_cache_create: %s",
+                                 ipmi_sdr_ctx_errormsg (host_data->session.sdr_ctx));
+      return (-1);
+    }
+
+  return (0);
+}
+
+/* The SDR cache stays open for the life of the session, it is only
+ * checked for being out of date when a session is established.
+ */
+int
+ipmisensorsd_sdr_cache_create_and_load (ipmisensorsd_host_data_t *host_data)
+{
+  char filename[MAXPATHLEN+1];
+  char *sdr_cache_dir;
+  char *hostname;
+
+  assert (host_data);
+  assert (host_data->session.ipmi_ctx);
+  assert (!host_data->session.sdr_ctx);
+  
+  memset (filename, '\0', MAXPATHLEN + 1);
+  
+  if (!(host_data->session.sdr_ctx = ipmi_sdr_ctx_create ()))
+    {
+      ipmisensorsd_err_output (host_data, "ipmi_sdr_ctx_create: %s", strerror (errno));
+      goto cleanup;
+    }
+  
+  if (host_data->prog_data->args->foreground
+      && host_data->prog_data->args->common_args.debug > 1)
+    {
+      /* Don't error out, if this fails we can still continue */
+      if (ipmi_sdr_ctx_set_flags (host_data->session.sdr_ctx, IPMI_SDR_FLAGS_DEBUG_DUMP) < 0)
+        ipmisensorsd_err_output (host_data,
+                                 "ipmi_sdr_ctx_set_flags: %s",
+                                 ipmi_sdr_ctx_errormsg (host_data->session.sdr_ctx));
+      
+      if (host_data->hostname)
+        {
+          if (ipmi_sdr_ctx_set_debug_prefix (host_data->session.sdr_ctx, host_data->hostname) < 0)
+            ipmisensorsd_err_output (host_data,
+                                     "ipmi_sdr_ctx_set_debug_prefix: %s",
+                                     ipmi_sdr_ctx_errormsg (host_data->session.sdr_ctx));
+        }
+    }
+  
+  if (host_data->prog_data->args->cache_directory)
+    sdr_cache_dir = host_data->prog_data->args->cache_directory;
+  else
+    sdr_cache_dir = IPMISENSORSD_CACHE_DIRECTORY;
+  
+  hostname = host_data->hostname;
+  if (!hostname)
+    hostname = IPMISENSORSD_CACHE_INBAND;
+  
+  snprintf (filename,
+            MAXPATHLEN,
+            "%s/%s.%s",
+            sdr_cache_dir,
+            IPMISENSORSD_SDR_CACHE_FILENAME,
+            hostname);
+
+  if (ipmi_sdr_cache_open (host_data->session.sdr_ctx,
+                           host_data->session.ipmi_ctx,
+                           filename) < 0)
+    {
+      if (ipmi_sdr_ctx_errnum (host_data->session.sdr_ctx) == IPMI_SDR_ERR_CACHE_READ_CACHE_DOES_NOT_EXIST)
+        {
+          if (_ipmisensorsd_sdr_cache_create (host_data,
+                                              filename,
+                                              IPMI_SDR_CACHE_CREATE_FLAGS_DEFAULT) < 0)
+            goto cleanup;
+        }
+      else if (ipmi_sdr_ctx_errnum (host_data->session.sdr_ctx) == IPMI_SDR_ERR_CACHE_OUT_OF_DATE)
+        {
+          /* the new cache replaces the old one once complete */
+          if (_ipmisensorsd_sdr_cache_create (host_data,
+                                              filename,
+                                              IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE) < 0)
+            goto cleanup;
+        }
+      else if (ipmi_sdr_ctx_errnum (host_data->session.sdr_ctx) == IPMI_SDR_ERR_CACHE_INVALID)
+        {
+          if (ipmi_sdr_cache_delete (host_data->session.sdr_ctx, filename) < 0)
+            {
+              ipmisensorsd_err_output (host_data,
+                                       "ipmi_sdr_cache_delete: %s",
+                                       ipmi_sdr_ctx_errormsg (host_data->session.sdr_ctx));
+              goto cleanup;
+            }
+          
+          if (_ipmisensorsd_sdr_cache_create (host_data,
+                                              filename,
+                                              IPMI_SDR_CACHE_CREATE_FLAGS_DEFAULT) < 0)
+            goto cleanup;
+        }
+      else
+        {
+          ipmisensorsd_err_output (host_data,
+                                   "ipmi_sdr_cache_open: %s",
+                                   ipmi_sdr_ctx_errormsg (host_data->session.sdr_ctx));
+          goto cleanup;
+        }
+      
+      /* 2nd try after the sdr was retrieved */
+      if (ipmi_sdr_cache_open (host_data->session.sdr_ctx,
+                               host_data->session.ipmi_ctx,
+                               filename) < 0)
+        {
+          ipmisensorsd_err_output (host_data,
+                                   "ipmi_sdr_cache_open: %s",
+                                   ipmi_sdr_ctx_errormsg (host_data->session.sdr_ctx));
+          goto cleanup;
+        }
+    }
+  
+  return (0);
+  
+ cleanup:
+  ipmi_sdr_ctx_destroy (host_data->session.sdr_ctx);
+  host_data->session.sdr_ctx = NULL;
+  return (-1);
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#if STDC_HEADERS
+#include <string.h>
+#include <stdarg.h>
+#endif /* STDC_HEADERS */
+#include <assert.h>
+
+#include "ipmisensorsd.h"
+#include "ipmisensorsd-common.h"
+
+#include "freeipmi-portability.h"
+#include "error.h"
+
+#define IPMISENSORSD_ERR_BUFLEN 1024
+
+void
+ipmisensorsd_err_output (ipmisensorsd_host_data_t *host_data,
+                         const char *message,
+                         ...)
+{
+  char buf[IPMISENSORSD_ERR_BUFLEN + 1];
+  va_list ap;
+
+  assert (host_data);
+  assert (message);
+  memset (buf, '\0', IPMISENSORSD_ERR_BUFLEN + 1);
+
+  va_start (ap, message);
+  vsnprintf(buf, IPMISENSORSD_ERR_BUFLEN, message, ap);
+
+  if (!host_data->hostname)
+    err_output ("%s", buf);
+  else
+    err_output ("%s: %s", host_data->hostname, buf);
+  va_end (ap);
+}
@@ -0,0 +1,781 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#if STDC_HEADERS
+#include <string.h>
+#include <stdarg.h>
+#endif /* STDC_HEADERS */
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#if TIME_WITH_SYS_TIME
+#include <sys/time.h>
+#include <time.h>
+#else /* !TIME_WITH_SYS_TIME */
+#if HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else /* !HAVE_SYS_TIME_H */
+#include <time.h>
+#endif /* !HAVE_SYS_TIME_H */
+#endif /* !TIME_WITH_SYS_TIME */
+#include <poll.h>
+#include <signal.h>
+#include <pthread.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <freeipmi/freeipmi.h>
+
+#include "ipmisensorsd.h"
+#include "ipmisensorsd-server.h"
+
+#include "freeipmi-portability.h"
+#include "error.h"
+#include "fd.h"
+
+#define IPMISENSORSD_SOCKET_DEFAULT      IPMISENSORSD_LOCALSTATEDIR "/run/ipmisensorsd.sock"
+
+#define IPMISENSORSD_LISTEN_BACKLOG      16
+
+/* clients served at once, further connections wait in the backlog */
+#define IPMISENSORSD_CLIENTS_MAX         32
+
+/* in milliseconds */
+#define IPMISENSORSD_POLL_TIMEOUT        1000
+
+/* in milliseconds, how long a client may take to speak first */
+#define IPMISENSORSD_REQUEST_TIMEOUT     250
+
+/* in milliseconds, how long a client may take to read the response */
+#define IPMISENSORSD_RESPONSE_TIMEOUT    10000
+
+#define IPMISENSORSD_REQUEST_BUFLEN      1024
+
+#define IPMISENSORSD_RENDER_BUFLEN_INIT  65536
+
+#define IPMISENSORSD_HTTP_HEADER \
+  "HTTP/1.0 200 OK\r\n" \
+  "Content-Type: text/plain; version=0.0.4\r\n" \
+  "Connection: close\r\n" \
+  "\r\n"
+
+struct ipmisensorsd_render_buf
+{
+  char *buf;
+  unsigned int buflen;
+  unsigned int bufsize;
+};
+
+typedef enum
+  {
+    IPMISENSORSD_CLIENT_UNUSED = 0,
+    IPMISENSORSD_CLIENT_REQUEST = 1,
+    IPMISENSORSD_CLIENT_RESPONSE = 2,
+  } ipmisensorsd_client_state_t;
+
+struct ipmisensorsd_client
+{
+  int fd;
+  ipmisensorsd_client_state_t state;
+  uint64_t deadline;            /* milliseconds */
+  char request[IPMISENSORSD_REQUEST_BUFLEN];
+  unsigned int request_len;
+  char *response;
+  unsigned int response_len;
+  unsigned int response_written;
+};
+
+static pthread_mutex_t metrics_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static ipmisensorsd_host_data_t **server_host_data_array = NULL;
+static unsigned int server_host_data_array_len = 0;
+static char *server_socket_path = NULL;
+static int server_fd = -1;
+static pthread_t server_tid;
+static int server_running = 0;
+static int server_exit_flag = 0;
+
+void
+ipmisensorsd_metrics_update (ipmisensorsd_host_data_t *host_data,
+                             ipmisensorsd_host_metrics_t *metrics)
+{
+  ipmisensorsd_sensor_t *old_sensors;
+
+  assert (host_data);
+  assert (metrics);
+
+  pthread_mutex_lock (&metrics_lock);
+  old_sensors = host_data->metrics.sensors;
+  host_data->metrics = *metrics;
+  pthread_mutex_unlock (&metrics_lock);
+
+  /* free outside the lock, don't stall a request in progress */
+  free (old_sensors);
+  memset (metrics, '\0', sizeof (ipmisensorsd_host_metrics_t));
+}
+
+static int
+_render_printf (struct ipmisensorsd_render_buf *rb, const char *fmt, ...)
+{
+  va_list ap;
+  int len;
+
+  assert (rb);
+  assert (fmt);
+
+  while (1)
+    {
+      va_start (ap, fmt);
+      len = vsnprintf (rb->buf + rb->buflen, rb->bufsize - rb->buflen, fmt, ap);
+      va_end (ap);
+
+      if (len < 0)
+        return (-1);
+
+      if (rb->buflen + len < rb->bufsize)
+        break;
+
+      {
+        unsigned int newsize = rb->bufsize * 2;
+        char *tmp;
+
+        while (newsize <= rb->buflen + len)
+          newsize *= 2;
+
+        if (!(tmp = realloc (rb->buf, newsize)))
+          return (-1);
+        rb->buf = tmp;
+        rb->bufsize = newsize;
+      }
+    }
+
+  rb->buflen += len;
+  return (0);
+}
+
+/* Label values are double quoted, backslash, double quote and
+ * newline must be escaped.
+ */
+static int
+_render_label (struct ipmisensorsd_render_buf *rb,
+               const char *name,
+               const char *value,
+               int first)
+{
+  const char *p;
+
+  assert (rb);
+  assert (name);
+  assert (value);
+
+  if (_render_printf (rb, "%s%s=\"", first ? "" : ",", name) < 0)
+    return (-1);
+
+  for (p = value; *p; p++)
+    {
+      int rv;
+
+      if (*p == '\\')
+        rv = _render_printf (rb, "\\\\");
+      else if (*p == '"')
+        rv = _render_printf (rb, "\\\"");
+      else if (*p == '\n')
+        rv = _render_printf (rb, "\\n");
+      else
+        rv = _render_printf (rb, "%c", *p);
+
+      if (rv < 0)
+        return (-1);
+    }
+
+  return (_render_printf (rb, "\""));
+}
+
+static const char *
+_host_label (ipmisensorsd_host_data_t *host_data)
+{
+  assert (host_data);
+
+  return (host_data->hostname ? host_data->hostname : "localhost");
+}
+
+static int
+_render_sensor_labels (struct ipmisensorsd_render_buf *rb,
+                       ipmisensorsd_host_data_t *host_data,
+                       ipmisensorsd_sensor_t *sensor,
+                       int with_units)
+{
+  char numbuf[16];
+
+  assert (rb);
+  assert (host_data);
+  assert (sensor);
+
+  if (_render_label (rb, "host", _host_label (host_data), 1) < 0)
+    return (-1);
+
+  snprintf (numbuf, sizeof (numbuf), "%u", sensor->record_id);
+  if (_render_label (rb, "record_id", numbuf, 0) < 0)
+    return (-1);
+
+  snprintf (numbuf, sizeof (numbuf), "%u", sensor->sensor_number);
+  if (_render_label (rb, "sensor_number", numbuf, 0) < 0)
+    return (-1);
+
+  if (_render_label (rb, "name", sensor->sensor_name, 0) < 0)
+    return (-1);
+
+  if (_render_label (rb, "type", sensor->sensor_type_str, 0) < 0)
+    return (-1);
+
+  if (with_units)
+    {
+      if (_render_label (rb, "units", sensor->sensor_units, 0) < 0)
+        return (-1);
+    }
+
+  return (0);
+}
+
+char *
+ipmisensorsd_metrics_render (ipmisensorsd_host_data_t **host_data_array,
+                             unsigned int host_data_array_len,
+                             unsigned int *buflen)
+{
+  struct ipmisensorsd_render_buf rb;
+  unsigned int i, j;
+
+  assert (host_data_array);
+  assert (buflen);
+
+  if (!(rb.buf = malloc (IPMISENSORSD_RENDER_BUFLEN_INIT)))
+    return (NULL);
+  rb.buflen = 0;
+  rb.bufsize = IPMISENSORSD_RENDER_BUFLEN_INIT;
+  rb.buf[0] = '\0';
+
+  pthread_mutex_lock (&metrics_lock);
+
+  if (_render_printf (&rb,
+                      "# HELP ipmi_up Whether the most recent sensor scrape of the host succeeded.\n"
+                      "# TYPE ipmi_up gauge\n") < 0)
+    goto cleanup;
+
+  for (i = 0; i < host_data_array_len; i++)
+    {
+      if (_render_printf (&rb, "ipmi_up{") < 0
+          || _render_label (&rb, "host", _host_label (host_data_array[i]), 1) < 0
+          || _render_printf (&rb, "} %d\n", host_data_array[i]->metrics.up) < 0)
+        goto cleanup;
+    }
+
+  if (_render_printf (&rb,
+                      "# HELP ipmi_scrape_duration_seconds Duration of the most recent sensor scrape of the host.\n"
+                      "# TYPE ipmi_scrape_duration_seconds gauge\n") < 0)
+    goto cleanup;
+
+  for (i = 0; i < host_data_array_len; i++)
+    {
+      /* not yet scraped */
+      if (!host_data_array[i]->metrics.last_scrape)
+        continue;
+
+      if (_render_printf (&rb, "ipmi_scrape_duration_seconds{") < 0
+          || _render_label (&rb, "host", _host_label (host_data_array[i]), 1) < 0
+          || _render_printf (&rb, "} %.6f\n", host_data_array[i]->metrics.scrape_duration) < 0)
+        goto cleanup;
+    }
+
+  if (_render_printf (&rb,
+                      "# HELP ipmi_last_scrape_timestamp_seconds Time of the most recent sensor scrape of the host.\n"
+                      "# TYPE ipmi_last_scrape_timestamp_seconds gauge\n") < 0)
+    goto cleanup;
+
+  for (i = 0; i < host_data_array_len; i++)
+    {
+      if (!host_data_array[i]->metrics.last_scrape)
+        continue;
+
+      if (_render_printf (&rb, "ipmi_last_scrape_timestamp_seconds{") < 0
+          || _render_label (&rb, "host", _host_label (host_data_array[i]), 1) < 0
+          || _render_printf (&rb, "} %lu\n", (unsigned long)host_data_array[i]->metrics.last_scrape) < 0)
+        goto cleanup;
+    }
+
+  if (_render_printf (&rb,
+                      "# HELP ipmi_sensor_reading Sensor reading in the units of the sensor.\n"
+                      "# TYPE ipmi_sensor_reading gauge\n") < 0)
+    goto cleanup;
+
+  for (i = 0; i < host_data_array_len; i++)
+    {
+      for (j = 0; j < host_data_array[i]->metrics.sensors_count; j++)
+        {
+          ipmisensorsd_sensor_t *sensor = &(host_data_array[i]->metrics.sensors[j]);
+
+          if (!sensor->reading_available)
+            continue;
+
+          if (_render_printf (&rb, "ipmi_sensor_reading{") < 0
+              || _render_sensor_labels (&rb, host_data_array[i], sensor, 1) < 0
+              || _render_printf (&rb, "} %.15g\n", sensor->reading) < 0)
+            goto cleanup;
+        }
+    }
+
+  if (_render_printf (&rb,
+                      "# HELP ipmi_sensor_state Sensor state, 0 = Nominal, 1 = Warning, 2 = Critical.\n"
+                      "# TYPE ipmi_sensor_state gauge\n") < 0)
+    goto cleanup;
+
+  for (i = 0; i < host_data_array_len; i++)
+    {
+      for (j = 0; j < host_data_array[i]->metrics.sensors_count; j++)
+        {
+          ipmisensorsd_sensor_t *sensor = &(host_data_array[i]->metrics.sensors[j]);
+
+          if (!sensor->state_available)
+            continue;
+
+          if (_render_printf (&rb, "ipmi_sensor_state{") < 0
+              || _render_sensor_labels (&rb, host_data_array[i], sensor, 0) < 0
+              || _render_printf (&rb, "} %u\n", sensor->state) < 0)
+            goto cleanup;
+        }
+    }
+
+  pthread_mutex_unlock (&metrics_lock);
+  (*buflen) = rb.buflen;
+  return (rb.buf);
+
+ cleanup:
+  pthread_mutex_unlock (&metrics_lock);
+  free (rb.buf);
+  return (NULL);
+}
+
+static uint64_t
+_now_ms (void)
+{
+  struct timeval tv;
+
+  gettimeofday (&tv, NULL);
+  return ((uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000);
+}
+
+static void
+_client_close (struct ipmisensorsd_client *client)
+{
+  assert (client);
+
+  close (client->fd);
+  free (client->response);
+  memset (client, '\0', sizeof (struct ipmisensorsd_client));
+  client->fd = -1;
+}
+
+/* Prepare the response once the request is known.  Plain connections
+ * (e.g. socat or nc -U) get the readings alone.  Clients that speak
+ * first are assumed to be HTTP, e.g. curl --unix-socket, and get a
+ * response header.  returns 0 on success, -1 on error.
+ */
+static int
+_client_respond (struct ipmisensorsd_client *client)
+{
+  char *metrics = NULL;
+  unsigned int metrics_len = 0;
+  unsigned int header_len = 0;
+  int http = 0;
+  int head = 0;
+
+  assert (client);
+  assert (client->state == IPMISENSORSD_CLIENT_REQUEST);
+
+  if (client->request_len >= 4)
+    {
+      if (!memcmp (client->request, "GET ", 4))
+        http = 1;
+      else if (!memcmp (client->request, "HEAD", 4))
+        http = head = 1;
+    }
+
+  if (http)
+    header_len = strlen (IPMISENSORSD_HTTP_HEADER);
+
+  if (!head)
+    {
+      if (!(metrics = ipmisensorsd_metrics_render (server_host_data_array,
+                                                   server_host_data_array_len,
+                                                   &metrics_len)))
+        {
+          err_output ("ipmisensorsd_metrics_render: %s", strerror (errno));
+          return (-1);
+        }
+    }
+
+  if (!(client->response = malloc (header_len + metrics_len + 1)))
+    {
+      err_output ("malloc: %s", strerror (errno));
+      free (metrics);
+      return (-1);
+    }
+
+  if (header_len)
+    memcpy (client->response, IPMISENSORSD_HTTP_HEADER, header_len);
+  if (metrics_len)
+    memcpy (client->response + header_len, metrics, metrics_len);
+  free (metrics);
+
+  client->response_len = header_len + metrics_len;
+  client->response_written = 0;
+  client->state = IPMISENSORSD_CLIENT_RESPONSE;
+  client->deadline = _now_ms () + IPMISENSORSD_RESPONSE_TIMEOUT;
+  return (0);
+}
+
+/* returns 0 if the client is still being served, -1 if it is done */
+static int
+_client_read (struct ipmisensorsd_client *client)
+{
+  ssize_t len;
+
+  assert (client);
+  assert (client->state == IPMISENSORSD_CLIENT_REQUEST);
+
+  if ((len = read (client->fd,
+                   client->request + client->request_len,
+                   IPMISENSORSD_REQUEST_BUFLEN - client->request_len)) < 0)
+    {
+      if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+        return (0);
+      err_output ("read: %s", strerror (errno));
+      return (-1);
+    }
+
+  client->request_len += len;
+
+  /* only the method is needed, respond once it is known or the
+   * client has finished sending
+   */
+  if (client->request_len < 4 && len)
+    return (0);
+
+  return (_client_respond (client));
+}
+
+/* returns 0 if the client is still being served, -1 if it is done */
+static int
+_client_write (struct ipmisensorsd_client *client)
+{
+  ssize_t len;
+
+  assert (client);
+  assert (client->state == IPMISENSORSD_CLIENT_RESPONSE);
+
+  if ((len = write (client->fd,
+                    client->response + client->response_written,
+                    client->response_len - client->response_written)) < 0)
+    {
+      if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+        return (0);
+      /* a client that goes away early is not an error worth logging */
+      return (-1);
+    }
+
+  client->response_written += len;
+
+  if (client->response_written < client->response_len)
+    return (0);
+
+  return (-1);
+}
+
+static void
+_server_accept (struct ipmisensorsd_client *clients)
+{
+  unsigned int i;
+  int fd;
+
+  assert (clients);
+
+  if ((fd = accept (server_fd, NULL, NULL)) < 0)
+    {
+      if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)
+        err_output ("accept: %s", strerror (errno));
+      return;
+    }
+
+  if (fd_set_nonblocking (fd) < 0)
+    {
+      err_output ("fd_set_nonblocking: %s", strerror (errno));
+      close (fd);
+      return;
+    }
+
+  for (i = 0; i < IPMISENSORSD_CLIENTS_MAX; i++)
+    {
+      if (clients[i].state == IPMISENSORSD_CLIENT_UNUSED)
+        break;
+    }
+
+  /* the listening socket is not polled while all slots are in use */
+  assert (i < IPMISENSORSD_CLIENTS_MAX);
+
+  clients[i].fd = fd;
+  clients[i].state = IPMISENSORSD_CLIENT_REQUEST;
+  clients[i].request_len = 0;
+  clients[i].deadline = _now_ms () + IPMISENSORSD_REQUEST_TIMEOUT;
+}
+
+/* Clients are served concurrently from one poll loop on non-blocking
+ * sockets, each with a deadline, so a client that never reads its
+ * response cannot hold up the others.
+ */
+static void *
+_server_func (void *arg)
+{
+  struct ipmisensorsd_client clients[IPMISENSORSD_CLIENTS_MAX];
+  struct pollfd pfds[IPMISENSORSD_CLIENTS_MAX + 1];
+  int pfds_client[IPMISENSORSD_CLIENTS_MAX + 1];
+  unsigned int i;
+
+  memset (clients, '\0', sizeof (clients));
+  for (i = 0; i < IPMISENSORSD_CLIENTS_MAX; i++)
+    clients[i].fd = -1;
+
+  while (!server_exit_flag)
+    {
+      unsigned int nfds = 0;
+      unsigned int clients_count = 0;
+      int timeout = IPMISENSORSD_POLL_TIMEOUT;
+      uint64_t now;
+      int ret;
+
+      now = _now_ms ();
+
+      for (i = 0; i < IPMISENSORSD_CLIENTS_MAX; i++)
+        {
+          if (clients[i].state == IPMISENSORSD_CLIENT_UNUSED)
+            continue;
+
+          if (now >= clients[i].deadline)
+            {
+              /* a client that never speaks gets the plain readings */
+              if (clients[i].state == IPMISENSORSD_CLIENT_REQUEST
+                  && !_client_respond (&clients[i]))
+                now = _now_ms ();
+              else
+                {
+                  _client_close (&clients[i]);
+                  continue;
+                }
+            }
+
+          if (clients[i].deadline - now < timeout)
+            timeout = clients[i].deadline - now;
+
+          pfds[nfds].fd = clients[i].fd;
+          pfds[nfds].events = clients[i].state == IPMISENSORSD_CLIENT_REQUEST ? POLLIN : POLLOUT;
+          pfds[nfds].revents = 0;
+          pfds_client[nfds] = i;
+          nfds++;
+          clients_count++;
+        }
+
+      if (clients_count < IPMISENSORSD_CLIENTS_MAX)
+        {
+          pfds[nfds].fd = server_fd;
+          pfds[nfds].events = POLLIN;
+          pfds[nfds].revents = 0;
+          pfds_client[nfds] = -1;
+          nfds++;
+        }
+
+      /* wake up periodically to check the exit flag */
+      if ((ret = poll (pfds, nfds, timeout)) < 0)
+        {
+          if (errno != EINTR)
+            err_output ("poll: %s", strerror (errno));
+          continue;
+        }
+
+      if (!ret)
+        continue;
+
+      for (i = 0; i < nfds; i++)
+        {
+          struct ipmisensorsd_client *client;
+          int done;
+
+          if (!pfds[i].revents)
+            continue;
+
+          if (pfds_client[i] < 0)
+            {
+              _server_accept (clients);
+              continue;
+            }
+
+          client = &clients[pfds_client[i]];
+
+          if (client->state == IPMISENSORSD_CLIENT_REQUEST)
+            done = _client_read (client);
+          else
+            done = _client_write (client);
+
+          if (done < 0)
+            _client_close (client);
+        }
+    }
+
+  for (i = 0; i < IPMISENSORSD_CLIENTS_MAX; i++)
+    {
+      if (clients[i].state != IPMISENSORSD_CLIENT_UNUSED)
+        _client_close (&clients[i]);
+    }
+
+  return (NULL);
+}
+
+int
+ipmisensorsd_server_init (ipmisensorsd_prog_data_t *prog_data,
+                          ipmisensorsd_host_data_t **host_data_array,
+                          unsigned int host_data_array_len)
+{
+  struct sockaddr_un addr;
+  struct stat statbuf;
+  int ret;
+  int rv = -1;
+
+  assert (prog_data);
+  assert (host_data_array);
+  assert (server_fd < 0);
+
+  server_host_data_array = host_data_array;
+  server_host_data_array_len = host_data_array_len;
+
+  if (prog_data->args->socket_path)
+    server_socket_path = prog_data->args->socket_path;
+  else
+    server_socket_path = IPMISENSORSD_SOCKET_DEFAULT;
+
+  if (strlen (server_socket_path) >= sizeof (addr.sun_path))
+    {
+      err_output ("socket path '%s' too long", server_socket_path);
+      goto cleanup;
+    }
+
+  /* remove a stale socket from a previous run, never anything else */
+  if (!lstat (server_socket_path, &statbuf))
+    {
+      if (!S_ISSOCK (statbuf.st_mode))
+        {
+          err_output ("'%s' exists and is not a socket", server_socket_path);
+          goto cleanup;
+        }
+
+      if (unlink (server_socket_path) < 0)
+        {
+          err_output ("unlink '%s': %s", server_socket_path, strerror (errno));
+          goto cleanup;
+        }
+    }
+  else if (errno != ENOENT)
+    {
+      err_output ("lstat '%s': %s", server_socket_path, strerror (errno));
+      goto cleanup;
+    }
+
+  /* clients closing early must not kill the daemon */
+  signal (SIGPIPE, SIG_IGN);
+
+  if ((server_fd = socket (AF_UNIX, SOCK_STREAM, 0)) < 0)
+    {
+      err_output ("socket: %s", strerror (errno));
+      goto cleanup;
+    }
+
+  memset (&addr, '\0', sizeof (struct sockaddr_un));
+  addr.sun_family = AF_UNIX;
+  strcpy (addr.sun_path, server_socket_path);
+
+  if (bind (server_fd, (struct sockaddr *)&addr, sizeof (struct sockaddr_un)) < 0)
+    {
+      err_output ("bind '%s': %s", server_socket_path, strerror (errno));
+      goto cleanup;
+    }
+
+  if (listen (server_fd, IPMISENSORSD_LISTEN_BACKLOG) < 0)
+    {
+      err_output ("listen: %s", strerror (errno));
+      goto cleanup;
+    }
+
+  /* a client that disconnects between poll and accept must not block */
+  if (fd_set_nonblocking (server_fd) < 0)
+    {
+      err_output ("fd_set_nonblocking: %s", strerror (errno));
+      goto cleanup;
+    }
+
+  server_exit_flag = 0;
+
+  if ((ret = pthread_create (&server_tid, NULL, _server_func, NULL)))
+    {
+      err_output ("pthread_create: %s", strerror (ret));
+      goto cleanup;
+    }
+  server_running = 1;
+
+  rv = 0;
+ cleanup:
+  if (rv < 0 && server_fd >= 0)
+    {
+      close (server_fd);
+      server_fd = -1;
+    }
+  return (rv);
+}
+
+void
+ipmisensorsd_server_destroy (void)
+{
+  if (server_running)
+    {
+      server_exit_flag = 1;
+      pthread_join (server_tid, NULL);
+      server_running = 0;
+    }
+
+  if (server_fd >= 0)
+    {
+      close (server_fd);
+      server_fd = -1;
+      unlink (server_socket_path);
+    }
+}
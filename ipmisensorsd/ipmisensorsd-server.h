@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef IPMISENSORSD_SERVER_H
+#define IPMISENSORSD_SERVER_H
+
+#include "ipmisensorsd.h"
+
+/* Replace the readings of a host with those from a completed scrape.
+ * The previous readings are freed, the metrics structure is cleared.
+ */
+void ipmisensorsd_metrics_update (ipmisensorsd_host_data_t *host_data,
+                                  ipmisensorsd_host_metrics_t *metrics);
+
+/* Returns the current readings of all hosts in Prometheus text
+ * exposition format, caller must free.  Returns NULL on error.
+ */
+char *ipmisensorsd_metrics_render (ipmisensorsd_host_data_t **host_data_array,
+                                   unsigned int host_data_array_len,
+                                   unsigned int *buflen);
+
+int ipmisensorsd_server_init (ipmisensorsd_prog_data_t *prog_data,
+                              ipmisensorsd_host_data_t **host_data_array,
+                              unsigned int host_data_array_len);
+
+void ipmisensorsd_server_destroy (void);
+
+#endif /* IPMISENSORSD_SERVER_H */
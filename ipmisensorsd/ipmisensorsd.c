@@ -0,0 +1,916 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#if STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#if TIME_WITH_SYS_TIME
+#include <sys/time.h>
+#include <time.h>
+#else /* !TIME_WITH_SYS_TIME */
+#if HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else /* !HAVE_SYS_TIME_H */
+#include <time.h>
+#endif /* !HAVE_SYS_TIME_H */
+#endif /* !TIME_WITH_SYS_TIME */
+#include <syslog.h>
+#include <pthread.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <freeipmi/freeipmi.h>
+
+#include "ipmisensorsd.h"
+#include "ipmisensorsd-argp.h"
+#include "ipmisensorsd-cache.h"
+#include "ipmisensorsd-common.h"
+#include "ipmisensorsd-server.h"
+
+#include "freeipmi-portability.h"
+#include "error.h"
+#include "fi_hostlist.h"
+#include "heap.h"
+#include "pstdout.h"
+#include "tool-common.h"
+#include "tool-daemon-common.h"
+#include "tool-oem-common.h"
+#include "tool-sensor-common.h"
+#include "tool-util-common.h"
+
+#define IPMISENSORSD_PIDFILE            IPMISENSORSD_LOCALSTATEDIR "/run/ipmisensorsd.pid"
+
+static Heap host_data_heap = NULL;
+static pthread_mutex_t host_data_heap_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static ipmisensorsd_host_data_t **host_data_array = NULL;
+static unsigned int host_data_array_len = 0;
+
+static int exit_flag = 1;
+
+static void
+_session_close (ipmisensorsd_host_data_t *host_data)
+{
+  assert (host_data);
+
+  ipmi_interpret_ctx_destroy (host_data->session.interpret_ctx);
+  ipmi_sensor_read_ctx_destroy (host_data->session.sensor_read_ctx);
+  ipmi_sdr_ctx_destroy (host_data->session.sdr_ctx);
+  ipmi_ctx_close (host_data->session.ipmi_ctx);
+  ipmi_ctx_destroy (host_data->session.ipmi_ctx);
+  memset (&host_data->session, '\0', sizeof (ipmisensorsd_host_session_t));
+}
+
+static int
+_session_open (ipmisensorsd_host_data_t *host_data)
+{
+  struct ipmisensorsd_arguments *args;
+  unsigned int interpret_flags = 0;
+
+  assert (host_data);
+  assert (!host_data->session.ipmi_ctx);
+
+  args = host_data->prog_data->args;
+
+  if (!(host_data->session.ipmi_ctx = ipmi_open_daemon (host_data->hostname,
+                                                        &(args->common_args),
+                                                        args->verbose_count,
+                                                        &(host_data->last_ipmi_errnum),
+                                                        &(host_data->last_ipmi_errnum_count))))
+    goto cleanup;
+
+  if (ipmisensorsd_sdr_cache_create_and_load (host_data) < 0)
+    goto cleanup;
+
+  if (!(host_data->session.sensor_read_ctx = ipmi_sensor_read_ctx_create (host_data->session.ipmi_ctx)))
+    {
+      ipmisensorsd_err_output (host_data, "ipmi_sensor_read_ctx_create: %s", strerror (errno));
+      goto cleanup;
+    }
+
+  if (!(host_data->session.interpret_ctx = ipmi_interpret_ctx_create ()))
+    {
+      ipmisensorsd_err_output (host_data, "ipmi_interpret_ctx_create: %s", strerror (errno));
+      goto cleanup;
+    }
+
+  if (ipmi_interpret_load_sensor_config (host_data->session.interpret_ctx,
+                                         args->sensor_state_config_file) < 0)
+    {
+      if (!(!args->sensor_state_config_file
+            && ipmi_interpret_ctx_errnum (host_data->session.interpret_ctx) == IPMI_INTERPRET_ERR_SENSOR_CONFIG_FILE_DOES_NOT_EXIST))
+        {
+          ipmisensorsd_err_output (host_data,
+                                   "ipmi_interpret_load_sensor_config: %s",
+                                   ipmi_interpret_ctx_errormsg (host_data->session.interpret_ctx));
+          goto cleanup;
+        }
+    }
+
+  if (args->interpret_oem_data)
+    {
+      if (ipmi_get_oem_data (NULL,
+                             host_data->session.ipmi_ctx,
+                             &host_data->session.oem_data) < 0)
+        goto cleanup;
+
+      if (ipmi_interpret_ctx_set_manufacturer_id (host_data->session.interpret_ctx,
+                                                  host_data->session.oem_data.manufacturer_id) < 0)
+        {
+          ipmisensorsd_err_output (host_data,
+                                   "ipmi_interpret_ctx_set_manufacturer_id: %s",
+                                   ipmi_interpret_ctx_errormsg (host_data->session.interpret_ctx));
+          goto cleanup;
+        }
+
+      if (ipmi_interpret_ctx_set_product_id (host_data->session.interpret_ctx,
+                                             host_data->session.oem_data.product_id) < 0)
+        {
+          ipmisensorsd_err_output (host_data,
+                                   "ipmi_interpret_ctx_set_product_id: %s",
+                                   ipmi_interpret_ctx_errormsg (host_data->session.interpret_ctx));
+          goto cleanup;
+        }
+
+      interpret_flags |= IPMI_INTERPRET_FLAGS_INTERPRET_OEM_DATA;
+    }
+
+  if (interpret_flags)
+    {
+      if (ipmi_interpret_ctx_set_flags (host_data->session.interpret_ctx, interpret_flags) < 0)
+        {
+          ipmisensorsd_err_output (host_data,
+                                   "ipmi_interpret_ctx_set_flags: %s",
+                                   ipmi_interpret_ctx_errormsg (host_data->session.interpret_ctx));
+          goto cleanup;
+        }
+    }
+
+  return (0);
+
+ cleanup:
+  _session_close (host_data);
+  return (-1);
+}
+
+/* A BMC drops sessions that see no traffic, past the session timeout
+ * a reused session would only cost a timeout before failing.
+ */
+static int
+_session_stale (ipmisensorsd_host_data_t *host_data, time_t now)
+{
+  unsigned int session_timeout;
+
+  assert (host_data);
+  assert (host_data->session.ipmi_ctx);
+
+  /* inband has no session */
+  if (!host_data->hostname)
+    return (0);
+
+  if (host_data->prog_data->args->common_args.session_timeout)
+    session_timeout = host_data->prog_data->args->common_args.session_timeout;
+  else
+    session_timeout = IPMI_SESSION_TIMEOUT_DEFAULT;
+
+  return ((now - host_data->session.last_activity) * 1000 >= session_timeout);
+}
+
+static int
+_sensor_type_filtered (ipmisensorsd_host_data_t *host_data)
+{
+  struct ipmisensorsd_arguments *args;
+  int flag;
+
+  assert (host_data);
+
+  args = host_data->prog_data->args;
+
+  if (args->sensor_types_length
+      && strcasecmp (args->sensor_types[0], SENSOR_PARSE_ALL_STRING))
+    {
+      if ((flag = sensor_type_listed_sdr (NULL,
+                                          host_data->session.sdr_ctx,
+                                          args->sensor_types,
+                                          args->sensor_types_length)) < 0)
+        return (-1);
+
+      if (!flag)
+        return (1);
+    }
+
+  if (args->exclude_sensor_types_length
+      && strcasecmp (args->exclude_sensor_types[0], SENSOR_PARSE_NONE_STRING))
+    {
+      if ((flag = sensor_type_listed_sdr (NULL,
+                                          host_data->session.sdr_ctx,
+                                          args->exclude_sensor_types,
+                                          args->exclude_sensor_types_length)) < 0)
+        return (-1);
+
+      if (flag)
+        return (1);
+    }
+
+  return (0);
+}
+
+/* returns 1 if a sensor was read, 0 if the sensor was skipped, -1 on error */
+static int
+_read_sensor (ipmisensorsd_host_data_t *host_data,
+              const void *sdr_record,
+              unsigned int sdr_record_len,
+              const ipmi_sdr_record_decoded_t *decoded,
+              uint8_t shared_sensor_number_offset,
+              ipmisensorsd_sensor_t *sensor)
+{
+  struct ipmisensorsd_arguments *args;
+  uint8_t sensor_reading_raw = 0;
+  double *sensor_reading = NULL;
+  uint16_t sensor_event_bitmask = 0;
+  int rv = -1;
+
+  assert (host_data);
+  assert (sdr_record);
+  assert (decoded);
+  assert (sensor);
+
+  args = host_data->prog_data->args;
+
+  memset (sensor, '\0', sizeof (ipmisensorsd_sensor_t));
+
+  if (ipmi_sensor_read (host_data->session.sensor_read_ctx,
+                        sdr_record,
+                        sdr_record_len,
+                        shared_sensor_number_offset,
+                        &sensor_reading_raw,
+                        &sensor_reading,
+                        &sensor_event_bitmask) <= 0)
+    {
+      int errnum = ipmi_sensor_read_ctx_errnum (host_data->session.sensor_read_ctx);
+
+      /* Not errors, the sensor has no reading to export */
+      if (errnum == IPMI_SENSOR_READ_ERR_SENSOR_IS_SYSTEM_SOFTWARE
+          || errnum == IPMI_SENSOR_READ_ERR_SENSOR_READING_UNAVAILABLE
+          || errnum == IPMI_SENSOR_READ_ERR_SENSOR_SCANNING_DISABLED
+          || errnum == IPMI_SENSOR_READ_ERR_SENSOR_NON_ANALOG
+          || errnum == IPMI_SENSOR_READ_ERR_SENSOR_NON_LINEAR
+          || errnum == IPMI_SENSOR_READ_ERR_SENSOR_NOT_OWNED_BY_BMC
+          || errnum == IPMI_SENSOR_READ_ERR_SENSOR_CANNOT_BE_BRIDGED
+          || errnum == IPMI_SENSOR_READ_ERR_SENSOR_READING_CANNOT_BE_OBTAINED
+          || errnum == IPMI_SENSOR_READ_ERR_NODE_BUSY
+          || errnum == IPMI_SENSOR_READ_ERR_INVALID_SDR_RECORD_TYPE)
+        {
+          if (args->common_args.debug)
+            ipmisensorsd_err_output (host_data,
+                                     "record id %u: %s",
+                                     decoded->record_id,
+                                     ipmi_sensor_read_ctx_errormsg (host_data->session.sensor_read_ctx));
+          rv = 0;
+          goto cleanup;
+        }
+
+      ipmisensorsd_err_output (host_data,
+                               "ipmi_sensor_read: %s",
+                               ipmi_sensor_read_ctx_errormsg (host_data->session.sensor_read_ctx));
+      goto cleanup;
+    }
+
+  sensor->record_id = decoded->record_id;
+  sensor->sensor_number = decoded->sensor_number + shared_sensor_number_offset;
+
+  if (args->entity_sensor_names)
+    {
+      if (ipmi_sdr_parse_entity_sensor_name (host_data->session.sdr_ctx,
+                                             sdr_record,
+                                             sdr_record_len,
+                                             sensor->sensor_number,
+                                             IPMI_SDR_SENSOR_NAME_FLAGS_DEFAULT,
+                                             sensor->sensor_name,
+                                             IPMISENSORSD_SENSOR_NAME_MAX) < 0)
+        {
+          ipmisensorsd_err_output (host_data,
+                                   "ipmi_sdr_parse_entity_sensor_name: %s",
+                                   ipmi_sdr_ctx_errormsg (host_data->session.sdr_ctx));
+          goto cleanup;
+        }
+    }
+  else
+    {
+      if (ipmi_sdr_parse_sensor_name (host_data->session.sdr_ctx,
+                                      sdr_record,
+                                      sdr_record_len,
+                                      sensor->sensor_number,
+                                      IPMI_SDR_SENSOR_NAME_FLAGS_DEFAULT,
+                                      sensor->sensor_name,
+                                      IPMISENSORSD_SENSOR_NAME_MAX) < 0)
+        {
+          ipmisensorsd_err_output (host_data,
+                                   "ipmi_sdr_parse_sensor_name: %s",
+                                   ipmi_sdr_ctx_errormsg (host_data->session.sdr_ctx));
+          goto cleanup;
+        }
+    }
+
+  sensor->sensor_type_str = get_sensor_type_output_string (decoded->sensor_type);
+
+  if (sensor_reading)
+    {
+      if (get_sensor_units_output_string (NULL,
+                                          host_data->session.sdr_ctx,
+                                          sensor->sensor_units,
+                                          IPMISENSORSD_SENSOR_UNITS_MAX,
+                                          args->non_abbreviated_units) < 0)
+        goto cleanup;
+
+      sensor->reading_available = 1;
+      sensor->reading = *sensor_reading;
+    }
+
+  if (ipmi_interpret_sensor (host_data->session.interpret_ctx,
+                             decoded->event_reading_type_code,
+                             decoded->sensor_type,
+                             sensor_event_bitmask,
+                             &sensor->state) < 0)
+    {
+      ipmisensorsd_err_output (host_data,
+                               "ipmi_interpret_sensor: %s",
+                               ipmi_interpret_ctx_errormsg (host_data->session.interpret_ctx));
+      goto cleanup;
+    }
+
+  if (sensor->state != IPMI_INTERPRET_STATE_UNKNOWN)
+    sensor->state_available = 1;
+
+  rv = 1;
+ cleanup:
+  free (sensor_reading);
+  return (rv);
+}
+
+static int
+_read_sensors (ipmisensorsd_host_data_t *host_data,
+               ipmisensorsd_host_metrics_t *metrics)
+{
+  uint16_t record_count;
+  unsigned int sensors_len = 0;
+  unsigned int i;
+
+  assert (host_data);
+  assert (host_data->session.sdr_ctx);
+  assert (metrics);
+
+  if (ipmi_sdr_cache_record_count (host_data->session.sdr_ctx, &record_count) < 0)
+    {
+      ipmisensorsd_err_output (host_data,
+                               "ipmi_sdr_cache_record_count: %s",
+                               ipmi_sdr_ctx_errormsg (host_data->session.sdr_ctx));
+      return (-1);
+    }
+
+  if (ipmi_sdr_cache_first (host_data->session.sdr_ctx) < 0)
+    {
+      ipmisensorsd_err_output (host_data,
+                               "ipmi_sdr_cache_first: %s",
+                               ipmi_sdr_ctx_errormsg (host_data->session.sdr_ctx));
+      return (-1);
+    }
+
+  for (i = 0; i < record_count; i++, ipmi_sdr_cache_next (host_data->session.sdr_ctx))
+    {
+      uint8_t sdr_record[IPMI_SDR_MAX_RECORD_LENGTH];
+      int sdr_record_len;
+      ipmi_sdr_record_decoded_t decoded;
+      uint8_t share_count = 1;
+      unsigned int j;
+      int ret;
+
+      /* decoded once per cache open, not once per scrape */
+      if (ipmi_sdr_cache_record_decoded (host_data->session.sdr_ctx,
+                                         &decoded,
+                                         sizeof (ipmi_sdr_record_decoded_t)) < 0)
+        {
+          /* a malformed record shouldn't fail every scrape */
+          if (ipmi_sdr_ctx_errnum (host_data->session.sdr_ctx) == IPMI_SDR_ERR_PARSE_INCOMPLETE_SDR_RECORD)
+            continue;
+
+          ipmisensorsd_err_output (host_data,
+                                   "ipmi_sdr_cache_record_decoded: %s",
+                                   ipmi_sdr_ctx_errormsg (host_data->session.sdr_ctx));
+          return (-1);
+        }
+
+      /* only sensors with readings or states */
+      if (decoded.record_type != IPMI_SDR_FORMAT_FULL_SENSOR_RECORD
+          && decoded.record_type != IPMI_SDR_FORMAT_COMPACT_SENSOR_RECORD)
+        continue;
+
+      if ((ret = _sensor_type_filtered (host_data)) < 0)
+        return (-1);
+
+      if (ret)
+        continue;
+
+      if ((sdr_record_len = ipmi_sdr_cache_record_read (host_data->session.sdr_ctx,
+                                                        sdr_record,
+                                                        IPMI_SDR_MAX_RECORD_LENGTH)) < 0)
+        {
+          ipmisensorsd_err_output (host_data,
+                                   "ipmi_sdr_cache_record_read: %s",
+                                   ipmi_sdr_ctx_errormsg (host_data->session.sdr_ctx));
+          return (-1);
+        }
+
+      /* Shared sensors are always expanded, every exported sensor
+       * needs its own name and number.
+       */
+      if (decoded.record_type == IPMI_SDR_FORMAT_COMPACT_SENSOR_RECORD
+          && decoded.share_count)
+        share_count = decoded.share_count;
+
+      for (j = 0; j < share_count; j++)
+        {
+          if (metrics->sensors_count == sensors_len)
+            {
+              ipmisensorsd_sensor_t *tmp;
+              unsigned int newlen = sensors_len ? sensors_len * 2 : record_count;
+
+              if (!(tmp = realloc (metrics->sensors, newlen * sizeof (ipmisensorsd_sensor_t))))
+                {
+                  ipmisensorsd_err_output (host_data, "realloc: %s", strerror (errno));
+                  return (-1);
+                }
+              metrics->sensors = tmp;
+              sensors_len = newlen;
+            }
+
+          if ((ret = _read_sensor (host_data,
+                                   sdr_record,
+                                   sdr_record_len,
+                                   &decoded,
+                                   j,
+                                   &metrics->sensors[metrics->sensors_count])) < 0)
+            return (-1);
+
+          if (ret)
+            metrics->sensors_count++;
+        }
+    }
+
+  return (0);
+}
+
+static int
+_ipmisensorsd_poll (void *arg)
+{
+  ipmisensorsd_host_data_t *host_data;
+  ipmisensorsd_host_metrics_t metrics;
+  struct timeval start, end;
+  int reused;
+  int rv = -1;
+
+  assert (arg);
+
+  host_data = (ipmisensorsd_host_data_t *)arg;
+
+  if (host_data->prog_data->args->foreground
+      && host_data->prog_data->args->common_args.debug)
+    err_debug ("Poll %s", host_data->hostname ? host_data->hostname : "localhost");
+
+  memset (&metrics, '\0', sizeof (ipmisensorsd_host_metrics_t));
+
+  gettimeofday (&start, NULL);
+
+  if (host_data->session.ipmi_ctx
+      && _session_stale (host_data, start.tv_sec))
+    _session_close (host_data);
+
+  reused = host_data->session.ipmi_ctx ? 1 : 0;
+
+  if (!reused)
+    {
+      if (_session_open (host_data) < 0)
+        goto out;
+    }
+
+  if (_read_sensors (host_data, &metrics) < 0)
+    {
+      _session_close (host_data);
+
+      /* The BMC may have dropped the session (e.g. a BMC reset),
+       * retry once on a new one before calling the host down.
+       */
+      if (!reused)
+        goto out;
+
+      free (metrics.sensors);
+      memset (&metrics, '\0', sizeof (ipmisensorsd_host_metrics_t));
+
+      if (_session_open (host_data) < 0)
+        goto out;
+
+      if (_read_sensors (host_data, &metrics) < 0)
+        {
+          _session_close (host_data);
+          goto out;
+        }
+    }
+
+  metrics.up = 1;
+  rv = 0;
+ out:
+  gettimeofday (&end, NULL);
+
+  if (host_data->session.ipmi_ctx)
+    host_data->session.last_activity = end.tv_sec;
+
+  if (!metrics.up)
+    {
+      free (metrics.sensors);
+      metrics.sensors = NULL;
+      metrics.sensors_count = 0;
+    }
+
+  metrics.last_scrape = end.tv_sec;
+  metrics.scrape_duration = (end.tv_sec - start.tv_sec)
+    + (end.tv_usec - start.tv_usec) / 1000000.0;
+
+  ipmisensorsd_metrics_update (host_data, &metrics);
+  return (rv);
+}
+
+static int
+_ipmisensorsd_poll_postprocess (void *arg)
+{
+  ipmisensorsd_host_data_t *host_data;
+  struct timeval tv;
+  int rv = -1;
+
+  assert (arg);
+
+  host_data = (ipmisensorsd_host_data_t *)arg;
+
+  gettimeofday (&tv, NULL);
+  host_data->next_poll_time = tv.tv_sec + host_data->prog_data->args->poll_interval;
+
+  pthread_mutex_lock (&host_data_heap_lock);
+  
+  if (!heap_insert (host_data_heap, host_data))
+    {
+      pthread_mutex_unlock (&host_data_heap_lock);
+      ipmisensorsd_err_output (host_data, "heap_insert: %s", strerror (errno));
+      goto cleanup;
+    }
+
+  pthread_mutex_unlock (&host_data_heap_lock);
+  rv = 0;
+ cleanup:
+  return (rv);
+}
+
+static void
+_signal_handler_callback (int sig)
+{
+  exit_flag = 0;
+}
+
+static void
+_free_host_data (ipmisensorsd_host_data_t *host_data)
+{
+  assert (host_data);
+
+  _session_close (host_data);
+  free (host_data->metrics.sensors);
+  free (host_data->hostname);
+  free (host_data);
+}
+
+static ipmisensorsd_host_data_t *
+_alloc_host_data (ipmisensorsd_prog_data_t *prog_data, const char *hostname)
+{
+  ipmisensorsd_host_data_t *host_data;
+
+  assert (prog_data);
+
+  if (!(host_data = (ipmisensorsd_host_data_t *) malloc (sizeof (ipmisensorsd_host_data_t))))
+    {
+      err_output ("malloc: %s", strerror (errno));
+      return (NULL);
+    }
+
+  memset (host_data, '\0', sizeof (ipmisensorsd_host_data_t));
+  host_data->prog_data = prog_data;
+  if (hostname)
+    {
+      if (!(host_data->hostname = strdup (hostname)))
+        {
+          err_output ("strdup: %s", strerror (errno));
+          free (host_data);
+          return (NULL);
+        }
+    }
+  else
+    host_data->hostname = NULL;
+  host_data->next_poll_time = 0; /* 0 will first immediate check first time through */
+  host_data->last_ipmi_errnum = 0;
+  host_data->last_ipmi_errnum_count = 0;
+
+  return (host_data);
+}
+
+static int
+_add_host_data (ipmisensorsd_prog_data_t *prog_data, const char *hostname)
+{
+  ipmisensorsd_host_data_t *host_data;
+
+  assert (prog_data);
+
+  if (!(host_data = _alloc_host_data (prog_data, hostname)))
+    return (-1);
+
+  /* the array owns the host data, the heap only schedules it */
+  host_data_array[host_data_array_len++] = host_data;
+
+  if (!heap_insert (host_data_heap, host_data))
+    {
+      err_output ("heap_insert: %s", strerror (errno));
+      return (-1);
+    }
+
+  return (0);
+}
+
+static int
+hostdata_timecmp (void *x, void *y)
+{
+  ipmisensorsd_host_data_t *hd1, *hd2;
+
+  assert (x);
+  assert (y);
+
+  hd1 = (ipmisensorsd_host_data_t *)x;
+  hd2 = (ipmisensorsd_host_data_t *)y;
+
+  if (hd1->next_poll_time < hd2->next_poll_time)
+    return (1);
+  else if (hd1->next_poll_time > hd2->next_poll_time)
+    return (-1);
+  return (0);
+}
+
+static int
+_ipmisensorsd (ipmisensorsd_prog_data_t *prog_data)
+{
+  int hosts_count = 0;
+  fi_hostlist_t hlist = NULL;
+  fi_hostlist_iterator_t hitr = NULL;
+  ipmisensorsd_host_data_t *host_data;
+  char *host = NULL;
+  unsigned int i;
+  int rv = -1;
+  int ret;
+
+  assert (prog_data);
+  assert (!host_data_heap);
+
+  if (prog_data->args->common_args.hostname)
+    {
+      if ((hosts_count = pstdout_hostnames_count (prog_data->args->common_args.hostname)) < 0)
+        {
+          err_output ("pstdout_hostnames_count: %s", pstdout_strerror (pstdout_errnum));
+          goto cleanup;
+        }
+      
+      if (!hosts_count)
+        {
+          err_output ("invalid number of hosts specified");
+          goto cleanup;
+        }
+    }
+  else /* inband communication, hosts_count = 1 */
+    hosts_count = 1;
+
+  /* don't need more threads than hosts */
+  if (hosts_count < prog_data->args->threadpool_count)
+    prog_data->args->threadpool_count = hosts_count;
+
+  if (!(host_data_array = (ipmisensorsd_host_data_t **)malloc (sizeof (ipmisensorsd_host_data_t *) * hosts_count)))
+    {
+      err_output ("malloc: %s", strerror (errno));
+      goto cleanup;
+    }
+
+  if (!(host_data_heap = heap_create (hosts_count,
+                                      (HeapCmpF)hostdata_timecmp,
+                                      NULL)))
+    {
+      err_output ("heap_create: %s", strerror (errno));
+      goto cleanup;
+    }
+
+  if ((ret = pthread_mutex_init (&host_data_heap_lock, NULL)))
+    {
+      err_output ("pthread_mutex_init: %s", strerror (ret));
+      goto cleanup;
+    }
+
+  if (hosts_count == 1)
+    {
+      if (_add_host_data (prog_data, prog_data->args->common_args.hostname) < 0)
+        goto cleanup;
+    }
+  else
+    {
+      if (!(hlist = fi_hostlist_create (prog_data->args->common_args.hostname)))
+        {
+          err_output ("fi_hostlist_create: %s", strerror (errno));
+          goto cleanup;
+        }
+
+      if (!(hitr = fi_hostlist_iterator_create (hlist)))
+        {
+          err_output ("fi_hostlist_iterator_create: %s", strerror (errno));
+          goto cleanup;
+        }
+
+      while ((host = fi_hostlist_next (hitr)))
+        {
+          if (_add_host_data (prog_data, host) < 0)
+            goto cleanup;
+
+          free(host);
+        }
+      host = NULL;
+    }
+
+  if (prog_data->args->test_run)
+    {
+      char *buf;
+      unsigned int buflen;
+
+      for (i = 0; i < host_data_array_len; i++)
+        _ipmisensorsd_poll (host_data_array[i]);
+
+      if (!(buf = ipmisensorsd_metrics_render (host_data_array,
+                                               host_data_array_len,
+                                               &buflen)))
+        {
+          err_output ("ipmisensorsd_metrics_render: %s", strerror (errno));
+          goto cleanup;
+        }
+
+      fwrite (buf, 1, buflen, stdout);
+      free (buf);
+      rv = 0;
+      goto cleanup;
+    }
+
+  if (ipmisensorsd_server_init (prog_data,
+                                host_data_array,
+                                host_data_array_len) < 0)
+    goto cleanup;
+
+  if (daemon_threadpool_init (prog_data->args->threadpool_count,
+                              _ipmisensorsd_poll,
+                              _ipmisensorsd_poll_postprocess) < 0)
+    goto cleanup;
+
+  while (exit_flag)
+    {
+      pthread_mutex_lock (&host_data_heap_lock);
+
+      host_data = heap_pop (host_data_heap);
+          
+      pthread_mutex_unlock (&host_data_heap_lock);
+
+      /* empty heap, everything is being polled.  Estimate 1/5th of
+       * the session timeout before checking again, like ipmiseld.
+       */
+      if (!host_data)
+        {
+          unsigned int waittime;
+
+          if (prog_data->args->common_args.session_timeout)
+            waittime = prog_data->args->common_args.session_timeout;
+          else
+            waittime = IPMI_SESSION_TIMEOUT_DEFAULT;
+
+          /* session timeout is in milliseconds */
+          waittime /= 1000;
+              
+          /* now take a 5th of it  */
+          waittime /= 5;
+
+          if (!waittime)
+            waittime = 1;
+
+          daemon_sleep (waittime);
+          continue;
+        }
+              
+      if (daemon_threadpool_queue (host_data) < 0)
+        {
+          pthread_mutex_lock (&host_data_heap_lock);
+
+          if (!heap_insert (host_data_heap, host_data))
+            ipmisensorsd_err_output (host_data, "heap_insert: %s", strerror (errno));
+
+          pthread_mutex_unlock (&host_data_heap_lock);
+        }
+
+      pthread_mutex_lock (&host_data_heap_lock);
+
+      host_data = heap_peek (host_data_heap);
+          
+      pthread_mutex_unlock (&host_data_heap_lock);
+
+      /* empty heap, everything must be processing, so we'll sleep
+       * for the poll interval, b/c no one should be scheduled
+       * until after this time has passed anyways.
+       */
+      if (!host_data)
+        daemon_sleep (prog_data->args->poll_interval + 1);
+      else
+        {
+          struct timeval tv;
+
+          gettimeofday (&tv, NULL);
+              
+          /* If next_poll_time == 0, no sleep, its the first time through */
+          if (host_data->next_poll_time
+              && (host_data->next_poll_time > tv.tv_sec)) 
+            daemon_sleep (host_data->next_poll_time - tv.tv_sec);
+        }
+    }
+  
+  rv = 0;
+ cleanup:
+  daemon_threadpool_destroy ();
+  ipmisensorsd_server_destroy ();
+  heap_destroy (host_data_heap);
+  for (i = 0; i < host_data_array_len; i++)
+    _free_host_data (host_data_array[i]);
+  free (host_data_array);
+  fi_hostlist_iterator_destroy (hitr);
+  fi_hostlist_destroy (hlist);
+  free (host);
+  return (rv);
+}
+
+int
+main (int argc, char **argv)
+{
+  ipmisensorsd_prog_data_t prog_data;
+  struct ipmisensorsd_arguments cmd_args;
+
+  err_init (argv[0]);
+  err_set_flags (ERROR_STDERR);
+
+  ipmi_disable_coredump ();
+
+  prog_data.progname = argv[0];
+  ipmisensorsd_argp_parse (argc, argv, &cmd_args);
+  prog_data.args = &cmd_args;
+
+  if (!cmd_args.test_run)
+    {
+      if (!cmd_args.foreground)
+        {
+          daemonize_common (IPMISENSORSD_PIDFILE);
+          err_set_flags (ERROR_SYSLOG);
+        }
+      else
+        err_set_flags (ERROR_STDERR);
+      
+      daemon_signal_handler_setup (_signal_handler_callback);
+
+      /* Call after daemonization, since daemonization closes currently
+       * open fds
+       */
+      openlog (argv[0], LOG_ODELAY | LOG_PID, LOG_DAEMON);
+    }
+  
+  return (_ipmisensorsd (&prog_data) < 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
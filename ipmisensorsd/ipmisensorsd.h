@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef IPMISENSORSD_H
+#define IPMISENSORSD_H
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#if TIME_WITH_SYS_TIME
+#include <sys/time.h>
+#include <time.h>
+#else /* !TIME_WITH_SYS_TIME */
+#if HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else /* !HAVE_SYS_TIME_H */
+#include <time.h>
+#endif /* !HAVE_SYS_TIME_H */
+#endif /* !TIME_WITH_SYS_TIME */
+
+#include <freeipmi/freeipmi.h>
+
+#include "tool-cmdline-common.h"
+#include "tool-oem-common.h"
+#include "tool-sensor-common.h"
+
+/* shorter than the default session timeout, so by default the
+ * session stays up between scrapes
+ */
+#define IPMISENSORSD_POLL_INTERVAL_DEFAULT      10
+
+#define IPMISENSORSD_THREADPOOL_COUNT           8
+
+#define IPMISENSORSD_SENSOR_NAME_MAX            IPMI_SDR_MAX_SENSOR_NAME_LENGTH
+
+#define IPMISENSORSD_SENSOR_UNITS_MAX           128
+
+enum ipmisensorsd_argp_option_keys
+  {
+    IPMISENSORSD_VERBOSE_KEY = 'v',
+    IPMISENSORSD_SENSOR_TYPES_KEY = 't',
+    IPMISENSORSD_EXCLUDE_SENSOR_TYPES_KEY = 'T',
+    IPMISENSORSD_SENSOR_STATE_CONFIG_FILE_KEY = 160,
+    IPMISENSORSD_INTERPRET_OEM_DATA_KEY = 161,
+    IPMISENSORSD_ENTITY_SENSOR_NAMES_KEY = 162,
+    IPMISENSORSD_NON_ABBREVIATED_UNITS_KEY = 163,
+    IPMISENSORSD_POLL_INTERVAL_KEY = 164,
+    IPMISENSORSD_CACHE_DIRECTORY_KEY = 165,
+    IPMISENSORSD_SOCKET_KEY = 166,
+    IPMISENSORSD_THREADPOOL_COUNT_KEY = 167,
+    IPMISENSORSD_TEST_RUN_KEY = 168,
+    IPMISENSORSD_FOREGROUND_KEY = 169,
+  };
+
+struct ipmisensorsd_arguments
+{
+  struct common_cmd_args common_args;
+  unsigned int verbose_count;
+  char sensor_types[MAX_SENSOR_TYPES][MAX_SENSOR_TYPES_STRING_LENGTH+1];
+  unsigned int sensor_types_length;
+  char exclude_sensor_types[MAX_SENSOR_TYPES][MAX_SENSOR_TYPES_STRING_LENGTH+1];
+  unsigned int exclude_sensor_types_length;
+  char *sensor_state_config_file;
+  int interpret_oem_data;
+  int entity_sensor_names;
+  int non_abbreviated_units;
+  unsigned int poll_interval;
+  char *cache_directory;
+  char *socket_path;
+  unsigned int threadpool_count;
+  int test_run;
+  int foreground;
+};
+
+typedef struct ipmisensorsd_prog_data
+{
+  char *progname;
+  struct ipmisensorsd_arguments *args;
+} ipmisensorsd_prog_data_t;
+
+/* One sensor reading from the most recent scrape.  Stored decoded,
+ * the server only formats it.
+ */
+typedef struct ipmisensorsd_sensor
+{
+  uint16_t record_id;
+  uint8_t sensor_number;
+  char sensor_name[IPMISENSORSD_SENSOR_NAME_MAX+1];
+  const char *sensor_type_str;
+  char sensor_units[IPMISENSORSD_SENSOR_UNITS_MAX+1];
+  int reading_available;
+  double reading;
+  int state_available;
+  unsigned int state;
+} ipmisensorsd_sensor_t;
+
+/* Results of the most recent scrape of a host, replaced as a whole
+ * under the metrics lock once a scrape completes.
+ */
+typedef struct ipmisensorsd_host_metrics
+{
+  ipmisensorsd_sensor_t *sensors;
+  unsigned int sensors_count;
+  int up;
+  time_t last_scrape;
+  double scrape_duration;
+} ipmisensorsd_host_metrics_t;
+
+/* Contexts kept open across scrapes.  Torn down and re-established
+ * when a scrape fails or the session may have timed out.
+ */
+typedef struct ipmisensorsd_host_session
+{
+  ipmi_ctx_t ipmi_ctx;
+  ipmi_sdr_ctx_t sdr_ctx;
+  ipmi_sensor_read_ctx_t sensor_read_ctx;
+  ipmi_interpret_ctx_t interpret_ctx;
+  struct ipmi_oem_data oem_data;
+  time_t last_activity;
+} ipmisensorsd_host_session_t;
+
+typedef struct ipmisensorsd_host_data
+{
+  ipmisensorsd_prog_data_t *prog_data;
+  char *hostname;
+  ipmisensorsd_host_session_t session;
+  ipmisensorsd_host_metrics_t metrics;
+  time_t next_poll_time;
+  int last_ipmi_errnum;
+  unsigned int last_ipmi_errnum_count;
+} ipmisensorsd_host_data_t;
+
+#endif /* IPMISENSORSD_H */
@@ -94,6 +94,11 @@ struct ipmi_ctx
 
   ipmi_errnum_type_t errnum;
 
+  /* packet_trace_buf non-NULL if tracing enabled */
+  int packet_trace_fd;
+  uint8_t *packet_trace_buf;
+  unsigned int packet_trace_buf_len;
+
   union
   {
     struct
@@ -81,6 +81,7 @@
 #include "ipmi-lan-session-common.h"
 #include "ipmi-kcs-driver-api.h"
 #include "ipmi-openipmi-driver-api.h"
+#include "ipmi-packet-trace.h"
 #include "ipmi-sunbmc-driver-api.h"
 #include "ipmi-ssif-driver-api.h"
 
@@ -252,6 +253,27 @@ ipmi_ctx_set_flags (ipmi_ctx_t ctx, unsigned int flags)
   return (0);
 }
 
+int
+ipmi_ctx_set_packet_trace_file (ipmi_ctx_t ctx, const char *filename)
+{
+  if (!ctx || ctx->magic != IPMI_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_ctx_errormsg (ctx), ipmi_ctx_errnum (ctx));
+      return (-1);
+    }
+
+  if (!filename)
+    api_packet_trace_close (ctx);
+  else
+    {
+      if (api_packet_trace_open (ctx, filename) < 0)
+        return (-1);
+    }
+
+  ctx->errnum = IPMI_ERR_SUCCESS;
+  return (0);
+}
+
 static void
 _ipmi_outofband_free (ipmi_ctx_t ctx)
 {
@@ -2263,6 +2285,8 @@ ipmi_ctx_close (ipmi_ctx_t ctx)
   else
     _ipmi_inband_close (ctx);
 
+  api_packet_trace_flush (ctx);
+
   ctx->type = IPMI_DEVICE_UNKNOWN;
   ctx->errnum = IPMI_ERR_SUCCESS;
   return (0);
@@ -2280,6 +2304,8 @@ ipmi_ctx_destroy (ipmi_ctx_t ctx)
   if (ctx->type != IPMI_DEVICE_UNKNOWN)
     ipmi_ctx_close (ctx);
 
+  api_packet_trace_close (ctx);
+
   /* secure_memset b/c ctx contains ipmi password */
   secure_memset (ctx, '\0', sizeof (struct ipmi_ctx));
   free (ctx);
@@ -51,6 +51,7 @@
 #include "ipmi-api-trace.h"
 #include "ipmi-api-util.h"
 #include "ipmi-kcs-driver-api.h"
+#include "ipmi-packet-trace.h"
 
 #include "libcommon/ipmi-fiid-util.h"
 
@@ -257,6 +258,13 @@ _kcs_cmd_write (ipmi_ctx_t ctx,
       goto cleanup;
     }
 
+  if (ctx->packet_trace_buf)
+    api_packet_trace_record (ctx,
+                             IPMI_PACKET_TRACE_TYPE_KCS,
+                             IPMI_PACKET_TRACE_DIRECTION_REQUEST,
+                             pkt,
+                             send_len);
+
   rv = 0;
  cleanup:
   free (pkt);
@@ -322,6 +330,13 @@ _kcs_cmd_read (ipmi_ctx_t ctx,
       API_SET_ERRNUM (ctx, IPMI_ERR_SYSTEM_ERROR);
       goto cleanup;
     }
+
+  if (ctx->packet_trace_buf)
+    api_packet_trace_record (ctx,
+                             IPMI_PACKET_TRACE_TYPE_KCS,
+                             IPMI_PACKET_TRACE_DIRECTION_RESPONSE,
+                             pkt,
+                             read_len);
   
   if (ctx->flags & IPMI_FLAGS_DEBUG_DUMP && read_len)
     _api_kcs_dump_rs (ctx,
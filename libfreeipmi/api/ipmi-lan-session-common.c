@@ -70,6 +70,7 @@
 #include "ipmi-api-trace.h"
 #include "ipmi-api-util.h"
 #include "ipmi-lan-session-common.h"
+#include "ipmi-packet-trace.h"
 
 #include "libcommon/ipmi-fiid-util.h"
 
@@ -294,6 +295,12 @@ _api_lan_recvfrom (ipmi_ctx_t ctx,
                                     NULL);
     } while (recv_len < 0 && errno == EINTR);
 
+  if (ctx->packet_trace_buf && recv_len > 0)
+    api_packet_trace_record_lan (ctx,
+                                 IPMI_PACKET_TRACE_DIRECTION_RESPONSE,
+                                 pkt,
+                                 recv_len);
+
   return (recv_len);
 }
 
@@ -580,6 +587,12 @@ _api_lan_cmd_send (ipmi_ctx_t ctx,
       API_ERRNO_TO_API_ERRNUM (ctx, errno);
       goto cleanup;
     }
+
+  if (ctx->packet_trace_buf)
+    api_packet_trace_record_lan (ctx,
+                                 IPMI_PACKET_TRACE_DIRECTION_REQUEST,
+                                 pkt,
+                                 send_len);
   
   if (gettimeofday (&ctx->io.outofband.last_send, NULL) < 0)
     {
@@ -2268,6 +2281,12 @@ _api_lan_2_0_cmd_send (ipmi_ctx_t ctx,
       goto cleanup;
     }
 
+  if (ctx->packet_trace_buf)
+    api_packet_trace_record_lan (ctx,
+                                 IPMI_PACKET_TRACE_DIRECTION_REQUEST,
+                                 pkt,
+                                 send_len);
+
   if (gettimeofday (&ctx->io.outofband.last_send, NULL) < 0)
     {
       API_ERRNO_TO_API_ERRNUM (ctx, errno);
@@ -0,0 +1,394 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#include <unistd.h>
+#include <fcntl.h>
+#if TIME_WITH_SYS_TIME
+#include <sys/time.h>
+#include <time.h>
+#else /* !TIME_WITH_SYS_TIME */
+#if HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else /* !HAVE_SYS_TIME_H */
+#include <time.h>
+#endif /* !HAVE_SYS_TIME_H */
+#endif /* !TIME_WITH_SYS_TIME */
+#include <assert.h>
+#include <errno.h>
+
+#include "freeipmi/api/ipmi-api.h"
+#include "freeipmi/debug/ipmi-debug.h"
+#include "freeipmi/interface/ipmi-rmcpplus-interface.h"
+#include "freeipmi/spec/ipmi-authentication-type-spec.h"
+
+#include "ipmi-api-defs.h"
+#include "ipmi-api-trace.h"
+#include "ipmi-api-util.h"
+#include "ipmi-packet-trace.h"
+
+#include "freeipmi-portability.h"
+
+/* RMCP header precedes the session header's authentication type */
+#define RMCP_HDR_LENGTH 4
+
+/* IPMI 1.5 session header: authentication type, session sequence
+ * number, session id, then the authentication code if the
+ * authentication type is not none.
+ */
+#define IPMI_1_5_AUTHENTICATION_CODE_OFFSET (RMCP_HDR_LENGTH + 9)
+#define IPMI_1_5_AUTHENTICATION_CODE_LENGTH 16
+
+/* IPMI 2.0 session header: authentication type, payload type, OEM
+ * IANA and payload id if the payload type is OEM explicit, session
+ * id, session sequence number, payload length.
+ */
+#define IPMI_2_0_PAYLOAD_TYPE_OFFSET          (RMCP_HDR_LENGTH + 1)
+#define IPMI_2_0_OEM_EXPLICIT_LENGTH          6
+/* session id, session sequence number and payload length */
+#define IPMI_2_0_SESSION_HDR_REMAINING_LENGTH 10
+
+/* Offset of the key exchange authentication code or integrity check
+ * value in RAKP messages 2, 3 and 4.
+ */
+#define IPMI_RAKP_MESSAGE_2_AUTHENTICATION_CODE_OFFSET 40
+#define IPMI_RAKP_MESSAGE_3_AUTHENTICATION_CODE_OFFSET 8
+#define IPMI_RAKP_MESSAGE_4_INTEGRITY_CHECK_VALUE_OFFSET 8
+
+/* pad length and next header precede the session trailer's
+ * authentication code
+ */
+#define IPMI_2_0_SESSION_TRLR_PAD_LENGTH_NEXT_HDR_LENGTH 2
+
+/* The context is only used by one thread at a time, so the buffer
+ * needs no locking.  Each flush is a single write() to a file opened
+ * with O_APPEND, so flushes from different contexts never interleave
+ * within a record.
+ */
+
+int
+api_packet_trace_open (ipmi_ctx_t ctx, const char *filename)
+{
+  int fd;
+
+  assert (ctx
+          && ctx->magic == IPMI_CTX_MAGIC
+          && filename);
+
+  if ((fd = open (filename, O_WRONLY | O_CREAT | O_APPEND, 0600)) < 0)
+    {
+      API_ERRNO_TO_API_ERRNUM (ctx, errno);
+      return (-1);
+    }
+
+  if (!ctx->packet_trace_buf)
+    {
+      if (!(ctx->packet_trace_buf = malloc (IPMI_PACKET_TRACE_BUFLEN)))
+        {
+          API_ERRNO_TO_API_ERRNUM (ctx, errno);
+          close (fd);
+          return (-1);
+        }
+    }
+  else
+    {
+      api_packet_trace_flush (ctx);
+      close (ctx->packet_trace_fd);
+    }
+
+  ctx->packet_trace_fd = fd;
+  ctx->packet_trace_buf_len = 0;
+  return (0);
+}
+
+void
+api_packet_trace_close (ipmi_ctx_t ctx)
+{
+  assert (ctx && ctx->magic == IPMI_CTX_MAGIC);
+
+  if (!ctx->packet_trace_buf)
+    return;
+
+  api_packet_trace_flush (ctx);
+  /* ignore potential error, destroy path */
+  close (ctx->packet_trace_fd);
+  free (ctx->packet_trace_buf);
+  ctx->packet_trace_fd = 0;
+  ctx->packet_trace_buf = NULL;
+  ctx->packet_trace_buf_len = 0;
+}
+
+void
+api_packet_trace_flush (ipmi_ctx_t ctx)
+{
+  ssize_t n;
+
+  assert (ctx && ctx->magic == IPMI_CTX_MAGIC);
+
+  if (!ctx->packet_trace_buf || !ctx->packet_trace_buf_len)
+    return;
+
+  do
+    {
+      n = write (ctx->packet_trace_fd,
+                 ctx->packet_trace_buf,
+                 ctx->packet_trace_buf_len);
+    } while (n < 0 && errno == EINTR);
+
+  /* Don't return an error here.  It's just debug code.  A short
+   * write leaves a partial record at the end of the file, which
+   * ipmi_dump_packet_trace() stops at.
+   */
+  ctx->packet_trace_buf_len = 0;
+}
+
+static uint8_t *
+_put_le (uint8_t *p, uint64_t val, unsigned int bytes)
+{
+  unsigned int i;
+
+  assert (p);
+
+  for (i = 0; i < bytes; i++)
+    p[i] = (val >> (i * 8)) & 0xFF;
+
+  return (p + bytes);
+}
+
+/* returns the copy of the packet in the trace buffer, NULL if the
+ * packet was not recorded
+ */
+static uint8_t *
+_packet_trace_record (ipmi_ctx_t ctx,
+                      uint8_t packet_type,
+                      uint8_t direction,
+                      const void *pkt,
+                      unsigned int *pkt_len)
+{
+  struct timeval tv;
+  const char *hostname = "";
+  unsigned int hostname_len;
+  unsigned int record_len;
+  uint32_t session_id = 0;
+  uint8_t authentication_algorithm = 0;
+  uint8_t integrity_algorithm = 0;
+  uint8_t confidentiality_algorithm = 0;
+  uint8_t *p;
+
+  assert (ctx
+          && ctx->magic == IPMI_CTX_MAGIC
+          && ctx->packet_trace_buf
+          && pkt
+          && pkt_len
+          && (*pkt_len));
+
+  if (packet_type == IPMI_PACKET_TRACE_TYPE_LAN
+      || packet_type == IPMI_PACKET_TRACE_TYPE_LAN_2_0)
+    {
+      hostname = ctx->io.outofband.hostname;
+
+      if (packet_type == IPMI_PACKET_TRACE_TYPE_LAN_2_0)
+        {
+          session_id = ctx->io.outofband.managed_system_session_id;
+          authentication_algorithm = ctx->io.outofband.authentication_algorithm;
+          integrity_algorithm = ctx->io.outofband.integrity_algorithm;
+          confidentiality_algorithm = ctx->io.outofband.confidentiality_algorithm;
+        }
+      else
+        session_id = ctx->io.outofband.session_id;
+    }
+
+  hostname_len = strlen (hostname);
+  if (hostname_len > UINT8_MAX)
+    hostname_len = UINT8_MAX;
+
+  if ((*pkt_len) > UINT16_MAX)
+    (*pkt_len) = UINT16_MAX;
+
+  record_len = IPMI_PACKET_TRACE_HEADER_LENGTH + hostname_len + (*pkt_len);
+
+  if (record_len > IPMI_PACKET_TRACE_BUFLEN)
+    return (NULL);
+
+  if (ctx->packet_trace_buf_len + record_len > IPMI_PACKET_TRACE_BUFLEN)
+    api_packet_trace_flush (ctx);
+
+  gettimeofday (&tv, NULL);
+
+  p = ctx->packet_trace_buf + ctx->packet_trace_buf_len;
+  p = _put_le (p, IPMI_PACKET_TRACE_MAGIC, 4);
+  p = _put_le (p, IPMI_PACKET_TRACE_HEADER_LENGTH, 2);
+  p = _put_le (p, IPMI_PACKET_TRACE_VERSION, 2);
+  p = _put_le (p, record_len, 4);
+  p = _put_le (p, session_id, 4);
+  p = _put_le (p, tv.tv_sec, 8);
+  p = _put_le (p, tv.tv_usec, 4);
+  p = _put_le (p, packet_type, 1);
+  p = _put_le (p, direction, 1);
+  p = _put_le (p, authentication_algorithm, 1);
+  p = _put_le (p, integrity_algorithm, 1);
+  p = _put_le (p, confidentiality_algorithm, 1);
+  p = _put_le (p, hostname_len, 1);
+  p = _put_le (p, (*pkt_len), 2);
+  memcpy (p, hostname, hostname_len);
+  p += hostname_len;
+  memcpy (p, pkt, (*pkt_len));
+
+  ctx->packet_trace_buf_len += record_len;
+  return (p);
+}
+
+void
+api_packet_trace_record (ipmi_ctx_t ctx,
+                         uint8_t packet_type,
+                         uint8_t direction,
+                         const void *pkt,
+                         unsigned int pkt_len)
+{
+  _packet_trace_record (ctx, packet_type, direction, pkt, &pkt_len);
+}
+
+static void
+_scrub_lan (uint8_t *pkt, unsigned int pkt_len)
+{
+  assert (pkt);
+
+  if (pkt_len >= IPMI_1_5_AUTHENTICATION_CODE_OFFSET + IPMI_1_5_AUTHENTICATION_CODE_LENGTH
+      && pkt[RMCP_HDR_LENGTH] != IPMI_AUTHENTICATION_TYPE_NONE)
+    memset (pkt + IPMI_1_5_AUTHENTICATION_CODE_OFFSET,
+            '\0',
+            IPMI_1_5_AUTHENTICATION_CODE_LENGTH);
+}
+
+static void
+_scrub_lan_2_0 (uint8_t *pkt, unsigned int pkt_len)
+{
+  uint8_t payload_type;
+  unsigned int payload_offset;
+  unsigned int payload_length;
+  unsigned int offset = 0;
+
+  assert (pkt);
+
+  if (pkt_len <= IPMI_2_0_PAYLOAD_TYPE_OFFSET)
+    return;
+
+  payload_type = pkt[IPMI_2_0_PAYLOAD_TYPE_OFFSET];
+
+  payload_offset = IPMI_2_0_PAYLOAD_TYPE_OFFSET + 1 + IPMI_2_0_SESSION_HDR_REMAINING_LENGTH;
+  if ((payload_type & 0x3F) == IPMI_PAYLOAD_TYPE_OEM_EXPLICIT)
+    payload_offset += IPMI_2_0_OEM_EXPLICIT_LENGTH;
+
+  if (pkt_len < payload_offset)
+    return;
+
+  payload_length = pkt[payload_offset - 2] | (pkt[payload_offset - 1] << 8);
+  if (payload_length > pkt_len - payload_offset)
+    payload_length = pkt_len - payload_offset;
+
+  /* RAKP authentication codes are HMACs keyed with the password or
+   * the session integrity key, they would allow an offline password
+   * search.
+   */
+  switch (payload_type & 0x3F)
+    {
+    case IPMI_PAYLOAD_TYPE_RAKP_MESSAGE_2:
+      offset = IPMI_RAKP_MESSAGE_2_AUTHENTICATION_CODE_OFFSET;
+      break;
+    case IPMI_PAYLOAD_TYPE_RAKP_MESSAGE_3:
+      offset = IPMI_RAKP_MESSAGE_3_AUTHENTICATION_CODE_OFFSET;
+      break;
+    case IPMI_PAYLOAD_TYPE_RAKP_MESSAGE_4:
+      offset = IPMI_RAKP_MESSAGE_4_INTEGRITY_CHECK_VALUE_OFFSET;
+      break;
+    }
+
+  if (offset && payload_length > offset)
+    memset (pkt + payload_offset + offset, '\0', payload_length - offset);
+
+  /* Likewise the session trailer's authentication code, it is the
+   * rest of the packet after the pad length and next header.
+   */
+  if (payload_type & 0x40)
+    {
+      unsigned int trlr_offset;
+      unsigned int pad_length;
+
+      trlr_offset = payload_offset + payload_length;
+
+      /* the pad precedes the pad length */
+      while (trlr_offset < pkt_len && pkt[trlr_offset] == 0xFF)
+        trlr_offset++;
+
+      if (trlr_offset >= pkt_len)
+        return;
+
+      pad_length = pkt[trlr_offset];
+      if (pad_length != trlr_offset - payload_offset - payload_length)
+        return;
+
+      trlr_offset += IPMI_2_0_SESSION_TRLR_PAD_LENGTH_NEXT_HDR_LENGTH;
+      if (trlr_offset < pkt_len)
+        memset (pkt + trlr_offset, '\0', pkt_len - trlr_offset);
+    }
+}
+
+void
+api_packet_trace_record_lan (ipmi_ctx_t ctx,
+                             uint8_t direction,
+                             const void *pkt,
+                             unsigned int pkt_len)
+{
+  uint8_t packet_type;
+  uint8_t *p;
+
+  assert (ctx
+          && ctx->magic == IPMI_CTX_MAGIC
+          && ctx->packet_trace_buf
+          && pkt
+          && pkt_len);
+
+  /* IPMI 1.5 packets are sent during IPMI 2.0 session setup, so go by
+   * the authentication type in the session header rather than the
+   * context type.
+   */
+  if (pkt_len > RMCP_HDR_LENGTH
+      && ((const uint8_t *)pkt)[RMCP_HDR_LENGTH] == IPMI_AUTHENTICATION_TYPE_RMCPPLUS)
+    packet_type = IPMI_PACKET_TRACE_TYPE_LAN_2_0;
+  else
+    packet_type = IPMI_PACKET_TRACE_TYPE_LAN;
+
+  if (!(p = _packet_trace_record (ctx, packet_type, direction, pkt, &pkt_len)))
+    return;
+
+  /* Authentication codes are zeroed in the trace copy, a trace must
+   * not give away the password.
+   */
+  if (packet_type == IPMI_PACKET_TRACE_TYPE_LAN_2_0)
+    _scrub_lan_2_0 (p, pkt_len);
+  else
+    _scrub_lan (p, pkt_len);
+}
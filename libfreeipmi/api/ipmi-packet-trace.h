@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+#ifndef IPMI_PACKET_TRACE_H
+#define IPMI_PACKET_TRACE_H
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdint.h>
+
+#include "freeipmi/api/ipmi-api.h"
+
+/* Per context buffer, appended to the trace file when full */
+#define IPMI_PACKET_TRACE_BUFLEN 65536
+
+int api_packet_trace_open (ipmi_ctx_t ctx, const char *filename);
+
+void api_packet_trace_close (ipmi_ctx_t ctx);
+
+void api_packet_trace_flush (ipmi_ctx_t ctx);
+
+/* Never fails, tracing must not affect the command being traced */
+void api_packet_trace_record (ipmi_ctx_t ctx,
+                              uint8_t packet_type,
+                              uint8_t direction,
+                              const void *pkt,
+                              unsigned int pkt_len);
+
+/* determines IPMI 1.5 vs. IPMI 2.0 from the packet */
+void api_packet_trace_record_lan (ipmi_ctx_t ctx,
+                                  uint8_t direction,
+                                  const void *pkt,
+                                  unsigned int pkt_len);
+
+#endif /* IPMI_PACKET_TRACE_H */
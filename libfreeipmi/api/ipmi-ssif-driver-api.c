@@ -60,6 +60,7 @@
 #include "ipmi-api-defs.h"
 #include "ipmi-api-trace.h"
 #include "ipmi-api-util.h"
+#include "ipmi-packet-trace.h"
 #include "ipmi-ssif-driver-api.h"
 
 #include "libcommon/ipmi-fiid-util.h"
@@ -236,6 +237,13 @@ _ssif_cmd_write (ipmi_ctx_t ctx,
       goto cleanup;
     }
 
+  if (ctx->packet_trace_buf)
+    api_packet_trace_record (ctx,
+                             IPMI_PACKET_TRACE_TYPE_SSIF,
+                             IPMI_PACKET_TRACE_DIRECTION_REQUEST,
+                             pkt,
+                             send_len);
+
   rv = 0;
  cleanup:
   free (pkt);
@@ -299,6 +307,13 @@ _ssif_cmd_read (ipmi_ctx_t ctx,
       API_SET_ERRNUM (ctx, IPMI_ERR_SYSTEM_ERROR);
       goto cleanup;
     }
+
+  if (ctx->packet_trace_buf)
+    api_packet_trace_record (ctx,
+                             IPMI_PACKET_TRACE_TYPE_SSIF,
+                             IPMI_PACKET_TRACE_DIRECTION_RESPONSE,
+                             pkt,
+                             read_len);
   
   if (ctx->flags & IPMI_FLAGS_DEBUG_DUMP && read_len)
     _api_ssif_dump_rs (ctx,
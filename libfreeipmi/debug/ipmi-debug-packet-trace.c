@@ -0,0 +1,570 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#if TIME_WITH_SYS_TIME
+#include <sys/time.h>
+#include <time.h>
+#else /* !TIME_WITH_SYS_TIME */
+#if HAVE_SYS_TIME_H
+#include <sys/time.h>
+#else /* !HAVE_SYS_TIME_H */
+#include <time.h>
+#endif /* !HAVE_SYS_TIME_H */
+#endif /* !TIME_WITH_SYS_TIME */
+#include <assert.h>
+#include <errno.h>
+
+#include "freeipmi/debug/ipmi-debug.h"
+#include "freeipmi/fiid/fiid.h"
+#include "freeipmi/interface/ipmi-lan-interface.h"
+#include "freeipmi/interface/ipmi-rmcpplus-interface.h"
+#include "freeipmi/interface/rmcp-interface.h"
+#include "freeipmi/payload/ipmi-sol-payload.h"
+#include "freeipmi/spec/ipmi-authentication-type-spec.h"
+
+#include "ipmi-debug-common.h"
+
+#include "libcommon/ipmi-trace.h"
+
+#include "freeipmi-portability.h"
+#include "debug-util.h"
+
+/* offsets into the raw packets, see the interface templates */
+#define PACKET_TRACE_RMCP_HDR_LEN                  4
+#define PACKET_TRACE_LAN_SESSION_HDR_LEN           10
+#define PACKET_TRACE_LAN_AUTHENTICATION_CODE_LEN   16
+#define PACKET_TRACE_RMCPPLUS_SESSION_HDR_LEN      12
+#define PACKET_TRACE_RMCPPLUS_PAYLOAD_TYPE_MASK    0x3F
+#define PACKET_TRACE_RMCPPLUS_PAYLOAD_ENCRYPTED    0x80
+#define PACKET_TRACE_LAN_MSG_HDR_RQ_LEN            6
+#define PACKET_TRACE_LAN_MSG_HDR_RS_LEN            6
+#define PACKET_TRACE_INBAND_HDR_LEN                1
+
+#define PACKET_TRACE_HOSTNAME_MAX                  255
+
+#define PACKET_TRACE_TIME_BUFLEN                   256
+
+/* The command is not known when decoding a trace, so the command
+ * data is dumped as raw bytes after the command and completion
+ * code.
+ */
+static fiid_template_t tmpl_packet_trace_cmd_rq =
+  {
+    { 8, "cmd", FIID_FIELD_REQUIRED | FIID_FIELD_LENGTH_FIXED},
+    { 8192, "data", FIID_FIELD_OPTIONAL | FIID_FIELD_LENGTH_VARIABLE},
+    { 0, "", 0}
+  };
+
+static fiid_template_t tmpl_packet_trace_cmd_rs =
+  {
+    { 8, "cmd", FIID_FIELD_REQUIRED | FIID_FIELD_LENGTH_FIXED},
+    { 8, "comp_code", FIID_FIELD_REQUIRED | FIID_FIELD_LENGTH_FIXED},
+    { 8192, "data", FIID_FIELD_OPTIONAL | FIID_FIELD_LENGTH_VARIABLE},
+    { 0, "", 0}
+  };
+
+struct packet_trace_record
+{
+  uint32_t session_id;
+  uint64_t seconds;
+  uint32_t usec;
+  uint8_t packet_type;
+  uint8_t direction;
+  uint8_t authentication_algorithm;
+  uint8_t integrity_algorithm;
+  uint8_t confidentiality_algorithm;
+  char hostname[PACKET_TRACE_HOSTNAME_MAX + 1];
+  const uint8_t *pkt;
+  unsigned int pkt_len;
+};
+
+static uint64_t
+_get_le (const uint8_t *p, unsigned int bytes)
+{
+  uint64_t val = 0;
+  unsigned int i;
+
+  assert (p);
+
+  for (i = 0; i < bytes; i++)
+    val |= ((uint64_t)p[i]) << (i * 8);
+
+  return (val);
+}
+
+/* msg is the IPMI message header followed by the command */
+static void
+_hdr_msg (uint8_t debug_type,
+          uint8_t direction,
+          const uint8_t *msg,
+          unsigned int msg_len,
+          char *hdrbuf)
+{
+  unsigned int hdr_len;
+  uint8_t net_fn;
+  uint8_t cmd;
+  uint8_t group_extension = 0;
+  unsigned int group_extension_indx;
+
+  assert (msg);
+  assert (hdrbuf);
+
+  if (direction == IPMI_PACKET_TRACE_DIRECTION_REQUEST)
+    hdr_len = PACKET_TRACE_LAN_MSG_HDR_RQ_LEN;
+  else
+    hdr_len = PACKET_TRACE_LAN_MSG_HDR_RS_LEN;
+
+  if (msg_len < hdr_len)
+    {
+      debug_hdr_str (debug_type,
+                     direction,
+                     DEBUG_UTIL_FLAGS_DEFAULT,
+                     "Unknown",
+                     hdrbuf,
+                     DEBUG_UTIL_HDR_BUFLEN);
+      return;
+    }
+
+  /* response net_fn is the request net_fn + 1 */
+  net_fn = (msg[1] >> 2) & ~0x01;
+  cmd = msg[hdr_len - 1];
+
+  group_extension_indx = hdr_len;
+  if (direction == IPMI_PACKET_TRACE_DIRECTION_RESPONSE)
+    group_extension_indx++;
+  if (msg_len > group_extension_indx)
+    group_extension = msg[group_extension_indx];
+
+  debug_hdr_cmd (debug_type,
+                 direction,
+                 net_fn,
+                 cmd,
+                 group_extension,
+                 hdrbuf,
+                 DEBUG_UTIL_HDR_BUFLEN);
+}
+
+static int
+_dump_lan (int fd,
+           const char *prefix,
+           const struct packet_trace_record *record)
+{
+  char hdrbuf[DEBUG_UTIL_HDR_BUFLEN + 1];
+  unsigned int msg_indx;
+  fiid_template_t *tmpl_lan_msg_hdr;
+  fiid_template_t *tmpl_cmd;
+
+  assert (record);
+
+  memset (hdrbuf, '\0', DEBUG_UTIL_HDR_BUFLEN + 1);
+
+  msg_indx = PACKET_TRACE_RMCP_HDR_LEN + PACKET_TRACE_LAN_SESSION_HDR_LEN;
+
+  if (record->pkt_len < msg_indx
+      || (record->pkt[3] & 0x1F) != RMCP_HDR_MESSAGE_CLASS_IPMI)
+    goto dump_hex;
+
+  if (record->pkt[PACKET_TRACE_RMCP_HDR_LEN] != IPMI_AUTHENTICATION_TYPE_NONE)
+    msg_indx += PACKET_TRACE_LAN_AUTHENTICATION_CODE_LEN;
+
+  if (record->pkt_len <= msg_indx)
+    goto dump_hex;
+
+  _hdr_msg (DEBUG_UTIL_TYPE_IPMI_1_5,
+            record->direction,
+            record->pkt + msg_indx,
+            record->pkt_len - msg_indx,
+            hdrbuf);
+
+  if (record->direction == IPMI_PACKET_TRACE_DIRECTION_REQUEST)
+    {
+      tmpl_lan_msg_hdr = &tmpl_lan_msg_hdr_rq;
+      tmpl_cmd = &tmpl_packet_trace_cmd_rq;
+    }
+  else
+    {
+      tmpl_lan_msg_hdr = &tmpl_lan_msg_hdr_rs;
+      tmpl_cmd = &tmpl_packet_trace_cmd_rs;
+    }
+
+  return (ipmi_dump_lan_packet (fd,
+                                prefix,
+                                hdrbuf,
+                                NULL,
+                                record->pkt,
+                                record->pkt_len,
+                                *tmpl_lan_msg_hdr,
+                                *tmpl_cmd));
+
+ dump_hex:
+  debug_hdr_str (DEBUG_UTIL_TYPE_IPMI_1_5,
+                 record->direction,
+                 DEBUG_UTIL_FLAGS_DEFAULT,
+                 "Unknown",
+                 hdrbuf,
+                 DEBUG_UTIL_HDR_BUFLEN);
+  return (ipmi_dump_hex (fd,
+                         prefix,
+                         hdrbuf,
+                         NULL,
+                         record->pkt,
+                         record->pkt_len));
+}
+
+static int
+_dump_lan_2_0 (int fd,
+               const char *prefix,
+               const struct packet_trace_record *record)
+{
+  char hdrbuf[DEBUG_UTIL_HDR_BUFLEN + 1];
+  unsigned int payload_indx;
+  uint8_t payload_type;
+  const char *str = NULL;
+  fiid_template_t *tmpl_lan_msg_hdr = NULL;
+  fiid_template_t *tmpl_cmd = NULL;
+
+  assert (record);
+
+  memset (hdrbuf, '\0', DEBUG_UTIL_HDR_BUFLEN + 1);
+
+  payload_indx = PACKET_TRACE_RMCP_HDR_LEN + PACKET_TRACE_RMCPPLUS_SESSION_HDR_LEN;
+
+  if (record->pkt_len <= payload_indx
+      || (record->pkt[3] & 0x1F) != RMCP_HDR_MESSAGE_CLASS_IPMI
+      || !IPMI_AUTHENTICATION_ALGORITHM_SUPPORTED (record->authentication_algorithm)
+      || !IPMI_INTEGRITY_ALGORITHM_SUPPORTED (record->integrity_algorithm))
+    goto dump_hex;
+
+  /* Payloads encrypted with AES can't be decoded, the key is not
+   * recorded.
+   */
+  if (record->pkt[PACKET_TRACE_RMCP_HDR_LEN + 1] & PACKET_TRACE_RMCPPLUS_PAYLOAD_ENCRYPTED)
+    {
+      str = "Encrypted";
+      goto dump_hex;
+    }
+
+  payload_type = record->pkt[PACKET_TRACE_RMCP_HDR_LEN + 1] & PACKET_TRACE_RMCPPLUS_PAYLOAD_TYPE_MASK;
+
+  switch (payload_type)
+    {
+    case IPMI_PAYLOAD_TYPE_IPMI:
+      _hdr_msg (DEBUG_UTIL_TYPE_IPMI_2_0,
+                record->direction,
+                record->pkt + payload_indx,
+                record->pkt_len - payload_indx,
+                hdrbuf);
+      if (record->direction == IPMI_PACKET_TRACE_DIRECTION_REQUEST)
+        {
+          tmpl_lan_msg_hdr = &tmpl_lan_msg_hdr_rq;
+          tmpl_cmd = &tmpl_packet_trace_cmd_rq;
+        }
+      else
+        {
+          tmpl_lan_msg_hdr = &tmpl_lan_msg_hdr_rs;
+          tmpl_cmd = &tmpl_packet_trace_cmd_rs;
+        }
+      break;
+    case IPMI_PAYLOAD_TYPE_SOL:
+      str = "SOL";
+      tmpl_cmd = &tmpl_sol_payload_data;
+      break;
+    case IPMI_PAYLOAD_TYPE_RMCPPLUS_OPEN_SESSION_REQUEST:
+      str = DEBUG_UTIL_OPEN_SESSION_STR;
+      tmpl_cmd = &tmpl_rmcpplus_open_session_request;
+      break;
+    case IPMI_PAYLOAD_TYPE_RMCPPLUS_OPEN_SESSION_RESPONSE:
+      str = DEBUG_UTIL_OPEN_SESSION_STR;
+      tmpl_cmd = &tmpl_rmcpplus_open_session_response;
+      break;
+    case IPMI_PAYLOAD_TYPE_RAKP_MESSAGE_1:
+      str = DEBUG_UTIL_RAKP_1_STR;
+      tmpl_cmd = &tmpl_rmcpplus_rakp_message_1;
+      break;
+    case IPMI_PAYLOAD_TYPE_RAKP_MESSAGE_2:
+      str = DEBUG_UTIL_RAKP_2_STR;
+      tmpl_cmd = &tmpl_rmcpplus_rakp_message_2;
+      break;
+    case IPMI_PAYLOAD_TYPE_RAKP_MESSAGE_3:
+      str = DEBUG_UTIL_RAKP_3_STR;
+      tmpl_cmd = &tmpl_rmcpplus_rakp_message_3;
+      break;
+    case IPMI_PAYLOAD_TYPE_RAKP_MESSAGE_4:
+      str = DEBUG_UTIL_RAKP_4_STR;
+      tmpl_cmd = &tmpl_rmcpplus_rakp_message_4;
+      break;
+    default:
+      goto dump_hex;
+    }
+
+  if (str)
+    debug_hdr_str (DEBUG_UTIL_TYPE_IPMI_2_0,
+                   record->direction,
+                   DEBUG_UTIL_FLAGS_DEFAULT,
+                   str,
+                   hdrbuf,
+                   DEBUG_UTIL_HDR_BUFLEN);
+
+  return (ipmi_dump_rmcpplus_packet (fd,
+                                     prefix,
+                                     hdrbuf,
+                                     NULL,
+                                     record->authentication_algorithm,
+                                     record->integrity_algorithm,
+                                     IPMI_CONFIDENTIALITY_ALGORITHM_NONE,
+                                     NULL,
+                                     0,
+                                     NULL,
+                                     0,
+                                     record->pkt,
+                                     record->pkt_len,
+                                     tmpl_lan_msg_hdr ? *tmpl_lan_msg_hdr : NULL,
+                                     *tmpl_cmd));
+
+ dump_hex:
+  debug_hdr_str (DEBUG_UTIL_TYPE_IPMI_2_0,
+                 record->direction,
+                 DEBUG_UTIL_FLAGS_DEFAULT,
+                 str ? str : "Unknown",
+                 hdrbuf,
+                 DEBUG_UTIL_HDR_BUFLEN);
+  return (ipmi_dump_hex (fd,
+                         prefix,
+                         hdrbuf,
+                         NULL,
+                         record->pkt,
+                         record->pkt_len));
+}
+
+static int
+_dump_inband (int fd,
+              const char *prefix,
+              const struct packet_trace_record *record)
+{
+  char hdrbuf[DEBUG_UTIL_HDR_BUFLEN + 1];
+  fiid_template_t *tmpl_cmd;
+  uint8_t net_fn;
+  uint8_t group_extension = 0;
+  unsigned int group_extension_indx;
+
+  assert (record);
+
+  memset (hdrbuf, '\0', DEBUG_UTIL_HDR_BUFLEN + 1);
+
+  /* inband packets are the net_fn/lun byte followed by the command */
+  if (record->pkt_len <= PACKET_TRACE_INBAND_HDR_LEN)
+    {
+      debug_hdr_str (DEBUG_UTIL_TYPE_INBAND,
+                     record->direction,
+                     DEBUG_UTIL_FLAGS_DEFAULT,
+                     "Unknown",
+                     hdrbuf,
+                     DEBUG_UTIL_HDR_BUFLEN);
+      return (ipmi_dump_hex (fd,
+                             prefix,
+                             hdrbuf,
+                             NULL,
+                             record->pkt,
+                             record->pkt_len));
+    }
+
+  net_fn = (record->pkt[0] >> 2) & ~0x01;
+
+  group_extension_indx = PACKET_TRACE_INBAND_HDR_LEN + 1;
+  if (record->direction == IPMI_PACKET_TRACE_DIRECTION_RESPONSE)
+    group_extension_indx++;
+  if (record->pkt_len > group_extension_indx)
+    group_extension = record->pkt[group_extension_indx];
+
+  debug_hdr_cmd (DEBUG_UTIL_TYPE_INBAND,
+                 record->direction,
+                 net_fn,
+                 record->pkt[PACKET_TRACE_INBAND_HDR_LEN],
+                 group_extension,
+                 hdrbuf,
+                 DEBUG_UTIL_HDR_BUFLEN);
+
+  if (record->direction == IPMI_PACKET_TRACE_DIRECTION_REQUEST)
+    tmpl_cmd = &tmpl_packet_trace_cmd_rq;
+  else
+    tmpl_cmd = &tmpl_packet_trace_cmd_rs;
+
+  if (record->packet_type == IPMI_PACKET_TRACE_TYPE_KCS)
+    return (ipmi_dump_kcs_packet (fd,
+                                  prefix,
+                                  hdrbuf,
+                                  NULL,
+                                  record->pkt,
+                                  record->pkt_len,
+                                  *tmpl_cmd));
+
+  return (ipmi_dump_ssif_packet (fd,
+                                 prefix,
+                                 hdrbuf,
+                                 NULL,
+                                 record->pkt,
+                                 record->pkt_len,
+                                 *tmpl_cmd));
+}
+
+static int
+_dump_record (int fd, const struct packet_trace_record *record)
+{
+  char prefix_buf[IPMI_DEBUG_MAX_PREFIX_LEN];
+  char timebuf[PACKET_TRACE_TIME_BUFLEN + 1];
+  const char *prefix = NULL;
+  struct tm tm;
+  time_t t;
+
+  assert (record);
+
+  if (record->hostname[0])
+    prefix = record->hostname;
+
+  if (debug_set_prefix (prefix_buf, IPMI_DEBUG_MAX_PREFIX_LEN, prefix) < 0)
+    {
+      ERRNO_TRACE (errno);
+      return (-1);
+    }
+
+  memset (timebuf, '\0', PACKET_TRACE_TIME_BUFLEN + 1);
+  t = record->seconds;
+  localtime_r (&t, &tm);
+  strftime (timebuf, PACKET_TRACE_TIME_BUFLEN, "%Y-%m-%d %H:%M:%S", &tm);
+
+  if (debug_dprintf (fd,
+                     "%s%s.%06u Session ID = 0x%08X\n",
+                     prefix_buf,
+                     timebuf,
+                     record->usec,
+                     record->session_id) < 0)
+    {
+      ERRNO_TRACE (errno);
+      return (-1);
+    }
+
+  switch (record->packet_type)
+    {
+    case IPMI_PACKET_TRACE_TYPE_LAN:
+      return (_dump_lan (fd, prefix, record));
+    case IPMI_PACKET_TRACE_TYPE_LAN_2_0:
+      return (_dump_lan_2_0 (fd, prefix, record));
+    case IPMI_PACKET_TRACE_TYPE_KCS:
+    case IPMI_PACKET_TRACE_TYPE_SSIF:
+      return (_dump_inband (fd, prefix, record));
+    default:
+      {
+        char hdrbuf[DEBUG_UTIL_HDR_BUFLEN + 1];
+
+        /* from a newer version, dump what we can */
+        memset (hdrbuf, '\0', DEBUG_UTIL_HDR_BUFLEN + 1);
+        debug_hdr_str (DEBUG_UTIL_TYPE_NONE,
+                       record->direction,
+                       DEBUG_UTIL_FLAGS_DEFAULT,
+                       "Unknown",
+                       hdrbuf,
+                       DEBUG_UTIL_HDR_BUFLEN);
+        return (ipmi_dump_hex (fd,
+                               prefix,
+                               hdrbuf,
+                               NULL,
+                               record->pkt,
+                               record->pkt_len));
+      }
+    }
+
+  /* NOT REACHED */
+  return (0);
+}
+
+int
+ipmi_dump_packet_trace (int fd,
+                        const void *buf,
+                        unsigned int buf_len)
+{
+  const uint8_t *p = buf;
+  unsigned int indx = 0;
+
+  if (!buf)
+    {
+      SET_ERRNO (EINVAL);
+      return (-1);
+    }
+
+  while (buf_len - indx >= IPMI_PACKET_TRACE_HEADER_LENGTH)
+    {
+      struct packet_trace_record record;
+      unsigned int header_len;
+      unsigned int record_len;
+      unsigned int hostname_len;
+
+      if (_get_le (p + indx, 4) != IPMI_PACKET_TRACE_MAGIC)
+        {
+          SET_ERRNO (EINVAL);
+          return (-1);
+        }
+
+      /* later versions may extend the header, but not reorder it */
+      header_len = _get_le (p + indx + 4, 2);
+      record_len = _get_le (p + indx + 8, 4);
+      record.session_id = _get_le (p + indx + 12, 4);
+      record.seconds = _get_le (p + indx + 16, 8);
+      record.usec = _get_le (p + indx + 24, 4);
+      record.packet_type = p[indx + 28];
+      record.direction = p[indx + 29];
+      record.authentication_algorithm = p[indx + 30];
+      record.integrity_algorithm = p[indx + 31];
+      record.confidentiality_algorithm = p[indx + 32];
+      hostname_len = p[indx + 33];
+      record.pkt_len = _get_le (p + indx + 34, 2);
+
+      if (header_len < IPMI_PACKET_TRACE_HEADER_LENGTH
+          || record_len < header_len + hostname_len + record.pkt_len
+          || (record.direction != IPMI_PACKET_TRACE_DIRECTION_REQUEST
+              && record.direction != IPMI_PACKET_TRACE_DIRECTION_RESPONSE)
+          || !record.pkt_len)
+        {
+          SET_ERRNO (EINVAL);
+          return (-1);
+        }
+
+      /* partial record at the end of the buffer */
+      if (buf_len - indx < record_len)
+        break;
+
+      memcpy (record.hostname, p + indx + header_len, hostname_len);
+      record.hostname[hostname_len] = '\0';
+      record.pkt = p + indx + header_len + hostname_len;
+
+      if (_dump_record (fd, &record) < 0)
+        return (-1);
+
+      indx += record_len;
+    }
+
+  return (indx);
+}
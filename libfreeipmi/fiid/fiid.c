@@ -41,6 +41,15 @@
 #define FIID_OBJ_MAGIC 0xf00fd00d
 #define FIID_ITERATOR_MAGIC 0xd00df00f
 
+/* How fiid_obj_get() and fiid_obj_set() access a field, decided once
+ * per field when the object is created.  Most IPMI fields are whole
+ * bytes or lie within a single byte, those skip the generic bit
+ * operations.
+ */
+#define FIID_FIELD_ACCESS_GENERIC  0
+#define FIID_FIELD_ACCESS_BYTES    1 /* byte aligned, 1 to 8 whole bytes */
+#define FIID_FIELD_ACCESS_SUB_BYTE 2 /* within a single byte */
+
 struct fiid_field_data
 {
   unsigned int max_field_len;
@@ -50,6 +59,7 @@ struct fiid_field_data
   unsigned int index;           /* for lookup */
   unsigned int start;           /* for lookup */
   unsigned int end;             /* for lookup */
+  unsigned int access;          /* FIID_FIELD_ACCESS_* */
 };
 
 struct fiid_obj
@@ -779,11 +789,8 @@ fiid_template_free (fiid_field_t *tmpl_dynamic)
   free (tmpl_dynamic);
 }
 
-static int
-_fiid_obj_field_start_end (fiid_obj_t obj,
-                           const char *field,
-                           unsigned int *start,
-                           unsigned int *end)
+static struct fiid_field_data *
+_fiid_obj_lookup_field (fiid_obj_t obj, const char *field)
 {
   struct fiid_field_data *ffdptr;
   unsigned int i;
@@ -791,15 +798,9 @@ _fiid_obj_field_start_end (fiid_obj_t obj,
   assert (obj);
   assert (obj->magic == FIID_OBJ_MAGIC);
   assert (field);
-  assert (start);
-  assert (end);
 
   if ((ffdptr = hash_find (obj->lookup, field)))
-    {
-      *start = ffdptr->start;
-      *end = ffdptr->end;
-      return (ffdptr->max_field_len);
-    }
+    return (ffdptr);
 
   /* integer overflow conditions checked during object creation */
   for (i = 0; obj->field_data[i].max_field_len; i++)
@@ -811,17 +812,37 @@ _fiid_obj_field_start_end (fiid_obj_t obj,
                             &(obj->field_data[i])))
             {
               obj->errnum = FIID_ERR_INTERNAL_ERROR;
-              return (-1);
+              return (NULL);
             }
-          
-          *start = obj->field_data[i].start;
-          *end = obj->field_data[i].end;
-          return (obj->field_data[i].max_field_len);
+
+          return (&(obj->field_data[i]));
         }
     }
 
   obj->errnum = FIID_ERR_FIELD_NOT_FOUND;
-  return (-1);
+  return (NULL);
+}
+
+static int
+_fiid_obj_field_start_end (fiid_obj_t obj,
+                           const char *field,
+                           unsigned int *start,
+                           unsigned int *end)
+{
+  struct fiid_field_data *ffdptr;
+
+  assert (obj);
+  assert (obj->magic == FIID_OBJ_MAGIC);
+  assert (field);
+  assert (start);
+  assert (end);
+
+  if (!(ffdptr = _fiid_obj_lookup_field (obj, field)))
+    return (-1);
+
+  *start = ffdptr->start;
+  *end = ffdptr->end;
+  return (ffdptr->max_field_len);
 }
 
 static int
@@ -860,33 +881,15 @@ static int
 _fiid_obj_field_len (fiid_obj_t obj, const char *field)
 {
   struct fiid_field_data *ffdptr;
-  unsigned int i;
 
   assert (obj);
   assert (obj->magic == FIID_OBJ_MAGIC);
   assert (field);
-  
-  if ((ffdptr = hash_find (obj->lookup, field)))
-    return (ffdptr->max_field_len);
-  
-  for (i = 0; obj->field_data[i].max_field_len; i++)
-    {
-      if (!strcmp (obj->field_data[i].key, field))
-        {
-          if (!hash_insert (obj->lookup,
-                            obj->field_data[i].key,
-                            &(obj->field_data[i])))
-            {
-              obj->errnum = FIID_ERR_INTERNAL_ERROR;
-              return (-1);
-            }
-          
-          return (obj->field_data[i].max_field_len);
-        }
-    }
 
-  obj->errnum = FIID_ERR_FIELD_NOT_FOUND;
-  return (-1);
+  if (!(ffdptr = _fiid_obj_lookup_field (obj, field)))
+    return (-1);
+
+  return (ffdptr->max_field_len);
 }
 
 char *
@@ -898,6 +901,22 @@ fiid_strerror (fiid_err_t errnum)
     return (fiid_errmsg[FIID_ERR_ERRNUMRANGE]);
 }
 
+static unsigned int
+_fiid_field_access (unsigned int start, unsigned int field_len)
+{
+  if (!(start % 8)
+      && !(field_len % 8)
+      && field_len
+      && field_len <= 64)
+    return (FIID_FIELD_ACCESS_BYTES);
+
+  if (field_len
+      && (start % 8) + field_len <= 8)
+    return (FIID_FIELD_ACCESS_SUB_BYTE);
+
+  return (FIID_FIELD_ACCESS_GENERIC);
+}
+
 fiid_obj_t
 fiid_obj_create (fiid_template_t tmpl)
 {
@@ -970,10 +989,10 @@ fiid_obj_create (fiid_template_t tmpl)
     }
   memset (obj->field_data, '\0', obj->field_data_len * sizeof (struct fiid_field_data));
   
-  if (!(obj->lookup = hash_create (obj->field_data_len,
-                                   (hash_key_f)hash_key_string,
-                                   (hash_cmp_f)strcmp,
-                                   NULL)))
+  if (!(obj->lookup = hash_create_fixed (obj->field_data_len,
+                                         (hash_key_f)hash_key_string,
+                                         (hash_cmp_f)strcmp,
+                                         NULL)))
     {
       errno = ENOMEM;
       goto cleanup;
@@ -1005,6 +1024,7 @@ fiid_obj_create (fiid_template_t tmpl)
       obj->field_data[i].index = i;
       obj->field_data[i].start = start;
       obj->field_data[i].end = start + obj->field_data[i].max_field_len;
+      obj->field_data[i].access = _fiid_field_access (start, obj->field_data[i].max_field_len);
       max_pkt_len += tmpl[i].max_field_len;
 
       if (obj->field_data[i].flags & FIID_FIELD_MAKES_PACKET_SUFFICIENT)
@@ -1087,10 +1107,10 @@ fiid_obj_dup (fiid_obj_t src_obj)
           src_obj->field_data,
           src_obj->field_data_len * sizeof (struct fiid_field_data));
 
-  if (!(dest_obj->lookup = hash_create (dest_obj->field_data_len,
-                                        (hash_key_f)hash_key_string,
-                                        (hash_cmp_f)strcmp,
-                                        NULL)))
+  if (!(dest_obj->lookup = hash_create_fixed (dest_obj->field_data_len,
+                                              (hash_key_f)hash_key_string,
+                                              (hash_cmp_f)strcmp,
+                                              NULL)))
     {
       src_obj->errnum = FIID_ERR_OUT_OF_MEMORY;
       goto cleanup;
@@ -1475,38 +1495,17 @@ static int
 _fiid_obj_lookup_field_index (fiid_obj_t obj, const char *field, unsigned int *index)
 {
   struct fiid_field_data *ffdptr;
-  unsigned int i;
 
   assert (obj);
   assert (obj->magic == FIID_OBJ_MAGIC);
   assert (field);
   assert (index);
 
-  if ((ffdptr = hash_find (obj->lookup, field)))
-    {
-      (*index) = ffdptr->index;
-      return (0);
-    }
-  
-  for (i = 0; obj->field_data[i].max_field_len; i++)
-    {
-      if (!strcmp (obj->field_data[i].key, field))
-        {
-          if (!hash_insert (obj->lookup,
-                            obj->field_data[i].key,
-                            &(obj->field_data[i])))
-            {
-              obj->errnum = FIID_ERR_INTERNAL_ERROR;
-              return (-1);
-            }
-
-          (*index) = obj->field_data[i].index;
-          return (0);
-        }
-    }
+  if (!(ffdptr = _fiid_obj_lookup_field (obj, field)))
+    return (-1);
 
-  obj->errnum = FIID_ERR_FIELD_NOT_FOUND;
-  return (-1);
+  (*index) = ffdptr->index;
+  return (0);
 }
 
 int
@@ -1795,7 +1794,6 @@ fiid_obj_set (fiid_obj_t obj,
               uint64_t val)
 {
   unsigned int start_bit_pos = 0;
-  unsigned int end_bit_pos = 0; /* excluded always */
   int byte_pos = 0;
   int start_bit_in_byte_pos = 0;
   int end_bit_in_byte_pos = 0;
@@ -1804,6 +1802,7 @@ fiid_obj_set (fiid_obj_t obj,
   unsigned int key_index;
   uint64_t merged_val = 0;
   uint8_t *temp_data = NULL;
+  struct fiid_field_data *ffdptr;
 
   if (!obj || obj->magic != FIID_OBJ_MAGIC)
     goto cleanup;
@@ -1814,14 +1813,39 @@ fiid_obj_set (fiid_obj_t obj,
       goto cleanup;
     }
 
-  if (_fiid_obj_lookup_field_index (obj, field, &key_index) < 0)
+  if (!(ffdptr = _fiid_obj_lookup_field (obj, field)))
     return (-1);
 
-  if ((field_len = _fiid_obj_field_start_end (obj,
-                                              field,
-                                              &start_bit_pos,
-                                              &end_bit_pos)) < 0)
-    return (-1);
+  if (ffdptr->access == FIID_FIELD_ACCESS_BYTES)
+    {
+      uint8_t *p = obj->data + (ffdptr->start / 8);
+      unsigned int i;
+
+      /* little endian, bytes beyond the field are dropped */
+      for (i = 0; i < ffdptr->max_field_len / 8; i++)
+        p[i] = (val >> (i * 8)) & 0xFF;
+
+      ffdptr->set_field_len = ffdptr->max_field_len;
+      obj->errnum = FIID_ERR_SUCCESS;
+      return (0);
+    }
+
+  if (ffdptr->access == FIID_FIELD_ACCESS_SUB_BYTE)
+    {
+      unsigned int shift = ffdptr->start % 8;
+      uint8_t mask = ((1 << ffdptr->max_field_len) - 1) << shift;
+      uint8_t *p = obj->data + (ffdptr->start / 8);
+
+      (*p) = ((*p) & ~mask) | ((val << shift) & mask);
+
+      ffdptr->set_field_len = ffdptr->max_field_len;
+      obj->errnum = FIID_ERR_SUCCESS;
+      return (0);
+    }
+
+  key_index = ffdptr->index;
+  start_bit_pos = ffdptr->start;
+  field_len = ffdptr->max_field_len;
 
   if (field_len > 64)
     field_len = 64;
@@ -1946,7 +1970,6 @@ fiid_obj_get (fiid_obj_t obj,
               uint64_t *val)
 {
   unsigned int start_bit_pos = 0;
-  unsigned int end_bit_pos = 0; /* excluded always */
   int byte_pos = 0;
   int start_bit_in_byte_pos = 0;
   int end_bit_in_byte_pos = 0;
@@ -1954,6 +1977,7 @@ fiid_obj_get (fiid_obj_t obj,
   int bytes_used = 0;
   unsigned int key_index;
   uint64_t merged_val = 0;
+  struct fiid_field_data *ffdptr;
 
   if (!obj || obj->magic != FIID_OBJ_MAGIC)
     return (-1);
@@ -1964,20 +1988,46 @@ fiid_obj_get (fiid_obj_t obj,
       return (-1);
     }
 
-  if (_fiid_obj_lookup_field_index (obj, field, &key_index) < 0)
+  if (!(ffdptr = _fiid_obj_lookup_field (obj, field)))
     return (-1);
 
-  if (!obj->field_data[key_index].set_field_len)
+  if (!ffdptr->set_field_len)
     {
       obj->errnum = FIID_ERR_SUCCESS;
       return (0);
     }
 
-  if ((field_len = _fiid_obj_field_start_end (obj,
-                                              field,
-                                              &start_bit_pos,
-                                              &end_bit_pos)) < 0)
-    return (-1);
+  /* partially set fields, e.g. the last field of a short
+   * fiid_obj_set_all(), take the generic path
+   */
+  if (ffdptr->set_field_len == ffdptr->max_field_len)
+    {
+      if (ffdptr->access == FIID_FIELD_ACCESS_BYTES)
+        {
+          const uint8_t *p = obj->data + (ffdptr->start / 8);
+          uint64_t lval = 0;
+          unsigned int i;
+
+          for (i = ffdptr->max_field_len / 8; i > 0; i--)
+            lval = (lval << 8) | p[i - 1];
+
+          *val = lval;
+          obj->errnum = FIID_ERR_SUCCESS;
+          return (1);
+        }
+
+      if (ffdptr->access == FIID_FIELD_ACCESS_SUB_BYTE)
+        {
+          *val = (obj->data[ffdptr->start / 8] >> (ffdptr->start % 8))
+            & ((1 << ffdptr->max_field_len) - 1);
+          obj->errnum = FIID_ERR_SUCCESS;
+          return (1);
+        }
+    }
+
+  key_index = ffdptr->index;
+  start_bit_pos = ffdptr->start;
+  field_len = ffdptr->max_field_len;
 
   if (field_len > 64)
     field_len = 64;
@@ -2115,8 +2165,8 @@ fiid_obj_set_data (fiid_obj_t obj,
                    const void *data,
                    unsigned int data_len)
 {
-  unsigned int field_offset, bytes_len, key_index;
-  int bits_len, field_start;
+  struct fiid_field_data *ffdptr;
+  unsigned int bytes_len;
 
   if (!obj || obj->magic != FIID_OBJ_MAGIC)
     return (-1);
@@ -2127,38 +2177,26 @@ fiid_obj_set_data (fiid_obj_t obj,
       return (-1);
     }
 
-  if (_fiid_obj_lookup_field_index (obj, field, &key_index) < 0)
+  if (!(ffdptr = _fiid_obj_lookup_field (obj, field)))
     return (-1);
 
   /* achu: We assume the field must start on a byte boundary and end
    * on a byte boundary.
    */
 
-  if ((field_start = _fiid_obj_field_start (obj, field)) < 0)
-    return (-1);
-
-  if (field_start % 8)
-    {
-      obj->errnum = FIID_ERR_DATA_NOT_BYTE_ALIGNED;
-      return (-1);
-    }
-
-  if ((bits_len = _fiid_obj_field_len (obj, field)) < 0)
-    return (-1);
-
-  if (bits_len % 8)
+  if ((ffdptr->start % 8)
+      || (ffdptr->max_field_len % 8))
     {
       obj->errnum = FIID_ERR_DATA_NOT_BYTE_ALIGNED;
       return (-1);
     }
 
-  bytes_len = BITS_ROUND_BYTES (bits_len);
+  bytes_len = BITS_ROUND_BYTES (ffdptr->max_field_len);
   if (data_len > bytes_len)
     data_len = bytes_len;
 
-  field_offset = BITS_ROUND_BYTES (field_start);
-  memcpy ((obj->data + field_offset), data, data_len);
-  obj->field_data[key_index].set_field_len = (data_len * 8);
+  memcpy ((obj->data + (ffdptr->start / 8)), data, data_len);
+  ffdptr->set_field_len = (data_len * 8);
 
   obj->errnum = FIID_ERR_SUCCESS;
   return (data_len);
@@ -2170,8 +2208,8 @@ fiid_obj_get_data (fiid_obj_t obj,
                    void *data,
                    unsigned int data_len)
 {
-  unsigned int field_offset, bytes_len, key_index;
-  int bits_len, field_start;
+  struct fiid_field_data *ffdptr;
+  unsigned int bits_len, bytes_len;
 
   if (!obj || obj->magic != FIID_OBJ_MAGIC)
     return (-1);
@@ -2182,30 +2220,25 @@ fiid_obj_get_data (fiid_obj_t obj,
       return (-1);
     }
 
-  if (_fiid_obj_lookup_field_index (obj, field, &key_index) < 0)
+  if (!(ffdptr = _fiid_obj_lookup_field (obj, field)))
     return (-1);
 
-  if (!obj->field_data[key_index].set_field_len)
+  if (!ffdptr->set_field_len)
     return (0);
 
   /* achu: We assume the field must start on a byte boundary and end
    * on a byte boundary.
    */
 
-  if ((field_start = _fiid_obj_field_start (obj, field)) < 0)
-    return (-1);
-
-  if (field_start % 8)
+  if (ffdptr->start % 8)
     {
       obj->errnum = FIID_ERR_DATA_NOT_BYTE_ALIGNED;
       return (-1);
     }
 
-  if ((bits_len = _fiid_obj_field_len (obj, field)) < 0)
-    return (-1);
-
-  if (obj->field_data[key_index].set_field_len < bits_len)
-    bits_len = obj->field_data[key_index].set_field_len;
+  bits_len = ffdptr->max_field_len;
+  if (ffdptr->set_field_len < bits_len)
+    bits_len = ffdptr->set_field_len;
 
   if (bits_len % 8)
     {
@@ -2221,9 +2254,7 @@ fiid_obj_get_data (fiid_obj_t obj,
       return (-1);
     }
 
-  field_offset = BITS_ROUND_BYTES (field_start);
-
-  memcpy (data, (obj->data + field_offset), bytes_len);
+  memcpy (data, (obj->data + (ffdptr->start / 8)), bytes_len);
 
   obj->errnum = FIID_ERR_SUCCESS;
   return (bytes_len);
@@ -251,6 +251,16 @@ int ipmi_ctx_get_flags (ipmi_ctx_t ctx, unsigned int *flags);
 /* for changing flags mid-operation for corner cases */
 int ipmi_ctx_set_flags (ipmi_ctx_t ctx, unsigned int flags);
 
+/* Record every packet sent and received into filename, in the binary
+ * format described in ipmi-debug.h.  Records are buffered in the
+ * context and appended to the file in bulk, cheap enough to leave on
+ * in production, unlike IPMI_FLAGS_DEBUG_DUMP.  Records from several
+ * contexts, threads, or processes can be appended to the same file.
+ * May be called before the context is opened, to also record session
+ * setup.  Pass NULL to flush and stop tracing.
+ */
+int ipmi_ctx_set_packet_trace_file (ipmi_ctx_t ctx, const char *filename);
+
 /* For IPMI 1.5 sessions */
 /* For session_timeout and retransmission_timeout, specify 0 for default */
 int ipmi_ctx_open_outofband (ipmi_ctx_t ctx,
@@ -144,6 +144,57 @@ int ipmi_dump_hex (int fd,
                    const void *buf,
                    unsigned int buf_len);
 
+/* Binary packet trace
+ *
+ * Written by contexts configured with
+ * ipmi_ctx_set_packet_trace_file().  A trace is a sequence of
+ * records, each a fixed header followed by the hostname and the raw
+ * packet.  All integers are little endian.
+ *
+ * uint32 magic (IPMI_PACKET_TRACE_MAGIC)
+ * uint16 header length, hostname starts here
+ * uint16 version
+ * uint32 record length, including the header
+ * uint32 session id
+ * uint64 time, seconds since the epoch
+ * uint32 time, microseconds
+ * uint8  packet type
+ * uint8  direction
+ * uint8  authentication algorithm, IPMI 2.0 only
+ * uint8  integrity algorithm, IPMI 2.0 only
+ * uint8  confidentiality algorithm, IPMI 2.0 only
+ * uint8  hostname length
+ * uint16 packet length
+ *
+ * Session keys are not recorded, the payload of encrypted IPMI 2.0
+ * packets can only be dumped in hex.  Authentication codes (IPMI 1.5
+ * session authentication codes, RAKP key exchange authentication
+ * codes and integrity check values, IPMI 2.0 session trailer
+ * authentication codes) are zeroed.  Command data, including any
+ * password sent in it, is recorded as is.
+ */
+#define IPMI_PACKET_TRACE_MAGIC              0x54504946
+#define IPMI_PACKET_TRACE_VERSION            1
+#define IPMI_PACKET_TRACE_HEADER_LENGTH      36
+
+#define IPMI_PACKET_TRACE_TYPE_LAN           0x01
+#define IPMI_PACKET_TRACE_TYPE_LAN_2_0       0x02
+#define IPMI_PACKET_TRACE_TYPE_KCS           0x03
+#define IPMI_PACKET_TRACE_TYPE_SSIF          0x04
+
+#define IPMI_PACKET_TRACE_DIRECTION_REQUEST  0x01
+#define IPMI_PACKET_TRACE_DIRECTION_RESPONSE 0x02
+
+/* Dump the records of a packet trace in the same format as
+ * IPMI_FLAGS_DEBUG_DUMP.  Command data is dumped as raw bytes, the
+ * command templates are not known.  Returns the number of bytes of
+ * buf consumed, less than buf_len if buf ends with a partial record.
+ * Returns -1 on error, e.g. a corrupt record.
+ */
+int ipmi_dump_packet_trace (int fd,
+                            const void *buf,
+                            unsigned int buf_len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -48,6 +48,7 @@ extern "C" {
 
 #include <stdint.h>
 #include <freeipmi/api/ipmi-api.h>
+#include <freeipmi/record-format/ipmi-sdr-record-format.h>
 
 #define IPMI_SDR_ERR_SUCCESS                                      0
 #define IPMI_SDR_ERR_CONTEXT_NULL                                 1
@@ -108,6 +109,142 @@ extern "C" {
 
 typedef struct ipmi_sdr_ctx *ipmi_sdr_ctx_t;
 
+/* Decoded SDR record
+ *
+ * Every field of a Full, Compact, Event Only, FRU Device Locator or
+ * Management Controller Device Locator SDR record, decoded in a
+ * single pass.  Fields not applicable to the record_type are 0.
+ * Values are identical to those returned by the equivalent
+ * ipmi_sdr_parse_*() functions, e.g. r_exponent, b_exponent, m, and
+ * b are sign extended.
+ *
+ * For other record types only the header fields are decoded.
+ *
+ * Fields are only ever added to the end of this struct.  Functions
+ * filling it take the caller's sizeof (ipmi_sdr_record_decoded_t),
+ * so binaries built against an older, shorter definition keep
+ * working.
+ */
+typedef struct ipmi_sdr_record_decoded
+{
+  /* All SDR records */
+  uint16_t record_id;
+  uint8_t record_type;
+  uint8_t sdr_version_major;
+  uint8_t sdr_version_minor;
+  uint8_t record_length;
+
+  /* Full, Compact, Event Only SDR records */
+  uint8_t sensor_owner_id_type;
+  uint8_t sensor_owner_id;
+  uint8_t sensor_owner_lun;
+  uint8_t sensor_number;
+  uint8_t sensor_type;
+  uint8_t event_reading_type_code;
+  uint8_t sensor_direction;
+
+  /* Full, Compact, Event Only, Management Controller Device Locator SDR records */
+  uint8_t entity_id;
+  uint8_t entity_instance;
+  uint8_t entity_instance_type;
+
+  /* Full, Compact, Event Only, FRU Device Locator, Management
+   * Controller Device Locator SDR records
+   */
+  uint8_t channel_number;
+  uint8_t oem;
+  /* id string or device id string, NUL terminated */
+  char id_string[IPMI_SDR_MAX_ID_STRING_LENGTH + 1];
+  unsigned int id_string_len;
+
+  /* Full, Compact SDR records */
+  uint8_t sensor_initialization_sensor_scanning;
+  uint8_t sensor_initialization_event_generation;
+  uint8_t sensor_initialization_init_sensor_type;
+  uint8_t sensor_initialization_init_hysteresis;
+  uint8_t sensor_initialization_init_thresholds;
+  uint8_t sensor_initialization_init_events;
+  uint8_t sensor_initialization_init_scanning;
+  uint8_t event_message_control_support;
+  uint8_t threshold_access_support;
+  uint8_t hysteresis_support;
+  uint8_t auto_re_arm_support;
+  uint8_t entity_ignore_support;
+  /* threshold sensors - assertion event mask / lower threshold
+   * reading mask, deassertion event mask / upper threshold reading
+   * mask, settable / readable threshold mask
+   */
+  uint16_t assertion_event_mask;
+  uint16_t deassertion_event_mask;
+  uint16_t discrete_reading_mask;
+  uint8_t sensor_units_percentage;
+  uint8_t sensor_units_modifier;
+  uint8_t sensor_units_rate;
+  uint8_t sensor_base_unit_type;
+  uint8_t sensor_modifier_unit_type;
+  uint8_t analog_data_format;
+  uint8_t positive_going_threshold_hysteresis;
+  uint8_t negative_going_threshold_hysteresis;
+
+  /* Compact, Event Only SDR records */
+  uint8_t share_count;
+  uint8_t id_string_instance_modifier_type;
+  uint8_t id_string_instance_modifier_offset;
+  uint8_t entity_instance_sharing;
+
+  /* Full SDR records */
+  uint8_t linearization;
+  int8_t r_exponent;
+  int8_t b_exponent;
+  int16_t m;
+  int16_t b;
+  uint8_t tolerance;
+  uint16_t accuracy;
+  uint8_t accuracy_exp;
+  uint8_t nominal_reading_specified;
+  uint8_t normal_maximum_specified;
+  uint8_t normal_minimum_specified;
+  uint8_t nominal_reading;
+  uint8_t normal_maximum;
+  uint8_t normal_minimum;
+  uint8_t sensor_maximum_reading;
+  uint8_t sensor_minimum_reading;
+  uint8_t upper_non_recoverable_threshold;
+  uint8_t upper_critical_threshold;
+  uint8_t upper_non_critical_threshold;
+  uint8_t lower_non_recoverable_threshold;
+  uint8_t lower_critical_threshold;
+  uint8_t lower_non_critical_threshold;
+
+  /* FRU Device Locator SDR records */
+  uint8_t device_access_address;
+  uint8_t logical_fru_device_device_slave_address;
+  uint8_t private_bus_id;
+  uint8_t lun_for_master_write_read_fru_command;
+  uint8_t logical_physical_fru_device;
+  uint8_t device_type;
+  uint8_t device_type_modifier;
+  uint8_t fru_entity_id;
+  uint8_t fru_entity_instance;
+
+  /* Management Controller Device Locator SDR records */
+  uint8_t device_slave_address;
+  uint8_t global_initialization_event_message_generation;
+  uint8_t global_initialization_log_initialization_agent_errors;
+  uint8_t global_initialization_controller_logs_initialization_agent_errors;
+  uint8_t power_state_notification_controller;
+  uint8_t power_state_notification_acpi_device_power_state_notification;
+  uint8_t power_state_notification_acpi_system_power_state_notification;
+  uint8_t device_capabilities_sensor_device;
+  uint8_t device_capabilities_sdr_repository_device;
+  uint8_t device_capabilities_sel_device;
+  uint8_t device_capabilities_fru_inventory_device;
+  uint8_t device_capabilities_ipmb_event_receiver;
+  uint8_t device_capabilities_ipmb_event_generator;
+  uint8_t device_capabilities_bridge;
+  uint8_t device_capabilities_chassis_device;
+} ipmi_sdr_record_decoded_t;
+
 typedef void (*Ipmi_Sdr_Cache_Create_Callback)(uint8_t sdr_version,
                                                uint16_t record_count,
                                                uint32_t most_recent_addition_timestamp,
@@ -147,6 +284,9 @@ int ipmi_sdr_ctx_set_debug_prefix (ipmi_sdr_ctx_t ctx, const char *debug_prefix)
  * SDR Cache Creation Functions
  */
 /* ipmi_sdr_cache_create
+ * - the cache is written to a temporary file next to filename and
+ *   moved into place when complete, an existing cache is untouched on
+ *   failure
  * - callback called between every record that is cached
  */
 int ipmi_sdr_cache_create (ipmi_sdr_ctx_t ctx,
@@ -188,6 +328,17 @@ int ipmi_sdr_cache_record_read (ipmi_sdr_ctx_t ctx,
                                 void *buf,
                                 unsigned int buflen);
 
+/* ipmi_sdr_cache_record_decoded
+ * - copies the current record decoded into decoded, see
+ *   ipmi_sdr_parse_record_decode()
+ * - decoded_len must be sizeof (ipmi_sdr_record_decoded_t)
+ * - all records are decoded once, on the first call after
+ *   ipmi_sdr_cache_open(), later calls only look up the record
+ */
+int ipmi_sdr_cache_record_decoded (ipmi_sdr_ctx_t ctx,
+                                   ipmi_sdr_record_decoded_t *decoded,
+                                   unsigned int decoded_len);
+
 /* ipmi_sdr_cache_iterate 
  * - iterate through all SDR records calling callback for each one.
  * - if callback returns < 0, that will break iteration and return
@@ -232,6 +383,18 @@ int ipmi_sdr_parse_record_id_and_type (ipmi_sdr_ctx_t ctx,
                                        uint16_t *record_id,
                                        uint8_t *record_type);
 
+/* For all SDR records */
+/* Decode every field of the record into decoded, see
+ * ipmi_sdr_record_decoded_t.  decoded_len must be sizeof
+ * (ipmi_sdr_record_decoded_t).  Unlike other parsing functions, the
+ * fixed length portion of the record must be complete.
+ */
+int ipmi_sdr_parse_record_decode (ipmi_sdr_ctx_t ctx,
+                                  const void *sdr_record,
+                                  unsigned int sdr_record_len,
+                                  ipmi_sdr_record_decoded_t *decoded,
+                                  unsigned int decoded_len);
+
 /* For Full, Compact, Event SDR records */
 int ipmi_sdr_parse_sensor_owner_id (ipmi_sdr_ctx_t ctx,
                                     const void *sdr_record,
@@ -60,6 +60,33 @@ int ipmi_timestamp_string (uint32_t timestamp,
                            char *buf,
                            unsigned int buflen);
 
+/* Timestamp context
+ *
+ * Caches the local timezone's UTC offset across calls, for callers
+ * formatting many timestamps, such as SEL records.  The tz code is
+ * only consulted again when a timestamp falls outside a range of
+ * times already known to have the same offset, e.g. a daylight
+ * savings period.  Common numeric formats are also formatted without
+ * strftime().
+ *
+ * A context is not thread safe, use one per thread.
+ */
+typedef struct ipmi_timestamp_ctx *ipmi_timestamp_ctx_t;
+
+/* returns NULL on error, errno set */
+ipmi_timestamp_ctx_t ipmi_timestamp_ctx_create (void);
+
+void ipmi_timestamp_ctx_destroy (ipmi_timestamp_ctx_t ctx);
+
+/* same as ipmi_timestamp_string() */
+int ipmi_timestamp_ctx_string (ipmi_timestamp_ctx_t ctx,
+                               uint32_t timestamp,
+                               int utc_offset,
+                               unsigned int flags,
+                               const char *format,
+                               char *buf,
+                               unsigned int buflen);
+
 #ifdef __cplusplus
 }
 #endif
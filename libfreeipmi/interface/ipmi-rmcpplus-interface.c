@@ -686,9 +686,9 @@ static int
 _construct_payload_confidentiality_none (uint8_t payload_type,
                                          fiid_obj_t obj_lan_msg_hdr,
                                          fiid_obj_t obj_cmd,
-                                         fiid_obj_t obj_rmcpplus_payload)
+                                         void *pkt,
+                                         unsigned int pkt_len)
 {
-  uint8_t payload_buf[IPMI_MAX_PAYLOAD_LENGTH];
   int payload_len;
 
   assert ((payload_type == IPMI_PAYLOAD_TYPE_IPMI
@@ -699,28 +699,21 @@ _construct_payload_confidentiality_none (uint8_t payload_type,
           && !(payload_type == IPMI_PAYLOAD_TYPE_SOL
                && !(fiid_obj_template_compare (obj_cmd, tmpl_sol_payload_data) == 1
                     || fiid_obj_template_compare (obj_cmd, tmpl_sol_payload_data_remote_console_to_bmc) == 1))
-          && fiid_obj_valid (obj_rmcpplus_payload)
-          && fiid_obj_template_compare (obj_rmcpplus_payload, tmpl_rmcpplus_payload) == 1);
+          && pkt);
 
+  /* No encryption, the payload is constructed directly into
+   * the packet.
+   */
   if ((payload_len = _construct_payload_buf (payload_type,
                                              obj_lan_msg_hdr,
                                              obj_cmd,
-                                             payload_buf,
-                                             IPMI_MAX_PAYLOAD_LENGTH)) < 0)
+                                             pkt,
+                                             pkt_len)) < 0)
     {
       ERRNO_TRACE (errno);
       return (-1);
     }
 
-  if (fiid_obj_set_data (obj_rmcpplus_payload,
-                         "payload_data",
-                         payload_buf,
-                         payload_len) < 0)
-    {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_payload);
-      return (-1);
-    }
-
   return (payload_len);
 }
 
@@ -731,11 +724,12 @@ _construct_payload_confidentiality_aes_cbc_128 (uint8_t payload_type,
                                                 fiid_obj_t obj_cmd,
                                                 const void *confidentiality_key,
                                                 unsigned int confidentiality_key_len,
-                                                fiid_obj_t obj_rmcpplus_payload)
+                                                void *pkt,
+                                                unsigned int pkt_len)
 {
-  uint8_t iv[IPMI_CRYPT_AES_CBC_128_IV_LENGTH];
+  uint8_t *iv;
+  uint8_t *payload_buf;
   int iv_len;
-  uint8_t payload_buf[IPMI_MAX_PAYLOAD_LENGTH];
   uint8_t pad_len, pad_tmp;
   int payload_len, cipher_keylen, cipher_blocklen, encrypt_len;
 
@@ -753,8 +747,7 @@ _construct_payload_confidentiality_aes_cbc_128 (uint8_t payload_type,
           && fiid_obj_packet_valid (obj_cmd) == 1
           && confidentiality_key
           && confidentiality_key_len
-          && fiid_obj_valid (obj_rmcpplus_payload)
-          && fiid_obj_template_compare (obj_rmcpplus_payload, tmpl_rmcpplus_payload) == 1);
+          && pkt);
 
   if ((cipher_keylen = crypt_cipher_key_len (IPMI_CRYPT_CIPHER_AES)) < 0)
     {
@@ -780,6 +773,20 @@ _construct_payload_confidentiality_aes_cbc_128 (uint8_t payload_type,
 
   assert (cipher_blocklen == IPMI_CRYPT_AES_CBC_128_BLOCK_LENGTH);
 
+  if (pkt_len < IPMI_CRYPT_AES_CBC_128_IV_LENGTH)
+    {
+      SET_ERRNO (ENOSPC);
+      return (-1);
+    }
+
+  /* The IV is the confidentiality header, it is generated
+   * directly into the packet and the payload is constructed and
+   * encrypted in place after it.
+   */
+  iv = (uint8_t *)pkt;
+  payload_buf = (uint8_t *)pkt + IPMI_CRYPT_AES_CBC_128_IV_LENGTH;
+  pkt_len -= IPMI_CRYPT_AES_CBC_128_IV_LENGTH;
+
   if ((iv_len = ipmi_get_random (iv, IPMI_CRYPT_AES_CBC_128_IV_LENGTH)) < 0)
     {
       ERRNO_TRACE (errno);
@@ -796,7 +803,7 @@ _construct_payload_confidentiality_aes_cbc_128 (uint8_t payload_type,
                                              obj_lan_msg_hdr,
                                              obj_cmd,
                                              payload_buf,
-                                             IPMI_MAX_PAYLOAD_LENGTH)) < 0)
+                                             pkt_len)) < 0)
     {
       ERRNO_TRACE (errno);
       return (-1);
@@ -811,7 +818,8 @@ _construct_payload_confidentiality_aes_cbc_128 (uint8_t payload_type,
   else
     pad_len = 0;
 
-  if ((payload_len + pad_len + 1) > IPMI_MAX_PAYLOAD_LENGTH)
+  if ((payload_len + pad_len + 1) > IPMI_MAX_PAYLOAD_LENGTH
+      || (payload_len + pad_len + 1) > pkt_len)
     {
       SET_ERRNO (ENOSPC);
       return (-1);
@@ -845,42 +853,15 @@ _construct_payload_confidentiality_aes_cbc_128 (uint8_t payload_type,
       return (-1);
     }
 
-  if (fiid_obj_set_data (obj_rmcpplus_payload,
-                         "confidentiality_header",
-                         iv,
-                         IPMI_CRYPT_AES_CBC_128_IV_LENGTH) < 0)
-    {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_payload);
-      return (-1);
-    }
-
-  if (fiid_obj_set_data (obj_rmcpplus_payload,
-                         "payload_data",
-                         payload_buf,
-                         payload_len) < 0)
-    {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_payload);
-      return (-1);
-    }
-
-  if (fiid_obj_set_data (obj_rmcpplus_payload,
-                         "confidentiality_trailer",
-                         payload_buf + payload_len,
-                         pad_len + 1) < 0)
-    {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_payload);
-      return (-1);
-    }
-
   return (iv_len + payload_len + pad_len + 1);
 }
 
 static int
 _construct_payload_rakp (uint8_t payload_type,
                          fiid_obj_t obj_cmd,
-                         fiid_obj_t obj_rmcpplus_payload)
+                         void *pkt,
+                         unsigned int pkt_len)
 {
-  uint8_t obj_cmd_buf[IPMI_MAX_PAYLOAD_LENGTH];
   int obj_cmd_len = 0;
 
   assert ((payload_type == IPMI_PAYLOAD_TYPE_RMCPPLUS_OPEN_SESSION_REQUEST
@@ -893,30 +874,35 @@ _construct_payload_rakp (uint8_t payload_type,
                && fiid_obj_template_compare (obj_cmd, tmpl_rmcpplus_rakp_message_1) < 0)
           && !(payload_type == IPMI_PAYLOAD_TYPE_RAKP_MESSAGE_3
                && fiid_obj_template_compare (obj_cmd, tmpl_rmcpplus_rakp_message_3) < 0)
-          && fiid_obj_valid (obj_rmcpplus_payload)
-          && fiid_obj_template_compare (obj_rmcpplus_payload, tmpl_rmcpplus_payload) == 1
-          && fiid_obj_packet_valid (obj_cmd) == 1);
+          && fiid_obj_packet_valid (obj_cmd) == 1
+          && pkt);
 
-  if ((obj_cmd_len = fiid_obj_get_all (obj_cmd,
-                                       obj_cmd_buf,
-                                       IPMI_MAX_PAYLOAD_LENGTH)) < 0)
+  if ((obj_cmd_len = fiid_obj_len_bytes (obj_cmd)) < 0)
     {
       FIID_OBJECT_ERROR_TO_ERRNO (obj_cmd);
       return (-1);
     }
 
-  if (fiid_obj_set_data (obj_rmcpplus_payload,
-                         "payload_data",
-                         obj_cmd_buf,
-                         obj_cmd_len) < 0)
+  if (obj_cmd_len > pkt_len)
     {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_payload);
+      SET_ERRNO (ENOSPC);
+      return (-1);
+    }
+
+  if ((obj_cmd_len = fiid_obj_get_all (obj_cmd,
+                                       pkt,
+                                       pkt_len)) < 0)
+    {
+      FIID_OBJECT_ERROR_TO_ERRNO (obj_cmd);
       return (-1);
     }
 
   return (obj_cmd_len);
 }
 
+/* Constructs the payload directly into pkt, returns the payload
+ * length (i.e. the ipmi_payload_len of the session header).
+ */
 static int
 _construct_payload (uint8_t payload_type,
                     uint8_t payload_encrypted,
@@ -926,7 +912,8 @@ _construct_payload (uint8_t payload_type,
                     fiid_obj_t obj_cmd,
                     const void *confidentiality_key,
                     unsigned int confidentiality_key_len,
-                    fiid_obj_t obj_rmcpplus_payload)
+                    void *pkt,
+                    unsigned int pkt_len)
 {
   assert ((payload_type == IPMI_PAYLOAD_TYPE_IPMI
            || payload_type == IPMI_PAYLOAD_TYPE_SOL
@@ -938,9 +925,8 @@ _construct_payload (uint8_t payload_type,
           && !(payload_type == IPMI_PAYLOAD_TYPE_IPMI
                && !fiid_obj_valid (obj_lan_msg_hdr))
           && fiid_obj_valid (obj_cmd)
-          && fiid_obj_valid (obj_rmcpplus_payload)
           && fiid_obj_template_compare (obj_lan_msg_hdr, tmpl_lan_msg_hdr_rq) == 1
-          && fiid_obj_template_compare (obj_rmcpplus_payload, tmpl_rmcpplus_payload) == 1);
+          && pkt);
 
   if (payload_type == IPMI_PAYLOAD_TYPE_IPMI
       || payload_type == IPMI_PAYLOAD_TYPE_SOL)
@@ -950,7 +936,8 @@ _construct_payload (uint8_t payload_type,
         return (_construct_payload_confidentiality_none (payload_type,
                                                          obj_lan_msg_hdr,
                                                          obj_cmd,
-                                                         obj_rmcpplus_payload));
+                                                         pkt,
+                                                         pkt_len));
       else /* IPMI_CONFIDENTIALITY_ALGORITHM_AES_CBC_128 */
         return (_construct_payload_confidentiality_aes_cbc_128 (payload_type,
                                                                 payload_encrypted,
@@ -958,29 +945,36 @@ _construct_payload (uint8_t payload_type,
                                                                 obj_cmd,
                                                                 confidentiality_key,
                                                                 confidentiality_key_len,
-                                                                obj_rmcpplus_payload));
+                                                                pkt,
+                                                                pkt_len));
     }
   else
     return (_construct_payload_rakp (payload_type,
                                      obj_cmd,
-                                     obj_rmcpplus_payload));
+                                     pkt,
+                                     pkt_len));
 }
 
+/* Writes the integrity pad, pad length, and next header directly
+ * into pkt, returns the number of bytes written.
+ */
 static int
 _construct_session_trlr_pad (uint8_t integrity_algorithm,
                              unsigned int ipmi_msg_len,
-                             fiid_obj_t obj_rmcpplus_session_trlr)
+                             fiid_obj_t obj_rmcpplus_session_trlr,
+                             void *pkt,
+                             unsigned int pkt_len)
 {
   int pad_length_field_len, next_header_field_len;
   unsigned int pad_length = 0;
-  uint8_t pad_bytes[IPMI_INTEGRITY_PAD_MULTIPLE] = { IPMI_INTEGRITY_PAD_DATA,
-                                                     IPMI_INTEGRITY_PAD_DATA,
-                                                     IPMI_INTEGRITY_PAD_DATA,
-                                                     IPMI_INTEGRITY_PAD_DATA};
+  uint8_t next_header = 0;
+  uint64_t val;
+  int ret;
 
   assert (IPMI_INTEGRITY_ALGORITHM_SUPPORTED (integrity_algorithm)
           && fiid_obj_valid (obj_rmcpplus_session_trlr)
-          && fiid_obj_template_compare (obj_rmcpplus_session_trlr, tmpl_rmcpplus_session_trlr) == 1);
+          && fiid_obj_template_compare (obj_rmcpplus_session_trlr, tmpl_rmcpplus_session_trlr) == 1
+          && pkt);
 
   if ((pad_length_field_len = fiid_template_field_len_bytes (tmpl_rmcpplus_session_trlr,
                                                              "pad_length")) < 0)
@@ -995,33 +989,36 @@ _construct_session_trlr_pad (uint8_t integrity_algorithm,
       return (-1);
     }
 
+  assert (pad_length_field_len == 1 && next_header_field_len == 1);
+
+  if ((ret = fiid_obj_get (obj_rmcpplus_session_trlr,
+                           "next_header",
+                           &val)) < 0)
+    {
+      FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_session_trlr);
+      return (-1);
+    }
+  if (ret)
+    next_header = val;
+
   ipmi_msg_len += pad_length_field_len;
   ipmi_msg_len += next_header_field_len;
 
   if (ipmi_msg_len % IPMI_INTEGRITY_PAD_MULTIPLE)
     pad_length = IPMI_INTEGRITY_PAD_MULTIPLE - (ipmi_msg_len % IPMI_INTEGRITY_PAD_MULTIPLE);
 
-  if (pad_length)
+  if ((pad_length + pad_length_field_len + next_header_field_len) > pkt_len)
     {
-      if (fiid_obj_set_data (obj_rmcpplus_session_trlr,
-                             "integrity_pad",
-                             pad_bytes,
-                             pad_length) < 0)
-        {
-          FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_session_trlr);
-          return (-1);
-        }
-    }
-
-  if (fiid_obj_set (obj_rmcpplus_session_trlr,
-                    "pad_length",
-                    pad_length) < 0)
-    {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_session_trlr);
+      SET_ERRNO (ENOSPC);
       return (-1);
     }
 
-  return (0);
+  if (pad_length)
+    memset (pkt, IPMI_INTEGRITY_PAD_DATA, pad_length);
+  ((uint8_t *)pkt)[pad_length] = pad_length;
+  ((uint8_t *)pkt)[pad_length + pad_length_field_len] = next_header;
+
+  return (pad_length + pad_length_field_len + next_header_field_len);
 }
 
 static int
@@ -1064,6 +1061,7 @@ _construct_session_trlr_authentication_code (uint8_t integrity_algorithm,
   int crypt_digest_len, authentication_code_len, integrity_digest_len, len, rv = -1;
   unsigned int hash_algorithm, hash_flags, expected_digest_len, copy_digest_len, hash_data_len;
   uint8_t hash_data[IPMI_MAX_PAYLOAD_LENGTH];
+  const void *hash_data_ptr;
   uint8_t integrity_digest[IPMI_MAX_INTEGRITY_DATA_LENGTH];
   uint8_t pwbuf[IPMI_2_0_MAX_PASSWORD_LENGTH];
 
@@ -1153,10 +1151,10 @@ _construct_session_trlr_authentication_code (uint8_t integrity_algorithm,
 
   assert (crypt_digest_len == expected_digest_len);
 
-  hash_data_len = 0;
-
   if (integrity_algorithm == IPMI_INTEGRITY_ALGORITHM_MD5_128)
     {
+      hash_data_len = 0;
+
       /* achu: Password must be zero padded */
       memset (pwbuf, '\0', IPMI_2_0_MAX_PASSWORD_LENGTH);
 
@@ -1167,24 +1165,29 @@ _construct_session_trlr_authentication_code (uint8_t integrity_algorithm,
               pwbuf,
               IPMI_2_0_MAX_PASSWORD_LENGTH);
       hash_data_len += IPMI_2_0_MAX_PASSWORD_LENGTH;
-    }
 
-  memcpy (hash_data + hash_data_len, pkt_data, pkt_data_len);
-  hash_data_len += pkt_data_len;
+      memcpy (hash_data + hash_data_len, pkt_data, pkt_data_len);
+      hash_data_len += pkt_data_len;
 
-  if (integrity_algorithm == IPMI_INTEGRITY_ALGORITHM_MD5_128)
-    {
       memcpy (hash_data + hash_data_len,
               pwbuf,
               IPMI_2_0_MAX_PASSWORD_LENGTH);
       hash_data_len += IPMI_2_0_MAX_PASSWORD_LENGTH;
+
+      hash_data_ptr = hash_data;
+    }
+  else
+    {
+      /* HMACs are calculated over the packet data in place */
+      hash_data_ptr = pkt_data;
+      hash_data_len = pkt_data_len;
     }
 
   if ((integrity_digest_len = crypt_hash (hash_algorithm,
                                           hash_flags,
                                           integrity_key,
                                           integrity_key_len,
-                                          hash_data,
+                                          hash_data_ptr,
                                           hash_data_len,
                                           integrity_digest,
                                           IPMI_MAX_INTEGRITY_DATA_LENGTH)) < 0)
@@ -1199,7 +1202,7 @@ _construct_session_trlr_authentication_code (uint8_t integrity_algorithm,
       goto cleanup;
     }
 
-  if (integrity_digest_len > authentication_code_buf_len)
+  if (copy_digest_len > authentication_code_buf_len)
     {
       SET_ERRNO (ENOSPC);
       goto cleanup;
@@ -1233,14 +1236,11 @@ assemble_ipmi_rmcpplus_pkt (uint8_t authentication_algorithm,
                             unsigned int pkt_len,
                             unsigned int flags)
 {
-  unsigned int indx = 0;
-  int obj_rmcp_hdr_len, obj_len, oem_iana_len, oem_payload_id_len, payload_len, len, rv = -1;
+  unsigned int indx = 0, payload_len_indx;
+  int obj_rmcp_hdr_len, oem_iana_len, oem_payload_id_len, payload_len, len;
   uint8_t payload_type, payload_authenticated, payload_encrypted;
   uint32_t session_id, session_sequence_number;
   uint64_t val;
-  fiid_obj_t obj_rmcpplus_payload = NULL;
-  fiid_obj_t obj_session_hdr_temp = NULL;
-  fiid_obj_t obj_rmcpplus_session_trlr_temp = NULL;
   unsigned int flags_mask = 0;
 
   /* achu: obj_lan_msg_hdr only needed for payload type IPMI
@@ -1520,14 +1520,26 @@ assemble_ipmi_rmcpplus_pkt (uint8_t authentication_algorithm,
   indx += len;
 
   /*
-   * Construct/Encrypt Payload and copy into packet
+   * Construct/Encrypt Payload directly into packet, after the IPMI
+   * Payload Length which is filled in afterwards.
    */
-  if (!(obj_rmcpplus_payload = fiid_obj_create (tmpl_rmcpplus_payload)))
+  if ((len = fiid_template_field_len_bytes (tmpl_rmcpplus_session_hdr,
+                                            "ipmi_payload_len")) < 0)
     {
       ERRNO_TRACE (errno);
-      goto cleanup;
+      return (-1);
     }
 
+  assert (len == 2);
+
+  if (len > (pkt_len - indx))
+    {
+      SET_ERRNO (ENOSPC);
+      return (-1);
+    }
+  payload_len_indx = indx;
+  indx += len;
+
   if ((payload_len = _construct_payload (payload_type,
                                          payload_encrypted,
                                          authentication_algorithm,
@@ -1536,118 +1548,44 @@ assemble_ipmi_rmcpplus_pkt (uint8_t authentication_algorithm,
                                          obj_cmd,
                                          confidentiality_key,
                                          confidentiality_key_len,
-                                         obj_rmcpplus_payload)) < 0)
-    {
-      ERRNO_TRACE (errno);
-      goto cleanup;
-    }
-
-  /*
-   * Copy IPMI Payload Length into packet
-   */
-
-  if (!(obj_session_hdr_temp = fiid_obj_create (tmpl_rmcpplus_session_hdr)))
+                                         pkt + indx,
+                                         pkt_len - indx)) < 0)
     {
       ERRNO_TRACE (errno);
-      goto cleanup;
-    }
-
-  if (fiid_obj_set (obj_session_hdr_temp,
-                    "ipmi_payload_len",
-                    payload_len) < 0)
-    {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_session_hdr_temp);
-      goto cleanup;
-    }
-
-  if ((obj_len = fiid_obj_len_bytes (obj_session_hdr_temp)) < 0)
-    {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_session_hdr_temp);
-      goto cleanup;
-    }
-
-  if (obj_len > (pkt_len - indx))
-    {
-      SET_ERRNO (ENOSPC);
-      goto cleanup;
-    }
-
-  if ((obj_len = fiid_obj_get_all (obj_session_hdr_temp,
-                                   pkt + indx,
-                                   pkt_len - indx)) < 0)
-    {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_session_hdr_temp);
-      goto cleanup;
-    }
-  indx += obj_len;
-
-  /*
-   * Copy IPMI Payload into packet
-   */
-
-  if ((obj_len = fiid_obj_len_bytes (obj_rmcpplus_payload)) < 0)
-    {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_payload);
-      goto cleanup;
+      return (-1);
     }
 
-  if (obj_len > (pkt_len - indx))
+  if (payload_len > USHRT_MAX)
     {
-      SET_ERRNO (ENOSPC);
-      goto cleanup;
+      SET_ERRNO (EMSGSIZE);
+      return (-1);
     }
 
-  if ((obj_len = fiid_obj_get_all (obj_rmcpplus_payload,
-                                   pkt + indx,
-                                   pkt_len - indx)) < 0)
-    {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_payload);
-      goto cleanup;
-    }
-  indx += obj_len;
+  /* ipmi_payload_len is little endian */
+  ((uint8_t *)pkt)[payload_len_indx] = (payload_len & 0x00FF);
+  ((uint8_t *)pkt)[payload_len_indx + 1] = (payload_len & 0xFF00) >> 8;
+  indx += payload_len;
 
   if (session_id && payload_authenticated == IPMI_PAYLOAD_FLAG_AUTHENTICATED)
     {
-      uint8_t authentication_code_buf[IPMI_MAX_PAYLOAD_LENGTH];
       int authentication_code_len;
 
-      if (!(obj_rmcpplus_session_trlr_temp = fiid_obj_dup (obj_rmcpplus_session_trlr)))
-        {
-          FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_session_trlr);
-          goto cleanup;
-        }
-
-      if (_construct_session_trlr_pad (integrity_algorithm,
-                                       (indx - obj_rmcp_hdr_len),
-                                       obj_rmcpplus_session_trlr_temp) < 0)
+      if ((len = _construct_session_trlr_pad (integrity_algorithm,
+                                              (indx - obj_rmcp_hdr_len),
+                                              obj_rmcpplus_session_trlr,
+                                              pkt + indx,
+                                              pkt_len - indx)) < 0)
         {
           ERRNO_TRACE (errno);
-          goto cleanup;
+          return (-1);
         }
+      indx += len;
 
-      if ((len = fiid_obj_block_len_bytes (obj_rmcpplus_session_trlr_temp,
-                                           "integrity_pad",
-                                           "next_header")) < 0)
-        {
-          FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_session_trlr_temp);
-          goto cleanup;
-        }
-      if (len > (pkt_len - indx))
+      if (indx >= pkt_len)
         {
           SET_ERRNO (ENOSPC);
-          goto cleanup;
-        }
-
-      if ((len = fiid_obj_get_block (obj_rmcpplus_session_trlr_temp,
-                                     "integrity_pad",
-                                     "next_header",
-                                     pkt + indx,
-                                     pkt_len - indx)) < 0)
-        {
-          FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_session_trlr_temp);
-          goto cleanup;
+          return (-1);
         }
-      indx += len;
 
       /* achu: Note that the integrity code is all data prior to the authentication_code, so this
        * call must be done after the pad, pad length, and next header are copied into
@@ -1658,40 +1596,25 @@ assemble_ipmi_rmcpplus_pkt (uint8_t authentication_algorithm,
                                                                                   integrity_key_len,
                                                                                   authentication_code_data,
                                                                                   authentication_code_data_len,
-                                                                                  obj_rmcpplus_session_trlr_temp,
+                                                                                  obj_rmcpplus_session_trlr,
                                                                                   pkt + obj_rmcp_hdr_len,
                                                                                   indx - obj_rmcp_hdr_len,
-                                                                                  authentication_code_buf,
-                                                                                  IPMI_MAX_PAYLOAD_LENGTH)) < 0)
+                                                                                  pkt + indx,
+                                                                                  pkt_len - indx)) < 0)
         {
           ERRNO_TRACE (errno);
-          goto cleanup;
-        }
-
-      if (authentication_code_len)
-        {
-          if (authentication_code_len > (pkt_len - indx))
-            {
-              SET_ERRNO (ENOSPC);
-              goto cleanup;
-            }
-          memcpy (pkt + indx, authentication_code_buf, authentication_code_len);
-          indx += authentication_code_len;
+          return (-1);
         }
+      indx += authentication_code_len;
     }
 
   if (indx > INT_MAX)
     {
       SET_ERRNO (EMSGSIZE);
-      goto cleanup;
+      return (-1);
     }
 
-  rv = indx;
- cleanup:
-  fiid_obj_destroy (obj_rmcpplus_payload);
-  fiid_obj_destroy (obj_session_hdr_temp);
-  fiid_obj_destroy (obj_rmcpplus_session_trlr_temp);
-  return (rv);
+  return (indx);
 }
 
 /* return 1 on full parse, 0 if not, -1 on error */
@@ -1865,7 +1788,7 @@ _deconstruct_payload_confidentiality_aes_cbc_128 (uint8_t payload_type,
                                                   const void *pkt,
                                                   uint16_t ipmi_payload_len)
 {
-  uint8_t iv[IPMI_CRYPT_AES_CBC_128_IV_LENGTH];
+  const uint8_t *iv;
   uint8_t payload_buf[IPMI_MAX_PAYLOAD_LENGTH];
   uint8_t pad_length;
   int cipher_keylen, cipher_blocklen, decrypt_len;
@@ -1931,7 +1854,10 @@ _deconstruct_payload_confidentiality_aes_cbc_128 (uint8_t payload_type,
       return (0);
     }
 
-  memcpy (iv, pkt, IPMI_CRYPT_AES_CBC_128_BLOCK_LENGTH);
+  /* The IV is used directly from the packet, only the
+   * encrypted data must be copied to be decrypted in place.
+   */
+  iv = (const uint8_t *)pkt;
   indx += IPMI_CRYPT_AES_CBC_128_BLOCK_LENGTH;
   memcpy (payload_buf, pkt + indx, payload_data_len);
 
@@ -1999,7 +1925,7 @@ _deconstruct_payload_confidentiality_aes_cbc_128 (uint8_t payload_type,
   if (fiid_obj_set_data (obj_rmcpplus_payload,
                          "confidentiality_trailer",
                          payload_buf + cmd_data_len,
-                         pad_length + 1), 0)
+                         pad_length + 1) < 0)
     {
       FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_payload);
       return (-1);
@@ -2145,8 +2071,8 @@ unassemble_ipmi_rmcpplus_pkt (uint8_t authentication_algorithm,
   uint8_t payload_type, payload_authenticated, payload_encrypted;
   uint32_t session_id, session_sequence_number;
   uint16_t ipmi_payload_len;
+  const uint8_t *hdr;
   int ret, check_session_trlr_valid = 0;
-  uint64_t val;
   unsigned int flags_mask = (IPMI_INTERFACE_FLAGS_NO_LEGAL_CHECK);
 
   /* achu: obj_lan_msg_hdr & trlr only needed for payload type IPMI
@@ -2231,7 +2157,12 @@ unassemble_ipmi_rmcpplus_pkt (uint8_t authentication_algorithm,
 
   /*
    * Extract auth_type and payload information
+   *
+   * Fields needed below are read directly from the packet
+   * rather than back out of the fiid object.  The length checks
+   * after each block guarantee the whole block is in the packet.
    */
+  hdr = (const uint8_t *)pkt + indx;
   if ((obj_len = fiid_obj_set_block (obj_rmcpplus_session_hdr,
                                      "authentication_type",
                                      "payload_type.encrypted",
@@ -2250,14 +2181,9 @@ unassemble_ipmi_rmcpplus_pkt (uint8_t authentication_algorithm,
       return (0);
     }
 
-  if (FIID_OBJ_GET (obj_rmcpplus_session_hdr,
-                    "payload_type",
-                    &val) < 0)
-    {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_session_hdr);
-      return (-1);
-    }
-  payload_type = val;
+  payload_type = hdr[1] & 0x3F;
+  payload_authenticated = (hdr[1] & 0x40) >> 6;
+  payload_encrypted = (hdr[1] & 0x80) >> 7;
 
   if (payload_type != IPMI_PAYLOAD_TYPE_IPMI
       && payload_type != IPMI_PAYLOAD_TYPE_SOL
@@ -2303,6 +2229,7 @@ unassemble_ipmi_rmcpplus_pkt (uint8_t authentication_algorithm,
   /*
    * Extract Session ID, Session Sequence Number, and Payload Length
    */
+  hdr = (const uint8_t *)pkt + indx;
   if ((obj_len = fiid_obj_set_block (obj_rmcpplus_session_hdr,
                                      "session_id",
                                      "ipmi_payload_len",
@@ -2321,50 +2248,16 @@ unassemble_ipmi_rmcpplus_pkt (uint8_t authentication_algorithm,
       return (0);
     }
 
-  if (FIID_OBJ_GET (obj_rmcpplus_session_hdr,
-                    "payload_type.authenticated",
-                    &val) < 0)
-    {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_session_hdr);
-      return (-1);
-    }
-  payload_authenticated = val;
-
-  if (FIID_OBJ_GET (obj_rmcpplus_session_hdr,
-                    "payload_type.encrypted",
-                    &val) < 0)
-    {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_session_hdr);
-      return (-1);
-    }
-  payload_encrypted = val;
-
-  if (FIID_OBJ_GET (obj_rmcpplus_session_hdr,
-                    "session_id",
-                    &val) < 0)
-    {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_session_hdr);
-      return (-1);
-    }
-  session_id = val;
-
-  if (FIID_OBJ_GET (obj_rmcpplus_session_hdr,
-                    "session_sequence_number",
-                    &val) < 0)
-    {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_session_hdr);
-      return (-1);
-    }
-  session_sequence_number = val;
-
-  if (FIID_OBJ_GET (obj_rmcpplus_session_hdr,
-                    "ipmi_payload_len",
-                    &val) < 0)
-    {
-      FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_session_hdr);
-      return (-1);
-    }
-  ipmi_payload_len = val;
+  /* all little endian */
+  session_id = (uint32_t)hdr[0]
+    | ((uint32_t)hdr[1] << 8)
+    | ((uint32_t)hdr[2] << 16)
+    | ((uint32_t)hdr[3] << 24);
+  session_sequence_number = (uint32_t)hdr[4]
+    | ((uint32_t)hdr[5] << 8)
+    | ((uint32_t)hdr[6] << 16)
+    | ((uint32_t)hdr[7] << 24);
+  ipmi_payload_len = (uint16_t)hdr[8] | ((uint16_t)hdr[9] << 8);
 
   if ((IPMI_PAYLOAD_TYPE_SESSION_SETUP (payload_type)
        && (payload_authenticated
@@ -2570,14 +2463,7 @@ unassemble_ipmi_rmcpplus_pkt (uint8_t authentication_algorithm,
           return (-1);
         }
 
-      if (FIID_OBJ_GET (obj_rmcpplus_session_trlr,
-                        "pad_length",
-                        &val) < 0)
-        {
-          FIID_OBJECT_ERROR_TO_ERRNO (obj_rmcpplus_session_trlr);
-          return (-1);
-        }
-      pad_length = val;
+      pad_length = ((const uint8_t *)pkt)[indx + ((pkt_len - indx) - authentication_code_len - next_header_field_len - pad_length_field_len)];
 
       if (pad_length > IPMI_INTEGRITY_PAD_MULTIPLE)
         {
@@ -73,6 +73,12 @@
 #define IPMI_SDR_CACHE_BYTES_TO_READ_START      16
 #define IPMI_SDR_CACHE_BYTES_TO_READ_DECREMENT  4
 
+/* The cache is built in "<filename>.XXXXXX" and moved into place when
+ * complete.
+ */
+#define IPMI_SDR_CACHE_TMPFILE_SUFFIX           ".XXXXXX"
+#define IPMI_SDR_CACHE_TMPFILE_SUFFIX_LENGTH    7
+
 static int
 _sdr_cache_header_write (ipmi_sdr_ctx_t ctx,
                          ipmi_ctx_t ipmi_ctx,
@@ -742,6 +748,32 @@ _sdr_cache_record_write (ipmi_sdr_ctx_t ctx,
 
 }
 
+static void
+_sdr_cache_set_file_errnum (ipmi_sdr_ctx_t ctx, int cache_create_flags)
+{
+  assert (ctx);
+  assert (ctx->magic == IPMI_SDR_CTX_MAGIC);
+
+  if (!(cache_create_flags & IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE)
+      && errno == EEXIST)
+    SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_CACHE_CREATE_CACHE_EXISTS);
+  else if (errno == EPERM
+           || errno == EACCES
+           || errno == EISDIR
+           || errno == EROFS)
+    SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_PERMISSION);
+  else if (errno == ENAMETOOLONG
+           || errno == ENOENT
+           || errno == ELOOP)
+    SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_FILENAME_INVALID);
+  else if (errno == ENOSPC
+           || errno == EMFILE
+           || errno == ENFILE)
+    SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_FILESYSTEM);
+  else
+    SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_SYSTEM_ERROR);
+}
+
 int
 ipmi_sdr_cache_create (ipmi_sdr_ctx_t ctx,
                        ipmi_ctx_t ipmi_ctx,
@@ -750,7 +782,8 @@ ipmi_sdr_cache_create (ipmi_sdr_ctx_t ctx,
                        Ipmi_Sdr_Cache_Create_Callback create_callback,
                        void *create_callback_data)
 {
-  int open_flags;
+  char tmpfilename[MAXPATHLEN + 1];
+  struct stat buf;
   uint8_t sdr_version;
   uint16_t record_count, reservation_id, record_id, next_record_id;
   uint32_t most_recent_addition_timestamp, most_recent_erase_timestamp;
@@ -774,7 +807,7 @@ ipmi_sdr_cache_create (ipmi_sdr_ctx_t ctx,
   /* Version cannot be 0h according to the IPMI spec */
   if (!ipmi_ctx
       || !filename
-      || (strlen (filename) > MAXPATHLEN)
+      || ((strlen (filename) + IPMI_SDR_CACHE_TMPFILE_SUFFIX_LENGTH) > MAXPATHLEN)
       || (cache_create_flags & ~cache_create_flags_mask))
     {
       SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_PARAMETERS);
@@ -791,32 +824,39 @@ ipmi_sdr_cache_create (ipmi_sdr_ctx_t ctx,
     }
   
   ctx->operation = IPMI_SDR_OPERATION_CREATE_CACHE;
-  
-  if (cache_create_flags & IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE)
-    open_flags = O_CREAT | O_TRUNC | O_WRONLY;
-  else
-    open_flags = O_CREAT | O_EXCL | O_WRONLY;
-  
-  if ((fd = open (filename, open_flags, 0644)) < 0)
+
+  memset (tmpfilename, '\0', MAXPATHLEN + 1);
+
+  /* Fail early rather than after reading the entire SDR, the final
+   * link() below still catches a cache created in the meantime.
+   */
+  if (!(cache_create_flags & IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE)
+      && !lstat (filename, &buf))
     {
-      if (!(cache_create_flags & IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE)
-          && errno == EEXIST)
-        SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_CACHE_CREATE_CACHE_EXISTS);
-      else if (errno == EPERM
-               || errno == EACCES
-               || errno == EISDIR
-               || errno == EROFS)
-        SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_PERMISSION);
-      else if (errno == ENAMETOOLONG
-               || errno == ENOENT
-               || errno == ELOOP)
-        SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_FILENAME_INVALID);
-      else if (errno == ENOSPC
-               || errno == EMFILE
-               || errno == ENFILE)
-        SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_FILESYSTEM);
-      else
-        SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_SYSTEM_ERROR);
+      SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_CACHE_CREATE_CACHE_EXISTS);
+      goto cleanup;
+    }
+
+  /* Build the cache in a temporary file next to the final one, so
+   * readers never see a partially written cache and an existing cache
+   * is left as is if the SDR cannot be read.
+   */
+  snprintf (tmpfilename,
+            MAXPATHLEN + 1,
+            "%s%s",
+            filename,
+            IPMI_SDR_CACHE_TMPFILE_SUFFIX);
+
+  if ((fd = mkstemp (tmpfilename)) < 0)
+    {
+      _sdr_cache_set_file_errnum (ctx, IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE);
+      tmpfilename[0] = '\0';
+      goto cleanup;
+    }
+
+  if (fchmod (fd, 0644) < 0)
+    {
+      SDR_ERRNO_TO_SDR_ERRNUM (ctx, errno);
       goto cleanup;
     }
 
@@ -1032,18 +1072,38 @@ ipmi_sdr_cache_create (ipmi_sdr_ctx_t ctx,
     }
   fd = -1;
 
+  /* link() will not replace a cache created by someone else while
+   * this one was being built.
+   */
+  if (cache_create_flags & IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE)
+    {
+      if (rename (tmpfilename, filename) < 0)
+        {
+          _sdr_cache_set_file_errnum (ctx, cache_create_flags);
+          goto cleanup;
+        }
+      tmpfilename[0] = '\0';
+    }
+  else
+    {
+      if (link (tmpfilename, filename) < 0)
+        {
+          _sdr_cache_set_file_errnum (ctx, cache_create_flags);
+          goto cleanup;
+        }
+    }
+
   rv = 0;
   ctx->errnum = IPMI_SDR_ERR_SUCCESS;
  cleanup:
   ctx->operation = IPMI_SDR_OPERATION_UNINITIALIZED;
+  /* ignore potential error, cleanup path */
   if (fd >= 0)
-    {
-      /* If the cache create never completed, try to remove the file */
-      /* ignore potential error, cleanup path */
-      unlink (filename);
-      /* ignore potential error, cleanup path */
-      close (fd);
-    }
+    close (fd);
+  /* If the cache create never completed, try to remove the file */
+  /* ignore potential error, cleanup path */
+  if (tmpfilename[0] != '\0')
+    unlink (tmpfilename);
   free (record_ids);
   sdr_init_ctx (ctx);
   return (rv);
@@ -706,6 +706,138 @@ ipmi_sdr_cache_record_read (ipmi_sdr_ctx_t ctx,
   return (record_length + IPMI_SDR_RECORD_HEADER_LENGTH);
 }
 
+/* Decode every record of the cache once.  The records are already
+ * mapped, so this is a single pass with no fiid objects.
+ */
+static int
+_sdr_cache_decode_records (ipmi_sdr_ctx_t ctx)
+{
+  struct ipmi_sdr_decoded_record *decoded_records = NULL;
+  unsigned int count = 0;
+  unsigned int i;
+  off_t offset;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_SDR_CTX_MAGIC);
+  assert (ctx->operation == IPMI_SDR_OPERATION_READ_CACHE);
+  assert (!ctx->decoded_records);
+
+  offset = ctx->records_start_offset;
+  while ((offset + IPMI_SDR_RECORD_HEADER_LENGTH) <= ctx->records_end_offset)
+    {
+      unsigned int record_length;
+
+      record_length = (uint8_t)((ctx->sdr_cache + offset)[IPMI_SDR_RECORD_LENGTH_INDEX]);
+      offset += IPMI_SDR_RECORD_HEADER_LENGTH;
+      offset += record_length;
+      count++;
+    }
+
+  if (!count)
+    {
+      SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_CACHE_INVALID);
+      return (-1);
+    }
+
+  if (!(decoded_records = (struct ipmi_sdr_decoded_record *)malloc (sizeof (struct ipmi_sdr_decoded_record) * count)))
+    {
+      SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_OUT_OF_MEMORY);
+      return (-1);
+    }
+
+  offset = ctx->records_start_offset;
+  for (i = 0; i < count; i++)
+    {
+      unsigned int record_length;
+
+      record_length = (uint8_t)((ctx->sdr_cache + offset)[IPMI_SDR_RECORD_LENGTH_INDEX]);
+      record_length += IPMI_SDR_RECORD_HEADER_LENGTH;
+
+      /* last record may be truncated */
+      if ((offset + record_length) > ctx->records_end_offset)
+        record_length = ctx->records_end_offset - offset;
+
+      decoded_records[i].offset = offset;
+      if (sdr_decode_record (ctx,
+                             ctx->sdr_cache + offset,
+                             record_length,
+                             &decoded_records[i].decoded) < 0)
+        decoded_records[i].errnum = ctx->errnum;
+      else
+        decoded_records[i].errnum = IPMI_SDR_ERR_SUCCESS;
+
+      offset += record_length;
+    }
+
+  ctx->decoded_records = decoded_records;
+  ctx->decoded_records_count = count;
+  return (0);
+}
+
+int
+ipmi_sdr_cache_record_decoded (ipmi_sdr_ctx_t ctx,
+                               ipmi_sdr_record_decoded_t *decoded,
+                               unsigned int decoded_len)
+{
+  unsigned int low, high;
+
+  if (!ctx || ctx->magic != IPMI_SDR_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_sdr_ctx_errormsg (ctx), ipmi_sdr_ctx_errnum (ctx));
+      return (-1);
+    }
+
+  if (!decoded || !decoded_len)
+    {
+      SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  if (ctx->operation != IPMI_SDR_OPERATION_READ_CACHE)
+    {
+      SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_CACHE_READ_INITIALIZATION);
+      return (-1);
+    }
+
+  if (!ctx->decoded_records)
+    {
+      if (_sdr_cache_decode_records (ctx) < 0)
+        return (-1);
+    }
+
+  /* records are decoded in offset order */
+  low = 0;
+  high = ctx->decoded_records_count;
+  while (low < high)
+    {
+      unsigned int mid = low + (high - low) / 2;
+
+      if (ctx->decoded_records[mid].offset < ctx->current_offset.offset)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+
+  if (low >= ctx->decoded_records_count
+      || ctx->decoded_records[low].offset != ctx->current_offset.offset)
+    {
+      SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_INTERNAL_ERROR);
+      return (-1);
+    }
+
+  if (ctx->decoded_records[low].errnum != IPMI_SDR_ERR_SUCCESS)
+    {
+      SDR_SET_ERRNUM (ctx, ctx->decoded_records[low].errnum);
+      return (-1);
+    }
+
+  sdr_check_read_status (ctx);
+
+  sdr_decode_record_copy (decoded, decoded_len, &ctx->decoded_records[low].decoded);
+  ctx->errnum = IPMI_SDR_ERR_SUCCESS;
+  return (0);
+}
+
 static int
 _sdr_save_current_offset (ipmi_sdr_ctx_t ctx)
 {
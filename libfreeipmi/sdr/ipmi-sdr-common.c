@@ -73,6 +73,10 @@ sdr_init_ctx (ipmi_sdr_ctx_t ctx)
   ctx->current_offset.offset = 0;
   ctx->current_offset.offset_dumped = 0;
   ctx->callback_lock = 0;
+
+  free (ctx->decoded_records);
+  ctx->decoded_records = NULL;
+  ctx->decoded_records_count = 0;
   
   ctx->stats_compiled = 0;
   memset (ctx->entity_counts,
@@ -50,4 +50,15 @@ const char *sdr_record_type_str (ipmi_sdr_ctx_t ctx,
 
 void sdr_check_read_status (ipmi_sdr_ctx_t ctx);
 
+/* decode without fiid, see ipmi_sdr_parse_record_decode() */
+int sdr_decode_record (ipmi_sdr_ctx_t ctx,
+                       const uint8_t *sdr_record,
+                       unsigned int sdr_record_len,
+                       ipmi_sdr_record_decoded_t *decoded);
+
+/* copy to a caller's ipmi_sdr_record_decoded_t of decoded_len bytes */
+void sdr_decode_record_copy (ipmi_sdr_record_decoded_t *decoded,
+                             unsigned int decoded_len,
+                             const ipmi_sdr_record_decoded_t *src);
+
 #endif /* IPMI_SDR_COMMON_H */
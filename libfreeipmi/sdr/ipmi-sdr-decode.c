@@ -0,0 +1,450 @@
+/*
+ * Copyright (C) 2003-2015 FreeIPMI Core Team
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * 
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#if STDC_HEADERS
+#include <string.h>
+#endif /* STDC_HEADERS */
+#include <assert.h>
+#include <errno.h>
+
+#include "freeipmi/sdr/ipmi-sdr.h"
+
+#include "freeipmi/record-format/ipmi-sdr-record-format.h"
+#include "freeipmi/spec/ipmi-sensor-units-spec.h"
+
+#include "ipmi-sdr-common.h"
+#include "ipmi-sdr-defs.h"
+#include "ipmi-sdr-trace.h"
+
+#include "freeipmi-portability.h"
+
+/* Records are decoded straight from the record bytes instead of
+ * through fiid objects.  Byte offsets and bit positions follow the
+ * tmpl_sdr_*_record templates in ipmi-sdr-record-format.c.
+ */
+
+#define SDR_BITS(byte, shift, mask) (((byte) >> (shift)) & (mask))
+
+/* Fixed length portion of each record, i.e. the offset of the id string */
+#define SDR_FULL_SENSOR_RECORD_ID_STRING_INDEX                           48
+#define SDR_COMPACT_SENSOR_RECORD_ID_STRING_INDEX                        32
+#define SDR_EVENT_ONLY_RECORD_ID_STRING_INDEX                            17
+#define SDR_FRU_DEVICE_LOCATOR_RECORD_ID_STRING_INDEX                    16
+#define SDR_MANAGEMENT_CONTROLLER_DEVICE_LOCATOR_RECORD_ID_STRING_INDEX  16
+
+static void
+_decode_id_string (const uint8_t *sdr_record,
+                   unsigned int sdr_record_len,
+                   unsigned int index,
+                   ipmi_sdr_record_decoded_t *decoded)
+{
+  unsigned int len;
+
+  assert (sdr_record);
+  assert (sdr_record_len >= index);
+  assert (decoded);
+
+  len = sdr_record_len - index;
+  if (len > IPMI_SDR_MAX_ID_STRING_LENGTH)
+    len = IPMI_SDR_MAX_ID_STRING_LENGTH;
+
+  memcpy (decoded->id_string, sdr_record + index, len);
+  decoded->id_string[len] = '\0';
+  decoded->id_string_len = len;
+}
+
+/* sensor owner, sensor number, entity - identical in full, compact,
+ * and event only records
+ */
+static void
+_decode_sensor_key (const uint8_t *sdr_record,
+                    ipmi_sdr_record_decoded_t *decoded)
+{
+  assert (sdr_record);
+  assert (decoded);
+
+  decoded->sensor_owner_id_type = SDR_BITS (sdr_record[5], 0, 0x01);
+  decoded->sensor_owner_id = SDR_BITS (sdr_record[5], 1, 0x7F);
+  decoded->sensor_owner_lun = SDR_BITS (sdr_record[6], 0, 0x03);
+  decoded->channel_number = SDR_BITS (sdr_record[6], 4, 0x0F);
+  decoded->sensor_number = sdr_record[7];
+  decoded->entity_id = sdr_record[8];
+  decoded->entity_instance = SDR_BITS (sdr_record[9], 0, 0x7F);
+  decoded->entity_instance_type = SDR_BITS (sdr_record[9], 7, 0x01);
+}
+
+/* bytes 10 - 22 and the hysteresis, common to full and compact records */
+static void
+_decode_sensor_body (const uint8_t *sdr_record,
+                     ipmi_sdr_record_decoded_t *decoded)
+{
+  assert (sdr_record);
+  assert (decoded);
+
+  decoded->sensor_initialization_sensor_scanning = SDR_BITS (sdr_record[10], 0, 0x01);
+  decoded->sensor_initialization_event_generation = SDR_BITS (sdr_record[10], 1, 0x01);
+  decoded->sensor_initialization_init_sensor_type = SDR_BITS (sdr_record[10], 2, 0x01);
+  decoded->sensor_initialization_init_hysteresis = SDR_BITS (sdr_record[10], 3, 0x01);
+  decoded->sensor_initialization_init_thresholds = SDR_BITS (sdr_record[10], 4, 0x01);
+  decoded->sensor_initialization_init_events = SDR_BITS (sdr_record[10], 5, 0x01);
+  decoded->sensor_initialization_init_scanning = SDR_BITS (sdr_record[10], 6, 0x01);
+
+  decoded->event_message_control_support = SDR_BITS (sdr_record[11], 0, 0x03);
+  decoded->threshold_access_support = SDR_BITS (sdr_record[11], 2, 0x03);
+  decoded->hysteresis_support = SDR_BITS (sdr_record[11], 4, 0x03);
+  decoded->auto_re_arm_support = SDR_BITS (sdr_record[11], 6, 0x01);
+  decoded->entity_ignore_support = SDR_BITS (sdr_record[11], 7, 0x01);
+
+  decoded->sensor_type = sdr_record[12];
+  decoded->event_reading_type_code = sdr_record[13];
+
+  decoded->assertion_event_mask = sdr_record[14] | ((uint16_t)sdr_record[15] << 8);
+  decoded->deassertion_event_mask = sdr_record[16] | ((uint16_t)sdr_record[17] << 8);
+  decoded->discrete_reading_mask = sdr_record[18] | ((uint16_t)sdr_record[19] << 8);
+
+  decoded->sensor_units_percentage = SDR_BITS (sdr_record[20], 0, 0x01);
+  decoded->sensor_units_modifier = SDR_BITS (sdr_record[20], 1, 0x03);
+  decoded->sensor_units_rate = SDR_BITS (sdr_record[20], 3, 0x07);
+  decoded->analog_data_format = SDR_BITS (sdr_record[20], 6, 0x03);
+  decoded->sensor_base_unit_type = sdr_record[21];
+  decoded->sensor_modifier_unit_type = sdr_record[22];
+
+  if (!IPMI_SENSOR_UNIT_VALID (decoded->sensor_base_unit_type))
+    decoded->sensor_base_unit_type = IPMI_SENSOR_UNIT_UNSPECIFIED;
+  if (!IPMI_SENSOR_UNIT_VALID (decoded->sensor_modifier_unit_type))
+    decoded->sensor_modifier_unit_type = IPMI_SENSOR_UNIT_UNSPECIFIED;
+}
+
+/* sensor record sharing, identical in compact and event only records */
+static void
+_decode_sensor_sharing (const uint8_t *sdr_record,
+                        unsigned int index,
+                        ipmi_sdr_record_decoded_t *decoded)
+{
+  assert (sdr_record);
+  assert (decoded);
+
+  decoded->share_count = SDR_BITS (sdr_record[index], 0, 0x0F);
+  decoded->id_string_instance_modifier_type = SDR_BITS (sdr_record[index], 4, 0x03);
+  decoded->sensor_direction = SDR_BITS (sdr_record[index], 6, 0x03);
+  decoded->id_string_instance_modifier_offset = SDR_BITS (sdr_record[index + 1], 0, 0x7F);
+  decoded->entity_instance_sharing = SDR_BITS (sdr_record[index + 1], 7, 0x01);
+}
+
+static void
+_decode_full_sensor_record (const uint8_t *sdr_record,
+                            unsigned int sdr_record_len,
+                            ipmi_sdr_record_decoded_t *decoded)
+{
+  assert (sdr_record);
+  assert (sdr_record_len >= SDR_FULL_SENSOR_RECORD_ID_STRING_INDEX);
+  assert (decoded);
+
+  _decode_sensor_key (sdr_record, decoded);
+  _decode_sensor_body (sdr_record, decoded);
+
+  decoded->linearization = SDR_BITS (sdr_record[23], 0, 0x7F);
+
+  /* m and b are 10 bit two's complement, exponents 4 bit */
+  decoded->m = sdr_record[24] | ((int16_t)SDR_BITS (sdr_record[25], 6, 0x03) << 8);
+  if (decoded->m & 0x200)
+    decoded->m |= 0xFE00;
+  decoded->tolerance = SDR_BITS (sdr_record[25], 0, 0x3F);
+  decoded->b = sdr_record[26] | ((int16_t)SDR_BITS (sdr_record[27], 6, 0x03) << 8);
+  if (decoded->b & 0x200)
+    decoded->b |= 0xFE00;
+  decoded->accuracy = SDR_BITS (sdr_record[27], 0, 0x3F)
+    | ((uint16_t)SDR_BITS (sdr_record[28], 4, 0x0F) << 6);
+  decoded->accuracy_exp = SDR_BITS (sdr_record[28], 2, 0x03);
+  decoded->sensor_direction = SDR_BITS (sdr_record[28], 0, 0x03);
+  decoded->b_exponent = SDR_BITS (sdr_record[29], 0, 0x0F);
+  if (decoded->b_exponent & 0x08)
+    decoded->b_exponent |= 0xF0;
+  decoded->r_exponent = SDR_BITS (sdr_record[29], 4, 0x0F);
+  if (decoded->r_exponent & 0x08)
+    decoded->r_exponent |= 0xF0;
+
+  decoded->nominal_reading_specified = SDR_BITS (sdr_record[30], 0, 0x01);
+  decoded->normal_maximum_specified = SDR_BITS (sdr_record[30], 1, 0x01);
+  decoded->normal_minimum_specified = SDR_BITS (sdr_record[30], 2, 0x01);
+  decoded->nominal_reading = sdr_record[31];
+  decoded->normal_maximum = sdr_record[32];
+  decoded->normal_minimum = sdr_record[33];
+  decoded->sensor_maximum_reading = sdr_record[34];
+  decoded->sensor_minimum_reading = sdr_record[35];
+  decoded->upper_non_recoverable_threshold = sdr_record[36];
+  decoded->upper_critical_threshold = sdr_record[37];
+  decoded->upper_non_critical_threshold = sdr_record[38];
+  decoded->lower_non_recoverable_threshold = sdr_record[39];
+  decoded->lower_critical_threshold = sdr_record[40];
+  decoded->lower_non_critical_threshold = sdr_record[41];
+  decoded->positive_going_threshold_hysteresis = sdr_record[42];
+  decoded->negative_going_threshold_hysteresis = sdr_record[43];
+  decoded->oem = sdr_record[46];
+
+  _decode_id_string (sdr_record,
+                     sdr_record_len,
+                     SDR_FULL_SENSOR_RECORD_ID_STRING_INDEX,
+                     decoded);
+}
+
+static void
+_decode_compact_sensor_record (const uint8_t *sdr_record,
+                               unsigned int sdr_record_len,
+                               ipmi_sdr_record_decoded_t *decoded)
+{
+  assert (sdr_record);
+  assert (sdr_record_len >= SDR_COMPACT_SENSOR_RECORD_ID_STRING_INDEX);
+  assert (decoded);
+
+  _decode_sensor_key (sdr_record, decoded);
+  _decode_sensor_body (sdr_record, decoded);
+  _decode_sensor_sharing (sdr_record, 23, decoded);
+
+  decoded->positive_going_threshold_hysteresis = sdr_record[25];
+  decoded->negative_going_threshold_hysteresis = sdr_record[26];
+  decoded->oem = sdr_record[30];
+
+  _decode_id_string (sdr_record,
+                     sdr_record_len,
+                     SDR_COMPACT_SENSOR_RECORD_ID_STRING_INDEX,
+                     decoded);
+}
+
+static void
+_decode_event_only_record (const uint8_t *sdr_record,
+                           unsigned int sdr_record_len,
+                           ipmi_sdr_record_decoded_t *decoded)
+{
+  assert (sdr_record);
+  assert (sdr_record_len >= SDR_EVENT_ONLY_RECORD_ID_STRING_INDEX);
+  assert (decoded);
+
+  _decode_sensor_key (sdr_record, decoded);
+
+  decoded->sensor_type = sdr_record[10];
+  decoded->event_reading_type_code = sdr_record[11];
+  _decode_sensor_sharing (sdr_record, 12, decoded);
+  decoded->oem = sdr_record[15];
+
+  _decode_id_string (sdr_record,
+                     sdr_record_len,
+                     SDR_EVENT_ONLY_RECORD_ID_STRING_INDEX,
+                     decoded);
+}
+
+static void
+_decode_fru_device_locator_record (const uint8_t *sdr_record,
+                                   unsigned int sdr_record_len,
+                                   ipmi_sdr_record_decoded_t *decoded)
+{
+  assert (sdr_record);
+  assert (sdr_record_len >= SDR_FRU_DEVICE_LOCATOR_RECORD_ID_STRING_INDEX);
+  assert (decoded);
+
+  decoded->device_access_address = SDR_BITS (sdr_record[5], 1, 0x7F);
+  decoded->logical_fru_device_device_slave_address = sdr_record[6];
+  decoded->private_bus_id = SDR_BITS (sdr_record[7], 0, 0x07);
+  decoded->lun_for_master_write_read_fru_command = SDR_BITS (sdr_record[7], 3, 0x03);
+  decoded->logical_physical_fru_device = SDR_BITS (sdr_record[7], 7, 0x01);
+  decoded->channel_number = SDR_BITS (sdr_record[8], 4, 0x0F);
+  decoded->device_type = sdr_record[10];
+  decoded->device_type_modifier = sdr_record[11];
+  decoded->fru_entity_id = sdr_record[12];
+  decoded->fru_entity_instance = sdr_record[13];
+  decoded->oem = sdr_record[14];
+
+  _decode_id_string (sdr_record,
+                     sdr_record_len,
+                     SDR_FRU_DEVICE_LOCATOR_RECORD_ID_STRING_INDEX,
+                     decoded);
+}
+
+static void
+_decode_management_controller_device_locator_record (const uint8_t *sdr_record,
+                                                     unsigned int sdr_record_len,
+                                                     ipmi_sdr_record_decoded_t *decoded)
+{
+  assert (sdr_record);
+  assert (sdr_record_len >= SDR_MANAGEMENT_CONTROLLER_DEVICE_LOCATOR_RECORD_ID_STRING_INDEX);
+  assert (decoded);
+
+  decoded->device_slave_address = SDR_BITS (sdr_record[5], 1, 0x7F);
+  decoded->channel_number = SDR_BITS (sdr_record[6], 0, 0x0F);
+
+  decoded->global_initialization_event_message_generation = SDR_BITS (sdr_record[7], 0, 0x03);
+  decoded->global_initialization_log_initialization_agent_errors = SDR_BITS (sdr_record[7], 2, 0x01);
+  decoded->global_initialization_controller_logs_initialization_agent_errors = SDR_BITS (sdr_record[7], 3, 0x01);
+  decoded->power_state_notification_controller = SDR_BITS (sdr_record[7], 5, 0x01);
+  decoded->power_state_notification_acpi_device_power_state_notification = SDR_BITS (sdr_record[7], 6, 0x01);
+  decoded->power_state_notification_acpi_system_power_state_notification = SDR_BITS (sdr_record[7], 7, 0x01);
+
+  decoded->device_capabilities_sensor_device = SDR_BITS (sdr_record[8], 0, 0x01);
+  decoded->device_capabilities_sdr_repository_device = SDR_BITS (sdr_record[8], 1, 0x01);
+  decoded->device_capabilities_sel_device = SDR_BITS (sdr_record[8], 2, 0x01);
+  decoded->device_capabilities_fru_inventory_device = SDR_BITS (sdr_record[8], 3, 0x01);
+  decoded->device_capabilities_ipmb_event_receiver = SDR_BITS (sdr_record[8], 4, 0x01);
+  decoded->device_capabilities_ipmb_event_generator = SDR_BITS (sdr_record[8], 5, 0x01);
+  decoded->device_capabilities_bridge = SDR_BITS (sdr_record[8], 6, 0x01);
+  decoded->device_capabilities_chassis_device = SDR_BITS (sdr_record[8], 7, 0x01);
+
+  decoded->entity_id = sdr_record[12];
+  decoded->entity_instance = SDR_BITS (sdr_record[13], 0, 0x7F);
+  decoded->entity_instance_type = SDR_BITS (sdr_record[13], 7, 0x01);
+  decoded->oem = sdr_record[14];
+
+  _decode_id_string (sdr_record,
+                     sdr_record_len,
+                     SDR_MANAGEMENT_CONTROLLER_DEVICE_LOCATOR_RECORD_ID_STRING_INDEX,
+                     decoded);
+}
+
+int
+sdr_decode_record (ipmi_sdr_ctx_t ctx,
+                   const uint8_t *sdr_record,
+                   unsigned int sdr_record_len,
+                   ipmi_sdr_record_decoded_t *decoded)
+{
+  unsigned int fixed_len = IPMI_SDR_RECORD_HEADER_LENGTH;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_SDR_CTX_MAGIC);
+  assert (sdr_record);
+  assert (decoded);
+
+  memset (decoded, '\0', sizeof (ipmi_sdr_record_decoded_t));
+
+  if (sdr_record_len < IPMI_SDR_RECORD_HEADER_LENGTH)
+    {
+      SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_PARSE_INCOMPLETE_SDR_RECORD);
+      return (-1);
+    }
+
+  decoded->record_id = sdr_record[IPMI_SDR_RECORD_ID_INDEX_LS]
+    | ((uint16_t)sdr_record[IPMI_SDR_RECORD_ID_INDEX_MS] << 8);
+  decoded->sdr_version_major = SDR_BITS (sdr_record[2], 0, 0x0F);
+  decoded->sdr_version_minor = SDR_BITS (sdr_record[2], 4, 0x0F);
+  decoded->record_type = sdr_record[IPMI_SDR_RECORD_TYPE_INDEX];
+  decoded->record_length = sdr_record[IPMI_SDR_RECORD_LENGTH_INDEX];
+
+  if (decoded->record_type == IPMI_SDR_FORMAT_FULL_SENSOR_RECORD)
+    fixed_len = SDR_FULL_SENSOR_RECORD_ID_STRING_INDEX;
+  else if (decoded->record_type == IPMI_SDR_FORMAT_COMPACT_SENSOR_RECORD)
+    fixed_len = SDR_COMPACT_SENSOR_RECORD_ID_STRING_INDEX;
+  else if (decoded->record_type == IPMI_SDR_FORMAT_EVENT_ONLY_RECORD)
+    fixed_len = SDR_EVENT_ONLY_RECORD_ID_STRING_INDEX;
+  else if (decoded->record_type == IPMI_SDR_FORMAT_FRU_DEVICE_LOCATOR_RECORD)
+    fixed_len = SDR_FRU_DEVICE_LOCATOR_RECORD_ID_STRING_INDEX;
+  else if (decoded->record_type == IPMI_SDR_FORMAT_MANAGEMENT_CONTROLLER_DEVICE_LOCATOR_RECORD)
+    fixed_len = SDR_MANAGEMENT_CONTROLLER_DEVICE_LOCATOR_RECORD_ID_STRING_INDEX;
+
+  if (sdr_record_len < fixed_len)
+    {
+      SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_PARSE_INCOMPLETE_SDR_RECORD);
+      return (-1);
+    }
+
+  if (decoded->record_type == IPMI_SDR_FORMAT_FULL_SENSOR_RECORD)
+    _decode_full_sensor_record (sdr_record, sdr_record_len, decoded);
+  else if (decoded->record_type == IPMI_SDR_FORMAT_COMPACT_SENSOR_RECORD)
+    _decode_compact_sensor_record (sdr_record, sdr_record_len, decoded);
+  else if (decoded->record_type == IPMI_SDR_FORMAT_EVENT_ONLY_RECORD)
+    _decode_event_only_record (sdr_record, sdr_record_len, decoded);
+  else if (decoded->record_type == IPMI_SDR_FORMAT_FRU_DEVICE_LOCATOR_RECORD)
+    _decode_fru_device_locator_record (sdr_record, sdr_record_len, decoded);
+  else if (decoded->record_type == IPMI_SDR_FORMAT_MANAGEMENT_CONTROLLER_DEVICE_LOCATOR_RECORD)
+    _decode_management_controller_device_locator_record (sdr_record, sdr_record_len, decoded);
+
+  return (0);
+}
+
+/* A caller built against an older ipmi_sdr_record_decoded_t gets the
+ * fields it knows about.  One built against a newer one gets the
+ * fields this library doesn't know about zeroed.
+ */
+void
+sdr_decode_record_copy (ipmi_sdr_record_decoded_t *decoded,
+                        unsigned int decoded_len,
+                        const ipmi_sdr_record_decoded_t *src)
+{
+  assert (decoded);
+  assert (decoded_len);
+  assert (src);
+
+  if (decoded_len > sizeof (ipmi_sdr_record_decoded_t))
+    {
+      memcpy (decoded, src, sizeof (ipmi_sdr_record_decoded_t));
+      memset ((uint8_t *)decoded + sizeof (ipmi_sdr_record_decoded_t),
+              '\0',
+              decoded_len - sizeof (ipmi_sdr_record_decoded_t));
+    }
+  else
+    memcpy (decoded, src, decoded_len);
+}
+
+int
+ipmi_sdr_parse_record_decode (ipmi_sdr_ctx_t ctx,
+                              const void *sdr_record,
+                              unsigned int sdr_record_len,
+                              ipmi_sdr_record_decoded_t *decoded,
+                              unsigned int decoded_len)
+{
+  ipmi_sdr_record_decoded_t tmp;
+
+  if (!ctx || ctx->magic != IPMI_SDR_CTX_MAGIC)
+    {
+      ERR_TRACE (ipmi_sdr_ctx_errormsg (ctx), ipmi_sdr_ctx_errnum (ctx));
+      return (-1);
+    }
+
+  if (!decoded || !decoded_len)
+    {
+      SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  if (!sdr_record || !sdr_record_len)
+    {
+      if (ctx->operation != IPMI_SDR_OPERATION_READ_CACHE
+          || sdr_record
+          || sdr_record_len)
+        {
+          SDR_SET_ERRNUM (ctx, IPMI_SDR_ERR_PARAMETERS);
+          return (-1);
+        }
+
+      /* the cache decodes every record once, copy it from there */
+      return (ipmi_sdr_cache_record_decoded (ctx, decoded, decoded_len));
+    }
+
+  if (sdr_decode_record (ctx, sdr_record, sdr_record_len, &tmp) < 0)
+    return (-1);
+
+  sdr_decode_record_copy (decoded, decoded_len, &tmp);
+
+  sdr_check_read_status (ctx);
+
+  ctx->errnum = IPMI_SDR_ERR_SUCCESS;
+  return (0);
+}
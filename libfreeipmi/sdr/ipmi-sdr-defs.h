@@ -126,6 +126,13 @@ struct ipmi_sdr_offset {
   int offset_dumped;
 };
 
+/* errnum set if the record could not be decoded */
+struct ipmi_sdr_decoded_record {
+  off_t offset;
+  int errnum;
+  ipmi_sdr_record_decoded_t decoded;
+};
+
 struct ipmi_sdr_entity_count {
   uint8_t entity_instances[IPMI_MAX_ENTITY_ID_INSTANCES];
   unsigned int entity_instances_count;
@@ -155,6 +162,10 @@ struct ipmi_sdr_ctx {
   /* for saving/reset */
   List saved_offsets;
 
+  /* Decoded records, sorted by offset, built on first use */
+  struct ipmi_sdr_decoded_record *decoded_records;
+  unsigned int decoded_records_count;
+
   /* Stats */
   int stats_compiled;
   struct ipmi_sdr_entity_count entity_counts[IPMI_MAX_ENTITY_IDS];
@@ -137,6 +137,7 @@ ipmi_sdr_ctx_destroy (ipmi_sdr_ctx_t ctx)
     munmap (ctx->sdr_cache, ctx->file_size);
 
   list_destroy (ctx->saved_offsets);
+  free (ctx->decoded_records);
 
   ctx->magic = ~IPMI_SDR_CTX_MAGIC;
   ctx->operation = IPMI_SDR_OPERATION_UNINITIALIZED;
@@ -120,16 +120,93 @@ sel_get_reservation_id (ipmi_sel_ctx_t ctx,
   return (rv);
 }
 
+/* Decode the fixed record layouts (Table 32-1, 32-2, 32-3) straight
+ * from the record bytes, rather than through a fiid object per
+ * accessor.  The timestamp sits at the same offset in system event
+ * and timestamped OEM records, so it is decoded for both.
+ */
+static void
+_sel_entry_decode (struct ipmi_sel_entry *sel_entry)
+{
+  struct ipmi_sel_system_event_record_data *data;
+  const uint8_t *p;
+
+  assert (sel_entry);
+  assert (sel_entry->sel_event_record_len >= IPMI_SEL_RECORD_HEADER_LENGTH);
+
+  if (sel_entry->decoded)
+    return;
+
+  p = sel_entry->sel_event_record;
+  data = &sel_entry->system_event_record_data;
+
+  memset (data, '\0', sizeof (struct ipmi_sel_system_event_record_data));
+  sel_entry->manufacturer_id = 0;
+
+  sel_entry->record_id = p[0] | (p[1] << 8);
+  sel_entry->record_type = p[2];
+
+  if (sel_entry->sel_event_record_len >= IPMI_SEL_RECORD_LENGTH)
+    {
+      data->timestamp = (uint32_t)p[3]
+        | ((uint32_t)p[4] << 8)
+        | ((uint32_t)p[5] << 16)
+        | ((uint32_t)p[6] << 24);
+      data->generator_id = p[7];
+      data->ipmb_device_lun = p[8] & 0x03;
+      data->channel_number = (p[8] >> 4) & 0x0F;
+      data->event_message_format_version = p[9];
+      data->sensor_type = p[10];
+      data->sensor_number = p[11];
+      data->event_type_code = p[12] & 0x7F;
+      data->event_direction = (p[12] >> 7) & 0x01;
+      data->offset_from_event_reading_type_code = p[13] & 0x0F;
+      data->event_data3_flag = (p[13] >> 4) & 0x03;
+      data->event_data2_flag = (p[13] >> 6) & 0x03;
+      data->event_data1 = p[13];
+      data->event_data2 = p[14];
+      data->event_data3 = p[15];
+
+      sel_entry->manufacturer_id = (uint32_t)p[7]
+        | ((uint32_t)p[8] << 8)
+        | ((uint32_t)p[9] << 16);
+    }
+
+  sel_entry->decoded = 1;
+}
+
+/* returns record type class, -1 on error */
+static int
+_sel_entry_record_type_class (ipmi_sel_ctx_t ctx,
+                              struct ipmi_sel_entry *sel_entry)
+{
+  uint8_t record_type;
+
+  assert (ctx);
+  assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
+  assert (sel_entry);
+
+  if (sel_entry->sel_event_record_len < IPMI_SEL_RECORD_LENGTH)
+    {
+      SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
+      return (-1);
+    }
+
+  if (sel_get_record_header_info (ctx,
+                                  sel_entry,
+                                  NULL,
+                                  &record_type) < 0)
+    return (-1);
+
+  return (ipmi_sel_record_type_class (record_type));
+}
+
 int
 sel_get_record_header_info (ipmi_sel_ctx_t ctx,
                             struct ipmi_sel_entry *sel_entry,
                             uint16_t *record_id,
                             uint8_t *record_type)
 {
-  fiid_obj_t obj_sel_record_header = NULL;
-  uint64_t val;
-  int rv = -1;
-
   assert (ctx);
   assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
   assert (sel_entry);
@@ -137,55 +214,24 @@ sel_get_record_header_info (ipmi_sel_ctx_t ctx,
   if (sel_entry->sel_event_record_len < IPMI_SEL_RECORD_HEADER_LENGTH)
     {
       SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
-      goto cleanup;
+      return (-1);
     }
 
-  if (!(obj_sel_record_header = fiid_obj_create (tmpl_sel_record_header)))
-    {
-      SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
-      goto cleanup;
-    }
-
-  if (fiid_obj_set_all (obj_sel_record_header,
-                        sel_entry->sel_event_record,
-                        sel_entry->sel_event_record_len) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record_header);
-      goto cleanup;
-    }
+  _sel_entry_decode (sel_entry);
 
   if (record_id)
-    {
-      if (FIID_OBJ_GET (obj_sel_record_header,
-                        "record_id",
-                        &val) < 0)
-        {
-          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record_header);
-          goto cleanup;
-        }
-      (*record_id) = val;
-    }
+    (*record_id) = sel_entry->record_id;
 
   if (record_type)
     {
-      if (FIID_OBJ_GET (obj_sel_record_header,
-                        "record_type",
-                        &val) < 0)
-        {
-          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record_header);
-          goto cleanup;
-        }
-      (*record_type) = val;
+      (*record_type) = sel_entry->record_type;
 
       if (ctx->flags & IPMI_SEL_FLAGS_ASSUME_SYTEM_EVENT_RECORDS
           && !IPMI_SEL_RECORD_TYPE_VALID ((*record_type)))
         (*record_type) = IPMI_SEL_RECORD_TYPE_SYSTEM_EVENT_RECORD;
     }
 
-  rv = 0;
- cleanup:
-  fiid_obj_destroy (obj_sel_record_header);
-  return (rv);
+  return (0);
 }
 
 int
@@ -193,78 +239,26 @@ sel_get_timestamp (ipmi_sel_ctx_t ctx,
                    struct ipmi_sel_entry *sel_entry,
                    uint32_t *timestamp)
 {
-  fiid_obj_t obj_sel_record = NULL;
-  uint8_t record_type;
   int record_type_class;
-  uint64_t val;
-  int rv = -1;
 
   assert (ctx);
   assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
   assert (sel_entry);
 
-  if (sel_entry->sel_event_record_len < IPMI_SEL_RECORD_LENGTH)
-    {
-      SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
-      goto cleanup;
-    }
-
-  if (sel_get_record_header_info (ctx,
-                                  sel_entry,
-                                  NULL,
-                                  &record_type) < 0)
-    goto cleanup;
-
-  record_type_class = ipmi_sel_record_type_class (record_type);
+  if ((record_type_class = _sel_entry_record_type_class (ctx, sel_entry)) < 0)
+    return (-1);
 
   if (record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_SYSTEM_EVENT_RECORD
       && record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_TIMESTAMPED_OEM_RECORD)
     {
       SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
-      goto cleanup;
-    }
-
-  if (record_type_class == IPMI_SEL_RECORD_TYPE_CLASS_SYSTEM_EVENT_RECORD)
-    {
-      if (!(obj_sel_record = fiid_obj_create (tmpl_sel_system_event_record)))
-        {
-          SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
-          goto cleanup;
-        }
-    }
-  else
-    {
-      if (!(obj_sel_record = fiid_obj_create (tmpl_sel_timestamped_oem_record)))
-        {
-          SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
-          goto cleanup;
-        }
-    }
-
-  if (fiid_obj_set_all (obj_sel_record,
-                        sel_entry->sel_event_record,
-                        sel_entry->sel_event_record_len) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
-      goto cleanup;
+      return (-1);
     }
 
   if (timestamp)
-    {
-      if (FIID_OBJ_GET (obj_sel_record,
-                        "timestamp",
-                        &val) < 0)
-        {
-          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
-          goto cleanup;
-        }
-      (*timestamp) = val;
-    }
+    (*timestamp) = sel_entry->system_event_record_data.timestamp;
 
-  rv = 0;
- cleanup:
-  fiid_obj_destroy (obj_sel_record);
-  return (rv);
+  return (0);
 }
 
 int
@@ -272,66 +266,25 @@ sel_get_manufacturer_id (ipmi_sel_ctx_t ctx,
                          struct ipmi_sel_entry *sel_entry,
                          uint32_t *manufacturer_id)
 {
-  fiid_obj_t obj_sel_record = NULL;
-  uint8_t record_type;
   int record_type_class;
-  uint64_t val;
-  int rv = -1;
 
   assert (ctx);
   assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
   assert (sel_entry);
 
-  if (sel_entry->sel_event_record_len < IPMI_SEL_RECORD_LENGTH)
-    {
-      SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
-      goto cleanup;
-    }
-
-  if (sel_get_record_header_info (ctx,
-                                  sel_entry,
-                                  NULL,
-                                  &record_type) < 0)
-    goto cleanup;
-
-  record_type_class = ipmi_sel_record_type_class (record_type);
+  if ((record_type_class = _sel_entry_record_type_class (ctx, sel_entry)) < 0)
+    return (-1);
 
   if (record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_TIMESTAMPED_OEM_RECORD)
     {
       SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
-      goto cleanup;
-    }
-
-  if (!(obj_sel_record = fiid_obj_create (tmpl_sel_timestamped_oem_record)))
-    {
-      SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
-      goto cleanup;
-    }
-
-  if (fiid_obj_set_all (obj_sel_record,
-                        sel_entry->sel_event_record,
-                        sel_entry->sel_event_record_len) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
-      goto cleanup;
+      return (-1);
     }
 
   if (manufacturer_id)
-    {
-      if (FIID_OBJ_GET (obj_sel_record,
-                        "manufacturer_id",
-                        &val) < 0)
-        {
-          SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
-          goto cleanup;
-        }
-      (*manufacturer_id) = val;
-    }
+    (*manufacturer_id) = sel_entry->manufacturer_id;
 
-  rv = 0;
- cleanup:
-  fiid_obj_destroy (obj_sel_record);
-  return (rv);
+  return (0);
 }
 
 int
@@ -340,11 +293,9 @@ sel_get_oem (ipmi_sel_ctx_t ctx,
              uint8_t *buf,
              unsigned int buflen)
 {
-  fiid_obj_t obj_sel_record = NULL;
-  uint8_t record_type;
   int record_type_class;
-  int len;
-  int rv = -1;
+  unsigned int offset;
+  unsigned int len;
 
   assert (ctx);
   assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
@@ -352,65 +303,29 @@ sel_get_oem (ipmi_sel_ctx_t ctx,
   assert (buf);
   assert (buflen);
 
-  if (sel_entry->sel_event_record_len < IPMI_SEL_RECORD_LENGTH)
-    {
-      SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
-      goto cleanup;
-    }
-
-  if (sel_get_record_header_info (ctx,
-                                  sel_entry,
-                                  NULL,
-                                  &record_type) < 0)
-    goto cleanup;
-
-  record_type_class = ipmi_sel_record_type_class (record_type);
-
-  if (record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_TIMESTAMPED_OEM_RECORD
-      && record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_NON_TIMESTAMPED_OEM_RECORD)
-    {
-      SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
-      goto cleanup;
-    }
+  if ((record_type_class = _sel_entry_record_type_class (ctx, sel_entry)) < 0)
+    return (-1);
 
   if (record_type_class == IPMI_SEL_RECORD_TYPE_CLASS_TIMESTAMPED_OEM_RECORD)
-    {
-      if (!(obj_sel_record = fiid_obj_create (tmpl_sel_timestamped_oem_record)))
-        {
-          SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
-          goto cleanup;
-        }
-    }
+    offset = IPMI_SEL_TIMESTAMPED_OEM_RECORD_OEM_OFFSET;
+  else if (record_type_class == IPMI_SEL_RECORD_TYPE_CLASS_NON_TIMESTAMPED_OEM_RECORD)
+    offset = IPMI_SEL_RECORD_HEADER_LENGTH;
   else
     {
-      if (!(obj_sel_record = fiid_obj_create (tmpl_sel_non_timestamped_oem_record)))
-        {
-          SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
-          goto cleanup;
-        }
+      SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
+      return (-1);
     }
 
-  if (fiid_obj_set_all (obj_sel_record,
-                        sel_entry->sel_event_record,
-                        sel_entry->sel_event_record_len) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_record);
-      goto cleanup;
-    }
+  len = IPMI_SEL_RECORD_LENGTH - offset;
 
-  if ((len = fiid_obj_get_data (obj_sel_record,
-                                "oem_defined",
-                                buf,
-                                buflen)) < 0)
+  if (buflen < len)
     {
-      ERR_TRACE (ipmi_sel_ctx_errormsg (ctx), ipmi_sel_ctx_errnum (ctx));
-      goto cleanup;
+      SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_OVERFLOW);
+      return (-1);
     }
 
-  rv = len;
- cleanup:
-  fiid_obj_destroy (obj_sel_record);
-  return (rv);
+  memcpy (buf, &sel_entry->sel_event_record[offset], len);
+  return (len);
 }
 
 int
@@ -418,217 +333,25 @@ sel_get_system_event_record (ipmi_sel_ctx_t ctx,
                              struct ipmi_sel_entry *sel_entry,
                              struct ipmi_sel_system_event_record_data *system_event_record_data)
 {
-  fiid_obj_t obj_sel_system_event_record = NULL;
-  fiid_obj_t obj_sel_system_event_record_event_fields = NULL;
   int record_type_class;
-  uint8_t record_type;
-  uint8_t generator_id_type;
-  uint8_t generator_id_address;
-  uint64_t val;
-  int rv = -1;
 
   assert (ctx);
   assert (ctx->magic == IPMI_SEL_CTX_MAGIC);
   assert (sel_entry);
   assert (system_event_record_data);
 
-  if (sel_entry->sel_event_record_len < IPMI_SEL_RECORD_LENGTH)
-    {
-      SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
-      goto cleanup;
-    }
-
-  if (sel_get_record_header_info (ctx,
-                                  sel_entry,
-                                  NULL,
-                                  &record_type) < 0)
-    goto cleanup;
-
-  record_type_class = ipmi_sel_record_type_class (record_type);
+  if ((record_type_class = _sel_entry_record_type_class (ctx, sel_entry)) < 0)
+    return (-1);
 
   if (record_type_class != IPMI_SEL_RECORD_TYPE_CLASS_SYSTEM_EVENT_RECORD)
     {
       SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INVALID_SEL_ENTRY);
-      goto cleanup;
-    }
-
-  if (!(obj_sel_system_event_record = fiid_obj_create (tmpl_sel_system_event_record)))
-    {
-      SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
-      goto cleanup;
-    }
-
-  if (!(obj_sel_system_event_record_event_fields = fiid_obj_create (tmpl_sel_system_event_record_event_fields)))
-    {
-      SEL_ERRNO_TO_SEL_ERRNUM (ctx, errno);
-      goto cleanup;
-    }
-
-  if (fiid_obj_set_all (obj_sel_system_event_record,
-                        sel_entry->sel_event_record,
-                        sel_entry->sel_event_record_len) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-
-  if (fiid_obj_set_all (obj_sel_system_event_record_event_fields,
-                        sel_entry->sel_event_record,
-                        sel_entry->sel_event_record_len) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record_event_fields);
-      goto cleanup;
-    }
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "timestamp",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->timestamp = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "generator_id.id_type",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  generator_id_type = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "generator_id.id",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  generator_id_address = val;
-
-  system_event_record_data->generator_id = ((generator_id_address << 1) | generator_id_type);
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "ipmb_device_lun",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
+      return (-1);
     }
-  system_event_record_data->ipmb_device_lun = val;
 
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "channel_number",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->channel_number = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "event_message_format_version",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->event_message_format_version = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "sensor_type",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->sensor_type = val;
+  memcpy (system_event_record_data,
+          &sel_entry->system_event_record_data,
+          sizeof (struct ipmi_sel_system_event_record_data));
 
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "sensor_number",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->sensor_number = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "event_type_code",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->event_type_code = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "event_dir",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->event_direction = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "event_data1",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->event_data1 = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "event_data2",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->event_data2 = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record,
-                    "event_data3",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record);
-      goto cleanup;
-    }
-  system_event_record_data->event_data3 = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record_event_fields,
-                    "offset_from_event_reading_type_code",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record_event_fields);
-      goto cleanup;
-    }
-  system_event_record_data->offset_from_event_reading_type_code = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record_event_fields,
-                    "event_data2_flag",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record_event_fields);
-      goto cleanup;
-    }
-  system_event_record_data->event_data2_flag = val;
-
-  if (FIID_OBJ_GET (obj_sel_system_event_record_event_fields,
-                    "event_data3_flag",
-                    &val) < 0)
-    {
-      SEL_FIID_OBJECT_ERROR_TO_SEL_ERRNUM (ctx, obj_sel_system_event_record_event_fields);
-      goto cleanup;
-    }
-  system_event_record_data->event_data3_flag = val;
-
-  rv = 0;
- cleanup:
-  fiid_obj_destroy (obj_sel_system_event_record);
-  fiid_obj_destroy (obj_sel_system_event_record_event_fields);
-  return (rv);
+  return (0);
 }
@@ -29,26 +29,6 @@
 
 #include "ipmi-sel-defs.h"
 
-/* convenience struct */
-struct ipmi_sel_system_event_record_data
-{
-  uint32_t timestamp;
-  uint8_t generator_id;
-  uint8_t ipmb_device_lun;
-  uint8_t channel_number;
-  uint8_t event_message_format_version;
-  uint8_t sensor_type;
-  uint8_t sensor_number;
-  uint8_t event_type_code;
-  uint8_t event_direction;
-  uint8_t offset_from_event_reading_type_code;
-  uint8_t event_data2_flag;
-  uint8_t event_data3_flag;
-  uint8_t event_data1;
-  uint8_t event_data2;
-  uint8_t event_data3;
-};
-
 int sel_get_reservation_id (ipmi_sel_ctx_t ctx,
                             uint16_t *reservation_id,
                             unsigned int *is_insufficient_privilege_level);
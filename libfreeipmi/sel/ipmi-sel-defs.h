@@ -29,6 +29,7 @@
 #include "freeipmi/interpret/ipmi-interpret.h"
 #include "freeipmi/sdr/ipmi-sdr.h"
 #include "freeipmi/sel/ipmi-sel.h"
+#include "freeipmi/util/ipmi-timestamp-util.h"
 
 #include "list.h"
 
@@ -42,6 +43,9 @@
 #define IPMI_SEL_RECORD_LENGTH               16
 #define IPMI_SEL_RECORD_HEADER_LENGTH         3
 
+/* Table 32-2, after the timestamp and manufacturer id */
+#define IPMI_SEL_TIMESTAMPED_OEM_RECORD_OEM_OFFSET 10
+
 #define IPMI_SEL_RESERVATION_ID_RETRY         4
 
 #define IPMI_SEL_FLAGS_MASK                     \
@@ -63,9 +67,38 @@
    | IPMI_SEL_STRING_FLAGS_LOCALTIME_TO_UTC             \
    | IPMI_SEL_STRING_FLAGS_LEGACY)
 
+/* convenience struct */
+struct ipmi_sel_system_event_record_data
+{
+  uint32_t timestamp;
+  uint8_t generator_id;
+  uint8_t ipmb_device_lun;
+  uint8_t channel_number;
+  uint8_t event_message_format_version;
+  uint8_t sensor_type;
+  uint8_t sensor_number;
+  uint8_t event_type_code;
+  uint8_t event_direction;
+  uint8_t offset_from_event_reading_type_code;
+  uint8_t event_data2_flag;
+  uint8_t event_data3_flag;
+  uint8_t event_data1;
+  uint8_t event_data2;
+  uint8_t event_data3;
+};
+
+/* The record is decoded once into the fields following it, on
+ * first use by any of the sel_get_*() functions.  Whoever fills in
+ * sel_event_record must clear decoded.
+ */
 struct ipmi_sel_entry {
   uint8_t sel_event_record[IPMI_SEL_RECORD_LENGTH];
   unsigned int sel_event_record_len; /* should always be 16, but just in case */
+  int decoded;
+  uint16_t record_id;
+  uint8_t record_type;          /* as in the record, before any flags */
+  uint32_t manufacturer_id;     /* timestamped OEM records */
+  struct ipmi_sel_system_event_record_data system_event_record_data;
 };
 
 struct ipmi_sel_oem_intel_node_manager {
@@ -95,6 +128,7 @@ struct ipmi_sel_ctx {
   ipmi_sdr_ctx_t sdr_ctx;
   ipmi_interpret_ctx_t interpret_ctx;
   int utc_offset;
+  ipmi_timestamp_ctx_t timestamp_ctx;
 
   int sel_entries_loaded;
   List sel_entries;
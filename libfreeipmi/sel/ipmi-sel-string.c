@@ -807,12 +807,13 @@ _output_time (ipmi_sel_ctx_t ctx,
   if (flags & IPMI_SEL_STRING_FLAGS_LOCALTIME_TO_UTC)
     timestamp_flags |= IPMI_TIMESTAMP_FLAG_LOCALTIME_TO_UTC;
 
-  if (ipmi_timestamp_string (timestamp,
-                             ctx->utc_offset,
-                             timestamp_flags,
-                             "%H:%M:%S",
-                             tmpbuf,
-                             SEL_BUFFER_LENGTH) < 0)
+  if (ipmi_timestamp_ctx_string (ctx->timestamp_ctx,
+                                 timestamp,
+                                 ctx->utc_offset,
+                                 timestamp_flags,
+                                 "%H:%M:%S",
+                                 tmpbuf,
+                                 SEL_BUFFER_LENGTH) < 0)
     {
       SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INTERNAL_ERROR);
       return (-1);
@@ -885,12 +886,13 @@ _output_date (ipmi_sel_ctx_t ctx,
   if (flags & IPMI_SEL_STRING_FLAGS_LOCALTIME_TO_UTC)
     timestamp_flags |= IPMI_TIMESTAMP_FLAG_LOCALTIME_TO_UTC;
 
-  if (ipmi_timestamp_string (timestamp,
-                             ctx->utc_offset,
-                             timestamp_flags,
-                             date_format,
-                             tmpbuf,
-                             SEL_BUFFER_LENGTH) < 0)
+  if (ipmi_timestamp_ctx_string (ctx->timestamp_ctx,
+                                 timestamp,
+                                 ctx->utc_offset,
+                                 timestamp_flags,
+                                 date_format,
+                                 tmpbuf,
+                                 SEL_BUFFER_LENGTH) < 0)
     {
       SEL_SET_ERRNUM (ctx, IPMI_SEL_ERR_INTERNAL_ERROR);
       return (-1);
@@ -2750,6 +2752,7 @@ sel_format_record_string (ipmi_sel_ctx_t ctx,
 
   memcpy (sel_entry.sel_event_record, sel_record, IPMI_SEL_RECORD_LENGTH);
   sel_entry.sel_event_record_len = IPMI_SEL_RECORD_LENGTH;
+  sel_entry.decoded = 0;
 
   if (sel_get_record_header_info (ctx,
                                   &sel_entry,
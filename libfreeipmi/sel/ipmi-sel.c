@@ -132,6 +132,12 @@ ipmi_sel_ctx_create (ipmi_ctx_t ipmi_ctx, ipmi_sdr_ctx_t sdr_ctx)
 
   ctx->sel_entries_loaded = 0;
 
+  if (!(ctx->timestamp_ctx = ipmi_timestamp_ctx_create ()))
+    {
+      ERRNO_TRACE (errno);
+      goto cleanup;
+    }
+
   if (!(ctx->sel_entries = list_create ((ListDelF)free)))
     {
       ERRNO_TRACE (errno);
@@ -145,6 +151,7 @@ ipmi_sel_ctx_create (ipmi_ctx_t ipmi_ctx, ipmi_sdr_ctx_t sdr_ctx)
     {
       if (ctx->sel_entries)
         list_destroy (ctx->sel_entries);
+      ipmi_timestamp_ctx_destroy (ctx->timestamp_ctx);
       free (ctx);
     }
   return (NULL);
@@ -188,6 +195,7 @@ ipmi_sel_ctx_destroy (ipmi_sel_ctx_t ctx)
   free (ctx->separator);
   _sel_entries_clear (ctx);
   list_destroy (ctx->sel_entries);
+  ipmi_timestamp_ctx_destroy (ctx->timestamp_ctx);
   ctx->magic = ~IPMI_SEL_CTX_MAGIC;
   free (ctx);
 }
@@ -979,6 +987,7 @@ ipmi_sel_parse (ipmi_sel_ctx_t ctx,
         }
       
       tmp_sel_entry.sel_event_record_len = len;
+      tmp_sel_entry.decoded = 0;
 
       if (sel_get_record_header_info (ctx,
                                       &tmp_sel_entry,
@@ -1025,6 +1034,7 @@ ipmi_sel_parse (ipmi_sel_ctx_t ctx,
         }
       
       sel_entry->sel_event_record_len = len;
+      sel_entry->decoded = 0;
      
       _sel_entry_dump (ctx, sel_entry);
       
@@ -1107,6 +1117,7 @@ ipmi_sel_parse (ipmi_sel_ctx_t ctx,
         }
       
       sel_entry->sel_event_record_len = len;
+      sel_entry->decoded = 0;
       
       _sel_entry_dump (ctx, sel_entry);
       
@@ -1226,6 +1237,7 @@ ipmi_sel_parse_record_ids (ipmi_sel_ctx_t ctx,
         }
       
       sel_entry->sel_event_record_len = len;
+      sel_entry->decoded = 0;
       
       _sel_entry_dump (ctx, sel_entry);
       
@@ -1522,6 +1534,7 @@ _sel_parse_read_common (ipmi_sel_ctx_t ctx,
         }
 
       sel_entry_buf->sel_event_record_len = sel_record_len > IPMI_SEL_RECORD_LENGTH ? IPMI_SEL_RECORD_LENGTH : sel_record_len;
+      sel_entry_buf->decoded = 0;
       memcpy (sel_entry_buf->sel_event_record,
               sel_record,
               sel_entry_buf->sel_event_record_len);
@@ -1640,6 +1653,7 @@ _sel_parse_system_event_common (ipmi_sel_ctx_t ctx,
         }
 
       sel_entry_buf.sel_event_record_len = sel_record_len > IPMI_SEL_RECORD_LENGTH ? IPMI_SEL_RECORD_LENGTH : sel_record_len;
+      sel_entry_buf.decoded = 0;
       memcpy (sel_entry_buf.sel_event_record,
               sel_record,
               sel_entry_buf.sel_event_record_len);
@@ -36,6 +36,7 @@
 #endif /* !HAVE_SYS_TIME_H */
 #endif /* !TIME_WITH_SYS_TIME */
 #include <errno.h>
+#include <assert.h>
 
 #include "freeipmi/util/ipmi-timestamp-util.h"
 #include "freeipmi/spec/ipmi-timestamp-spec.h"
@@ -49,24 +50,37 @@
    | IPMI_TIMESTAMP_FLAG_UTC_TO_LOCALTIME \
    | IPMI_TIMESTAMP_FLAG_LOCALTIME_TO_UTC)
 
-int
-ipmi_timestamp_string (uint32_t timestamp,
-                       int utc_offset,
-                       unsigned int flags,
-                       const char *format,
-                       char *buf,
-                       unsigned int buflen)
+#define IPMI_TIMESTAMP_SECONDS_PER_DAY 86400
+
+/* Assume the UTC offset of the local timezone changes at most once in
+ * this many seconds.  Daylight savings periods are far longer.
+ */
+#define IPMI_TIMESTAMP_OFFSET_PERIOD_MIN (7 * IPMI_TIMESTAMP_SECONDS_PER_DAY)
+
+/* Range of times [start, end] known to have the same offset */
+struct ipmi_timestamp_offset_cache
 {
-  struct tm tm;
-  time_t t;
+  int valid;
+  time_t start;
+  time_t end;
+  time_t offset;
+};
 
-  if ((flags & ~IPMI_TIMESTAMP_FLAG_MASK) || !buf || !buflen)
-    {
-      SET_ERRNO (EINVAL);
-      return (-1);
-    }
+struct ipmi_timestamp_ctx
+{
+  struct ipmi_timestamp_offset_cache utc_to_localtime;
+  struct ipmi_timestamp_offset_cache localtime_to_utc;
+};
 
-  /* Timestamp Special Cases */
+/* returns 1 if special case string written, 0 if not */
+static int
+_timestamp_special_case (uint32_t timestamp,
+                         unsigned int flags,
+                         char *buf,
+                         unsigned int buflen)
+{
+  assert (buf);
+  assert (buflen);
 
   if (timestamp == IPMI_TIMESTAMP_UNSPECIFIED)
     {
@@ -74,7 +88,7 @@ ipmi_timestamp_string (uint32_t timestamp,
         snprintf (buf, buflen, "Unspec.");
       else
         snprintf (buf, buflen, "Unspecified");
-      return (0);
+      return (1);
     }
 
   if (IPMI_TIMESTAMP_POST_INIT (timestamp))
@@ -83,9 +97,34 @@ ipmi_timestamp_string (uint32_t timestamp,
         snprintf (buf, buflen, "PostInit");
       else
         snprintf (buf, buflen, "Post-Init %u s", timestamp);
-      return (0);
+      return (1);
     }
 
+  return (0);
+}
+
+int
+ipmi_timestamp_string (uint32_t timestamp,
+                       int utc_offset,
+                       unsigned int flags,
+                       const char *format,
+                       char *buf,
+                       unsigned int buflen)
+{
+  struct tm tm;
+  time_t t;
+
+  if ((flags & ~IPMI_TIMESTAMP_FLAG_MASK) || !buf || !buflen)
+    {
+      SET_ERRNO (EINVAL);
+      return (-1);
+    }
+
+  /* Timestamp Special Cases */
+
+  if (_timestamp_special_case (timestamp, flags, buf, buflen))
+    return (0);
+
   /* Posix says individual calls need not clear/set all portions of
    * 'struct tm', thus passing 'struct tm' between functions could
    * have issues.  So we need to memset.
@@ -104,9 +143,7 @@ ipmi_timestamp_string (uint32_t timestamp,
       /* In order for this to be threadsafe, we won't modify the TZ
        * environment variable.  We'll calculate the offset manually.
        *
-       * XXX: This may be called alot via tools like ipmi-sel, should
-       * find some way to cache this or something if we care about
-       * performance later on.
+       * See ipmi_timestamp_ctx_string() for a cached version.
        */
       struct tm gmtm;
       struct tm localtm;
@@ -141,3 +178,386 @@ ipmi_timestamp_string (uint32_t timestamp,
 
   return (0);
 }
+
+ipmi_timestamp_ctx_t
+ipmi_timestamp_ctx_create (void)
+{
+  struct ipmi_timestamp_ctx *ctx = NULL;
+
+  if (!(ctx = (ipmi_timestamp_ctx_t)malloc (sizeof (struct ipmi_timestamp_ctx))))
+    {
+      ERRNO_TRACE (errno);
+      return (NULL);
+    }
+  memset (ctx, '\0', sizeof (struct ipmi_timestamp_ctx));
+  ctx->utc_to_localtime.valid = 0;
+  ctx->localtime_to_utc.valid = 0;
+
+  return (ctx);
+}
+
+void
+ipmi_timestamp_ctx_destroy (ipmi_timestamp_ctx_t ctx)
+{
+  free (ctx);
+}
+
+/* days since the epoch of a proleptic gregorian date, month 1-12 */
+static int64_t
+_days_from_civil (int64_t year, unsigned int month, unsigned int day)
+{
+  int64_t era;
+  unsigned int yoe, doy, doe;
+
+  if (month <= 2)
+    year--;
+  era = (year >= 0 ? year : year - 399) / 400;
+  yoe = (unsigned int)(year - era * 400);
+  doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return (era * 146097 + (int64_t)doe - 719468);
+}
+
+/* gmtime_r() without the tz lock, fills in everything strftime()
+ * may look at except the timezone fields.
+ */
+static void
+_seconds_to_tm (int64_t seconds, struct tm *tm)
+{
+  int64_t days, secs, era, year;
+  unsigned int doe, yoe, doy, mp, month, day;
+
+  assert (tm);
+
+  days = seconds / IPMI_TIMESTAMP_SECONDS_PER_DAY;
+  secs = seconds % IPMI_TIMESTAMP_SECONDS_PER_DAY;
+  if (secs < 0)
+    {
+      secs += IPMI_TIMESTAMP_SECONDS_PER_DAY;
+      days--;
+    }
+
+  tm->tm_hour = secs / 3600;
+  tm->tm_min = (secs % 3600) / 60;
+  tm->tm_sec = secs % 60;
+
+  /* 1970-01-01 was a Thursday */
+  tm->tm_wday = (int)((days % 7 + 11) % 7);
+
+  days += 719468;
+  era = (days >= 0 ? days : days - 146096) / 146097;
+  doe = (unsigned int)(days - era * 146097);
+  yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  year = (int64_t)yoe + era * 400;
+  doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  mp = (5 * doy + 2) / 153;
+  day = doy - (153 * mp + 2) / 5 + 1;
+  month = mp < 10 ? mp + 3 : mp - 9;
+  if (month <= 2)
+    year++;
+
+  tm->tm_year = year - 1900;
+  tm->tm_mon = month - 1;
+  tm->tm_mday = day;
+  tm->tm_yday = (int)(_days_from_civil (year, month, day)
+                      - _days_from_civil (year, 1, 1));
+  tm->tm_isdst = 0;
+}
+
+/* offset to add to t, as calculated by ipmi_timestamp_string() */
+static time_t
+_timestamp_offset (time_t t, unsigned int flags)
+{
+  struct tm localtm;
+
+  memset (&localtm, '\0', sizeof (struct tm));
+
+  localtime_r (&t, &localtm);
+
+  if (flags & IPMI_TIMESTAMP_FLAG_UTC_TO_LOCALTIME)
+    return ((time_t)(_days_from_civil (localtm.tm_year + 1900,
+                                       localtm.tm_mon + 1,
+                                       localtm.tm_mday) * IPMI_TIMESTAMP_SECONDS_PER_DAY
+                     + localtm.tm_hour * 3600
+                     + localtm.tm_min * 60
+                     + localtm.tm_sec
+                     - t));
+  else
+    {
+      struct tm gmtm;
+      time_t gmt, localt;
+
+      memset (&gmtm, '\0', sizeof (struct tm));
+
+      gmtime_r (&t, &gmtm);
+
+      gmt = mktime (&gmtm);
+      localt = mktime (&localtm);
+
+      return (-(localt - gmt));
+    }
+}
+
+/* Find the offset for t, with as few calls into the tz code as
+ * possible.  On a cache miss the offset is also checked a period
+ * before and after t.  The offset can change at most once within a
+ * period, so if it's the same at both ends it's the same throughout.
+ * If it differs the change is found by bisection.  Timestamps from
+ * a SEL are usually close together, so nearly all lookups hit.
+ */
+static time_t
+_timestamp_offset_cached (struct ipmi_timestamp_offset_cache *cache,
+                          time_t t,
+                          unsigned int flags)
+{
+  time_t offset;
+  time_t same, diff, mid;
+
+  assert (cache);
+
+  if (cache->valid
+      && t >= cache->start
+      && t <= cache->end)
+    return (cache->offset);
+
+  offset = _timestamp_offset (t, flags);
+
+  cache->valid = 1;
+  cache->start = t;
+  cache->end = t;
+  cache->offset = offset;
+
+  diff = t + IPMI_TIMESTAMP_OFFSET_PERIOD_MIN;
+  if (diff > t)
+    {
+      if (_timestamp_offset (diff, flags) == offset)
+        cache->end = diff;
+      else
+        {
+          same = t;
+          while (diff - same > 1)
+            {
+              mid = same + (diff - same) / 2;
+              if (_timestamp_offset (mid, flags) == offset)
+                same = mid;
+              else
+                diff = mid;
+            }
+          cache->end = same;
+        }
+    }
+
+  diff = t - IPMI_TIMESTAMP_OFFSET_PERIOD_MIN;
+  if (diff < t)
+    {
+      if (_timestamp_offset (diff, flags) == offset)
+        cache->start = diff;
+      else
+        {
+          same = t;
+          while (same - diff > 1)
+            {
+              mid = diff + (same - diff) / 2;
+              if (_timestamp_offset (mid, flags) == offset)
+                same = mid;
+              else
+                diff = mid;
+            }
+          cache->start = same;
+        }
+    }
+
+  return (offset);
+}
+
+static int
+_format_number (char *buf,
+                unsigned int buflen,
+                unsigned int *len,
+                unsigned int val,
+                unsigned int digits)
+{
+  char tmp[16];
+  unsigned int n = 0;
+
+  assert (buf);
+  assert (len);
+
+  do
+    {
+      tmp[n++] = '0' + (val % 10);
+      val /= 10;
+    } while (val && n < sizeof (tmp));
+
+  while (n < digits)
+    tmp[n++] = '0';
+
+  if ((*len + n) >= buflen)
+    return (-1);
+
+  while (n)
+    buf[(*len)++] = tmp[--n];
+
+  return (0);
+}
+
+/* returns 1 if formatted, 0 if the format needs strftime(), -1 if buf
+ * is too small.  Only the numeric conversions SEL output uses.
+ */
+static int
+_format_tm (const char *format,
+            const struct tm *tm,
+            char *buf,
+            unsigned int buflen)
+{
+  unsigned int len = 0;
+  const char *p;
+  int ret;
+
+  assert (format);
+  assert (tm);
+  assert (buf);
+  assert (buflen);
+
+  for (p = format; *p; p++)
+    {
+      if (*p != '%')
+        {
+          if ((len + 1) >= buflen)
+            return (-1);
+          buf[len++] = *p;
+          continue;
+        }
+
+      p++;
+      switch (*p)
+        {
+        case 'Y':
+          if (tm->tm_year + 1900 < 0)
+            return (0);
+          ret = _format_number (buf, buflen, &len, tm->tm_year + 1900, 1);
+          break;
+        case 'm':
+          ret = _format_number (buf, buflen, &len, tm->tm_mon + 1, 2);
+          break;
+        case 'd':
+          ret = _format_number (buf, buflen, &len, tm->tm_mday, 2);
+          break;
+        case 'H':
+          ret = _format_number (buf, buflen, &len, tm->tm_hour, 2);
+          break;
+        case 'M':
+          ret = _format_number (buf, buflen, &len, tm->tm_min, 2);
+          break;
+        case 'S':
+          ret = _format_number (buf, buflen, &len, tm->tm_sec, 2);
+          break;
+        case '%':
+          if ((len + 1) >= buflen)
+            return (-1);
+          buf[len++] = '%';
+          ret = 0;
+          break;
+        default:
+          return (0);
+        }
+
+      if (ret < 0)
+        return (-1);
+    }
+
+  buf[len] = '\0';
+  return (1);
+}
+
+/* conversions that need the timezone fields of struct tm */
+static int
+_format_needs_timezone (const char *format)
+{
+  const char *p;
+
+  assert (format);
+
+  for (p = format; *p; p++)
+    {
+      if (*p != '%')
+        continue;
+
+      p++;
+      while (*p == 'E' || *p == 'O')
+        p++;
+
+      if (*p == 'Z' || *p == 'z' || *p == 's' || *p == '+')
+        return (1);
+
+      if (!*p)
+        break;
+    }
+
+  return (0);
+}
+
+int
+ipmi_timestamp_ctx_string (ipmi_timestamp_ctx_t ctx,
+                           uint32_t timestamp,
+                           int utc_offset,
+                           unsigned int flags,
+                           const char *format,
+                           char *buf,
+                           unsigned int buflen)
+{
+  struct tm tm;
+  time_t t;
+  int ret;
+
+  if (!ctx
+      || (flags & ~IPMI_TIMESTAMP_FLAG_MASK)
+      || !buf
+      || !buflen)
+    {
+      SET_ERRNO (EINVAL);
+      return (-1);
+    }
+
+  if (_timestamp_special_case (timestamp, flags, buf, buflen))
+    return (0);
+
+  if (!format)
+    format = "%m/%d/%Y - %H:%M:%S";
+
+  /* rarely used, not worth special casing */
+  if (_format_needs_timezone (format))
+    return (ipmi_timestamp_string (timestamp,
+                                   utc_offset,
+                                   flags,
+                                   format,
+                                   buf,
+                                   buflen));
+
+  memset (&tm, '\0', sizeof (struct tm));
+
+  t = timestamp;
+
+  if (utc_offset)
+    t += utc_offset;
+
+  if (flags & IPMI_TIMESTAMP_FLAG_UTC_TO_LOCALTIME)
+    t += _timestamp_offset_cached (&ctx->utc_to_localtime, t, flags);
+  else if (flags & IPMI_TIMESTAMP_FLAG_LOCALTIME_TO_UTC)
+    t += _timestamp_offset_cached (&ctx->localtime_to_utc, t, flags);
+
+  _seconds_to_tm (t, &tm);
+
+  if ((ret = _format_tm (format, &tm, buf, buflen)) > 0)
+    return (0);
+
+  /* like strftime(), contents are undefined if it doesn't fit */
+  if (ret < 0)
+    {
+      buf[0] = '\0';
+      return (0);
+    }
+
+  strftime (buf, buflen, format, &tm);
+  return (0);
+}
@@ -66,6 +66,7 @@
 #include "ipmiconsole_debug.h"
 #include "ipmiconsole_engine.h"
 #include "ipmiconsole_util.h"
+#include "scbuf.h"
 
 #include "freeipmi-portability.h"
 #include "conffile.h"
@@ -120,6 +121,8 @@ static char *ipmiconsole_errmsgs[] =
 #define IPMICONSOLE_ENGINE_LOCK_MEMORY_STR                "lockmemory"
 #define IPMICONSOLE_ENGINE_SERIAL_KEEPALIVE_STR           "serialkeepalive"
 #define IPMICONSOLE_ENGINE_SERIAL_KEEPALIVE_EMPTY_STR     "serialkeepaliveempty"
+#define IPMICONSOLE_ENGINE_SHARED_SOCKET_STR              "sharedsocket"
+#define IPMICONSOLE_ENGINE_LOG_ONLY_STR                   "logonly"
 
 #define IPMICONSOLE_BEHAVIOR_ERROR_ON_SOL_INUSE_STR       "erroronsolinuse"
 #define IPMICONSOLE_BEHAVIOR_DEACTIVATE_ONLY_STR          "deactivateonly"
@@ -133,6 +136,8 @@ static char *ipmiconsole_errmsgs[] =
 
 struct ipmiconsole_ctx_config default_config;
 
+static unsigned int default_engine_stats_interval;
+
 static int
 _config_file_unsigned_int_positive (conffile_t cf,
                                     struct conffile_data *data,
@@ -382,6 +387,10 @@ _config_file_engine_flags (conffile_t cf,
         engine_flags |= IPMICONSOLE_ENGINE_SERIAL_KEEPALIVE;
       else if (!strcasecmp (data->stringlist[i], IPMICONSOLE_ENGINE_SERIAL_KEEPALIVE_EMPTY_STR))
         engine_flags |= IPMICONSOLE_ENGINE_SERIAL_KEEPALIVE_EMPTY;
+      else if (!strcasecmp (data->stringlist[i], IPMICONSOLE_ENGINE_SHARED_SOCKET_STR))
+        engine_flags |= IPMICONSOLE_ENGINE_SHARED_SOCKET;
+      else if (!strcasecmp (data->stringlist[i], IPMICONSOLE_ENGINE_LOG_ONLY_STR))
+        engine_flags |= IPMICONSOLE_ENGINE_LOG_ONLY;
       else
         IPMICONSOLE_DEBUG (("libipmiconsole config file engine flag invalid"));
     }
@@ -507,7 +516,8 @@ _ipmiconsole_defaults_setup (void)
     libipmiconsole_context_engine_flags_count = 0,
     libipmiconsole_context_behavior_flags_count = 0,
     libipmiconsole_context_debug_flags_count = 0,
-    libipmiconsole_context_sol_payload_instance_count = 0;
+    libipmiconsole_context_sol_payload_instance_count = 0,
+    libipmiconsole_engine_stats_interval_count = 0;
 
   struct conffile_option libipmiconsole_options[] =
     {
@@ -698,6 +708,17 @@ _ipmiconsole_defaults_setup (void)
         &(default_config.sol_payload_instance),
         0
       },
+      {
+        "libipmiconsole-engine-stats-interval",
+        CONFFILE_OPTION_INT,
+        -1,
+        _config_file_unsigned_int_positive,
+        1,
+        0,
+        &libipmiconsole_engine_stats_interval_count,
+        &default_engine_stats_interval,
+        0
+      },
     };
 
   conffile_t cf = NULL;
@@ -718,6 +739,7 @@ _ipmiconsole_defaults_setup (void)
   default_config.acceptable_packet_errors_count = IPMICONSOLE_ACCEPTABLE_PACKET_ERRORS_COUNT_DEFAULT;
   default_config.maximum_retransmission_count = IPMICONSOLE_MAXIMUM_RETRANSMISSION_COUNT_DEFAULT;
   default_config.sol_payload_instance = IPMI_PAYLOAD_INSTANCE_DEFAULT;
+  default_engine_stats_interval = 0;
 
   if (!(cf = conffile_handle_create ()))
     {
@@ -748,6 +770,9 @@ _ipmiconsole_defaults_setup (void)
     }
   
  out:
+  if (default_engine_stats_interval > IPMICONSOLE_ENGINE_STATS_INTERVAL_MAX)
+    default_engine_stats_interval = IPMICONSOLE_ENGINE_STATS_INTERVAL_MAX;
+  ipmiconsole_engine_stats_interval_set (default_engine_stats_interval);
   rv = 0;
  cleanup:
   conffile_handle_destroy (cf);
@@ -1147,6 +1172,20 @@ ipmiconsole_engine_submit_block (ipmiconsole_ctx_t c)
   return (-1);
 }
 
+int
+ipmiconsole_engine_stats (struct ipmiconsole_engine_stats *stats,
+                          unsigned int stats_len)
+{
+  if (!ipmiconsole_engine_is_setup ()
+      || !stats)
+    {
+      errno = EINVAL;
+      return (-1);
+    }
+
+  return (ipmiconsole_engine_stats_get (stats, stats_len));
+}
+
 void
 ipmiconsole_engine_teardown (int cleanup_sol_sessions)
 {
@@ -1281,6 +1320,12 @@ ipmiconsole_ctx_create (const char *hostname,
   if (ipmiconsole_ctx_blocking_setup (c) < 0)
     goto cleanup;
 
+  if (ipmiconsole_ctx_log_setup (c) < 0)
+    goto cleanup;
+
+  if (ipmiconsole_ctx_stats_setup (c) < 0)
+    goto cleanup;
+
   /* only initializes value, no need to destroy/cleanup anything in here */
   ipmiconsole_ctx_fds_setup (c);
 
@@ -1302,6 +1347,10 @@ ipmiconsole_ctx_create (const char *hostname,
 
   ipmiconsole_ctx_blocking_cleanup (c);
 
+  ipmiconsole_ctx_log_cleanup (c);
+
+  ipmiconsole_ctx_stats_cleanup (c);
+
   /* Note: use engine_config->engine_flags not c->config.engine_flags,
    * b/c we don't know where we failed earlier.
    */
@@ -1326,13 +1375,19 @@ ipmiconsole_ctx_set_config (ipmiconsole_ctx_t c,
                             void *config_option_value)
 {
   unsigned int *tmpptr;
+  char *strptr;
 
   if (!c
       || c->magic != IPMICONSOLE_CTX_MAGIC
       || c->api_magic != IPMICONSOLE_CTX_API_MAGIC)
     return (-1);
 
-  if ((config_option != IPMICONSOLE_CTX_CONFIG_OPTION_SOL_PAYLOAD_INSTANCE)
+  if ((config_option != IPMICONSOLE_CTX_CONFIG_OPTION_SOL_PAYLOAD_INSTANCE
+       && config_option != IPMICONSOLE_CTX_CONFIG_OPTION_LOG_FILE
+       && config_option != IPMICONSOLE_CTX_CONFIG_OPTION_LOG_FILE_MAX_SIZE
+       && config_option != IPMICONSOLE_CTX_CONFIG_OPTION_LOG_TAIL_SIZE
+       && config_option != IPMICONSOLE_CTX_CONFIG_OPTION_SOL_INPUT_COALESCE_INTERVAL
+       && config_option != IPMICONSOLE_CTX_CONFIG_OPTION_SOL_OUTPUT_FLUSH_INTERVAL)
       || !config_option_value)
     {
       ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_PARAMETERS);
@@ -1356,6 +1411,52 @@ ipmiconsole_ctx_set_config (ipmiconsole_ctx_t c,
         }
       c->config.sol_payload_instance = *(tmpptr);
       break;
+    case IPMICONSOLE_CTX_CONFIG_OPTION_LOG_FILE:
+      strptr = (char *)config_option_value;
+      if (!strlen (strptr)
+          || strlen (strptr) + 2 >= MAXPATHLEN)
+        {
+          ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_PARAMETERS);
+          return (-1);
+        }
+      free (c->config.log_file);
+      if (!(c->config.log_file = strdup (strptr)))
+        {
+          ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_OUT_OF_MEMORY);
+          return (-1);
+        }
+      break;
+    case IPMICONSOLE_CTX_CONFIG_OPTION_LOG_FILE_MAX_SIZE:
+      tmpptr = (unsigned int *)config_option_value;
+      c->config.log_file_max_size = *(tmpptr);
+      break;
+    case IPMICONSOLE_CTX_CONFIG_OPTION_LOG_TAIL_SIZE:
+      tmpptr = (unsigned int *)config_option_value;
+      if ((*tmpptr) > IPMICONSOLE_LOG_TAIL_SIZE_MAX)
+        {
+          ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_PARAMETERS);
+          return (-1);
+        }
+      c->config.log_tail_size = *(tmpptr);
+      break;
+    case IPMICONSOLE_CTX_CONFIG_OPTION_SOL_INPUT_COALESCE_INTERVAL:
+      tmpptr = (unsigned int *)config_option_value;
+      if ((*tmpptr) > IPMICONSOLE_SOL_COALESCE_INTERVAL_MAX)
+        {
+          ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_PARAMETERS);
+          return (-1);
+        }
+      c->config.sol_input_coalesce_interval = *(tmpptr);
+      break;
+    case IPMICONSOLE_CTX_CONFIG_OPTION_SOL_OUTPUT_FLUSH_INTERVAL:
+      tmpptr = (unsigned int *)config_option_value;
+      if ((*tmpptr) > IPMICONSOLE_SOL_COALESCE_INTERVAL_MAX)
+        {
+          ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_PARAMETERS);
+          return (-1);
+        }
+      c->config.sol_output_flush_interval = *(tmpptr);
+      break;
     default:
       ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_INTERNAL_ERROR);
       return (-1);
@@ -1371,13 +1472,19 @@ ipmiconsole_ctx_get_config (ipmiconsole_ctx_t c,
                             void *config_option_value)
 {
   unsigned int *tmpptr;
+  char **strptrptr;
 
   if (!c
       || c->magic != IPMICONSOLE_CTX_MAGIC
       || c->api_magic != IPMICONSOLE_CTX_API_MAGIC)
     return (-1);
 
-  if ((config_option != IPMICONSOLE_CTX_CONFIG_OPTION_SOL_PAYLOAD_INSTANCE)
+  if ((config_option != IPMICONSOLE_CTX_CONFIG_OPTION_SOL_PAYLOAD_INSTANCE
+       && config_option != IPMICONSOLE_CTX_CONFIG_OPTION_LOG_FILE
+       && config_option != IPMICONSOLE_CTX_CONFIG_OPTION_LOG_FILE_MAX_SIZE
+       && config_option != IPMICONSOLE_CTX_CONFIG_OPTION_LOG_TAIL_SIZE
+       && config_option != IPMICONSOLE_CTX_CONFIG_OPTION_SOL_INPUT_COALESCE_INTERVAL
+       && config_option != IPMICONSOLE_CTX_CONFIG_OPTION_SOL_OUTPUT_FLUSH_INTERVAL)
       || !config_option_value)
     {
       ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_PARAMETERS);
@@ -1390,6 +1497,26 @@ ipmiconsole_ctx_get_config (ipmiconsole_ctx_t c,
       tmpptr = (unsigned int *)config_option_value;
       (*tmpptr) = c->config.sol_payload_instance;
       break;
+    case IPMICONSOLE_CTX_CONFIG_OPTION_LOG_FILE:
+      strptrptr = (char **)config_option_value;
+      (*strptrptr) = c->config.log_file;
+      break;
+    case IPMICONSOLE_CTX_CONFIG_OPTION_LOG_FILE_MAX_SIZE:
+      tmpptr = (unsigned int *)config_option_value;
+      (*tmpptr) = c->config.log_file_max_size;
+      break;
+    case IPMICONSOLE_CTX_CONFIG_OPTION_LOG_TAIL_SIZE:
+      tmpptr = (unsigned int *)config_option_value;
+      (*tmpptr) = c->config.log_tail_size;
+      break;
+    case IPMICONSOLE_CTX_CONFIG_OPTION_SOL_INPUT_COALESCE_INTERVAL:
+      tmpptr = (unsigned int *)config_option_value;
+      (*tmpptr) = c->config.sol_input_coalesce_interval;
+      break;
+    case IPMICONSOLE_CTX_CONFIG_OPTION_SOL_OUTPUT_FLUSH_INTERVAL:
+      tmpptr = (unsigned int *)config_option_value;
+      (*tmpptr) = c->config.sol_output_flush_interval;
+      break;
     default:
       ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_INTERNAL_ERROR);
       return (-1);
@@ -1508,6 +1635,103 @@ ipmiconsole_ctx_generate_break (ipmiconsole_ctx_t c)
   return (0);
 }
 
+int
+ipmiconsole_ctx_log_tail (ipmiconsole_ctx_t c,
+                          char *buf,
+                          unsigned int buflen)
+{
+  char *tmpbuf = NULL;
+  int used, len;
+  int perr;
+  int rv = -1;
+
+  if (!c
+      || c->magic != IPMICONSOLE_CTX_MAGIC
+      || c->api_magic != IPMICONSOLE_CTX_API_MAGIC)
+    return (-1);
+
+  if (!buf)
+    {
+      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  if ((perr = pthread_mutex_lock (&(c->log.tail_mutex))) != 0)
+    {
+      IPMICONSOLE_DEBUG (("pthread_mutex_lock: %s", strerror (perr)));
+      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_INTERNAL_ERROR);
+      return (-1);
+    }
+
+  if (!c->log.tail
+      || !buflen
+      || !(used = scbuf_used (c->log.tail)))
+    {
+      rv = 0;
+      goto out;
+    }
+
+  /* scbuf peeks from the oldest data, grab everything and copy
+   * out the most recent
+   */
+  if (!(tmpbuf = malloc (used)))
+    {
+      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_OUT_OF_MEMORY);
+      goto out;
+    }
+
+  if ((len = scbuf_peek (c->log.tail, tmpbuf, used)) < 0)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("scbuf_peek: %s", strerror (errno)));
+      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_INTERNAL_ERROR);
+      goto out;
+    }
+
+  if (len > buflen)
+    {
+      memcpy (buf, tmpbuf + (len - buflen), buflen);
+      rv = buflen;
+    }
+  else
+    {
+      memcpy (buf, tmpbuf, len);
+      rv = len;
+    }
+
+ out:
+  if ((perr = pthread_mutex_unlock (&(c->log.tail_mutex))) != 0)
+    IPMICONSOLE_DEBUG (("pthread_mutex_unlock: %s", strerror (perr)));
+  free (tmpbuf);
+  if (rv >= 0)
+    ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SUCCESS);
+  return (rv);
+}
+
+int
+ipmiconsole_ctx_stats (ipmiconsole_ctx_t c,
+                       struct ipmiconsole_ctx_stats *stats)
+{
+  if (!c
+      || c->magic != IPMICONSOLE_CTX_MAGIC
+      || c->api_magic != IPMICONSOLE_CTX_API_MAGIC)
+    return (-1);
+
+  if (!stats)
+    {
+      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_PARAMETERS);
+      return (-1);
+    }
+
+  if (ipmiconsole_ctx_stats_get (c, stats) < 0)
+    {
+      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_INTERNAL_ERROR);
+      return (-1);
+    }
+
+  ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SUCCESS);
+  return (0);
+}
+
 void
 ipmiconsole_ctx_destroy (ipmiconsole_ctx_t c)
 {
@@ -1566,6 +1790,8 @@ ipmiconsole_ctx_destroy (ipmiconsole_ctx_t c)
           ipmiconsole_ctx_debug_cleanup (c);
           ipmiconsole_ctx_signal_cleanup (c);
           ipmiconsole_ctx_blocking_cleanup (c);
+          ipmiconsole_ctx_log_cleanup (c);
+          ipmiconsole_ctx_stats_cleanup (c);
           ipmiconsole_ctx_cleanup (c);
 
           /* No unlocking, mutex is now destroyed */
@@ -1595,6 +1821,8 @@ ipmiconsole_ctx_destroy (ipmiconsole_ctx_t c)
   ipmiconsole_ctx_debug_cleanup (c);
   ipmiconsole_ctx_signal_cleanup (c);
   ipmiconsole_ctx_blocking_cleanup (c);
+  ipmiconsole_ctx_log_cleanup (c);
+  ipmiconsole_ctx_stats_cleanup (c);
   ipmiconsole_ctx_cleanup (c);
 }
 
@@ -144,6 +144,8 @@ ipmiconsole_ctx_garbage_collection_cleanup (ipmiconsole_ctx_t c)
       ipmiconsole_ctx_debug_cleanup (c);
       ipmiconsole_ctx_signal_cleanup (c);
       ipmiconsole_ctx_blocking_cleanup (c);
+      ipmiconsole_ctx_log_cleanup (c);
+      ipmiconsole_ctx_stats_cleanup (c);
       ipmiconsole_ctx_cleanup (c);
     }
   /* When tearing down engine, contexts could be in garbage collection
@@ -369,7 +371,8 @@ ipmiconsole_ctx_config_cleanup (ipmiconsole_ctx_t c)
   assert (c);
   assert (c->magic == IPMICONSOLE_CTX_MAGIC);
 
-  /* nothing now, reserve for later */
+  free (c->config.log_file);
+  c->config.log_file = NULL;
 }
 
 int
@@ -501,6 +504,269 @@ ipmiconsole_ctx_blocking_cleanup (ipmiconsole_ctx_t c)
   pthread_mutex_destroy (&(c->blocking.blocking_mutex));
 }
 
+int
+ipmiconsole_ctx_log_setup (ipmiconsole_ctx_t c)
+{
+  int perr;
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+
+  if ((perr = pthread_mutex_init (&c->log.tail_mutex, NULL)) != 0)
+    {
+      errno = perr;
+      return (-1);
+    }
+  c->log.tail = NULL;
+
+  return (0);
+}
+
+void
+ipmiconsole_ctx_log_cleanup (ipmiconsole_ctx_t c)
+{
+  int secure_malloc_flag;
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+
+  secure_malloc_flag = (c->config.engine_flags & IPMICONSOLE_ENGINE_LOCK_MEMORY) ? 1 : 0;
+
+  if (c->log.tail)
+    scbuf_destroy (c->log.tail, secure_malloc_flag);
+  c->log.tail = NULL;
+  pthread_mutex_destroy (&(c->log.tail_mutex));
+}
+
+int
+ipmiconsole_ctx_stats_setup (ipmiconsole_ctx_t c)
+{
+  int perr;
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+
+  if ((perr = pthread_mutex_init (&c->stats.stats_mutex, NULL)) != 0)
+    {
+      errno = perr;
+      return (-1);
+    }
+  memset (&(c->stats.stats), '\0', sizeof (struct ipmiconsole_ctx_stats));
+
+  return (0);
+}
+
+void
+ipmiconsole_ctx_stats_cleanup (ipmiconsole_ctx_t c)
+{
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+
+  pthread_mutex_destroy (&(c->stats.stats_mutex));
+}
+
+int
+ipmiconsole_ctx_stats_get (ipmiconsole_ctx_t c, struct ipmiconsole_ctx_stats *stats)
+{
+  int perr;
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+  assert (stats);
+
+  if ((perr = pthread_mutex_lock (&(c->stats.stats_mutex))) != 0)
+    {
+      IPMICONSOLE_DEBUG (("pthread_mutex_lock: %s", strerror (perr)));
+      errno = perr;
+      return (-1);
+    }
+
+  memcpy (stats, &(c->stats.stats), sizeof (struct ipmiconsole_ctx_stats));
+
+  if ((perr = pthread_mutex_unlock (&(c->stats.stats_mutex))) != 0)
+    IPMICONSOLE_DEBUG (("pthread_mutex_unlock: %s", strerror (perr)));
+
+  return (0);
+}
+
+static int
+_log_file_open (ipmiconsole_ctx_t c, int truncate_flag)
+{
+  struct stat buf;
+  int flags;
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+  assert (c->config.log_file);
+
+  flags = O_CREAT | O_APPEND | O_WRONLY;
+  if (truncate_flag)
+    flags |= O_TRUNC;
+
+  if ((c->connection.log_fd = open (c->config.log_file, flags, 0600)) < 0)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("open: %s", strerror (errno)));
+      if (errno == EMFILE)
+        ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_TOO_MANY_OPEN_FILES);
+      else
+        ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SYSTEM_ERROR);
+      return (-1);
+    }
+
+  if (ipmiconsole_set_closeonexec (c, c->connection.log_fd) < 0)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("closeonexec error"));
+      return (-1);
+    }
+
+  if (fstat (c->connection.log_fd, &buf) < 0)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("fstat: %s", strerror (errno)));
+      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SYSTEM_ERROR);
+      return (-1);
+    }
+  c->connection.log_file_size = buf.st_size;
+
+  return (0);
+}
+
+/* Move the current log file to <log_file>.1 and start a new one */
+static int
+_log_file_rotate (ipmiconsole_ctx_t c)
+{
+  char filename[MAXPATHLEN];
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+  assert (c->connection.log_fd >= 0);
+
+  snprintf (filename, MAXPATHLEN, "%s.1", c->config.log_file);
+
+  if (rename (c->config.log_file, filename) < 0)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("rename: %s", strerror (errno)));
+      return (-1);
+    }
+
+  /* ignore potential error, file already rotated */
+  close (c->connection.log_fd);
+  c->connection.log_fd = -1;
+
+  return (_log_file_open (c, 1));
+}
+
+int
+ipmiconsole_ctx_log_flush (ipmiconsole_ctx_t c)
+{
+  unsigned int count = 0;
+  ssize_t n;
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+
+  if (!c->connection.log_buf_len)
+    return (0);
+
+  if (c->connection.log_fd < 0)
+    goto out;
+
+  if (c->config.log_file_max_size
+      && c->connection.log_file_size
+      && c->connection.log_file_size + c->connection.log_buf_len > c->config.log_file_max_size)
+    {
+      if (_log_file_rotate (c) < 0)
+        {
+          /* rotation is best effort, continue to append to the
+           * current file if it is still open
+           */
+          if (c->connection.log_fd < 0)
+            goto out;
+        }
+    }
+
+  while (count < c->connection.log_buf_len)
+    {
+      if ((n = write (c->connection.log_fd,
+                      c->connection.log_buf + count,
+                      c->connection.log_buf_len - count)) < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          IPMICONSOLE_CTX_DEBUG (c, ("write: %s", strerror (errno)));
+          c->connection.log_buf_len = 0;
+          return (-1);
+        }
+      count += n;
+    }
+  c->connection.log_file_size += count;
+
+ out:
+  c->connection.log_buf_len = 0;
+  return (0);
+}
+
+int
+ipmiconsole_ctx_log_write (ipmiconsole_ctx_t c, const char *buf, unsigned int buflen)
+{
+  int secure_malloc_flag;
+  int perr;
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+  assert (buf);
+
+  secure_malloc_flag = (c->config.engine_flags & IPMICONSOLE_ENGINE_LOCK_MEMORY) ? 1 : 0;
+
+  if (c->log.tail)
+    {
+      int dropped;
+
+      if ((perr = pthread_mutex_lock (&(c->log.tail_mutex))) != 0)
+        IPMICONSOLE_DEBUG (("pthread_mutex_lock: %s", strerror (perr)));
+
+      /* dropped data is expected, only the tail is kept */
+      if (scbuf_write (c->log.tail, (void *)buf, buflen, &dropped, secure_malloc_flag) < 0)
+        IPMICONSOLE_CTX_DEBUG (c, ("scbuf_write: %s", strerror (errno)));
+
+      if ((perr = pthread_mutex_unlock (&(c->log.tail_mutex))) != 0)
+        IPMICONSOLE_DEBUG (("pthread_mutex_unlock: %s", strerror (perr)));
+    }
+
+  if (!c->connection.log_buf)
+    return (0);
+
+  while (buflen)
+    {
+      unsigned int len;
+
+      if (c->connection.log_buf_len == IPMICONSOLE_LOG_BUFLEN)
+        {
+          if (ipmiconsole_ctx_log_flush (c) < 0)
+            return (-1);
+        }
+
+      if (!c->connection.log_buf_len)
+        {
+          if (gettimeofday (&(c->connection.log_buf_first_write), NULL) < 0)
+            {
+              IPMICONSOLE_CTX_DEBUG (c, ("gettimeofday: %s", strerror (errno)));
+              return (-1);
+            }
+        }
+
+      len = IPMICONSOLE_LOG_BUFLEN - c->connection.log_buf_len;
+      if (len > buflen)
+        len = buflen;
+
+      memcpy (c->connection.log_buf + c->connection.log_buf_len, buf, len);
+      c->connection.log_buf_len += len;
+      buf += len;
+      buflen -= len;
+    }
+
+  return (0);
+}
+
 int
 ipmiconsole_ctx_connection_setup (ipmiconsole_ctx_t c)
 {
@@ -525,6 +791,7 @@ ipmiconsole_ctx_connection_setup (ipmiconsole_ctx_t c)
   c->connection.ipmi_fd = -1;
   c->connection.asynccomm[0] = -1;
   c->connection.asynccomm[1] = -1;
+  c->connection.log_fd = -1;
 
   /* File Descriptor User Interface */
 
@@ -573,46 +840,52 @@ ipmiconsole_ctx_connection_setup (ipmiconsole_ctx_t c)
 
   /* Connection Data */
 
-  if (c->session.addr->sa_family == AF_INET)
-    {
-      memset (&srcaddr4, '\0', sizeof (struct sockaddr_in));
-      srcaddr4.sin_family = AF_INET;
-      srcaddr4.sin_port = htons (0);
-      srcaddr = (struct sockaddr *)&srcaddr4;
-      srcaddr_len = sizeof (struct sockaddr_in);
-      domain = AF_INET;		/* to remove dereference warning on srcaddr below */
-    }
-  else
-    {
-      memset (&srcaddr6, '\0', sizeof (struct sockaddr_in6));
-      srcaddr6.sin6_family = AF_INET6;
-      srcaddr6.sin6_port = htons (0);
-      srcaddr = (struct sockaddr *)&srcaddr6;
-      srcaddr_len = sizeof (struct sockaddr_in6);
-      domain = AF_INET6;	/* to remove dereference warning on srcaddr below */
-    }
-
-  if ((c->connection.ipmi_fd = socket (domain, SOCK_DGRAM, 0)) < 0)
+  /* With a shared socket, the ipmi_fd is assigned by the engine when
+   * the context is submitted.
+   */
+  if (!(c->config.engine_flags & IPMICONSOLE_ENGINE_SHARED_SOCKET))
     {
-      IPMICONSOLE_DEBUG (("socket: %s", strerror (errno)));
-      if (errno == EMFILE)
-        ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_TOO_MANY_OPEN_FILES);
+      if (c->session.addr->sa_family == AF_INET)
+        {
+          memset (&srcaddr4, '\0', sizeof (struct sockaddr_in));
+          srcaddr4.sin_family = AF_INET;
+          srcaddr4.sin_port = htons (0);
+          srcaddr = (struct sockaddr *)&srcaddr4;
+          srcaddr_len = sizeof (struct sockaddr_in);
+          domain = AF_INET;		/* to remove dereference warning on srcaddr below */
+        }
       else
-        ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SYSTEM_ERROR);
-      goto cleanup;
-    }
+        {
+          memset (&srcaddr6, '\0', sizeof (struct sockaddr_in6));
+          srcaddr6.sin6_family = AF_INET6;
+          srcaddr6.sin6_port = htons (0);
+          srcaddr = (struct sockaddr *)&srcaddr6;
+          srcaddr_len = sizeof (struct sockaddr_in6);
+          domain = AF_INET6;	/* to remove dereference warning on srcaddr below */
+        }
 
-  if (ipmiconsole_set_closeonexec (c, c->connection.ipmi_fd) < 0)
-    {
-      IPMICONSOLE_DEBUG (("closeonexec error"));
-      goto cleanup;
-    }
+      if ((c->connection.ipmi_fd = socket (domain, SOCK_DGRAM, 0)) < 0)
+        {
+          IPMICONSOLE_DEBUG (("socket: %s", strerror (errno)));
+          if (errno == EMFILE)
+            ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_TOO_MANY_OPEN_FILES);
+          else
+            ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SYSTEM_ERROR);
+          goto cleanup;
+        }
 
-  if (bind (c->connection.ipmi_fd, srcaddr, srcaddr_len) < 0)
-    {
-      IPMICONSOLE_DEBUG (("bind: %s", strerror (errno)));
-      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SYSTEM_ERROR);
-      goto cleanup;
+      if (ipmiconsole_set_closeonexec (c, c->connection.ipmi_fd) < 0)
+        {
+          IPMICONSOLE_DEBUG (("closeonexec error"));
+          goto cleanup;
+        }
+
+      if (bind (c->connection.ipmi_fd, srcaddr, srcaddr_len) < 0)
+        {
+          IPMICONSOLE_DEBUG (("bind: %s", strerror (errno)));
+          ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SYSTEM_ERROR);
+          goto cleanup;
+        }
     }
 
   if (!(c->connection.ipmi_from_bmc = scbuf_create (IPMI_FROM_BMC_BUF_MIN, IPMI_FROM_BMC_BUF_MAX, secure_malloc_flag)))
@@ -629,6 +902,35 @@ ipmiconsole_ctx_connection_setup (ipmiconsole_ctx_t c)
       goto cleanup;
     }
 
+  /* Console Logging */
+
+  if (c->config.log_file)
+    {
+      if (_log_file_open (c, 0) < 0)
+        goto cleanup;
+
+      if (!(c->connection.log_buf = malloc (IPMICONSOLE_LOG_BUFLEN)))
+        {
+          IPMICONSOLE_DEBUG (("malloc: %s", strerror (errno)));
+          ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_OUT_OF_MEMORY);
+          goto cleanup;
+        }
+    }
+
+  if (c->config.log_tail_size && !c->log.tail)
+    {
+      int minsize;
+
+      minsize = c->config.log_tail_size < CONSOLE_BMC_TO_REMOTE_CONSOLE_BUF_MIN ? c->config.log_tail_size : CONSOLE_BMC_TO_REMOTE_CONSOLE_BUF_MIN;
+
+      if (!(c->log.tail = scbuf_create (minsize, c->config.log_tail_size, secure_malloc_flag)))
+        {
+          IPMICONSOLE_DEBUG (("scbuf_create: %s", strerror (errno)));
+          ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_OUT_OF_MEMORY);
+          goto cleanup;
+        }
+    }
+
   /* Pipe for non-fd communication */
   if (pipe (c->connection.asynccomm) < 0)
     {
@@ -982,9 +1284,23 @@ __ipmiconsole_ctx_connection_cleanup (ipmiconsole_ctx_t c, int session_submitted
     scbuf_destroy (c->connection.console_bmc_to_remote_console, secure_malloc_flag);
 
   /* ignore potential error, cleanup path */
-  if (c->connection.ipmi_fd >= 0)
+  if (c->connection.ipmi_fd >= 0
+      && !c->connection.ipmi_fd_shared)
     close (c->connection.ipmi_fd);
   c->connection.ipmi_fd = -1;
+  c->connection.ipmi_fd_shared = 0;
+
+  /* ignore potential error, cleanup path */
+  if (c->connection.log_buf)
+    ipmiconsole_ctx_log_flush (c);
+  free (c->connection.log_buf);
+  c->connection.log_buf = NULL;
+  c->connection.log_buf_len = 0;
+
+  /* ignore potential error, cleanup path */
+  if (c->connection.log_fd >= 0)
+    close (c->connection.log_fd);
+  c->connection.log_fd = -1;
 
   if (c->connection.ipmi_from_bmc)
     scbuf_destroy (c->connection.ipmi_from_bmc, secure_malloc_flag);
@@ -1116,6 +1432,8 @@ __ipmiconsole_ctx_connection_cleanup (ipmiconsole_ctx_t c, int session_submitted
       ipmiconsole_ctx_debug_cleanup (c);
       ipmiconsole_ctx_signal_cleanup (c);
       ipmiconsole_ctx_blocking_cleanup (c);
+      ipmiconsole_ctx_log_cleanup (c);
+      ipmiconsole_ctx_stats_cleanup (c);
       ipmiconsole_ctx_cleanup (c);
     }
   /* Can be in INIT because of error early in setup */
@@ -61,6 +61,23 @@ int ipmiconsole_ctx_blocking_setup (ipmiconsole_ctx_t c);
 
 void ipmiconsole_ctx_blocking_cleanup (ipmiconsole_ctx_t c);
 
+int ipmiconsole_ctx_log_setup (ipmiconsole_ctx_t c);
+
+void ipmiconsole_ctx_log_cleanup (ipmiconsole_ctx_t c);
+
+/* Append console output to the log tail and log file buffer */
+int ipmiconsole_ctx_log_write (ipmiconsole_ctx_t c, const char *buf, unsigned int buflen);
+
+/* Write out buffered console output to the log file */
+int ipmiconsole_ctx_log_flush (ipmiconsole_ctx_t c);
+
+int ipmiconsole_ctx_stats_setup (ipmiconsole_ctx_t c);
+
+void ipmiconsole_ctx_stats_cleanup (ipmiconsole_ctx_t c);
+
+/* Copy out the counters, safe to call from the API or the engine */
+int ipmiconsole_ctx_stats_get (ipmiconsole_ctx_t c, struct ipmiconsole_ctx_stats *stats);
+
 int ipmiconsole_ctx_connection_setup (ipmiconsole_ctx_t c);
 
 void ipmiconsole_ctx_connection_cleanup_session_submitted (ipmiconsole_ctx_t c);
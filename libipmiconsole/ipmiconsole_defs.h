@@ -201,6 +201,23 @@ typedef enum
 
 #define IPMICONSOLE_PIPE_GENERATE_BREAK_CODE  0x01
 
+/* Console output is batched before being written to the log file.
+ * Flush interval in milliseconds.
+ */
+#define IPMICONSOLE_LOG_BUFLEN                16384
+#define IPMICONSOLE_LOG_FLUSH_INTERVAL        250
+#define IPMICONSOLE_LOG_TAIL_SIZE_MAX         (1024*1024)
+
+/* Coalescing of SOL character data, intervals in milliseconds.
+ * Console output is flushed to the user early once
+ * IPMICONSOLE_SOL_OUTPUT_FLUSH_LEN bytes are batched.
+ */
+#define IPMICONSOLE_SOL_COALESCE_INTERVAL_MAX 1000
+#define IPMICONSOLE_SOL_OUTPUT_FLUSH_LEN      1024
+
+/* Seconds, for libipmiconsole-engine-stats-interval */
+#define IPMICONSOLE_ENGINE_STATS_INTERVAL_MAX 86400
+
 #define IPMICONSOLE_DEBUG_MASK         \
   (IPMICONSOLE_DEBUG_STDOUT            \
    | IPMICONSOLE_DEBUG_STDERR          \
@@ -228,7 +245,9 @@ typedef enum
    | IPMICONSOLE_ENGINE_OUTPUT_ON_SOL_ESTABLISHED  \
    | IPMICONSOLE_ENGINE_LOCK_MEMORY                \
    | IPMICONSOLE_ENGINE_SERIAL_KEEPALIVE           \
-   | IPMICONSOLE_ENGINE_SERIAL_KEEPALIVE_EMPTY)
+   | IPMICONSOLE_ENGINE_SERIAL_KEEPALIVE_EMPTY      \
+   | IPMICONSOLE_ENGINE_SHARED_SOCKET              \
+   | IPMICONSOLE_ENGINE_LOG_ONLY)
 
 #define IPMICONSOLE_BEHAVIOR_MASK           \
   (IPMICONSOLE_BEHAVIOR_ERROR_ON_SOL_INUSE  \
@@ -269,6 +288,11 @@ struct ipmiconsole_ctx_config {
 
   /* advanced config */
   unsigned int sol_payload_instance;
+  char *log_file;
+  unsigned int log_file_max_size;
+  unsigned int log_tail_size;
+  unsigned int sol_input_coalesce_interval;
+  unsigned int sol_output_flush_interval;
 
   /* Data based on Configuration Parameters */
   uint8_t authentication_algorithm;
@@ -287,12 +311,29 @@ struct ipmiconsole_ctx_connection {
 
   /* Connection Data */
   int ipmi_fd;
+  /* if set, ipmi_fd is owned by the engine thread, not the context */
+  int ipmi_fd_shared;
   scbuf_t ipmi_from_bmc;
   scbuf_t ipmi_to_bmc;
 
   /* Pipe for non-fd communication: from API to engine */
   int asynccomm[2];
 
+  /* Console output log, batched in log_buf before being written */
+  int log_fd;
+  char *log_buf;
+  unsigned int log_buf_len;
+  unsigned int log_file_size;
+  struct timeval log_buf_first_write;
+
+  /* When the console buffers last went from empty to non-empty, for
+   * SOL input coalescing and output batching
+   */
+  struct timeval console_remote_console_to_bmc_first_write;
+  struct timeval console_bmc_to_remote_console_first_write;
+  /* set if console output should be written to the user now */
+  int console_bmc_to_remote_console_flush;
+
   /* Fiid Objects */
 
   fiid_obj_t obj_rmcp_hdr_rq;
@@ -419,6 +460,7 @@ struct ipmiconsole_ctx_session {
   int sol_input_waiting_for_ack;
   int sol_input_waiting_for_break_ack;
   struct timeval last_sol_input_packet_sent;
+  int sol_input_retransmitted;
   uint8_t sol_input_packet_sequence_number;
   uint8_t sol_input_character_data[IPMICONSOLE_MAX_CHARACTER_DATA+1];
   unsigned int sol_input_character_data_len;
@@ -436,6 +478,23 @@ struct ipmiconsole_ctx_debug {
   int debug_fd;
 };
 
+/* In memory tail of console output.  Written by the engine and read
+ * by the API, it outlives the SOL session so the user may retrieve
+ * the last output of a failed session.
+ */
+struct ipmiconsole_ctx_log {
+  pthread_mutex_t tail_mutex;
+  scbuf_t tail;
+};
+
+/* SOL counters.  Written by the engine and read by the API, they
+ * outlive the SOL session like the log tail.
+ */
+struct ipmiconsole_ctx_stats_data {
+  pthread_mutex_t stats_mutex;
+  struct ipmiconsole_ctx_stats stats;
+};
+
 /* Mutexes + flags for signaling between the API and engine */
 
 /* state of context
@@ -557,6 +616,10 @@ struct ipmiconsole_ctx {
 
   struct ipmiconsole_ctx_blocking blocking;
 
+  struct ipmiconsole_ctx_log log;
+
+  struct ipmiconsole_ctx_stats_data stats;
+
   struct ipmiconsole_ctx_session session;
 
   struct ipmiconsole_ctx_connection connection;
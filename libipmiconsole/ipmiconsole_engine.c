@@ -59,8 +59,10 @@
 #include "scbuf.h"
 
 #include "freeipmi-portability.h"
+#include "hash.h"
 #include "list.h"
 #include "secure.h"
+#include "timeval.h"
 
 /*
  * Locking notes:
@@ -83,6 +85,15 @@ static List console_engine_ctxs[IPMICONSOLE_THREAD_COUNT_MAX];
 static unsigned int console_engine_ctxs_count[IPMICONSOLE_THREAD_COUNT_MAX];
 static pthread_mutex_t console_engine_ctxs_mutex[IPMICONSOLE_THREAD_COUNT_MAX];
 
+/* Engine thread counters, protected by console_engine_ctxs_mutex */
+static struct ipmiconsole_engine_stats console_engine_stats[IPMICONSOLE_THREAD_COUNT_MAX];
+
+/* Seconds between dumps of the engine thread and context counters to
+ * the debug output, 0 for never.
+ */
+static unsigned int console_engine_stats_interval = 0;
+static pthread_mutex_t console_engine_stats_interval_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /* In the core engine code, the poll() may sit for a large number of
  * seconds, waiting for the next event to happen.  In the meantime, a
  * user may have submitted a new context or wants to close the engine.
@@ -115,17 +126,76 @@ extern pthread_cond_t garbage_collector_active_cond;
 /* See comments below in _poll_setup(). */
 static int dummy_fd = -1;
 
+/* Contexts submitted with IPMICONSOLE_ENGINE_SHARED_SOCKET do not own
+ * an ipmi_fd.  Each engine thread lazily creates one UDP socket per
+ * address family and all shared contexts managed by that thread send
+ * and receive through it.
+ *
+ * Incoming packets are demultiplexed to contexts by the remote
+ * console session id, which the BMC places in the IPMI 2.0 session
+ * header (or in the payload of the session setup responses, where the
+ * session header id is still 0).  IPMI 1.5 pre-session packets carry
+ * no usable session id, so they are handed to every shared context
+ * with a matching source address.  The normal packet checks will
+ * drop those that were not meant for a context.
+ *
+ * The session id hash is rebuilt on every pass through the engine
+ * loop from the contexts being polled.  Therefore it never references
+ * a context that has since been destroyed or one whose session id was
+ * regenerated (e.g. when trying a new port).
+ */
+#define IPMICONSOLE_SHARED_SOCKET_INET  0
+#define IPMICONSOLE_SHARED_SOCKET_INET6 1
+#define IPMICONSOLE_SHARED_SOCKET_COUNT 2
+
+struct _ipmiconsole_shared_socket {
+  int fd[IPMICONSOLE_SHARED_SOCKET_COUNT];
+  hash_t session_ids;
+  /* Receive buffer.  A packet read from a shared socket can't be
+   * stored until its context has processed the prior one.  If
+   * pkt_len is non-zero, such a packet is held here until the next
+   * pass through the engine loop.
+   */
+  uint8_t pkt[IPMICONSOLE_PACKET_BUFLEN];
+  unsigned int pkt_len;
+  struct sockaddr_in6 from;
+  socklen_t fromlen;
+};
+
+static struct _ipmiconsole_shared_socket *console_engine_shared_socket[IPMICONSOLE_THREAD_COUNT_MAX];
+
 struct _ipmiconsole_poll_data {
   struct pollfd *pfds;
   ipmiconsole_ctx_t *pfds_ctxs;
   unsigned int ctxs_len;
   unsigned int pfds_index;
+  struct _ipmiconsole_shared_socket *shared_socket;
+  int shared_pollout[IPMICONSOLE_SHARED_SOCKET_COUNT];
 };
 
 #define IPMICONSOLE_SPIN_WAIT_TIME 250000
 
 #define IPMICONSOLE_PIPE_BUFLEN 1024
 
+/* Max packets read off a shared socket per pass through the engine loop */
+#define IPMICONSOLE_SHARED_SOCKET_RECV_MAX 256
+
+#define IPMICONSOLE_SHARED_SOCKET_RCVBUF   (1024*1024)
+
+/* See IPMI 2.0 spec Section 13.6, Table 13-8 and Sections 13.18,
+ * 13.21 for the layout of the session header and the session setup
+ * payloads.
+ */
+#define IPMICONSOLE_RMCP_HDR_LENGTH                  4
+#define IPMICONSOLE_AUTHENTICATION_TYPE_LENGTH       1
+#define IPMICONSOLE_PAYLOAD_TYPE_LENGTH              1
+#define IPMICONSOLE_OEM_EXPLICIT_LENGTH              6
+#define IPMICONSOLE_SESSION_ID_LENGTH                4
+#define IPMICONSOLE_SESSION_SEQUENCE_NUMBER_LENGTH   4
+#define IPMICONSOLE_PAYLOAD_LENGTH_LENGTH            2
+#define IPMICONSOLE_SESSION_SETUP_SESSION_ID_OFFSET  4
+#define IPMICONSOLE_PAYLOAD_TYPE_MASK                0x3F
+
 static int
 _ipmiconsole_garbage_collector_create (void)
 {
@@ -216,6 +286,7 @@ ipmiconsole_engine_setup (unsigned int thread_count)
 
   memset (console_engine_ctxs, '\0', IPMICONSOLE_THREAD_COUNT_MAX * sizeof (List));
   memset (console_engine_ctxs_count, '\0', IPMICONSOLE_THREAD_COUNT_MAX * sizeof (unsigned int));
+  memset (console_engine_stats, '\0', IPMICONSOLE_THREAD_COUNT_MAX * sizeof (struct ipmiconsole_engine_stats));
   memset (console_engine_ctxs_mutex, '\0', IPMICONSOLE_THREAD_COUNT_MAX * sizeof (pthread_mutex_t));
   for (i = 0; i < IPMICONSOLE_THREAD_COUNT_MAX; i++)
     {
@@ -224,6 +295,7 @@ ipmiconsole_engine_setup (unsigned int thread_count)
     }
   garbage_collector_notifier[0] = -1;
   garbage_collector_notifier[1] = -1;
+  memset (console_engine_shared_socket, '\0', IPMICONSOLE_THREAD_COUNT_MAX * sizeof (struct _ipmiconsole_shared_socket *));
 
   if (ipmi_rmcpplus_init () < 0)
     {
@@ -394,6 +466,40 @@ ipmiconsole_engine_thread_count (void)
   return (thread_count);
 }
 
+static unsigned int
+_shared_socket_index (ipmiconsole_ctx_t c)
+{
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+
+  if (c->session.addr->sa_family == AF_INET)
+    return (IPMICONSOLE_SHARED_SOCKET_INET);
+  return (IPMICONSOLE_SHARED_SOCKET_INET6);
+}
+
+static unsigned int
+_shared_socket_session_id_hash (const void *key)
+{
+  assert (key);
+
+  return (*((uint32_t *)key));
+}
+
+static int
+_shared_socket_session_id_cmp (const void *key1, const void *key2)
+{
+  assert (key1);
+  assert (key2);
+
+  return ((*((uint32_t *)key1) == *((uint32_t *)key2)) ? 0 : 1);
+}
+
+static int
+_shared_socket_session_id_clear (void *data, const void *key, void *arg)
+{
+  return (1);
+}
+
 static int
 _teardown_initiate (void *x, void *arg)
 {
@@ -428,12 +534,38 @@ _poll_setup (void *x, void *arg)
 
   poll_data = (struct _ipmiconsole_poll_data *)arg;
 
-  poll_data->pfds[poll_data->pfds_index*3].fd = c->connection.ipmi_fd;
-  poll_data->pfds[poll_data->pfds_index*3].events = 0;
-  poll_data->pfds[poll_data->pfds_index*3].revents = 0;
-  poll_data->pfds[poll_data->pfds_index*3].events |= POLLIN;
-  if (!scbuf_is_empty (c->connection.ipmi_to_bmc))
-    poll_data->pfds[poll_data->pfds_index*3].events |= POLLOUT;
+  if (c->connection.ipmi_fd_shared)
+    {
+      assert (poll_data->shared_socket);
+
+      /* Shared contexts are polled through the engine thread's shared
+       * socket, a negative fd is ignored by poll().
+       */
+      poll_data->pfds[poll_data->pfds_index*3].fd = -1;
+      poll_data->pfds[poll_data->pfds_index*3].events = 0;
+      poll_data->pfds[poll_data->pfds_index*3].revents = 0;
+
+      /* Session ids are made unique on submission, but could collide
+       * if regenerated later on (i.e. trying a new port).  It's
+       * improbable, the session will simply timeout.
+       */
+      if (!hash_insert (poll_data->shared_socket->session_ids,
+                        &(c->session.remote_console_session_id),
+                        c))
+        IPMICONSOLE_CTX_DEBUG (c, ("hash_insert: %s", strerror (errno)));
+
+      if (!scbuf_is_empty (c->connection.ipmi_to_bmc))
+        poll_data->shared_pollout[_shared_socket_index (c)]++;
+    }
+  else
+    {
+      poll_data->pfds[poll_data->pfds_index*3].fd = c->connection.ipmi_fd;
+      poll_data->pfds[poll_data->pfds_index*3].events = 0;
+      poll_data->pfds[poll_data->pfds_index*3].revents = 0;
+      poll_data->pfds[poll_data->pfds_index*3].events |= POLLIN;
+      if (!scbuf_is_empty (c->connection.ipmi_to_bmc))
+        poll_data->pfds[poll_data->pfds_index*3].events |= POLLOUT;
+    }
 
   /* If the session is being torn down, don't bother settings flags on
    * these fds.  However, to avoid spinning due to an invalid fd or a
@@ -450,7 +582,8 @@ _poll_setup (void *x, void *arg)
       poll_data->pfds[poll_data->pfds_index*3 + 2].events = 0;
       poll_data->pfds[poll_data->pfds_index*3 + 2].revents = 0;
       poll_data->pfds[poll_data->pfds_index*3 + 2].events |= POLLIN;
-      if (!scbuf_is_empty (c->connection.console_bmc_to_remote_console))
+      if (!scbuf_is_empty (c->connection.console_bmc_to_remote_console)
+          && c->connection.console_bmc_to_remote_console_flush)
         poll_data->pfds[poll_data->pfds_index*3 + 2].events |= POLLOUT;
     }
   else
@@ -470,6 +603,99 @@ _poll_setup (void *x, void *arg)
   return (0);
 }
 
+/*
+ * Return 1 if packet is from the context's BMC
+ * Return 0 if not
+ */
+static int
+_ipmi_from_valid (ipmiconsole_ctx_t c, struct sockaddr *from, socklen_t fromlen)
+{
+  struct sockaddr_in6 from6;
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+  assert (from);
+
+  /* memcpy hacks to avoid warnings, i.e.
+   * warning: dereferencing pointer 'X' does break strict-aliasing rules
+   */
+  memset (&from6, '\0', sizeof (struct sockaddr_in6));
+  memcpy (&from6, from, fromlen < sizeof (struct sockaddr_in6) ? fromlen : sizeof (struct sockaddr_in6));
+
+  if (from6.sin6_family == AF_INET6)
+    {
+      if (memcmp (&from6.sin6_addr,
+                  &(c->session.addr6.sin6_addr),
+                  sizeof (from6.sin6_addr)))
+        return (0);
+    }
+  else
+    {
+      struct sockaddr_in from4;
+
+      memcpy (&from4, &from6, sizeof (struct sockaddr_in));
+
+      if (from4.sin_addr.s_addr != c->session.addr4.sin_addr.s_addr)
+        return (0);
+    }
+
+  return (1);
+}
+
+/*
+ * Return 0 on success
+ * Return -1 on fatal error
+ */
+static int
+_ipmi_packet_store (ipmiconsole_ctx_t c, void *pkt, unsigned int pkt_len)
+{
+  int n, dropped = 0;
+  int secure_malloc_flag;
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+  assert (pkt);
+
+  secure_malloc_flag = (c->config.engine_flags & IPMICONSOLE_ENGINE_LOCK_MEMORY) ? 1 : 0;
+
+  /* Empty the scbuf if it's not empty */
+  if (!scbuf_is_empty (c->connection.ipmi_from_bmc))
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("ipmi_from_bmc not empty, draining"));
+      do {
+        char tempbuf[IPMICONSOLE_PACKET_BUFLEN];
+        if (scbuf_read (c->connection.ipmi_from_bmc, tempbuf, IPMICONSOLE_PACKET_BUFLEN) < 0)
+          {
+            IPMICONSOLE_CTX_DEBUG (c, ("scbuf_read: %s", strerror (errno)));
+            break;
+          }
+      } while(!scbuf_is_empty (c->connection.ipmi_from_bmc));
+    }
+
+  if ((n = scbuf_write (c->connection.ipmi_from_bmc, pkt, pkt_len, &dropped, secure_malloc_flag)) < 0)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("scbuf_write: %s", strerror (errno)));
+      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_INTERNAL_ERROR);
+      return (-1);
+    }
+
+  if (n != pkt_len)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("scbuf_write: invalid bytes written; n=%d; len=%d", n, pkt_len));
+      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_INTERNAL_ERROR);
+      return (-1);
+    }
+
+  if (dropped)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("scbuf_write: dropped data: dropped=%d", dropped));
+      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_INTERNAL_ERROR);
+      return (-1);
+    }
+
+  return (0);
+}
+
 /*
  * Return 0 on success
  * Return -1 on fatal error
@@ -480,16 +706,12 @@ _ipmi_recvfrom (ipmiconsole_ctx_t c)
   char buffer[IPMICONSOLE_PACKET_BUFLEN];
   struct sockaddr_in6 from6;
   struct sockaddr *from = (struct sockaddr *)&from6;
-  unsigned int fromlen = sizeof (struct sockaddr_in6);
+  socklen_t fromlen = sizeof (struct sockaddr_in6);
   ssize_t len;
-  int n, dropped = 0;
-  int secure_malloc_flag;
 
   assert (c);
   assert (c->magic == IPMICONSOLE_CTX_MAGIC);
 
-  secure_malloc_flag = (c->config.engine_flags & IPMICONSOLE_ENGINE_LOCK_MEMORY) ? 1 : 0;
-
   do
     {
       /* For receive side, ipmi_lan_recvfrom and
@@ -560,70 +782,14 @@ _ipmi_recvfrom (ipmiconsole_ctx_t c)
     }
 
   /* Sanity Check */
-  if (from6.sin6_family == AF_INET6)
-    {
-      if (memcmp (&from6.sin6_addr,
-                  &(c->session.addr6.sin6_addr),
-                  sizeof (from6.sin6_addr)))
-        {
-          IPMICONSOLE_CTX_DEBUG (c, ("received from invalid address"));
-          /* Note: Not a fatal error, just return */
-          return (0);
-        }
-    }
-  else
-    {
-      /* memcpy hacks to avoid warnings, i.e.
-       * warning: dereferencing pointer 'X' does break strict-aliasing rules
-       */
-      struct sockaddr_in from4;
-
-      memcpy (&from4, from, fromlen);
-
-      if (from4.sin_addr.s_addr != c->session.addr4.sin_addr.s_addr)
-        {
-          IPMICONSOLE_CTX_DEBUG (c, ("received from invalid address"));
-          /* Note: Not a fatal error, just return */
-          return (0);
-        }
-    }
-
-  /* Empty the scbuf if it's not empty */
-  if (!scbuf_is_empty (c->connection.ipmi_from_bmc))
-    {
-      IPMICONSOLE_CTX_DEBUG (c, ("ipmi_from_bmc not empty, draining"));
-      do {
-        char tempbuf[IPMICONSOLE_PACKET_BUFLEN];
-        if (scbuf_read (c->connection.ipmi_from_bmc, tempbuf, IPMICONSOLE_PACKET_BUFLEN) < 0)
-          {
-            IPMICONSOLE_CTX_DEBUG (c, ("scbuf_read: %s", strerror (errno)));
-            break;
-          }
-      } while(!scbuf_is_empty (c->connection.ipmi_from_bmc));
-    }
-
-  if ((n = scbuf_write (c->connection.ipmi_from_bmc, buffer, len, &dropped, secure_malloc_flag)) < 0)
-    {
-      IPMICONSOLE_CTX_DEBUG (c, ("scbuf_write: %s", strerror (errno)));
-      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_INTERNAL_ERROR);
-      return (-1);
-    }
-
-  if (n != len)
-    {
-      IPMICONSOLE_CTX_DEBUG (c, ("scbuf_write: invalid bytes written; n=%d; len=%d", n, len));
-      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_INTERNAL_ERROR);
-      return (-1);
-    }
-
-  if (dropped)
+  if (!_ipmi_from_valid (c, from, fromlen))
     {
-      IPMICONSOLE_CTX_DEBUG (c, ("scbuf_write: dropped data: dropped=%d", dropped));
-      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_INTERNAL_ERROR);
-      return (-1);
+      IPMICONSOLE_CTX_DEBUG (c, ("received from invalid address"));
+      /* Note: Not a fatal error, just return */
+      return (0);
     }
 
-  return (0);
+  return (_ipmi_packet_store (c, buffer, len));
 }
 
 /*
@@ -700,6 +866,238 @@ _ipmi_sendto (ipmiconsole_ctx_t c)
   return (0);
 }
 
+/*
+ * Returns the remote console session id within the packet, 0 if one
+ * cannot be found.
+ */
+static uint32_t
+_shared_socket_session_id (const uint8_t *pkt, unsigned int pkt_len)
+{
+  unsigned int offset;
+  uint8_t payload_type;
+  uint32_t session_id;
+
+  assert (pkt);
+
+  if (ipmi_is_ipmi_2_0_packet (pkt, pkt_len) != 1)
+    return (0);
+
+  offset = IPMICONSOLE_RMCP_HDR_LENGTH + IPMICONSOLE_AUTHENTICATION_TYPE_LENGTH;
+  if (pkt_len < offset + IPMICONSOLE_PAYLOAD_TYPE_LENGTH)
+    return (0);
+
+  payload_type = pkt[offset] & IPMICONSOLE_PAYLOAD_TYPE_MASK;
+  offset += IPMICONSOLE_PAYLOAD_TYPE_LENGTH;
+
+  if (payload_type == IPMI_PAYLOAD_TYPE_OEM_EXPLICIT)
+    offset += IPMICONSOLE_OEM_EXPLICIT_LENGTH;
+
+  if (pkt_len < offset + IPMICONSOLE_SESSION_ID_LENGTH)
+    return (0);
+
+  session_id = pkt[offset];
+  session_id |= (pkt[offset + 1] << 8);
+  session_id |= (pkt[offset + 2] << 16);
+  session_id |= ((uint32_t)pkt[offset + 3] << 24);
+
+  if (session_id)
+    return (session_id);
+
+  /* Session setup responses carry the session id in the payload */
+  if (payload_type == IPMI_PAYLOAD_TYPE_RMCPPLUS_OPEN_SESSION_RESPONSE
+      || payload_type == IPMI_PAYLOAD_TYPE_RAKP_MESSAGE_2
+      || payload_type == IPMI_PAYLOAD_TYPE_RAKP_MESSAGE_4)
+    {
+      offset += IPMICONSOLE_SESSION_ID_LENGTH;
+      offset += IPMICONSOLE_SESSION_SEQUENCE_NUMBER_LENGTH;
+      offset += IPMICONSOLE_PAYLOAD_LENGTH_LENGTH;
+      offset += IPMICONSOLE_SESSION_SETUP_SESSION_ID_OFFSET;
+
+      if (pkt_len < offset + IPMICONSOLE_SESSION_ID_LENGTH)
+        return (0);
+
+      session_id = pkt[offset];
+      session_id |= (pkt[offset + 1] << 8);
+      session_id |= (pkt[offset + 2] << 16);
+      session_id |= ((uint32_t)pkt[offset + 3] << 24);
+    }
+
+  return (session_id);
+}
+
+/*
+ * Return 1 if packet dispatched (or dropped)
+ * Return 0 if packet must be deferred
+ */
+static int
+_shared_socket_dispatch (struct _ipmiconsole_poll_data *poll_data,
+                         uint8_t *pkt,
+                         unsigned int pkt_len,
+                         struct sockaddr *from,
+                         socklen_t fromlen)
+{
+  ipmiconsole_ctx_t c;
+  uint32_t session_id;
+  unsigned int i;
+
+  assert (poll_data);
+  assert (poll_data->shared_socket);
+  assert (pkt);
+  assert (from);
+
+  if ((session_id = _shared_socket_session_id (pkt, pkt_len)))
+    {
+      if (!(c = (ipmiconsole_ctx_t)hash_find (poll_data->shared_socket->session_ids, &session_id)))
+        {
+          IPMICONSOLE_DEBUG (("received unknown session id: %Xh", session_id));
+          return (1);
+        }
+
+      if (!_ipmi_from_valid (c, from, fromlen))
+        {
+          IPMICONSOLE_CTX_DEBUG (c, ("received from invalid address"));
+          return (1);
+        }
+
+      if (!scbuf_is_empty (c->connection.ipmi_from_bmc))
+        return (0);
+
+      if (_ipmi_packet_store (c, pkt, pkt_len) < 0)
+        c->session.close_session_flag++;
+
+      return (1);
+    }
+
+  /* No session id, hand the packet to every context at this address */
+  for (i = 0; i < poll_data->ctxs_len; i++)
+    {
+      c = poll_data->pfds_ctxs[i];
+
+      if (c->connection.ipmi_fd_shared
+          && _ipmi_from_valid (c, from, fromlen)
+          && !scbuf_is_empty (c->connection.ipmi_from_bmc))
+        return (0);
+    }
+
+  for (i = 0; i < poll_data->ctxs_len; i++)
+    {
+      c = poll_data->pfds_ctxs[i];
+
+      if (c->connection.ipmi_fd_shared
+          && _ipmi_from_valid (c, from, fromlen))
+        {
+          if (_ipmi_packet_store (c, pkt, pkt_len) < 0)
+            c->session.close_session_flag++;
+        }
+    }
+
+  return (1);
+}
+
+static void
+_shared_socket_recvfrom (struct _ipmiconsole_poll_data *poll_data, int fd)
+{
+  struct _ipmiconsole_shared_socket *s;
+  struct sockaddr *from;
+  unsigned int i;
+
+  assert (poll_data);
+  assert (poll_data->shared_socket);
+  assert (fd >= 0);
+
+  s = poll_data->shared_socket;
+  from = (struct sockaddr *)&(s->from);
+
+  /* Can't read more until the deferred packet has been stored */
+  for (i = 0; i < IPMICONSOLE_SHARED_SOCKET_RECV_MAX && !s->pkt_len; i++)
+    {
+      ssize_t len;
+
+      s->fromlen = sizeof (struct sockaddr_in6);
+
+      do
+        {
+          len = ipmi_lan_recvfrom (fd,
+                                   s->pkt,
+                                   IPMICONSOLE_PACKET_BUFLEN,
+                                   MSG_DONTWAIT,
+                                   from,
+                                   &(s->fromlen));
+        } while (len < 0 && errno == EINTR);
+
+      if (len < 0)
+        {
+          /* See comments in _ipmi_recvfrom() regarding ECONNRESET/ECONNREFUSED */
+          if (errno != EAGAIN
+              && errno != EWOULDBLOCK
+              && errno != ECONNRESET
+              && errno != ECONNREFUSED)
+            IPMICONSOLE_DEBUG (("ipmi_lan_recvfrom: %s", strerror (errno)));
+          break;
+        }
+
+      if (!len)
+        continue;
+
+      if (!_shared_socket_dispatch (poll_data, s->pkt, len, from, s->fromlen))
+        s->pkt_len = len;
+    }
+}
+
+static void
+_shared_socket_sendto (struct _ipmiconsole_poll_data *poll_data, unsigned int family_index)
+{
+  unsigned int i;
+
+  assert (poll_data);
+
+  for (i = 0; i < poll_data->ctxs_len; i++)
+    {
+      ipmiconsole_ctx_t c = poll_data->pfds_ctxs[i];
+
+      if (!c->connection.ipmi_fd_shared
+          || _shared_socket_index (c) != family_index
+          || scbuf_is_empty (c->connection.ipmi_to_bmc))
+        continue;
+
+      if (_ipmi_sendto (c) < 0)
+        c->session.close_session_flag++;
+    }
+}
+
+static void
+_shared_socket_process (struct _ipmiconsole_poll_data *poll_data)
+{
+  struct _ipmiconsole_shared_socket *s;
+  struct pollfd *pfds;
+  unsigned int i;
+
+  assert (poll_data);
+  assert (poll_data->shared_socket);
+
+  s = poll_data->shared_socket;
+  pfds = &(poll_data->pfds[poll_data->ctxs_len * 3]);
+
+  /* Deferred packet goes first to keep packets in order */
+  if (s->pkt_len)
+    {
+      if (_shared_socket_dispatch (poll_data,
+                                   s->pkt,
+                                   s->pkt_len,
+                                   (struct sockaddr *)&(s->from),
+                                   s->fromlen))
+        s->pkt_len = 0;
+    }
+
+  for (i = 0; i < IPMICONSOLE_SHARED_SOCKET_COUNT; i++)
+    {
+      if (pfds[i].revents & (POLLIN | POLLERR))
+        _shared_socket_recvfrom (poll_data, pfds[i].fd);
+      if (pfds[i].revents & POLLOUT)
+        _shared_socket_sendto (poll_data, i);
+    }
+}
+
 /*
  * Return 0 on success
  * Return -1 on fatal error
@@ -787,6 +1185,17 @@ _console_read (ipmiconsole_ctx_t c)
       return (-1);
     }
 
+  /* Start of the SOL input coalescing interval */
+  if (scbuf_is_empty (c->connection.console_remote_console_to_bmc))
+    {
+      if (gettimeofday (&(c->connection.console_remote_console_to_bmc_first_write), NULL) < 0)
+        {
+          IPMICONSOLE_CTX_DEBUG (c, ("gettimeofday: %s", strerror (errno)));
+          ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SYSTEM_ERROR);
+          return (-1);
+        }
+    }
+
   if ((n = scbuf_write (c->connection.console_remote_console_to_bmc, buffer, len, &dropped, secure_malloc_flag)) < 0)
     {
       IPMICONSOLE_CTX_DEBUG (c, ("scbuf_write: %s", strerror (errno)));
@@ -932,6 +1341,117 @@ _ipmiconsole_poll (struct pollfd *ufds, unsigned int nfds, int timeout)
   return n;
 }
 
+static int
+_stats_dump_ctx (void *x, void *arg)
+{
+  ipmiconsole_ctx_t c;
+  struct ipmiconsole_ctx_stats stats;
+  char histogram[IPMICONSOLE_CTX_STATS_ACK_LATENCY_BUCKETS * 21];
+  unsigned int histogram_len = 0;
+  unsigned int i;
+
+  assert (x);
+
+  c = (ipmiconsole_ctx_t)x;
+
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+
+  if (ipmiconsole_ctx_stats_get (c, &stats) < 0)
+    return (0);
+
+  histogram[0] = '\0';
+  for (i = 0; i < IPMICONSOLE_CTX_STATS_ACK_LATENCY_BUCKETS; i++)
+    histogram_len += snprintf (histogram + histogram_len,
+                               sizeof (histogram) - histogram_len,
+                               "%s%llu",
+                               i ? "/" : "",
+                               (unsigned long long)stats.sol_ack_latency_histogram[i]);
+
+  IPMICONSOLE_DEBUG (("stats: hostname=%s; "
+                      "ipmi_packets_sent=%llu; ipmi_packets_received=%llu; ipmi_retransmissions=%llu; keepalives=%llu; "
+                      "sol_packets_sent=%llu; sol_packets_received=%llu; sol_retransmissions=%llu; sol_serial_keepalives=%llu; "
+                      "sol_bytes_sent=%llu; sol_bytes_received=%llu; "
+                      "sol_acks=%llu; sol_ack_latency_total=%llu; sol_ack_latency_max=%llu; sol_ack_latency_histogram=%s",
+                      c->config.hostname,
+                      (unsigned long long)stats.ipmi_packets_sent,
+                      (unsigned long long)stats.ipmi_packets_received,
+                      (unsigned long long)stats.ipmi_retransmissions,
+                      (unsigned long long)stats.keepalives,
+                      (unsigned long long)stats.sol_packets_sent,
+                      (unsigned long long)stats.sol_packets_received,
+                      (unsigned long long)stats.sol_retransmissions,
+                      (unsigned long long)stats.sol_serial_keepalives,
+                      (unsigned long long)stats.sol_bytes_sent,
+                      (unsigned long long)stats.sol_bytes_received,
+                      (unsigned long long)stats.sol_acks,
+                      (unsigned long long)stats.sol_ack_latency_total,
+                      (unsigned long long)stats.sol_ack_latency_max,
+                      histogram));
+  return (1);
+}
+
+/* Dump the engine thread and context counters if the stats interval
+ * has passed and shorten the poll timeout so the next dump isn't
+ * late.  Called with console_engine_ctxs_mutex[index] held.
+ */
+static void
+_stats_dump_if_due (unsigned int index,
+                    struct timeval *last_stats_dump,
+                    unsigned int *timeout_len)
+{
+  struct timeval current, next_stats_dump, remaining;
+  unsigned int stats_interval;
+  unsigned int remaining_ms;
+  int perr;
+
+  assert (index < IPMICONSOLE_THREAD_COUNT_MAX);
+  assert (last_stats_dump);
+  assert (timeout_len);
+
+  if ((perr = pthread_mutex_lock (&console_engine_stats_interval_mutex)))
+    {
+      IPMICONSOLE_DEBUG (("pthread_mutex_lock: %s", strerror (perr)));
+      return;
+    }
+
+  stats_interval = console_engine_stats_interval;
+
+  if ((perr = pthread_mutex_unlock (&console_engine_stats_interval_mutex)))
+    IPMICONSOLE_DEBUG (("pthread_mutex_unlock: %s", strerror (perr)));
+
+  if (!stats_interval)
+    return;
+
+  if (gettimeofday (&current, NULL) < 0)
+    {
+      IPMICONSOLE_DEBUG (("gettimeofday: %s", strerror (errno)));
+      return;
+    }
+
+  timeval_add_ms (last_stats_dump, stats_interval * 1000, &next_stats_dump);
+
+  if (!timeval_lt (&current, &next_stats_dump))
+    {
+      IPMICONSOLE_DEBUG (("stats: engine thread=%u; loop_iterations=%llu; poll_time=%llu; ctxs_count=%u; ctxs_submitted=%u",
+                          index,
+                          (unsigned long long)console_engine_stats[index].loop_iterations,
+                          (unsigned long long)console_engine_stats[index].poll_time,
+                          list_count (console_engine_ctxs[index]),
+                          console_engine_ctxs_count[index]));
+
+      if (list_for_each (console_engine_ctxs[index], _stats_dump_ctx, NULL) < 0)
+        IPMICONSOLE_DEBUG (("list_for_each: %s", strerror (errno)));
+
+      *last_stats_dump = current;
+      timeval_add_ms (&current, stats_interval * 1000, &next_stats_dump);
+    }
+
+  timeval_sub (&next_stats_dump, &current, &remaining);
+  timeval_millisecond_calc (&remaining, &remaining_ms);
+  if (remaining_ms < *timeout_len)
+    *timeout_len = remaining_ms;
+}
+
 static void *
 _ipmiconsole_engine (void *arg)
 {
@@ -939,6 +1459,8 @@ _ipmiconsole_engine (void *arg)
   unsigned int index;
   unsigned int teardown_flag = 0;
   unsigned int teardown_initiated = 0;
+  struct timeval last_stats_dump;
+  uint64_t poll_time = 0;
 
   assert (arg);
 
@@ -952,6 +1474,12 @@ _ipmiconsole_engine (void *arg)
   if (signal (SIGPIPE, SIG_IGN) == SIG_ERR)
     IPMICONSOLE_DEBUG (("signal: %s", strerror (errno)));
 
+  if (gettimeofday (&last_stats_dump, NULL) < 0)
+    {
+      IPMICONSOLE_DEBUG (("gettimeofday: %s", strerror (errno)));
+      timeval_clear (&last_stats_dump);
+    }
+
   while (!teardown_flag || ctxs_count)
     {
       struct _ipmiconsole_poll_data poll_data;
@@ -961,11 +1489,14 @@ _ipmiconsole_engine (void *arg)
       int unlock_console_engine_ctxs_mutex_flag = 0;
       int spin_wait_flag = 0;
       char buf[IPMICONSOLE_PIPE_BUFLEN];
+      struct timeval poll_start, poll_end, poll_delta;
 
       poll_data.pfds = NULL;
       poll_data.pfds_ctxs = NULL;
       poll_data.ctxs_len = 0;
       poll_data.pfds_index = 0;
+      poll_data.shared_socket = NULL;
+      memset (poll_data.shared_pollout, '\0', sizeof (poll_data.shared_pollout));
 
       if ((perr = pthread_mutex_lock (&console_engine_teardown_mutex)))
         {
@@ -1004,6 +1535,13 @@ _ipmiconsole_engine (void *arg)
           teardown_flag = 1;
         }
 
+      /* poll time of the previous iteration is counted now that the
+       * stats are under the lock
+       */
+      console_engine_stats[index].loop_iterations++;
+      console_engine_stats[index].poll_time += poll_time;
+      poll_time = 0;
+
       /* Note: Set close_session_flag in the contexts before
        * ipmiconsole_process_ctxs(), so the initiation of the closing
        * down will begin now rather than the next iteration of the
@@ -1025,6 +1563,8 @@ _ipmiconsole_engine (void *arg)
       if ((ctxs_count = ipmiconsole_process_ctxs (console_engine_ctxs[index], &timeout_len)) < 0)
         goto continue_loop;
 
+      _stats_dump_if_due (index, &last_stats_dump, &timeout_len);
+
       if (!ctxs_count && teardown_flag)
         continue;
 
@@ -1051,10 +1591,12 @@ _ipmiconsole_engine (void *arg)
       /*
        * There are 3 pfds per ctx.  One for 'ipmi_fd', 'asynccomm[0]', and 'ipmiconsole_fd'.
        *
-       * There is + 1 pfds for the "console_engine_ctxs_notifier".
-       * This will be set up manually here, and not in _poll_setup().
+       * There are + IPMICONSOLE_SHARED_SOCKET_COUNT pfds for the
+       * shared sockets and + 1 pfds for the
+       * "console_engine_ctxs_notifier".  These will be set up
+       * manually here, and not in _poll_setup().
        */
-      if (!(poll_data.pfds = (struct pollfd *)malloc (((poll_data.ctxs_len * 3) + 1) * sizeof (struct pollfd))))
+      if (!(poll_data.pfds = (struct pollfd *)malloc (((poll_data.ctxs_len * 3) + IPMICONSOLE_SHARED_SOCKET_COUNT + 1) * sizeof (struct pollfd))))
         {
           IPMICONSOLE_DEBUG (("malloc: %s", strerror (errno)));
           goto continue_loop;
@@ -1066,20 +1608,52 @@ _ipmiconsole_engine (void *arg)
           goto continue_loop;
         }
 
+      /* Session id hash is rebuilt in _poll_setup() */
+      if ((poll_data.shared_socket = console_engine_shared_socket[index]))
+        {
+          if (hash_delete_if (poll_data.shared_socket->session_ids,
+                              _shared_socket_session_id_clear,
+                              NULL) < 0)
+            {
+              IPMICONSOLE_DEBUG (("hash_delete_if: %s", strerror (errno)));
+              goto continue_loop;
+            }
+        }
+
       if ((count = list_for_each (console_engine_ctxs[index], _poll_setup, &poll_data)) < 0)
         {
           IPMICONSOLE_DEBUG (("list_for_each: %s", strerror (errno)));
           goto continue_loop;
         }
 
+      /* Setup shared sockets after the ctxs */
+      for (i = 0; i < IPMICONSOLE_SHARED_SOCKET_COUNT; i++)
+        {
+          struct pollfd *pfd = &(poll_data.pfds[(poll_data.ctxs_len * 3) + i]);
+
+          pfd->fd = poll_data.shared_socket ? poll_data.shared_socket->fd[i] : -1;
+          pfd->events = 0;
+          pfd->revents = 0;
+          if (pfd->fd >= 0)
+            {
+              pfd->events |= POLLIN;
+              if (poll_data.shared_pollout[i])
+                pfd->events |= POLLOUT;
+            }
+        }
+
+      /* Don't sit in poll() if a deferred packet is waiting to be stored */
+      if (poll_data.shared_socket && poll_data.shared_socket->pkt_len)
+        timeout_len = 0;
+
       if ((perr = pthread_mutex_unlock (&console_engine_ctxs_mutex[index])))
         IPMICONSOLE_DEBUG (("pthread_mutex_unlock: %s", strerror (perr)));
       unlock_console_engine_ctxs_mutex_flag++;
 
       /* Setup notifier pipe as last remaining poll data */
-      poll_data.pfds[(poll_data.ctxs_len * 3)].fd = console_engine_ctxs_notifier[index][0];
-      poll_data.pfds[(poll_data.ctxs_len * 3)].events = POLLIN;
-      poll_data.pfds[(poll_data.ctxs_len * 3)].revents = 0;
+      poll_data.pfds[(poll_data.ctxs_len * 3) + IPMICONSOLE_SHARED_SOCKET_COUNT].fd = console_engine_ctxs_notifier[index][0];
+      poll_data.pfds[(poll_data.ctxs_len * 3) + IPMICONSOLE_SHARED_SOCKET_COUNT].events = POLLIN;
+      poll_data.pfds[(poll_data.ctxs_len * 3) + IPMICONSOLE_SHARED_SOCKET_COUNT].revents = 0;
 
       if (count != ctxs_count)
         {
@@ -1093,12 +1667,23 @@ _ipmiconsole_engine (void *arg)
           goto continue_loop;
         }
 
-      if (_ipmiconsole_poll (poll_data.pfds, (poll_data.ctxs_len * 3) + 1, timeout_len) < 0)
+      if (gettimeofday (&poll_start, NULL) < 0)
+        timeval_clear (&poll_start);
+
+      if (_ipmiconsole_poll (poll_data.pfds, (poll_data.ctxs_len * 3) + IPMICONSOLE_SHARED_SOCKET_COUNT + 1, timeout_len) < 0)
         {
           IPMICONSOLE_DEBUG (("poll: %s", strerror (errno)));
           goto continue_loop;
         }
 
+      if (poll_start.tv_sec
+          && gettimeofday (&poll_end, NULL) == 0
+          && timeval_gt (&poll_end, &poll_start))
+        {
+          timeval_sub (&poll_end, &poll_start, &poll_delta);
+          poll_time = (uint64_t)poll_delta.tv_sec * 1000000 + poll_delta.tv_usec;
+        }
+
       for (i = 0; i < poll_data.ctxs_len; i++)
         {
           if (poll_data.pfds[i*3].revents & POLLERR)
@@ -1194,8 +1779,11 @@ _ipmiconsole_engine (void *arg)
             }
         }
 
+      if (poll_data.shared_socket)
+        _shared_socket_process (&poll_data);
+
       /* We don't care what's read, just get it off the fd */
-      if (poll_data.pfds[(poll_data.ctxs_len * 3)].revents & POLLIN)
+      if (poll_data.pfds[(poll_data.ctxs_len * 3) + IPMICONSOLE_SHARED_SOCKET_COUNT].revents & POLLIN)
         {
           if (read (console_engine_ctxs_notifier[index][0], buf, IPMICONSOLE_PIPE_BUFLEN) < 0)
             IPMICONSOLE_DEBUG (("read: %s", strerror (errno)));
@@ -1306,6 +1894,157 @@ ipmiconsole_engine_thread_create (void)
   return (rv);
 }
 
+/*
+ * Return 0 on success
+ * Return -1 on error
+ */
+static int
+_shared_socket_setup (ipmiconsole_ctx_t c, unsigned int index)
+{
+  struct _ipmiconsole_shared_socket *s;
+  unsigned int family_index;
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+  assert (c->config.engine_flags & IPMICONSOLE_ENGINE_SHARED_SOCKET);
+  assert (index < IPMICONSOLE_THREAD_COUNT_MAX);
+
+  if (!console_engine_shared_socket[index])
+    {
+      if (!(s = (struct _ipmiconsole_shared_socket *)malloc (sizeof (struct _ipmiconsole_shared_socket))))
+        {
+          IPMICONSOLE_DEBUG (("malloc: %s", strerror (errno)));
+          ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_OUT_OF_MEMORY);
+          return (-1);
+        }
+      memset (s, '\0', sizeof (struct _ipmiconsole_shared_socket));
+      s->fd[IPMICONSOLE_SHARED_SOCKET_INET] = -1;
+      s->fd[IPMICONSOLE_SHARED_SOCKET_INET6] = -1;
+
+      if (!(s->session_ids = hash_create (0,
+                                          _shared_socket_session_id_hash,
+                                          _shared_socket_session_id_cmp,
+                                          NULL)))
+        {
+          IPMICONSOLE_DEBUG (("hash_create: %s", strerror (errno)));
+          ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_OUT_OF_MEMORY);
+          free (s);
+          return (-1);
+        }
+
+      console_engine_shared_socket[index] = s;
+    }
+
+  s = console_engine_shared_socket[index];
+  family_index = _shared_socket_index (c);
+
+  if (s->fd[family_index] < 0)
+    {
+      struct sockaddr *srcaddr;
+      socklen_t srcaddr_len;
+      struct sockaddr_in srcaddr4;
+      struct sockaddr_in6 srcaddr6;
+      int domain;
+      int rcvbuf = IPMICONSOLE_SHARED_SOCKET_RCVBUF;
+      int fd;
+
+      if (family_index == IPMICONSOLE_SHARED_SOCKET_INET)
+        {
+          memset (&srcaddr4, '\0', sizeof (struct sockaddr_in));
+          srcaddr4.sin_family = AF_INET;
+          srcaddr4.sin_port = htons (0);
+          srcaddr = (struct sockaddr *)&srcaddr4;
+          srcaddr_len = sizeof (struct sockaddr_in);
+          domain = AF_INET;
+        }
+      else
+        {
+          memset (&srcaddr6, '\0', sizeof (struct sockaddr_in6));
+          srcaddr6.sin6_family = AF_INET6;
+          srcaddr6.sin6_port = htons (0);
+          srcaddr = (struct sockaddr *)&srcaddr6;
+          srcaddr_len = sizeof (struct sockaddr_in6);
+          domain = AF_INET6;
+        }
+
+      if ((fd = socket (domain, SOCK_DGRAM, 0)) < 0)
+        {
+          IPMICONSOLE_DEBUG (("socket: %s", strerror (errno)));
+          if (errno == EMFILE)
+            ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_TOO_MANY_OPEN_FILES);
+          else
+            ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SYSTEM_ERROR);
+          return (-1);
+        }
+
+      if (ipmiconsole_set_closeonexec (c, fd) < 0)
+        {
+          IPMICONSOLE_DEBUG (("closeonexec error"));
+          /* ignore potential error, cleanup path */
+          close (fd);
+          return (-1);
+        }
+
+      if (bind (fd, srcaddr, srcaddr_len) < 0)
+        {
+          IPMICONSOLE_DEBUG (("bind: %s", strerror (errno)));
+          ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SYSTEM_ERROR);
+          /* ignore potential error, cleanup path */
+          close (fd);
+          return (-1);
+        }
+
+      /* Many BMCs will reply into this one socket, a larger receive
+       * buffer keeps packets from being dropped.  Not a fatal error.
+       */
+      if (setsockopt (fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof (rcvbuf)) < 0)
+        IPMICONSOLE_DEBUG (("setsockopt: %s", strerror (errno)));
+
+      s->fd[family_index] = fd;
+    }
+
+  /* Session ids must be unique among contexts sharing the socket */
+  while (hash_find (s->session_ids, &(c->session.remote_console_session_id)))
+    {
+      do
+        {
+          if (ipmi_get_random (&(c->session.remote_console_session_id),
+                               sizeof (c->session.remote_console_session_id)) < 0)
+            {
+              IPMICONSOLE_DEBUG (("ipmi_get_random: %s", strerror (errno)));
+              ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_INTERNAL_ERROR);
+              return (-1);
+            }
+        } while (!c->session.remote_console_session_id);
+    }
+
+  c->connection.ipmi_fd = s->fd[family_index];
+  c->connection.ipmi_fd_shared = 1;
+  return (0);
+}
+
+static void
+_shared_socket_cleanup (void)
+{
+  unsigned int i, j;
+
+  for (i = 0; i < IPMICONSOLE_THREAD_COUNT_MAX; i++)
+    {
+      if (!console_engine_shared_socket[i])
+        continue;
+
+      for (j = 0; j < IPMICONSOLE_SHARED_SOCKET_COUNT; j++)
+        {
+          /* ignore potential error, cleanup path */
+          if (console_engine_shared_socket[i]->fd[j] >= 0)
+            close (console_engine_shared_socket[i]->fd[j]);
+        }
+      hash_destroy (console_engine_shared_socket[i]->session_ids);
+      free (console_engine_shared_socket[i]);
+      console_engine_shared_socket[i] = NULL;
+    }
+}
+
 int
 ipmiconsole_engine_submit_ctx (ipmiconsole_ctx_t c)
 {
@@ -1356,6 +2095,12 @@ ipmiconsole_engine_submit_ctx (ipmiconsole_ctx_t c)
       goto cleanup_thread_count;
     }
 
+  if (c->config.engine_flags & IPMICONSOLE_ENGINE_SHARED_SOCKET)
+    {
+      if (_shared_socket_setup (c, index) < 0)
+        goto cleanup_ctxs;
+    }
+
   if (!(ptr = list_append (console_engine_ctxs[index], c)))
     {
       /* Note: Don't do a CTX debug, this is more of a global debug */
@@ -1557,6 +2302,8 @@ ipmiconsole_engine_cleanup (int cleanup_sol_sessions)
   list_destroy (console_engine_ctxs_to_destroy);
   console_engine_ctxs_to_destroy = NULL;
 
+  _shared_socket_cleanup ();
+
   /* ignore potential error, cleanup path */
   close (dummy_fd);
   dummy_fd = -1;
@@ -1585,3 +2332,60 @@ ipmiconsole_engine_cleanup (int cleanup_sol_sessions)
 
   return (rv);
 }
+
+int
+ipmiconsole_engine_stats_get (struct ipmiconsole_engine_stats *stats,
+                              unsigned int stats_len)
+{
+  unsigned int i;
+  int perr, rv = -1;
+
+  assert (stats);
+
+  if ((perr = pthread_mutex_lock (&console_engine_thread_count_mutex)))
+    {
+      IPMICONSOLE_DEBUG (("pthread_mutex_lock: %s", strerror (perr)));
+      errno = perr;
+      return (-1);
+    }
+
+  for (i = 0; i < console_engine_thread_count && i < stats_len; i++)
+    {
+      if ((perr = pthread_mutex_lock (&console_engine_ctxs_mutex[i])))
+        {
+          IPMICONSOLE_DEBUG (("pthread_mutex_lock: %s", strerror (perr)));
+          errno = perr;
+          goto cleanup;
+        }
+
+      memcpy (&stats[i], &console_engine_stats[i], sizeof (struct ipmiconsole_engine_stats));
+      stats[i].ctxs_count = list_count (console_engine_ctxs[i]);
+      stats[i].ctxs_submitted = console_engine_ctxs_count[i];
+
+      if ((perr = pthread_mutex_unlock (&console_engine_ctxs_mutex[i])))
+        IPMICONSOLE_DEBUG (("pthread_mutex_unlock: %s", strerror (perr)));
+    }
+
+  rv = i;
+ cleanup:
+  if ((perr = pthread_mutex_unlock (&console_engine_thread_count_mutex)))
+    IPMICONSOLE_DEBUG (("pthread_mutex_unlock: %s", strerror (perr)));
+  return (rv);
+}
+
+void
+ipmiconsole_engine_stats_interval_set (unsigned int stats_interval)
+{
+  int perr;
+
+  if ((perr = pthread_mutex_lock (&console_engine_stats_interval_mutex)))
+    {
+      IPMICONSOLE_DEBUG (("pthread_mutex_lock: %s", strerror (perr)));
+      return;
+    }
+
+  console_engine_stats_interval = stats_interval;
+
+  if ((perr = pthread_mutex_unlock (&console_engine_stats_interval_mutex)))
+    IPMICONSOLE_DEBUG (("pthread_mutex_unlock: %s", strerror (perr)));
+}
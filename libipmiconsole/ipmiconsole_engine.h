@@ -41,4 +41,11 @@ int ipmiconsole_engine_submit_ctx (ipmiconsole_ctx_t c);
 
 int ipmiconsole_engine_cleanup (int cleanup_sol_sessions);
 
+/* Returns number of engine threads whose stats were copied out */
+int ipmiconsole_engine_stats_get (struct ipmiconsole_engine_stats *stats,
+                                  unsigned int stats_len);
+
+/* 0 disables the periodic stats dump */
+void ipmiconsole_engine_stats_interval_set (unsigned int stats_interval);
+
 #endif /* IPMICONSOLE_ENGINE_H */
@@ -74,6 +74,30 @@
 #include "secure.h"
 #include "timeval.h"
 
+/* Counters are only read by the API and the engine's stats dump,
+ * errors updating them are not fatal to the session.
+ */
+static void
+_stats_add (ipmiconsole_ctx_t c, uint64_t *counter, uint64_t val)
+{
+  int perr;
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+  assert (counter);
+
+  if ((perr = pthread_mutex_lock (&(c->stats.stats_mutex))) != 0)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("pthread_mutex_lock: %s", strerror (perr)));
+      return;
+    }
+
+  (*counter) += val;
+
+  if ((perr = pthread_mutex_unlock (&(c->stats.stats_mutex))) != 0)
+    IPMICONSOLE_CTX_DEBUG (c, ("pthread_mutex_unlock: %s", strerror (perr)));
+}
+
 /*
  * Returns 0 on success
  * Returns -1 on error
@@ -155,6 +179,8 @@ _send_ipmi_packet (ipmiconsole_ctx_t c, ipmiconsole_packet_type_t p)
       return (-1);
     }
 
+  _stats_add (c, &(c->stats.stats.ipmi_packets_sent), 1);
+
   if (p != IPMICONSOLE_PACKET_TYPE_GET_CHANNEL_PAYLOAD_VERSION_RQ)
     t = &(c->session.last_ipmi_packet_sent);
   else
@@ -170,6 +196,108 @@ _send_ipmi_packet (ipmiconsole_ctx_t c, ipmiconsole_packet_type_t p)
   return (0);
 }
 
+/* Upper bounds in microseconds of the ACK latency histogram buckets,
+ * the last bucket has no bound.
+ */
+static const uint64_t ack_latency_bounds[IPMICONSOLE_CTX_STATS_ACK_LATENCY_BUCKETS - 1] =
+  {
+    1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000, 1000000,
+  };
+
+static void
+_sol_stats_ack (ipmiconsole_ctx_t c, unsigned int accepted_character_count)
+{
+  struct timeval current;
+  struct timeval latency;
+  uint64_t latency_us;
+  unsigned int i;
+  int perr;
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+
+  if (gettimeofday (&current, NULL) < 0)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("gettimeofday: %s", strerror (errno)));
+      return;
+    }
+
+  timeval_sub (&current, &(c->session.last_sol_input_packet_sent), &latency);
+  latency_us = (uint64_t)latency.tv_sec * 1000000 + latency.tv_usec;
+
+  if ((perr = pthread_mutex_lock (&(c->stats.stats_mutex))) != 0)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("pthread_mutex_lock: %s", strerror (perr)));
+      return;
+    }
+
+  c->stats.stats.sol_bytes_sent += accepted_character_count;
+
+  /* Can't tell which transmission a retransmitted packet's ACK is for */
+  if (!c->session.sol_input_retransmitted)
+    {
+      c->stats.stats.sol_acks++;
+      c->stats.stats.sol_ack_latency_total += latency_us;
+      if (latency_us > c->stats.stats.sol_ack_latency_max)
+        c->stats.stats.sol_ack_latency_max = latency_us;
+
+      for (i = 0; i < IPMICONSOLE_CTX_STATS_ACK_LATENCY_BUCKETS - 1; i++)
+        {
+          if (latency_us < ack_latency_bounds[i])
+            break;
+        }
+      c->stats.stats.sol_ack_latency_histogram[i]++;
+    }
+
+  if ((perr = pthread_mutex_unlock (&(c->stats.stats_mutex))) != 0)
+    IPMICONSOLE_CTX_DEBUG (c, ("pthread_mutex_unlock: %s", strerror (perr)));
+}
+
+/*
+ * Returns 1 if buffered user input should be sent now
+ * Returns 0 if it may be held back to fill a fuller packet
+ * Returns -1 on error
+ */
+static int
+_sol_input_is_due (ipmiconsole_ctx_t c)
+{
+  struct timeval current;
+  struct timeval coalesce_timeout;
+  int used;
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+
+  if (!c->config.sol_input_coalesce_interval
+      || c->session.break_requested)
+    return (1);
+
+  if ((used = scbuf_used (c->connection.console_remote_console_to_bmc)) < 0)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("scbuf_used: %s", strerror (errno)));
+      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_INTERNAL_ERROR);
+      return (-1);
+    }
+
+  if (used >= c->session.max_sol_character_send_size)
+    return (1);
+
+  if (gettimeofday (&current, NULL) < 0)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("gettimeofday: %s", strerror (errno)));
+      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SYSTEM_ERROR);
+      return (-1);
+    }
+
+  timeval_add_ms (&(c->connection.console_remote_console_to_bmc_first_write),
+                  c->config.sol_input_coalesce_interval,
+                  &coalesce_timeout);
+  if (timeval_lt (&current, &coalesce_timeout))
+    return (0);
+
+  return (1);
+}
+
 /*
  * Returns 0 on success
  * Returns -1 on error
@@ -293,6 +421,8 @@ _send_sol_packet_with_character_data (ipmiconsole_ctx_t c,
     }
 
   c->session.sol_input_waiting_for_ack++;
+  c->session.sol_input_retransmitted = is_retransmission;
+  _stats_add (c, &(c->stats.stats.sol_packets_sent), 1);
   rv = 0;
  cleanup:
   return (rv);
@@ -366,6 +496,7 @@ _send_sol_packet_ack_only (ipmiconsole_ctx_t c,
       return (-1);
     }
 
+  _stats_add (c, &(c->stats.stats.sol_packets_sent), 1);
   return (0);
 }
 
@@ -456,6 +587,8 @@ _send_sol_packet_generate_break (ipmiconsole_ctx_t c,
 
   c->session.sol_input_waiting_for_ack++;
   c->session.sol_input_waiting_for_break_ack++;
+  c->session.sol_input_retransmitted = is_retransmission;
+  _stats_add (c, &(c->stats.stats.sol_packets_sent), 1);
   return (0);
 }
 
@@ -586,6 +719,10 @@ _receive_packet (ipmiconsole_ctx_t c, ipmiconsole_packet_type_t *p)
     /* It's debugging, who cares if the call succeeds or fails */
     ipmiconsole_packet_dump (c, *p, pkt, pkt_len);
 
+  /* SOL payload packets are counted with the SOL counters */
+  if (*p != IPMICONSOLE_PACKET_TYPE_SOL_PAYLOAD_DATA_RS)
+    _stats_add (c, &(c->stats.stats.ipmi_packets_received), 1);
+
   if (*p == IPMICONSOLE_PACKET_TYPE_GET_AUTHENTICATION_CAPABILITIES_RS)
     {
       /* Notes: These checks are for IPMI 1.5 pre-session packets, so
@@ -1498,6 +1635,8 @@ _ipmi_retransmission_timeout (ipmiconsole_ctx_t c)
   IPMICONSOLE_CTX_DEBUG (c, ("retransmission: retransmission_count = %d; maximum_retransmission_count = %d; protocol_state = %d", c->session.retransmission_count, c->config.maximum_retransmission_count, c->session.protocol_state));
 #endif
 
+  _stats_add (c, &(c->stats.stats.ipmi_retransmissions), 1);
+
   /* Note:
    *
    * With the exception of close-session conditions, protocol
@@ -1673,6 +1812,8 @@ _sol_retransmission_timeout (ipmiconsole_ctx_t c, int *dont_deactivate_flag)
 
  send_sol_packet:
 
+  _stats_add (c, &(c->stats.stats.sol_retransmissions), 1);
+
   if (!c->session.sol_input_waiting_for_break_ack)
     {
       /* Notes: If the previous sol transmission included an ACK,
@@ -1762,6 +1903,7 @@ _keepalive_timeout (ipmiconsole_ctx_t c)
           /* Note that the protocol_state stays in SOL_SESSION */
           if (_send_ipmi_packet (c, IPMICONSOLE_PACKET_TYPE_GET_CHANNEL_PAYLOAD_VERSION_RQ) < 0)
             return (-1);
+          _stats_add (c, &(c->stats.stats.keepalives), 1);
           return (1);
         }
     }
@@ -1886,6 +2028,7 @@ _serial_keepalive_timeout (ipmiconsole_ctx_t c)
               c->session.protocol_state = IPMICONSOLE_PROTOCOL_STATE_DEACTIVATE_PAYLOAD_SENT;
               return (1);
             }
+          _stats_add (c, &(c->stats.stats.sol_serial_keepalives), 1);
           return (1);
         }
     }
@@ -2538,6 +2681,7 @@ _sol_bmc_to_remote_console_packet (ipmiconsole_ctx_t c, int *sol_deactivating_fl
   uint8_t nack;
   uint64_t val;
   int n, dropped, rv = -1;
+  int input_due = 0;
   int secure_malloc_flag;
 
   assert (c);
@@ -2565,6 +2709,8 @@ _sol_bmc_to_remote_console_packet (ipmiconsole_ctx_t c, int *sol_deactivating_fl
    * additional character data.
    */
 
+  _stats_add (c, &(c->stats.stats.sol_packets_received), 1);
+
   if (FIID_OBJ_GET (c->connection.obj_sol_payload_data_rs,
                     "packet_sequence_number",
                     &val) < 0)
@@ -2679,6 +2825,8 @@ _sol_bmc_to_remote_console_packet (ipmiconsole_ctx_t c, int *sol_deactivating_fl
               accepted_character_count = c->session.sol_input_character_data_len;
             }
 
+          _sol_stats_ack (c, accepted_character_count);
+
           if ((n = scbuf_drop (c->connection.console_remote_console_to_bmc, accepted_character_count)) < 0)
             {
               IPMICONSOLE_CTX_DEBUG (c, ("scbuf_drop: %s", strerror (errno)));
@@ -2718,6 +2866,8 @@ _sol_bmc_to_remote_console_packet (ipmiconsole_ctx_t c, int *sol_deactivating_fl
           if (break_condition != IPMI_SOL_BREAK_CONDITION_DETECTED)
             IPMICONSOLE_CTX_DEBUG (c, ("SOL packet w/o break condition detected"));
 #endif
+          _sol_stats_ack (c, 0);
+
           c->session.break_requested = 0;
           c->session.sol_input_waiting_for_ack = 0;
           c->session.sol_input_waiting_for_break_ack = 0;
@@ -2767,8 +2917,32 @@ _sol_bmc_to_remote_console_packet (ipmiconsole_ctx_t c, int *sol_deactivating_fl
       else
         character_data_len_to_write = character_data_len;
 
+      if (character_data_len_to_write
+          && (c->config.log_file || c->config.log_tail_size))
+        {
+          /* Logging errors are not fatal to the SOL session */
+          if (ipmiconsole_ctx_log_write (c,
+                                         character_data + character_data_index,
+                                         character_data_len_to_write) < 0)
+            IPMICONSOLE_CTX_DEBUG (c, ("ipmiconsole_ctx_log_write: failed"));
+        }
+
       if (character_data_len_to_write)
+        _stats_add (c, &(c->stats.stats.sol_bytes_received), character_data_len_to_write);
+
+      if (character_data_len_to_write
+          && !(c->config.engine_flags & IPMICONSOLE_ENGINE_LOG_ONLY))
         {
+          if (scbuf_is_empty (c->connection.console_bmc_to_remote_console))
+            {
+              if (gettimeofday (&(c->connection.console_bmc_to_remote_console_first_write), NULL) < 0)
+                {
+                  IPMICONSOLE_CTX_DEBUG (c, ("gettimeofday: %s", strerror (errno)));
+                  ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SYSTEM_ERROR);
+                  goto cleanup;
+                }
+            }
+
           n = scbuf_write (c->connection.console_bmc_to_remote_console,
                            character_data + character_data_index,
                            character_data_len_to_write,
@@ -2802,6 +2976,12 @@ _sol_bmc_to_remote_console_packet (ipmiconsole_ctx_t c, int *sol_deactivating_fl
 
       /* Acknowledge this data.  Send some user data if we got some.*/
       if (!c->session.sol_input_waiting_for_ack && !scbuf_is_empty (c->connection.console_remote_console_to_bmc))
+        {
+          if ((input_due = _sol_input_is_due (c)) < 0)
+            goto cleanup;
+        }
+
+      if (input_due)
         {
           if (_send_sol_packet_with_character_data (c,
                                                     packet_sequence_number,
@@ -2824,7 +3004,11 @@ _sol_bmc_to_remote_console_packet (ipmiconsole_ctx_t c, int *sol_deactivating_fl
           && (!c->session.break_requested
               || (c->session.break_requested && c->session.console_remote_console_to_bmc_bytes_before_break)))
         {
-          if (_send_sol_packet_with_character_data (c, 0, 0, 0) < 0)
+          if ((input_due = _sol_input_is_due (c)) < 0)
+            goto cleanup;
+
+          if (input_due
+              && _send_sol_packet_with_character_data (c, 0, 0, 0) < 0)
             goto cleanup;
         }
       else if (c->session.break_requested)
@@ -2956,15 +3140,225 @@ _calculate_timeout (ipmiconsole_ctx_t c, unsigned int *timeout)
         *timeout = session_timeout_ms;
     }
 
+  /* Buffered console output must be flushed to the log file in a
+   * timely manner.
+   */
+  if (c->connection.log_buf_len)
+    {
+      struct timeval current;
+      struct timeval log_flush_timeout;
+      struct timeval log_flush_timeout_val;
+      unsigned int log_flush_timeout_ms;
+
+      if (gettimeofday (&current, NULL) < 0)
+        {
+          IPMICONSOLE_CTX_DEBUG (c, ("gettimeofday: %s", strerror (errno)));
+          ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SYSTEM_ERROR);
+          return (-1);
+        }
+
+      timeval_add_ms (&c->connection.log_buf_first_write, IPMICONSOLE_LOG_FLUSH_INTERVAL, &log_flush_timeout);
+      timeval_sub (&log_flush_timeout, &current, &log_flush_timeout_val);
+      timeval_millisecond_calc (&log_flush_timeout_val, &log_flush_timeout_ms);
+      if (log_flush_timeout_ms < *timeout)
+        *timeout = log_flush_timeout_ms;
+    }
+
+  /* Coalesced user input and batched console output must go out
+   * within their intervals.  Once due they are no longer waited on
+   * here, the data is sent or written as soon as possible.
+   */
+  if (c->session.protocol_state == IPMICONSOLE_PROTOCOL_STATE_SOL_SESSION
+      && ((c->config.sol_input_coalesce_interval
+           && !c->session.sol_input_waiting_for_ack
+           && !scbuf_is_empty (c->connection.console_remote_console_to_bmc))
+          || !c->connection.console_bmc_to_remote_console_flush))
+    {
+      struct timeval current;
+      struct timeval coalesce_timeout;
+      struct timeval coalesce_timeout_val;
+      unsigned int coalesce_timeout_ms;
+
+      if (gettimeofday (&current, NULL) < 0)
+        {
+          IPMICONSOLE_CTX_DEBUG (c, ("gettimeofday: %s", strerror (errno)));
+          ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SYSTEM_ERROR);
+          return (-1);
+        }
+
+      if (c->config.sol_input_coalesce_interval
+          && !c->session.sol_input_waiting_for_ack
+          && !scbuf_is_empty (c->connection.console_remote_console_to_bmc))
+        {
+          timeval_add_ms (&c->connection.console_remote_console_to_bmc_first_write, c->config.sol_input_coalesce_interval, &coalesce_timeout);
+          if (timeval_lt (&current, &coalesce_timeout))
+            {
+              timeval_sub (&coalesce_timeout, &current, &coalesce_timeout_val);
+              timeval_millisecond_calc (&coalesce_timeout_val, &coalesce_timeout_ms);
+              if (coalesce_timeout_ms < *timeout)
+                *timeout = coalesce_timeout_ms;
+            }
+        }
+
+      if (!c->connection.console_bmc_to_remote_console_flush)
+        {
+          timeval_add_ms (&c->connection.console_bmc_to_remote_console_first_write, c->config.sol_output_flush_interval, &coalesce_timeout);
+          timeval_sub (&coalesce_timeout, &current, &coalesce_timeout_val);
+          timeval_millisecond_calc (&coalesce_timeout_val, &coalesce_timeout_ms);
+          if (coalesce_timeout_ms < *timeout)
+            *timeout = coalesce_timeout_ms;
+        }
+    }
+
+  return (0);
+}
+
+/*
+ * Returns 0 on success
+ * Returns -1 on error
+ */
+static int
+_log_flush_if_due (ipmiconsole_ctx_t c)
+{
+  struct timeval current;
+  struct timeval log_flush_timeout;
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+
+  if (!c->connection.log_buf_len)
+    return (0);
+
+  if (gettimeofday (&current, NULL) < 0)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("gettimeofday: %s", strerror (errno)));
+      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SYSTEM_ERROR);
+      return (-1);
+    }
+
+  timeval_add_ms (&c->connection.log_buf_first_write, IPMICONSOLE_LOG_FLUSH_INTERVAL, &log_flush_timeout);
+  if (!timeval_lt (&current, &log_flush_timeout))
+    {
+      /* Logging errors are not fatal to the SOL session */
+      if (ipmiconsole_ctx_log_flush (c) < 0)
+        IPMICONSOLE_CTX_DEBUG (c, ("ipmiconsole_ctx_log_flush: failed"));
+    }
+
   return (0);
 }
 
+/*
+ * Returns 0 on success
+ * Returns -1 on error
+ */
+static int
+_sol_output_flush_if_due (ipmiconsole_ctx_t c)
+{
+  struct timeval current;
+  struct timeval flush_timeout;
+  int used;
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+
+  c->connection.console_bmc_to_remote_console_flush = 1;
+
+  if (!c->config.sol_output_flush_interval
+      || scbuf_is_empty (c->connection.console_bmc_to_remote_console))
+    return (0);
+
+  if ((used = scbuf_used (c->connection.console_bmc_to_remote_console)) < 0)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("scbuf_used: %s", strerror (errno)));
+      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_INTERNAL_ERROR);
+      return (-1);
+    }
+
+  if (used >= IPMICONSOLE_SOL_OUTPUT_FLUSH_LEN)
+    return (0);
+
+  if (gettimeofday (&current, NULL) < 0)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("gettimeofday: %s", strerror (errno)));
+      ipmiconsole_ctx_set_errnum (c, IPMICONSOLE_ERR_SYSTEM_ERROR);
+      return (-1);
+    }
+
+  timeval_add_ms (&(c->connection.console_bmc_to_remote_console_first_write),
+                  c->config.sol_output_flush_interval,
+                  &flush_timeout);
+  if (timeval_lt (&current, &flush_timeout))
+    c->connection.console_bmc_to_remote_console_flush = 0;
+
+  return (0);
+}
+
+/* The user's fd is no longer polled once a session starts closing, so
+ * console output still batched for the flush interval would be lost.
+ * Write out what the user's socket will take before the session is
+ * torn down.  Errors are ignored, the session is going away
+ * regardless and its errnum must be kept.
+ */
+static void
+_sol_output_drain (ipmiconsole_ctx_t c)
+{
+  int flags;
+
+  assert (c);
+  assert (c->magic == IPMICONSOLE_CTX_MAGIC);
+
+  c->connection.console_bmc_to_remote_console_flush = 1;
+
+  if (c->connection.ipmiconsole_fd < 0
+      || scbuf_is_empty (c->connection.console_bmc_to_remote_console))
+    return;
+
+  /* The fd is closed with the session, don't block on a user that
+   * isn't reading.
+   */
+  if ((flags = fcntl (c->connection.ipmiconsole_fd, F_GETFL)) < 0
+      || fcntl (c->connection.ipmiconsole_fd, F_SETFL, flags | O_NONBLOCK) < 0)
+    {
+      IPMICONSOLE_CTX_DEBUG (c, ("fcntl: %s", strerror (errno)));
+      return;
+    }
+
+  while (!scbuf_is_empty (c->connection.console_bmc_to_remote_console))
+    {
+      char buffer[IPMICONSOLE_PACKET_BUFLEN];
+      ssize_t len;
+      int n;
+
+      if ((n = scbuf_peek (c->connection.console_bmc_to_remote_console,
+                           buffer,
+                           IPMICONSOLE_PACKET_BUFLEN)) <= 0)
+        {
+          IPMICONSOLE_CTX_DEBUG (c, ("scbuf_peek: %s", strerror (errno)));
+          return;
+        }
+
+      if ((len = write (c->connection.ipmiconsole_fd, buffer, n)) < 0)
+        {
+          IPMICONSOLE_CTX_DEBUG (c, ("write: %s", strerror (errno)));
+          return;
+        }
+
+      if (scbuf_drop (c->connection.console_bmc_to_remote_console, len) < 0)
+        {
+          IPMICONSOLE_CTX_DEBUG (c, ("scbuf_drop: %s", strerror (errno)));
+          return;
+        }
+    }
+}
+
 /* Returns 1 to continue the state machine (normally a packet was
  * sent), 0 if nothing was done, -1 to close the session (non-cleanly)
  */
 static int
 _send_sol_character_data_or_break (ipmiconsole_ctx_t c)
 {
+  int ret;
+
   assert (c);
   assert (c->magic == IPMICONSOLE_CTX_MAGIC);
 
@@ -2975,6 +3369,12 @@ _send_sol_character_data_or_break (ipmiconsole_ctx_t c)
       && (!c->session.break_requested
           || (c->session.break_requested && c->session.console_remote_console_to_bmc_bytes_before_break)))
     {
+      if ((ret = _sol_input_is_due (c)) < 0)
+        return (-1);
+
+      if (!ret)
+        return (0);
+
       if (_send_sol_packet_with_character_data (c, 0, 0, 0) < 0)
         {
           /* Attempt to close the session cleanly */
@@ -4189,6 +4589,10 @@ _process_ctx (ipmiconsole_ctx_t c, unsigned int *timeout)
     }
 
  calculate_timeout:
+  if (_log_flush_if_due (c) < 0)
+    goto close_session;
+  if (_sol_output_flush_if_due (c) < 0)
+    goto close_session;
   if (_calculate_timeout (c, timeout) < 0)
     goto close_session;
   rv = 0;
@@ -4228,6 +4632,8 @@ ipmiconsole_process_ctxs (List console_engine_ctxs, unsigned int *timeout)
 
       if ((_process_ctx (c, &ctx_timeout)) < 0)
         {
+          _sol_output_drain (c);
+
           /* On delete, function to cleanup ctx session will be done.
            * Error will be seen by the user via a EOF on a read() or
            * EPIPE on a write().
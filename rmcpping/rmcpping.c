@@ -261,7 +261,7 @@ endresult (const char *progname,
 int
 main (int argc, char **argv)
 {
-  ipmi_ping_setup (argc, argv, 0, RMCP_ASF_MESSAGE_TAG_MAX, "hVc:i:I:t:vs:d");
+  ipmi_ping_setup (argc, argv, 0, RMCP_ASF_MESSAGE_TAG_MAX, "hVc:i:I:t:vs:R:d");
   ipmi_ping_loop (createpacket, parsepacket, latepacket, endresult);
   exit (EXIT_FAILURE);                    /* NOT REACHED */
 }